@@ -550,7 +550,7 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   s->imgUV = NULL;
 
   get_mem2Dpel_pad (&(s->imgY), size_y, size_x, p_Vid->iLumaPadY, p_Vid->iLumaPadX);
-  s->iLumaStride = size_x+2*p_Vid->iLumaPadX;
+  s->iLumaStride = get_plane_stride(size_x, p_Vid->iLumaPadX);
   s->iLumaExpandedHeight = size_y+2*p_Vid->iLumaPadY;
 
   if (active_sps->chroma_format_idc != YUV400)
@@ -558,7 +558,7 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
     get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->iChromaPadY, p_Vid->iChromaPadX);
   }
 
-  s->iChromaStride =size_x_cr + 2*p_Vid->iChromaPadX;
+  s->iChromaStride = get_plane_stride(size_x_cr, p_Vid->iChromaPadX);
   s->iChromaExpandedHeight = size_y_cr + 2*p_Vid->iChromaPadY;
   s->iLumaPadY   = p_Vid->iLumaPadY;
   s->iLumaPadX   = p_Vid->iLumaPadX;
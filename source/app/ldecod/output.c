@@ -21,6 +21,7 @@
 #include "sei.h"
 #include "input.h"
 #include "fast_memory.h"
+#include "pel_convert.h"
 
 static void write_out_picture(VideoParameters *p_Vid, StorablePicture *p, int p_out);
 static void img2buf_byte   (imgpel** imgX, unsigned char* buf, int size_x, int size_y, int symbol_size_in_bytes, int crop_left, int crop_right, int crop_top, int crop_bottom, int iOutStride);
@@ -107,9 +108,21 @@ static void img2buf_normal (imgpel** imgX, unsigned char* buf, int size_x, int s
     for(i=crop_top; i<size_y-crop_bottom; i++)
     {
       int ipos = (i - crop_top) * iOutStride;
-      for(j=crop_left; j<size_x-crop_right; j++)
+      if (symbol_size_in_bytes == 1)
       {
-        memcpy(buf+(ipos+(j-crop_left)*symbol_size_in_bytes),&(imgX[i][j]), size);
+        get_pel_convert()->narrow_row(buf + ipos, &imgX[i][crop_left], twidth);
+      }
+      else if (size == symbol_size_in_bytes)
+      {
+        // imgpel == pixel in file
+        memcpy(buf + ipos, &imgX[i][crop_left], twidth * symbol_size_in_bytes);
+      }
+      else
+      {
+        for(j=crop_left; j<size_x-crop_right; j++)
+        {
+          memcpy(buf+(ipos+(j-crop_left)*symbol_size_in_bytes),&(imgX[i][j]), size);
+        }
       }
     }
   }
@@ -125,15 +138,10 @@ static void img2buf_normal (imgpel** imgX, unsigned char* buf, int size_x, int s
     //else
 #else
     {
-      imgpel *cur_pixel;
-      unsigned char *pDst; 
+      const PelConvert *conv = get_pel_convert();
+
       for(j = 0; j < size_y; j++)
-      {  
-        cur_pixel = imgX[j];
-        pDst = buf +j*iOutStride;
-        for(i=0; i < size_x; i++)
-          *(pDst++)=(unsigned char)*(cur_pixel++);
-      }
+        conv->narrow_row(buf + j * iOutStride, imgX[j], size_x);
     }
 #endif
   }
@@ -14,6 +14,7 @@
 
 #include "global.h"
 #include "nalucommon.h"
+#include "async_output.h"
 
 /*!
  ********************************************************************************************
@@ -45,7 +46,7 @@ int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
     length = 3;
   }
 
-  if ( length != (int) fwrite (startcode+offset, 1, length, *f_annexb))
+  if ( length != (int) write_stream_data (p_Vid, startcode+offset, length, *f_annexb))
   {
     printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", length);
     exit (-1);
@@ -55,7 +56,7 @@ int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
 
   first_byte = (unsigned char) ((n->forbidden_bit << 7) | (n->nal_reference_idc << 5) | n->nal_unit_type);
 
-  if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
+  if ( 1 != write_stream_data (p_Vid, &first_byte, 1, *f_annexb))
   {
     printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
     exit (-1);
@@ -70,7 +71,7 @@ int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
     int view_id = p_Vid->p_Inp->MVCFlipViews ? !(n->view_id) : n->view_id;
 
     first_byte = (unsigned char) ((n->svc_extension_flag << 7) | (n->non_idr_flag << 6) | n->priority_id);
-    if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
+    if ( 1 != write_stream_data (p_Vid, &first_byte, 1, *f_annexb))
     {
       printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
       exit (-1);
@@ -78,7 +79,7 @@ int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
     BitsWritten += 8;
 
     first_byte = (unsigned char) (view_id >> 2);
-    if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
+    if ( 1 != write_stream_data (p_Vid, &first_byte, 1, *f_annexb))
     {
       printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
       exit (-1);
@@ -86,7 +87,7 @@ int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
     BitsWritten += 8;
 
     first_byte = (unsigned char) (((view_id&3) << 6) | (n->temporal_id << 3) | (n->anchor_pic_flag << 2) | (n->inter_view_flag << 1) | n->reserved_one_bit);
-    if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
+    if ( 1 != write_stream_data (p_Vid, &first_byte, 1, *f_annexb))
     {
       printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
       exit (-1);
@@ -95,14 +96,14 @@ int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
   }
 #endif
 
-  if (n->len != fwrite (n->buf, 1, n->len, *f_annexb))
+  if (n->len != write_stream_data (p_Vid, n->buf, n->len, *f_annexb))
   {
     printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", n->len);
     exit (-1);
   }
   BitsWritten += n->len * 8;
 
-  fflush (*f_annexb);
+  flush_stream_data (p_Vid, *f_annexb);
 #if TRACE
   //fprintf (p_Enc->p_trace, "\nAnnex B NALU w/ %s startcode, len %d, forbidden_bit %d, nal_reference_idc %d, nal_unit_type %d\n\n\n",
   //  n->startcodeprefix_len == 4?"long":"short", n->len + 1, n->forbidden_bit, n->nal_reference_idc, n->nal_unit_type);
@@ -0,0 +1,363 @@
+/*!
+ *************************************************************************************
+ * \file async_output.c
+ *
+ * \brief
+ *    Asynchronous bitstream and reconstruction output.
+ *
+ *    With AsyncOutput=1 the NAL units and the reconstructed pictures are not
+ *    written by the encoding thread. Their bytes are copied into buffers of
+ *    a small pool and queued for a writer thread, which does the write() /
+ *    fwrite() and fflush() calls in queue order. The encoding thread only
+ *    waits when all buffers are in use, so slow storage stalls it only once
+ *    the writer is OUTPUT_POOL_SIZE buffers behind.
+ *
+ *    A failed write is reported (error()) by the encoding thread the next
+ *    time it asks for a buffer or flushes the queue; later data is dropped.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "async_output.h"
+
+#if !(defined(WIN32) || defined(WIN64))
+#define OUTPUT_THREAD
+#include <pthread.h>
+#endif
+
+typedef struct async_output
+{
+  OutputJob  job[OUTPUT_POOL_SIZE];        //!< pooled buffers
+  OutputJob *free_job[OUTPUT_POOL_SIZE];   //!< buffers not in use
+  int        num_free;
+  OutputJob *queue[OUTPUT_POOL_SIZE];      //!< buffers waiting for the writer
+  int64      queued;                       //!< buffers queued
+  int64      written;                      //!< buffers written
+  OutputJob *stream;                       //!< open buffer collecting the bytes of a NAL unit
+  int        failed;                       //!< a write failed
+  int        reported;                     //!< the failure has been reported
+  int        threaded;                     //!< buffers are written by the writer thread
+#if defined(OUTPUT_THREAD)
+  int             stop;
+  pthread_t       thread;
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+#endif
+} AsyncOutput;
+
+static int write_job(OutputJob *job)
+{
+  if (job->f != NULL)
+  {
+    if (job->size != fwrite(job->buf, 1, job->size, job->f))
+      return -1;
+    fflush(job->f);
+    return 0;
+  }
+
+  return ((size_t) write(job->fd, job->buf, (unsigned int) job->size) == job->size) ? 0 : -1;
+}
+
+static void release_job(AsyncOutput *p_ao, OutputJob *job)
+{
+  job->size = 0;
+  p_ao->free_job[p_ao->num_free++] = job;
+  p_ao->written++;
+}
+
+#if defined(OUTPUT_THREAD)
+static void *output_writer(void *arg)
+{
+  AsyncOutput *p_ao = (AsyncOutput *) arg;
+
+  pthread_mutex_lock(&p_ao->lock);
+  for (;;)
+  {
+    OutputJob *job;
+    int failed;
+
+    while (p_ao->written == p_ao->queued && !p_ao->stop)
+      pthread_cond_wait(&p_ao->cond, &p_ao->lock);
+    if (p_ao->written == p_ao->queued)
+      break;
+
+    job = p_ao->queue[p_ao->written % OUTPUT_POOL_SIZE];
+    failed = p_ao->failed;
+    pthread_mutex_unlock(&p_ao->lock);
+
+    if (!failed && write_job(job) != 0)
+      failed = 1;
+
+    pthread_mutex_lock(&p_ao->lock);
+    p_ao->failed = failed;
+    release_job(p_ao, job);
+    pthread_cond_broadcast(&p_ao->cond);
+  }
+  pthread_mutex_unlock(&p_ao->lock);
+
+  return NULL;
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reports the first failed write
+ ************************************************************************
+ */
+static void check_output_error(AsyncOutput *p_ao, int failed)
+{
+  if (failed && !p_ao->reported)
+  {
+    p_ao->reported = 1;
+    error ("async_output: error writing to output file.", 500);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts the writer thread. Without threads (or if the thread cannot
+ *    be created) queued buffers are written right away.
+ ************************************************************************
+ */
+void init_async_output(VideoParameters *p_Vid)
+{
+  AsyncOutput *p_ao;
+  int i;
+
+  if ((p_ao = (AsyncOutput *) calloc(1, sizeof(AsyncOutput))) == NULL)
+    no_mem_exit("init_async_output: p_ao");
+
+  for (i = 0; i < OUTPUT_POOL_SIZE; ++i)
+    p_ao->free_job[i] = &p_ao->job[i];
+  p_ao->num_free = OUTPUT_POOL_SIZE;
+
+#if defined(OUTPUT_THREAD)
+  pthread_mutex_init(&p_ao->lock, NULL);
+  pthread_cond_init(&p_ao->cond, NULL);
+  p_ao->threaded = (pthread_create(&p_ao->thread, NULL, output_writer, p_ao) == 0);
+#endif
+
+  p_Vid->p_Output = p_ao;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Writes the queued data, stops the writer and releases the pool
+ ************************************************************************
+ */
+void free_async_output(VideoParameters *p_Vid)
+{
+  AsyncOutput *p_ao = p_Vid->p_Output;
+  int i;
+
+  if (p_ao == NULL)
+    return;
+
+  flush_async_output(p_Vid);
+
+#if defined(OUTPUT_THREAD)
+  if (p_ao->threaded)
+  {
+    pthread_mutex_lock(&p_ao->lock);
+    p_ao->stop = 1;
+    pthread_cond_broadcast(&p_ao->cond);
+    pthread_mutex_unlock(&p_ao->lock);
+    pthread_join(p_ao->thread, NULL);
+  }
+  pthread_cond_destroy(&p_ao->cond);
+  pthread_mutex_destroy(&p_ao->lock);
+#endif
+
+  for (i = 0; i < OUTPUT_POOL_SIZE; ++i)
+    free(p_ao->job[i].buf);
+
+  free(p_ao);
+  p_Vid->p_Output = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Queues the open NAL unit and waits until all queued data is written
+ ************************************************************************
+ */
+void flush_async_output(VideoParameters *p_Vid)
+{
+  AsyncOutput *p_ao = p_Vid->p_Output;
+  int failed;
+
+  if (p_ao == NULL)
+    return;
+
+  queue_stream_data(p_Vid);
+
+#if defined(OUTPUT_THREAD)
+  if (p_ao->threaded)
+  {
+    pthread_mutex_lock(&p_ao->lock);
+    while (p_ao->written < p_ao->queued)
+      pthread_cond_wait(&p_ao->cond, &p_ao->lock);
+    failed = p_ao->failed;
+    pthread_mutex_unlock(&p_ao->lock);
+    check_output_error(p_ao, failed);
+    return;
+  }
+#endif
+
+  failed = p_ao->failed;
+  check_output_error(p_ao, failed);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Takes a buffer of at least size bytes from the pool, waiting for
+ *    the writer if all of them are queued
+ ************************************************************************
+ */
+OutputJob *get_output_job(VideoParameters *p_Vid, size_t size)
+{
+  AsyncOutput *p_ao = p_Vid->p_Output;
+  OutputJob *job;
+  int failed;
+
+#if defined(OUTPUT_THREAD)
+  if (p_ao->threaded)
+  {
+    pthread_mutex_lock(&p_ao->lock);
+    while (p_ao->num_free == 0)
+      pthread_cond_wait(&p_ao->cond, &p_ao->lock);
+    job = p_ao->free_job[--p_ao->num_free];
+    failed = p_ao->failed;
+    pthread_mutex_unlock(&p_ao->lock);
+  }
+  else
+#endif
+  {
+    job = p_ao->free_job[--p_ao->num_free];
+    failed = p_ao->failed;
+  }
+
+  if (job->capacity < size)
+  {
+    free(job->buf);
+    if ((job->buf = (byte *) malloc(size)) == NULL)
+      no_mem_exit("get_output_job: buf");
+    job->capacity = size;
+  }
+  job->size = 0;
+  job->fd   = -1;
+  job->f    = NULL;
+
+  check_output_error(p_ao, failed);
+
+  return job;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hands a filled buffer to the writer
+ ************************************************************************
+ */
+void queue_output_job(VideoParameters *p_Vid, OutputJob *job)
+{
+  AsyncOutput *p_ao = p_Vid->p_Output;
+
+#if defined(OUTPUT_THREAD)
+  if (p_ao->threaded)
+  {
+    pthread_mutex_lock(&p_ao->lock);
+    p_ao->queue[p_ao->queued % OUTPUT_POOL_SIZE] = job;
+    p_ao->queued++;
+    pthread_cond_broadcast(&p_ao->cond);
+    pthread_mutex_unlock(&p_ao->lock);
+    return;
+  }
+#endif
+
+  p_ao->queued++;
+  if (!p_ao->failed && write_job(job) != 0)
+    p_ao->failed = 1;
+  release_job(p_ao, job);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    fwrite() replacement for the NAL unit writers: with AsyncOutput
+ *    the data is appended to the open buffer of the stream, which is
+ *    queued by queue_stream_data()
+ ************************************************************************
+ */
+size_t write_stream_data(VideoParameters *p_Vid, const void *data, size_t size, FILE *f)
+{
+  AsyncOutput *p_ao = p_Vid->p_Output;
+  OutputJob *job;
+
+  if (p_ao == NULL)
+    return fwrite(data, 1, size, f);
+
+  if (p_ao->stream != NULL && p_ao->stream->f != f)
+    queue_stream_data(p_Vid);
+
+  if (p_ao->stream == NULL)
+  {
+    p_ao->stream = get_output_job(p_Vid, 0);
+    p_ao->stream->f = f;
+  }
+
+  job = p_ao->stream;
+  if (job->size + size > job->capacity)
+  {
+    size_t capacity = 2 * job->capacity;
+
+    if (capacity < job->size + size)
+      capacity = job->size + size;
+    if ((job->buf = (byte *) realloc(job->buf, capacity)) == NULL)
+      no_mem_exit("write_stream_data: buf");
+    job->capacity = capacity;
+  }
+  memcpy(job->buf + job->size, data, size);
+  job->size += size;
+
+  return size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hands the open buffer of the NAL unit writers to the writer
+ ************************************************************************
+ */
+void queue_stream_data(VideoParameters *p_Vid)
+{
+  AsyncOutput *p_ao = p_Vid->p_Output;
+
+  if (p_ao != NULL && p_ao->stream != NULL)
+  {
+    OutputJob *job = p_ao->stream;
+
+    p_ao->stream = NULL;
+    queue_output_job(p_Vid, job);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    fflush() replacement for the NAL unit writers: with AsyncOutput
+ *    the open buffer is queued and the writer flushes the stream
+ ************************************************************************
+ */
+void flush_stream_data(VideoParameters *p_Vid, FILE *f)
+{
+  if (p_Vid->p_Output == NULL)
+    fflush(f);
+  else
+    queue_stream_data(p_Vid);
+}
@@ -0,0 +1,39 @@
+/*!
+ ************************************************************************
+ * \file
+ *     async_output.h
+ *
+ * \brief
+ *    Bitstream and reconstruction file output from a background writer
+ *    thread with a bounded queue of pooled buffers
+ ************************************************************************
+ */
+
+#ifndef _ASYNC_OUTPUT_H_
+#define _ASYNC_OUTPUT_H_
+
+#include "global.h"
+
+#define OUTPUT_POOL_SIZE  8   //!< output buffers; bounds the data waiting for the writer
+
+//! Data waiting to be written to one output file
+typedef struct output_job
+{
+  int     fd;           //!< file descriptor (reconstruction), or -1
+  FILE   *f;            //!< stream (bitstream), or NULL
+  byte   *buf;          //!< data
+  size_t  size;         //!< bytes used
+  size_t  capacity;     //!< bytes allocated
+} OutputJob;
+
+extern void       init_async_output  (VideoParameters *p_Vid);
+extern void       free_async_output  (VideoParameters *p_Vid);
+extern void       flush_async_output (VideoParameters *p_Vid);
+extern OutputJob *get_output_job     (VideoParameters *p_Vid, size_t size);
+extern void       queue_output_job   (VideoParameters *p_Vid, OutputJob *job);
+extern size_t     write_stream_data  (VideoParameters *p_Vid, const void *data, size_t size, FILE *f);
+extern void       queue_stream_data  (VideoParameters *p_Vid);
+extern void       flush_stream_data  (VideoParameters *p_Vid, FILE *f);
+
+#endif
+
@@ -23,6 +23,27 @@
 // Range table for LPS
 static const byte renorm_table_32[32]={6,5,4,4,3,3,3,3,2,2,2,2,2,2,2,2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
 
+//! Cost of a bin in 1/32768 bit: entropyBits[63 - state] for the MPS, entropyBits[64 + state] for the LPS
+const int entropyBits[128]= 
+{
+     895,    943,    994,   1048,   1105,   1165,   1228,   1294, 
+    1364,   1439,   1517,   1599,   1686,   1778,   1875,   1978, 
+    2086,   2200,   2321,   2448,   2583,   2725,   2876,   3034, 
+    3202,   3380,   3568,   3767,   3977,   4199,   4435,   4684, 
+    4948,   5228,   5525,   5840,   6173,   6527,   6903,   7303, 
+    7727,   8178,   8658,   9169,   9714,  10294,  10914,  11575, 
+   12282,  13038,  13849,  14717,  15650,  16653,  17734,  18899, 
+   20159,  21523,  23005,  24617,  26378,  28306,  30426,  32768, 
+   32768,  35232,  37696,  40159,  42623,  45087,  47551,  50015, 
+   52479,  54942,  57406,  59870,  62334,  64798,  67262,  69725, 
+   72189,  74653,  77117,  79581,  82044,  84508,  86972,  89436, 
+   91900,  94363,  96827,  99291, 101755, 104219, 106683, 109146, 
+  111610, 114074, 116538, 119002, 121465, 123929, 126393, 128857, 
+  131321, 133785, 136248, 138712, 141176, 143640, 146104, 148568, 
+  151031, 153495, 155959, 158423, 160887, 163351, 165814, 168278, 
+  170742, 173207, 175669, 178134, 180598, 183061, 185525, 187989
+};
+
 
 void reset_pic_bin_count(VideoParameters *p_Vid)
 {
@@ -172,6 +193,35 @@ void arienco_start_encoding(EncodingEnvironmentPtr eep,
   eep->Ecodestrm_len = code_len;
 
   eep->Erange = HALF;
+
+  arienco_stop_estimation(eep);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Switches the EncodingEnvironment to rate estimation. Until
+ *    arienco_stop_estimation() no bins are coded: their cost is taken
+ *    from entropyBits[] and only the shadow states of the contexts are
+ *    updated, so the coder state and the real contexts stay untouched.
+ *    A new epoch invalidates all shadow states of an older epoch.
+ ************************************************************************
+ */
+void arienco_start_estimation(EncodingEnvironmentPtr eep, unsigned int epoch)
+{
+  eep->Eepoch    = epoch;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns to real arithmetic coding
+ ************************************************************************
+ */
+void arienco_stop_estimation(EncodingEnvironmentPtr eep)
+{
+  eep->Eepoch    = 0;
+  eep->Eest_bits = 0;
 }
 
 /*!
@@ -349,10 +399,42 @@ void biari_encode_symbol(EncodingEnvironmentPtr eep, int symbol, BiContextTypePt
     37,38,38,63
   };
 
-  unsigned int low = eep->Elow;
-  unsigned int range = eep->Erange;
-  int bl = eep->Ebits_to_go;
-  unsigned int rLPS = rLPS_table_64x4[bi_ct->state][(range>>6) & 3]; 
+  unsigned int low;
+  unsigned int range;
+  int bl;
+  unsigned int rLPS;
+
+  if (eep->Elog != NULL) // journal the context for restoring RDO coding states
+    log_context(eep->Elog, bi_ct);
+
+  if (eep->Eepoch) // rate estimation
+  {
+    if (bi_ct->est_epoch != eep->Eepoch) // first bin of the context in this epoch
+    {
+      bi_ct->est_state = bi_ct->state;
+      bi_ct->est_MPS   = bi_ct->MPS;
+      bi_ct->est_epoch = eep->Eepoch;
+    }
+
+    if ((symbol != 0) == bi_ct->est_MPS)
+    {
+      eep->Eest_bits += entropyBits[63 - bi_ct->est_state];
+      bi_ct->est_state = AC_next_state_MPS_64[bi_ct->est_state];
+    }
+    else
+    {
+      eep->Eest_bits += entropyBits[64 + bi_ct->est_state];
+      if (!bi_ct->est_state)
+        bi_ct->est_MPS ^= 0x01;
+      bi_ct->est_state = AC_next_state_LPS_64[bi_ct->est_state];
+    }
+    return;
+  }
+
+  low = eep->Elow;
+  range = eep->Erange;
+  bl = eep->Ebits_to_go;
+  rLPS = rLPS_table_64x4[bi_ct->state][(range>>6) & 3]; 
 
   range -= rLPS;
 
@@ -437,7 +519,15 @@ void biari_encode_symbol(EncodingEnvironmentPtr eep, int symbol, BiContextTypePt
  */
 void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol)
 {
-  unsigned int low = eep->Elow;
+  unsigned int low;
+
+  if (eep->Eepoch) // rate estimation
+  {
+    eep->Eest_bits += (1 << EST_BITS_SHIFT);
+    return;
+  }
+
+  low = eep->Elow;
   --(eep->Ebits_to_go);  
   ++(eep->C);
 
@@ -480,9 +570,20 @@ void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol)
  */
 void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol)
 {
-  unsigned int range = eep->Erange - 2;
-  unsigned int low = eep->Elow;
-  int bl = eep->Ebits_to_go; 
+  unsigned int range;
+  unsigned int low;
+  int bl; 
+
+  if (eep->Eepoch) // rate estimation: the terminating bin has a probability of about 2/range
+  {
+    if (symbol != 0)
+      eep->Eest_bits += (7 << EST_BITS_SHIFT);
+    return;
+  }
+
+  range = eep->Erange - 2;
+  low = eep->Elow;
+  bl = eep->Ebits_to_go; 
 
   ++(eep->C);
 
@@ -568,5 +669,6 @@ void biari_init_context (int qp, BiContextTypePtr ctx, const char* ini)
   }
 
   ctx->count = 0;
+  ctx->est_epoch = 0;
 }
 
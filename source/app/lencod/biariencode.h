@@ -41,6 +41,9 @@
 #define QUARTER        0x0100      //(1 << (B_BITS-2))
 #define MIN_BITS_TO_GO 0
 #define B_LOAD_MASK    0xFFFF      // ((1<<BITS_TO_LOAD) - 1)
+#define EST_BITS_SHIFT 15          // fractional accuracy of the rate estimation (1 bit = 32768)
+
+extern const int entropyBits[128];
 
 extern int get_pic_bin_count(VideoParameters *p_Vid);
 extern void reset_pic_bin_count(VideoParameters *p_Vid);
@@ -49,6 +52,8 @@ extern void set_pic_bin_count  (VideoParameters *p_Vid, EncodingEnvironmentPtr e
 extern void arienco_start_encoding(EncodingEnvironmentPtr eep, unsigned char *code_buffer, int *code_len);
 extern void arienco_reset_EC      (EncodingEnvironmentPtr eep);
 extern void arienco_done_encoding (Macroblock *currMB, EncodingEnvironmentPtr eep);
+extern void arienco_start_estimation(EncodingEnvironmentPtr eep, unsigned int epoch);
+extern void arienco_stop_estimation (EncodingEnvironmentPtr eep);
 extern void biari_init_context    (int qp, BiContextTypePtr ctx, const char* ini);
 extern void biari_encode_symbol   (EncodingEnvironmentPtr eep, int symbol, BiContextTypePtr bi_ct );
 extern void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol);
@@ -57,12 +62,37 @@ extern void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol);
 /*!
 ************************************************************************
 * \brief
-*    Returns the number of currently written bits
+*    Returns the number of currently written bits (including the
+*    bits estimated in rate estimation mode)
 ************************************************************************
 */
 static inline int arienco_bits_written(EncodingEnvironmentPtr eep)
 {
-  return (((*eep->Ecodestrm_len) + eep->Epbuf + 1) << 3) + (eep->Echunks_outstanding * BITS_TO_LOAD) + BITS_TO_LOAD - eep->Ebits_to_go;
+  return (((*eep->Ecodestrm_len) + eep->Epbuf + 1) << 3) + (eep->Echunks_outstanding * BITS_TO_LOAD) + BITS_TO_LOAD - eep->Ebits_to_go
+    + (int) (eep->Eest_bits >> EST_BITS_SHIFT);
+}
+
+/*!
+************************************************************************
+* \brief
+*    Appends a context model and its current value to the undo log
+************************************************************************
+*/
+static inline void log_context(CtxUndoLog *p_log, BiContextTypePtr bi_ct)
+{
+  CtxUndoEntry *entry;
+
+  if (p_log->size == p_log->max_size)
+  {
+    p_log->max_size <<= 1;
+    if ((p_log->entries = (CtxUndoEntry *) realloc(p_log->entries, p_log->max_size * sizeof(CtxUndoEntry))) == NULL)
+      no_mem_exit("log_context: p_log->entries");
+  }
+
+  entry = &p_log->entries[p_log->size++];
+  entry->ctx   = bi_ct;
+  entry->saved = *bi_ct;
+  entry->id    = ++p_log->next_id;
 }
 
 #endif  // BIARIENCOD_H
@@ -38,6 +38,7 @@
 #include "q_matrix.h"
 #include "quant4x4.h"
 #include "quantChroma.h"
+#include "fused_tq.h"
 #include "md_common.h"
 #include "transform8x8.h"
 
@@ -695,6 +696,10 @@ int residual_transform_quant_luma_4x4(Macroblock *currMB, ColorPlane pl, int blo
     currMB->subblock_x = ((b8&0x1)==0) ? (((b4&0x1)==0)? 0: 4) : (((b4&0x1)==0)? 8: 12); // horiz. position for coeff_count context
     currMB->subblock_y = (b8<2)        ? ((b4<2)       ? 0: 4) : ((b4<2)       ? 8: 12); // vert.  position for coeff_count context
 
+    // The normal and adaptive rounding quantizers have a fused transform / quantization / reconstruction path
+    if (currSlice->quant_4x4 == quant_4x4_normal || currSlice->quant_4x4 == quant_4x4_around)
+      return fused_tq_luma_4x4(currMB, pl, &quant_methods);
+
     //  Forward 4x4 transform
     forward4x4(mb_ores, currSlice->tblk16x16, block_y, block_x);
 
@@ -177,11 +177,18 @@ int64 getVideoFileSize(int video_file)
  */
 void get_number_of_frames (InputParameters *p_Inp, VideoDataFile *input_file)
 {
-  int64 fsize = getVideoFileSize(input_file->f_num);
-
+  int64 fsize;
   int64 isize = (int64) p_Inp->source.size;
   int maxBitDepth = imax(p_Inp->source.bit_depth[0], p_Inp->source.bit_depth[1]);
 
+  // sequential input: the frames that were in the stream when it ended
+  if (input_file->stream != NULL)
+  {
+    p_Inp->no_frames = InputStreamFrames(input_file) - p_Inp->start_frame;
+    return;
+  }
+
+  fsize = getVideoFileSize(input_file->f_num);
   isize <<= (maxBitDepth > 8)? 1: 0;
   p_Inp->no_frames   = (int) (((fsize - p_Inp->infile_header)/ isize) - p_Inp->start_frame);
 }
@@ -332,6 +339,9 @@ void Configure (VideoParameters *p_Vid, InputParameters *p_Inp, int ac, char *av
 #if ( IMGTYPE == 0 )
       printf("support for more than 8 bits/pel disabled\n");
 #endif
+#if ( JM_DUAL_PRECISION )
+      printf("sequences of up to 8 bits/pel coded with byte samples\n");
+#endif
 #if ( ENABLE_FIELD_CTX == 0 )
       printf("CABAC field coding disabled\n");
 #endif
@@ -783,6 +793,24 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
   ParseVideoType(&p_Inp->input_file1);
   ParseFrameNoFormatFromString (&p_Inp->input_file1);
 
+  // Sequential input is opened here (and kept open) so that a YUV4MPEG2 header can set the source format
+  if (IsInputStream(&p_Inp->input_file1))
+  {
+    Y4MHeader *y4m;
+
+    OpenFiles(&p_Inp->input_file1);
+    if ((y4m = GetY4MHeader(&p_Inp->input_file1)) != NULL)
+    {
+      p_Inp->source.width[0]     = y4m->width;
+      p_Inp->source.height[0]    = y4m->height;
+      p_Inp->source.bit_depth[0] = y4m->bit_depth;
+      p_Inp->source.bit_depth[1] = y4m->bit_depth;
+      p_Inp->yuv_format          = y4m->yuv_format;
+      if (y4m->frame_rate > 0.0)
+        p_Inp->source.frame_rate = y4m->frame_rate;
+    }
+  }
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Inp->num_of_views == 2 )
   {
@@ -883,6 +911,12 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     set_jm_vui_params( p_Inp );
   }
 
+  if (p_Inp->no_frames == -1 && p_Inp->input_file1.stream != NULL)
+  {
+    snprintf(errortext, ET_SIZE, "FramesToBeEncoded has to be set when the input (%s) is read sequentially.", p_Inp->input_file1.fname);
+    error (errortext, 500);
+  }
+
   if (p_Inp->no_frames == -1)
   {
     OpenFiles(&p_Inp->input_file1);
@@ -936,6 +970,65 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     printf("\nWarning: WPMCPredicions is set to 0 due to interlace coding.\n");
     p_Inp->WPMCPrecision = 0;
   }
+
+  if (p_Inp->ConcurrentFieldDecision)
+  {
+    // the OpenMP thread pool of the encoder does not survive the fork of the field candidate
+#if (defined(WIN32) || defined(WIN64) || TRACE || defined(OPENMP))
+    printf("Warning: ConcurrentFieldDecision not supported by this build. Process Disabled.\n");
+    p_Inp->ConcurrentFieldDecision = 0;
+#else
+    if (p_Inp->PicInterlace != ADAPTIVE_CODING || p_Inp->RCEnable || p_Inp->num_of_views > 1 || p_Inp->redundant_pic_flag)
+    {
+      printf("Warning: ConcurrentFieldDecision requires PicInterlace=2 without rate control, MVC or redundant pictures. Process Disabled.\n");
+      p_Inp->ConcurrentFieldDecision = 0;
+    }
+#endif
+  }
+
+  if (p_Inp->SegmentParallel)
+  {
+#if (defined(WIN32) || defined(WIN64) || TRACE)
+    printf("Warning: SegmentParallel not supported by this build. Process Disabled.\n");
+    p_Inp->SegmentParallel = 0;
+#else
+    if (p_Inp->idr_period == 0 || p_Inp->num_of_views > 1 || p_Inp->ExplicitSeqCoding || p_Inp->of_mode != PAR_OF_ANNEXB || p_Inp->input_file1.stream != NULL)
+    {
+      printf("Warning: SegmentParallel requires IDRPeriod, Annex B output and file input without MVC or explicit sequences. Process Disabled.\n");
+      p_Inp->SegmentParallel = 0;
+    }
+#endif
+  }
+
+  if (p_Inp->AsyncMetrics && (p_Inp->num_of_views > 1 || p_Inp->DistortionYUVtoRGB))
+  {
+    printf("Warning: AsyncMetrics is not supported with MVC or DistortionYUVtoRGB. Process Disabled.\n");
+    p_Inp->AsyncMetrics = 0;
+  }
+
+  if (p_Inp->IntraRDOCandidates && (p_Inp->rdopt == 0 || p_Inp->yuv_format == YUV444))
+  {
+    printf("Warning: IntraRDOCandidates requires RD optimized mode decision and is not supported for 4:4:4. Process Disabled.\n");
+    p_Inp->IntraRDOCandidates = 0;
+  }
+
+  if (p_Inp->CABACRateEstimation && (p_Inp->symbol_mode != CABAC || p_Inp->rdopt == 0))
+  {
+    printf("Warning: CABACRateEstimation requires SymbolMode=1 and RD optimized mode decision. Process Disabled.\n");
+    p_Inp->CABACRateEstimation = 0;
+  }
+
+  if (p_Inp->RTTargetFPS > 0 && (p_Inp->rdopt == 3 || p_Inp->IntraProfile))
+  {
+    printf("Warning: RTTargetFPS is not supported with RDOptimization=3 or intra profiles. Process Disabled.\n");
+    p_Inp->RTTargetFPS = 0;
+  }
+
+  if (p_Inp->LookaheadFrames > 0 && (p_Inp->num_of_views > 1 || p_Inp->enable_32_pulldown))
+  {
+    printf("Warning: LookaheadFrames is not supported with multiple views or 3:2 pulldown. Process Disabled.\n");
+    p_Inp->LookaheadFrames = 0;
+  }
 #if TRACE
   if ((int) strlen (p_Inp->TraceFile) > 0 && (p_Enc->p_trace = fopen(p_Inp->TraceFile,"w"))==NULL)
   {
@@ -1273,6 +1366,20 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     )
     p_Inp->EPZSSubPelGrid = 0;
 
+  if (p_Inp->ParallelRefME)
+  {
+#if !defined(OPENMP)
+    printf("Warning: ParallelRefME not supported by this build. Process Disabled.\n");
+    p_Inp->ParallelRefME = 0;
+#else
+    if (p_Inp->rdopt == 0 || p_Inp->OnTheFlyFractMCP == OTF_L3 || (p_Inp->SearchMode[0] != EPZS && p_Inp->SearchMode[0] != FULL_SEARCH))
+    {
+      printf("Warning: ParallelRefME requires RD optimized mode decision and Full Search or EPZS without OTF_L3. Process Disabled.\n");
+      p_Inp->ParallelRefME = 0;
+    }
+#endif
+  }
+
   if (p_Inp->redundant_pic_flag)
   {
     if (p_Inp->PicInterlace || p_Inp->MbInterlace)
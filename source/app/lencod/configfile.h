@@ -85,10 +85,15 @@ Mapping Map[] = {
     {"UseConstrainedIntraPred",  &cfgparams.UseConstrainedIntraPred,      0,   0.0,                       1,  0.0,              1.0,                             },
     {"InputFile",                &cfgparams.input_file1.fname,            1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"InputHeaderLength",        &cfgparams.infile_header,                0,   0.0,                       2,  0.0,              1.0,                             },
+    {"InputStreamBuffer",        &cfgparams.InputStreamBuffer,            0,   0.0,                       2,  0.0,              0.0,                             },
+    {"InputStreamReadAhead",     &cfgparams.InputStreamReadAhead,         0,   2.0,                       1,  0.0,             64.0,                             },
+    {"InputMemoryMap",           &cfgparams.InputMemoryMap,               0,   0.0,                       1,  0.0,              1.0,                             },
     {"OutputFile",               &cfgparams.outfile,                      1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"ReconFile",                &cfgparams.ReconFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"TraceFile",                &cfgparams.TraceFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"StatsFile",                &cfgparams.StatsFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
+    {"AsyncOutput",              &cfgparams.AsyncOutput,                  0,   0.0,                       1,  0.0,              1.0,                             },
+    {"SegmentParallel",          &cfgparams.SegmentParallel,              0,   0.0,                       1,  0.0,            256.0,                             },
     {"DisposableP",              &cfgparams.DisposableP,                  0,   0.0,                       1,  0.0,              1.0,                             },
     {"SetFirstAsLongTerm",       &cfgparams.SetFirstAsLongTerm,           0,   0.0,                       1,  0.0,              1.0,                             },
     {"MultiSourceData",          &cfgparams.MultiSourceData,              0,   0.0,                       0,  0.0,              2.0,                             },
@@ -162,12 +167,15 @@ Mapping Map[] = {
     {"DistortionMS_SSIM",        &cfgparams.Distortion[MS_SSIM],          0,   0.0,                       1,  0.0,              1.0,                             },
     {"SSIMOverlapSize",          &cfgparams.SSIMOverlapSize,              0,   1.0,                       2,  1.0,              1.0,                             },
     {"DistortionYUVtoRGB",       &cfgparams.DistortionYUVtoRGB,           0,   0.0,                       1,  0.0,              1.0,                             },
+    {"AsyncMetrics",             &cfgparams.AsyncMetrics,                 0,   0.0,                       1,  0.0,              1.0,                             },
     {"CtxAdptLagrangeMult",      &cfgparams.CtxAdptLagrangeMult,          0,   0.0,                       1,  0.0,              1.0,                             },
     {"FastCrIntraDecision",      &cfgparams.FastCrIntraDecision,          0,   0.0,                       1,  0.0,              1.0,                             },
+    {"IntraRDOCandidates",       &cfgparams.IntraRDOCandidates,           0,   0.0,                       1,  0.0,              8.0,                             },
     {"DisableThresholding",      &cfgparams.disthres,                     0,   0.0,                       1,  0.0,              2.0,                             },
     {"DisableBSkipRDO",          &cfgparams.nobskip,                      0,   0.0,                       1,  0.0,              1.0,                             },
     {"BiasSkipRDO",              &cfgparams.BiasSkipRDO,                  0,   0.0,                       1,  0.0,              1.0,                             },
     {"ForceTrueRateRDO",         &cfgparams.ForceTrueRateRDO,             0,   0.0,                       1,  0.0,              2.0,                             },    
+    {"CABACRateEstimation",      &cfgparams.CABACRateEstimation,          0,   0.0,                       1,  0.0,              1.0,                             },
     {"LossRateA",                &cfgparams.LossRateA,                    2,   0.0,                       2,  0.0,              0.0,                             },
     {"LossRateB",                &cfgparams.LossRateB,                    2,   0.0,                       2,  0.0,              0.0,                             },
     {"LossRateC",                &cfgparams.LossRateC,                    2,   0.0,                       2,  0.0,              0.0,                             },
@@ -181,6 +189,7 @@ Mapping Map[] = {
     {"LeakyBucketParamFile",     &cfgparams.LeakyBucketParamFile,         1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
 #endif
     {"PicInterlace",             &cfgparams.PicInterlace,                 0,   0.0,                       1,  0.0,              3.0,                             },
+    {"ConcurrentFieldDecision",  &cfgparams.ConcurrentFieldDecision,      0,   0.0,                       1,  0.0,              1.0,                             },
     {"MbInterlace",              &cfgparams.MbInterlace,                  0,   0.0,                       1,  0.0,              3.0,                             },
 
     {"IntraBottom",              &cfgparams.IntraBottom,                  0,   0.0,                       1,  0.0,              1.0,                             },
@@ -195,6 +204,7 @@ Mapping Map[] = {
     {"EnhancedBWeightSupport",   &cfgparams.EnhancedBWeightSupport,       0,   0.0,                       1,  0.0,              2.0,                             },    
     {"UseWeightedReferenceME",   &cfgparams.UseWeightedReferenceME,       0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDPictureDecision",        &cfgparams.RDPictureDecision,            0,   0.0,                       1,  0.0,              1.0,                             },
+    {"MEResultCache",            &cfgparams.MEResultCache,                0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDPSliceBTest",            &cfgparams.RDPSliceBTest,                0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDPSliceITest",            &cfgparams.RDPSliceITest,                0,   1.0,                       1,  0.0,              1.0,                             },
     {"RDPictureMaxPassISlice",   &cfgparams.RDPictureMaxPassISlice,       0,   1.0,                       1,  1.0,              3.0,                             },
@@ -205,6 +215,11 @@ Mapping Map[] = {
     {"RDPictureFrameQPPSlice",   &cfgparams.RDPictureFrameQPPSlice,       0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDPictureFrameQPBSlice",   &cfgparams.RDPictureFrameQPBSlice,       0,   0.0,                       1,  0.0,              1.0,                             },
     {"SkipIntraInInterSlices",   &cfgparams.SkipIntraInInterSlices,       0,   0.0,                       1,  0.0,              1.0,                             },
+    {"RTTargetFPS",              &cfgparams.RTTargetFPS,                  2,   0.0,                       2,  0.0,              0.0,                             },
+    {"RTMaxLevel",               &cfgparams.RTMaxLevel,                   0,  10.0,                       1,  0.0,             10.0,                             },
+    {"LookaheadFrames",          &cfgparams.LookaheadFrames,              0,   0.0,                       2,  0.0,              0.0,                             },
+    {"LookaheadSceneCut",        &cfgparams.LookaheadSceneCut,            2,   0.8,                       1,  0.0,              1.0,                             },
+    {"LookaheadAdaptiveB",       &cfgparams.LookaheadAdaptiveB,           0,   1.0,                       1,  0.0,              1.0,                             },
     {"PSliceSkipDecisionMethod", &cfgparams.PSliceSkipDecisionMethod,     0,   0.0,                       1,  0.0,              5.0,                             },
     {"BReferencePictures",       &cfgparams.BRefPictures,                 0,   0.0,                       1,  0.0,              2.0,                             },
     {"HierarchicalCoding",       &cfgparams.HierarchicalCoding,           0,   0.0,                       1,  0.0,              3.0,                             },
@@ -271,10 +286,12 @@ Mapping Map[] = {
     {"FixedModelNumber",         &cfgparams.model_number,                 0,   0.0,                       1,  0.0,              2.0,                             },
 
     {"ReportFrameStats",         &cfgparams.ReportFrameStats,             0,   0.0,                       1,  0.0,              1.0,                             },
+    {"ReportLog",                &cfgparams.ReportLog,                    0,   1.0,                       1,  0.0,              1.0,                             },
     {"DisplayEncParams",         &cfgparams.DisplayEncParams,             0,   0.0,                       1,  0.0,              1.0,                             },
     {"Verbose",                  &cfgparams.Verbose,                      0,   1.0,                       1,  0.0,              4.0,                             },
     {"SkipGlobalStats",          &cfgparams.skip_gl_stats,                0,   0.0,                       1,  0.0,              1.0,                             },
     {"OnTheFlyFractMCP",         &cfgparams.OnTheFlyFractMCP,             0,   0.0,                       1,  0.0,              3.0,                             },
+    {"OTFTileCacheSize",         &cfgparams.OTFTileCacheSize,             0,   1024.0,                    2,  4.0,              0.0,                             },
     {"ChromaMCBuffer",           &cfgparams.ChromaMCBuffer,               0,   0.0,                       1,  0.0,              1.0,                             },
     {"ChromaMEEnable",           &cfgparams.ChromaMEEnable,               0,   0.0,                       1,  0.0,              2.0,                             },
     {"ChromaMEWeight",           &cfgparams.ChromaMEWeight,               0,   1.0,                       2,  0.0,              1.0,                             },    
@@ -445,6 +462,7 @@ Mapping Map[] = {
     {"HMEEnable",                &cfgparams.HMEEnable,                    0,   0.0,                       1,  0.0,              1.0,                             },
     {"HMEDisableMMCO",           &cfgparams.HMEDisableMMCO,               0,   0.0,                       1,  0.0,              1.0,                             },
     {"PyramidLevels",            &cfgparams.PyramidLevels,                0,   0.0,                       1,  0.0,              6.0,                             },
+    {"ParallelRefME",            &cfgparams.ParallelRefME,                0,   0.0,                       1,  0.0,              1.0,                             },
 
     // Tone mapping SEI cfg file
     {"ToneMappingSEIPresentFlag",&cfgparams.ToneMappingSEIPresentFlag,    0,   0.0,                       1,  0.0,              1.0,                             },
@@ -465,7 +483,7 @@ Mapping Map[] = {
     {"RDOQ_CR",                  &cfgparams.RDOQ_CR,                      0,   1.0,                       1,  0.0,              1.0,                             },
     {"RDOQ_DC_CR",               &cfgparams.RDOQ_DC_CR,                   0,   1.0,                       1,  0.0,              1.0,                             },
     {"RDOQ_QP_Num",              &cfgparams.RDOQ_QP_Num,                  0,   1.0,                       1,  1.0,              9.0,                             },
-    {"RDOQ_CP_Mode",             &cfgparams.RDOQ_CP_Mode,                 0,   0.0,                       1,  0.0,              1.0,                             },
+    {"RDOQ_CP_Mode",             &cfgparams.RDOQ_CP_Mode,                 0,   0.0,                       1,  0.0,              2.0,                             },
     {"RDOQ_CP_MV",               &cfgparams.RDOQ_CP_MV,                   0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDOQ_Fast",                &cfgparams.RDOQ_Fast,                    0,   0.0,                       1,  0.0,              1.0,                             },
     // VUI parameters
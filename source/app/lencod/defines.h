@@ -34,7 +34,15 @@
 #define GET_METIME                1    //!< Enables or disables ME computation time
 #define DUMP_DPB                  0    //!< Dump DPB info for debug purposes
 #define PRINTREFLIST              0    //!< Print ref list info for debug purposes
+#ifndef IMGTYPE
 #define IMGTYPE                   1    //!< Define imgpel size type. 0 implies byte (cannot handle >8 bit depths) and 1 implies unsigned short
+#endif
+#ifndef DISTTYPE
+#define DISTTYPE            IMGTYPE    //!< Define distblk size type. 0 implies int32 (mode decision lambdas are limited to fit) and 1 implies int64
+#endif
+#ifndef JM_DUAL_PRECISION
+#define JM_DUAL_PRECISION         0    //!< 1: an encoder built with byte samples (IMGTYPE 0) is linked in and codes the sequences of at most 8 bits (set by the build)
+#endif
 #define ENABLE_FIELD_CTX          1    //!< Enables field context types for CABAC. If disabled, results in speedup for progressive content.
 #define ENABLE_HIGH444_CTX        1    //!< Enables High 444 context types for CABAC. If disabled, results in speedup of non High444 profile encodings.
 #define DEBUG_BITDEPTH            0    //!< Ensures that > 8 bit content have no values that would result in out of range results
@@ -130,7 +138,7 @@ typedef enum {
 #define  LAMBDA_ACCURACY_BITS         5
 #define  LAMBDA_FACTOR(lambda)        ((int)((double)(1 << LAMBDA_ACCURACY_BITS) * lambda + 0.5))
 
-#if (IMGTYPE == 0)
+#if (DISTTYPE == 0)
 #define DISTBLK_MAX  INT_MAX
 #else
 #define DISTBLK_MAX  ((distblk) INT_MAX << LAMBDA_ACCURACY_BITS)
@@ -345,7 +353,8 @@ typedef enum // JLT : on-the-fly levels/modes
 {
   OTF_L0 = 0, // Disable, interpolate & store all positions
   OTF_L1 = 1, // Store full pel & interpolated 1/2 pel positions; 1/4 pel positions interpolate on-the-fly
-  OTF_L2 = 2  // Store only full pell positions; 1/2 & 1/4 pel positions interpolate on-the-fly  
+  OTF_L2 = 2, // Store only full pell positions; 1/2 & 1/4 pel positions interpolate on-the-fly  
+  OTF_L3 = 3  // Store only full pel positions; 1/2 & 1/4 pel positions served from an LRU cache of interpolated tiles
 } OTFMode;
 
 typedef enum
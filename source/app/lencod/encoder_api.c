@@ -0,0 +1,825 @@
+/*!
+ *************************************************************************************
+ * \file encoder_api.c
+ *
+ * \brief
+ *    Encoder library API (lencod_api.h).
+ *
+ *    The encoder keeps its state in globals (p_Enc, cfgparams, errortext) and
+ *    in file scope variables of many modules, so one process codes one sequence
+ *    at a time. An encoder of the API is therefore a process that runs
+ *    encoder_main() on a command line built from the parameters, like
+ *    ConcurrentFieldDecision and SegmentParallel do for parts of a sequence.
+ *
+ *    The encoder processes are not forked from the caller, which may run other
+ *    threads by then, but from a pool server: lencod_pool_init() forks it while
+ *    the caller has a single thread, and the server stays single threaded.
+ *    lencod_open() sends it the parameters and the ends of three pipes over a
+ *    socket. For each request the server forks a monitor process, which forks
+ *    the encoder, waits for it and writes its exit code into the status pipe;
+ *    the server itself never waits, so it only serves requests.
+ *
+ *    The frames are written into a pipe that the encoder reads as sequential
+ *    input, and the Annex B bitstream comes back through a second pipe. A reader
+ *    thread of the calling process cuts it into NAL units for the callback. The
+ *    report files of the encoder are off unless the options name them, so
+ *    encoders in one working directory do not write the same files.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "configfile.h"
+#include "lencod_api.h"
+
+#if !(defined(WIN32) || defined(WIN64))
+#define ENCODER_PROCESS
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif
+
+#define API_MAX_ARGS     64          //!< command line arguments the API adds to the options
+#define API_ARG_SIZE     64          //!< size of an argument the API builds
+#define API_READ_SIZE    65536       //!< bytes read from the bitstream pipe at once
+#define API_MAX_STRINGS  (1 << 20)   //!< bytes of the file names and options of a request
+
+#if defined(ENCODER_PROCESS) && !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL     0           //!< SO_NOSIGPIPE is set on the socket instead
+#endif
+
+struct lencod_encoder
+{
+  LencodParams params;
+  int          width[3];             //!< component widths
+  int          height[3];            //!< component heights
+  int          sample_size;          //!< bytes per sample
+  byte        *frame;                //!< frame in the input file format
+  int          frame_size;
+  int          fd_frames;            //!< write end of the frame pipe
+  int          fd_nal;               //!< read end of the bitstream pipe
+  int          fd_status;            //!< read end of the pipe that returns the exit code of the encoder
+  int          failed;               //!< a frame could not be passed on
+#if defined(ENCODER_PROCESS)
+  pthread_t    reader;               //!< delivers the NAL units
+#endif
+};
+
+#if defined(ENCODER_PROCESS)
+//! Request of lencod_open() to the pool server. The pipe ends come with it, the strings follow it.
+typedef struct pool_request
+{
+  int    width;
+  int    height;
+  int    yuv_format;
+  int    bit_depth;
+  double frame_rate;
+  int    frames;
+  int    num_options;
+  int    string_size;                //!< config file, log file and options, each 0 terminated
+} PoolRequest;
+
+//! Pool server of the process
+typedef struct encoder_pool
+{
+  int             fd;                //!< socket to the pool server (-1: no pool)
+  pid_t           pid;               //!< pool server process
+  int             max_encoders;      //!< encoders that may be open at once (0: no limit)
+  int             num_encoders;      //!< encoders open
+  pthread_mutex_t lock;              //!< guards the pool and the requests on the socket
+  pthread_cond_t  closed;            //!< signalled when an encoder is closed
+} EncoderPool;
+
+static EncoderPool pool = { -1, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+#endif
+
+#if defined(ENCODER_PROCESS)
+/*!
+ ************************************************************************
+ * \brief
+ *    Writes size bytes to fd. A closed pipe (the encoder process ended)
+ *    is reported as an error instead of raising SIGPIPE in the caller.
+ ************************************************************************
+ */
+static int write_all(int fd, const byte *buf, int size)
+{
+  sigset_t pipe_set, old_set;
+  struct timespec no_wait = { 0, 0 };
+  int ret = 0;
+
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+  while (size > 0)
+  {
+    ssize_t n = write(fd, buf, size);
+
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+    {
+      // consume the SIGPIPE raised for this thread while it was blocked
+      if (errno == EPIPE)
+        sigtimedwait(&pipe_set, NULL, &no_wait);
+      ret = -1;
+      break;
+    }
+    buf  += n;
+    size -= (int) n;
+  }
+
+  pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+  return ret;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads size bytes from fd. Returns -1 if the data ends before.
+ ************************************************************************
+ */
+static int read_all(int fd, void *buf, int size)
+{
+  byte *dst = (byte *) buf;
+
+  while (size > 0)
+  {
+    ssize_t n = read(fd, dst, size);
+
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return -1;
+    dst  += n;
+    size -= (int) n;
+  }
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Closes the descriptors of a forked process (e.g. the pipes of other
+ *    encoders) except the standard ones and those in keep
+ ************************************************************************
+ */
+static void close_descriptors(const int *keep, int num_keep)
+{
+  int max_fd = imin((int) sysconf(_SC_OPEN_MAX), 65536);
+  int fd, i;
+
+  for (fd = 3; fd < max_fd; ++fd)
+  {
+    for (i = 0; i < num_keep && keep[i] != fd; ++i)
+      ;
+    if (i == num_keep)
+      close(fd);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reader thread: cuts the Annex B bitstream of the encoder process
+ *    at its start codes and passes the NAL units to the callback. The
+ *    trailing zero bytes before a start code belong to the start code.
+ ************************************************************************
+ */
+static void *nal_reader(void *arg)
+{
+  LencodEncoder *enc = (LencodEncoder *) arg;
+  int capacity = 2 * API_READ_SIZE;
+  int len = 0, scan = 0, nal = -1;
+  byte *buf;
+  ssize_t n;
+
+  // without memory the pipe is closed, which ends the encoder process with an error
+  if ((buf = (byte *) malloc(capacity)) == NULL)
+  {
+    close(enc->fd_nal);
+    enc->fd_nal = -1;
+    return NULL;
+  }
+
+  for (;;)
+  {
+    if (capacity - len < API_READ_SIZE)
+    {
+      byte *grown = (byte *) realloc(buf, 2 * capacity);
+
+      if (grown == NULL)
+      {
+        close(enc->fd_nal);
+        enc->fd_nal = -1;
+        free(buf);
+        return NULL;
+      }
+      buf = grown;
+      capacity *= 2;
+    }
+    if ((n = read(enc->fd_nal, buf + len, API_READ_SIZE)) < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    len += (int) n;
+
+    for (; scan + 3 <= len; ++scan)
+    {
+      if (buf[scan] != 0 || buf[scan + 1] != 0 || buf[scan + 2] != 1)
+        continue;
+      if (nal >= 0)
+      {
+        int end = scan;
+
+        while (end > nal && buf[end - 1] == 0)
+          --end;
+        if (end > nal)
+          enc->params.nal_out(enc->params.opaque, buf + nal, end - nal);
+      }
+      nal   = scan + 3;
+      scan += 2;
+    }
+
+    // keep the NAL unit in progress (and a start code that may be split)
+    if (nal > 0)
+    {
+      memmove(buf, buf + nal, len - nal);
+      len  -= nal;
+      scan -= nal;
+      nal   = 0;
+    }
+  }
+
+  if (nal >= 0)
+  {
+    while (len > nal && buf[len - 1] == 0)
+      --len;
+    if (len > nal)
+      enc->params.nal_out(enc->params.opaque, buf + nal, len - nal);
+  }
+
+  free(buf);
+  return NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Encoder process: codes the frames of the pipe fd_in into the pipe
+ *    fd_out. Does not return.
+ ************************************************************************
+ */
+static void run_encoder(const LencodParams *params, int fd_in, int fd_out)
+{
+  char arg[API_MAX_ARGS][API_ARG_SIZE];
+  char **argv;
+  int keep[2] = { fd_in, fd_out };
+  int argc = 0, num_options = 0, i, fd;
+
+  close_descriptors(keep, 2);
+
+  // the console output and the warnings of the encoder go to the log file, not to the caller's console
+  fd = open(params->log_file, OPENFLAGS_WRITE, OPEN_PERMISSIONS);
+  if (fd != -1)
+  {
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+  }
+  signal(SIGPIPE, SIG_DFL);
+
+  while (params->options != NULL && params->options[num_options] != NULL)
+    ++num_options;
+  if ((argv = (char **) calloc(3 + 2 * (num_options + API_MAX_ARGS) + 1, sizeof(char *))) == NULL)
+    no_mem_exit("run_encoder: argv");
+
+  argv[argc++] = "lencod";
+  argv[argc++] = "-d";
+  argv[argc++] = (char *) params->config_file;
+
+  // the report files are written into the working directory of the caller, which other
+  // encoders share: they are off unless the options name them for this encoder
+  argv[argc++] = "-p";
+  argv[argc++] = "StatsFile=/dev/null";
+  argv[argc++] = "-p";
+  argv[argc++] = "LeakyBucketParamFile=/dev/null";
+  argv[argc++] = "-p";
+  argv[argc++] = "ReportLog=0";
+  argv[argc++] = "-p";
+  argv[argc++] = "ReportFrameStats=0";
+
+  for (i = 0; i < num_options; ++i)
+  {
+    argv[argc++] = "-p";
+    argv[argc++] = (char *) params->options[i];
+  }
+
+  // the format and the files are those of the API, whatever the options say
+  i = 0;
+  snprintf(arg[i++], API_ARG_SIZE, "SourceWidth=%d", params->width);
+  snprintf(arg[i++], API_ARG_SIZE, "SourceHeight=%d", params->height);
+  snprintf(arg[i++], API_ARG_SIZE, "YUVFormat=%d", params->yuv_format);
+  snprintf(arg[i++], API_ARG_SIZE, "SourceBitDepthLuma=%d", params->bit_depth);
+  snprintf(arg[i++], API_ARG_SIZE, "SourceBitDepthChroma=%d", params->bit_depth);
+  snprintf(arg[i++], API_ARG_SIZE, "FrameRate=%f", params->frame_rate);
+  snprintf(arg[i++], API_ARG_SIZE, "FramesToBeEncoded=%d", params->frames);
+  snprintf(arg[i++], API_ARG_SIZE, "StartFrame=0");
+  snprintf(arg[i++], API_ARG_SIZE, "FrameSkip=0");
+  snprintf(arg[i++], API_ARG_SIZE, "InputHeaderLength=0");
+  snprintf(arg[i++], API_ARG_SIZE, "InputFile=/dev/fd/%d", fd_in);
+  snprintf(arg[i++], API_ARG_SIZE, "OutputFile=/dev/fd/%d", fd_out);
+  snprintf(arg[i++], API_ARG_SIZE, "ReconFile=");
+  snprintf(arg[i++], API_ARG_SIZE, "OutFileMode=0");
+  snprintf(arg[i++], API_ARG_SIZE, "NumberOfViews=1");
+  snprintf(arg[i++], API_ARG_SIZE, "SegmentParallel=0");
+  for (num_options = i, i = 0; i < num_options; ++i)
+  {
+    argv[argc++] = "-p";
+    argv[argc++] = arg[i];
+  }
+
+  i = encoder_main(argc, argv);
+  fflush(NULL);
+  _exit(i);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Monitor process of an encoder: forks the encoder, waits for it and
+ *    writes its exit code (-1 if it did not exit) into fd_status. Does
+ *    not return.
+ ************************************************************************
+ */
+static void run_monitor(const LencodParams *params, int fd_in, int fd_out, int fd_status)
+{
+  int status = -1, wait_status;
+  pid_t pid;
+
+  // the server ignores SIGCHLD to have its monitors reaped; this process waits for its child
+  signal(SIGCHLD, SIG_DFL);
+
+  if ((pid = fork()) == 0)
+    run_encoder(params, fd_in, fd_out);
+
+  // the reader of the caller sees the end of the bitstream when the encoder closes its end
+  close(fd_in);
+  close(fd_out);
+
+  if (pid > 0)
+  {
+    while (waitpid(pid, &wait_status, 0) < 0 && errno == EINTR)
+      ;
+    if (WIFEXITED(wait_status))
+      status = WEXITSTATUS(wait_status);
+  }
+
+  write_all(fd_status, (byte *) &status, sizeof(int));
+  _exit(0);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Receives a request and its three pipe ends from the pool server
+ *    socket. Returns -1 when the socket was closed or the request is
+ *    broken.
+ ************************************************************************
+ */
+static int receive_request(int fd, PoolRequest *req, int pipe_fd[3], char **strings)
+{
+  union { char buf[CMSG_SPACE(3 * sizeof(int))]; struct cmsghdr align; } control;
+  struct iovec iov;
+  struct msghdr msg;
+  struct cmsghdr *cmsg;
+  ssize_t n;
+
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base       = req;
+  iov.iov_len        = sizeof(PoolRequest);
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+
+  while ((n = recvmsg(fd, &msg, 0)) < 0 && errno == EINTR)
+    ;
+  if (n <= 0)
+    return -1;
+
+  // the descriptors come with the first byte of the request
+  cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(3 * sizeof(int)))
+    return -1;
+  memcpy(pipe_fd, CMSG_DATA(cmsg), 3 * sizeof(int));
+
+  if (read_all(fd, (byte *) req + n, (int) (sizeof(PoolRequest) - n)) != 0
+    || req->string_size <= 0 || req->string_size > API_MAX_STRINGS || req->num_options < 0
+    || (*strings = (char *) malloc(req->string_size)) == NULL)
+  {
+    close(pipe_fd[0]);
+    close(pipe_fd[1]);
+    close(pipe_fd[2]);
+    return -1;
+  }
+  if (read_all(fd, *strings, req->string_size) != 0 || (*strings)[req->string_size - 1] != 0)
+  {
+    free(*strings);
+    close(pipe_fd[0]);
+    close(pipe_fd[1]);
+    close(pipe_fd[2]);
+    return -1;
+  }
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Pool server: starts a monitor and encoder process for each request
+ *    of lencod_open() until the socket is closed. Does not return.
+ ************************************************************************
+ */
+static void run_pool_server(int fd)
+{
+  PoolRequest req;
+  LencodParams params;
+  int pipe_fd[3];
+  char *strings;
+  const char **options;
+  int i;
+
+  close_descriptors(&fd, 1);
+  signal(SIGCHLD, SIG_IGN);
+
+  while (receive_request(fd, &req, pipe_fd, &strings) == 0)
+  {
+    char *next = strings + strlen(strings) + 1;
+
+    memset(&params, 0, sizeof(LencodParams));
+    params.config_file = strings;
+    params.log_file    = next;
+    params.width       = req.width;
+    params.height      = req.height;
+    params.yuv_format  = req.yuv_format;
+    params.bit_depth   = req.bit_depth;
+    params.frame_rate  = req.frame_rate;
+    params.frames      = req.frames;
+
+    // the options follow the two file names
+    if ((options = (const char **) calloc(req.num_options + 1, sizeof(char *))) != NULL)
+    {
+      for (i = 0; i < req.num_options + 1 && next < strings + req.string_size; ++i)
+      {
+        if (i > 0)
+          options[i - 1] = next;
+        next += strlen(next) + 1;
+      }
+      params.options = options;
+
+      // a failed fork() closes the pipes below, which the caller sees as a failed encoder
+      if (i == req.num_options + 1 && fork() == 0)
+      {
+        close(fd);
+        run_monitor(&params, pipe_fd[0], pipe_fd[1], pipe_fd[2]);
+      }
+      free(options);
+    }
+
+    close(pipe_fd[0]);
+    close(pipe_fd[1]);
+    close(pipe_fd[2]);
+    free(strings);
+  }
+
+  _exit(0);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sends a request with the pipe ends of an encoder to the pool
+ *    server. Called with the pool lock held.
+ ************************************************************************
+ */
+static int send_request(const LencodParams *params, int fd_in, int fd_out, int fd_status)
+{
+  const char *config_file = (params->config_file != NULL) ? params->config_file : DEFAULTCONFIGFILENAME;
+  const char *log_file    = (params->log_file    != NULL) ? params->log_file    : "/dev/null";
+  int pipe_fd[3] = { fd_in, fd_out, fd_status };
+  union { char buf[CMSG_SPACE(3 * sizeof(int))]; struct cmsghdr align; } control;
+  struct iovec iov;
+  struct msghdr msg;
+  struct cmsghdr *cmsg;
+  PoolRequest *req;
+  char *strings;
+  int size, i, ret = 0;
+  ssize_t n;
+
+  size = (int) (strlen(config_file) + strlen(log_file)) + 2;
+  for (i = 0; params->options != NULL && params->options[i] != NULL; ++i)
+    size += (int) strlen(params->options[i]) + 1;
+  if (size > API_MAX_STRINGS || (req = (PoolRequest *) calloc(1, sizeof(PoolRequest) + size)) == NULL)
+    return -1;
+
+  req->width       = params->width;
+  req->height      = params->height;
+  req->yuv_format  = params->yuv_format;
+  req->bit_depth   = params->bit_depth;
+  req->frame_rate  = params->frame_rate;
+  req->frames      = params->frames;
+  req->num_options = i;
+  req->string_size = size;
+
+  strings = (char *) (req + 1);
+  strcpy(strings, config_file);
+  strings += strlen(strings) + 1;
+  strcpy(strings, log_file);
+  strings += strlen(strings) + 1;
+  for (i = 0; i < req->num_options; ++i)
+  {
+    strcpy(strings, params->options[i]);
+    strings += strlen(strings) + 1;
+  }
+
+  memset(&msg, 0, sizeof(msg));
+  memset(&control, 0, sizeof(control));
+  iov.iov_base       = req;
+  iov.iov_len        = sizeof(PoolRequest) + size;
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level   = SOL_SOCKET;
+  cmsg->cmsg_type    = SCM_RIGHTS;
+  cmsg->cmsg_len     = CMSG_LEN(3 * sizeof(int));
+  memcpy(CMSG_DATA(cmsg), pipe_fd, 3 * sizeof(int));
+
+  while ((n = sendmsg(pool.fd, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR)
+    ;
+  if (n <= 0)
+    ret = -1;
+  else if (n < (ssize_t) iov.iov_len)
+    ret = write_all(pool.fd, (byte *) req + n, (int) (iov.iov_len - n));
+
+  free(req);
+  return ret;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts the pool server. Must be called while the process has a
+ *    single thread.
+ ************************************************************************
+ */
+int lencod_pool_init(int max_encoders)
+{
+  int fd[2];
+  pid_t pid;
+
+  if (max_encoders < 0 || pool.fd != -1)
+    return -1;
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) != 0)
+    return -1;
+
+  // buffered output of the caller would be written twice otherwise
+  fflush(NULL);
+  if ((pid = fork()) == 0)
+  {
+    close(fd[0]);
+    run_pool_server(fd[1]);
+  }
+  close(fd[1]);
+  if (pid < 0)
+  {
+    close(fd[0]);
+    return -1;
+  }
+#if defined(SO_NOSIGPIPE)
+  {
+    int no_sigpipe = 1;
+    setsockopt(fd[0], SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+  }
+#endif
+
+  pool.fd           = fd[0];
+  pool.pid          = pid;
+  pool.max_encoders = max_encoders;
+  pool.num_encoders = 0;
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Ends the pool server; open encoders keep running
+ ************************************************************************
+ */
+void lencod_pool_exit(void)
+{
+  pthread_mutex_lock(&pool.lock);
+  if (pool.fd != -1)
+  {
+    close(pool.fd);
+    while (waitpid(pool.pid, NULL, 0) < 0 && errno == EINTR)
+      ;
+    pool.fd = -1;
+  }
+  // callers waiting for a free encoder fail now
+  pthread_cond_broadcast(&pool.closed);
+  pthread_mutex_unlock(&pool.lock);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Has the pool server start an encoder process and starts the thread
+ *    that delivers its NAL units
+ ************************************************************************
+ */
+LencodEncoder *lencod_open(const LencodParams *params)
+{
+  static const int chroma_shift_x[4] = { 0, 1, 1, 0 };
+  static const int chroma_shift_y[4] = { 0, 1, 0, 0 };
+  LencodEncoder *enc;
+  int fd_frames[2], fd_nal[2], fd_status[2];
+  int c, ret;
+
+  if (params == NULL || params->nal_out == NULL || params->width <= 0 || params->height <= 0 || params->frames <= 0
+    || params->yuv_format < 0 || params->yuv_format > 3 || params->bit_depth < 8 || params->bit_depth > 14)
+    return NULL;
+
+  if ((enc = (LencodEncoder *) calloc(1, sizeof(LencodEncoder))) == NULL)
+    return NULL;
+  enc->params      = *params;
+  enc->sample_size = (params->bit_depth > 8) ? 2 : 1;
+  enc->width[0]    = params->width;
+  enc->height[0]   = params->height;
+  for (c = 1; c < 3; ++c)
+  {
+    enc->width[c]  = (params->yuv_format == YUV400) ? 0 : params->width  >> chroma_shift_x[params->yuv_format];
+    enc->height[c] = (params->yuv_format == YUV400) ? 0 : params->height >> chroma_shift_y[params->yuv_format];
+  }
+  for (c = 0; c < 3; ++c)
+    enc->frame_size += enc->width[c] * enc->height[c] * enc->sample_size;
+  if ((enc->frame = (byte *) malloc(enc->frame_size)) == NULL)
+  {
+    free(enc);
+    return NULL;
+  }
+
+  if (pipe(fd_frames) != 0)
+  {
+    free(enc->frame);
+    free(enc);
+    return NULL;
+  }
+  if (pipe(fd_nal) != 0)
+  {
+    close(fd_frames[0]);
+    close(fd_frames[1]);
+    free(enc->frame);
+    free(enc);
+    return NULL;
+  }
+  if (pipe(fd_status) != 0)
+  {
+    close(fd_frames[0]);
+    close(fd_frames[1]);
+    close(fd_nal[0]);
+    close(fd_nal[1]);
+    free(enc->frame);
+    free(enc);
+    return NULL;
+  }
+
+  pthread_mutex_lock(&pool.lock);
+  while (pool.fd != -1 && pool.max_encoders > 0 && pool.num_encoders >= pool.max_encoders)
+    pthread_cond_wait(&pool.closed, &pool.lock);
+  ret = (pool.fd != -1) ? send_request(params, fd_frames[0], fd_nal[1], fd_status[1]) : -1;
+  if (ret == 0)
+    ++pool.num_encoders;
+  pthread_mutex_unlock(&pool.lock);
+
+  // the encoder got its own copies of these ends with the request
+  close(fd_frames[0]);
+  close(fd_nal[1]);
+  close(fd_status[1]);
+  enc->fd_frames = fd_frames[1];
+  enc->fd_nal    = fd_nal[0];
+  enc->fd_status = fd_status[0];
+
+  if (ret == 0 && pthread_create(&enc->reader, NULL, nal_reader, enc) == 0)
+    return enc;
+
+  // without the reader the encoder ends with an error when its input is closed
+  close(enc->fd_frames);
+  close(enc->fd_nal);
+  if (ret == 0)
+  {
+    read_all(enc->fd_status, &c, sizeof(int));
+    pthread_mutex_lock(&pool.lock);
+    --pool.num_encoders;
+    pthread_cond_signal(&pool.closed);
+    pthread_mutex_unlock(&pool.lock);
+  }
+  close(enc->fd_status);
+  free(enc->frame);
+  free(enc);
+  return NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Passes a frame to the encoder process. Blocks while the encoder is
+ *    more frames behind than the pipe and its input buffer hold.
+ ************************************************************************
+ */
+int lencod_encode(LencodEncoder *enc, const void *const plane[3], const int stride[3])
+{
+  byte *dst = enc->frame;
+  int c, y;
+
+  if (enc->failed)
+    return -1;
+
+  for (c = 0; c < 3; ++c)
+  {
+    const byte *src = (const byte *) plane[c];
+    int row_size = enc->width[c] * enc->sample_size;
+
+    for (y = 0; y < enc->height[c]; ++y)
+    {
+      memcpy(dst, src, row_size);
+      dst += row_size;
+      src += stride[c];
+    }
+  }
+
+  if (write_all(enc->fd_frames, enc->frame, enc->frame_size) != 0)
+    enc->failed = 1;
+
+  return enc->failed ? -1 : 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Ends the input of the encoder, waits for its last NAL unit and
+ *    for its exit code, and frees the encoder
+ ************************************************************************
+ */
+int lencod_close(LencodEncoder *enc)
+{
+  int status;
+
+  close(enc->fd_frames);
+  pthread_join(enc->reader, NULL);
+  if (enc->fd_nal != -1)
+    close(enc->fd_nal);
+  if (read_all(enc->fd_status, &status, sizeof(int)) != 0)
+    status = -1;
+  close(enc->fd_status);
+
+  free(enc->frame);
+  free(enc);
+
+  pthread_mutex_lock(&pool.lock);
+  --pool.num_encoders;
+  pthread_cond_signal(&pool.closed);
+  pthread_mutex_unlock(&pool.lock);
+
+  return status;
+}
+#else
+int lencod_pool_init(int max_encoders)
+{
+  printf("Warning: the encoder library API is not supported by this build.\n");
+  return -1;
+}
+
+void lencod_pool_exit(void)
+{
+}
+
+LencodEncoder *lencod_open(const LencodParams *params)
+{
+  return NULL;
+}
+
+int lencod_encode(LencodEncoder *enc, const void *const plane[3], const int stride[3])
+{
+  return -1;
+}
+
+int lencod_close(LencodEncoder *enc)
+{
+  return -1;
+}
+#endif
@@ -27,6 +27,7 @@
 #include "md_distortion.h"
 #include "md_common.h"
 #include "lln_mc_prediction.h"
+#include "loop_filter.h"
 
 static void add_residue     (Macroblock *currMB, StorablePicture *enc_pic, int decoder, int pl, int block8x8, int x_size, int y_size);
 static void Build_Status_Map(VideoParameters *p_Vid, InputParameters *p_Inp, byte **s_map);
@@ -172,17 +173,64 @@ distblk errdo_distortion_estimation_multihyp(Macroblock *currMB, int block, int
  *    Performs the simulation of the packet losses, calls the error concealment funcs
  *    and deblocks the error concealed pictures
  *
+ *    The loss patterns are drawn first, in decoder order, so that the random sequence
+ *    does not depend on how the decoders are distributed among threads. The filter
+ *    decisions are the same for all decoders and are derived once; the decoders then
+ *    only write their own planes and run in parallel (OPENMP builds).
  *************************************************************************************
  */
 void UpdateDecoders(VideoParameters *p_Vid, InputParameters *p_Inp, StorablePicture *enc_pic)
 {
+  byte ***mb_error_map = enc_pic->de_mem->mb_error_map;
+  MbDeblockInfo *deblock_info = NULL;
+  unsigned int mb;
   int k;
+
+  for (k = 0; k < p_Inp->NoOfDecoders; k++)
+    Build_Status_Map(p_Vid, p_Inp, mb_error_map[k]); // simulates the packet losses
+
+  // positions of the macroblocks lost in any of the decoders, the concealment only reads them
+  for (mb = 0; mb < p_Vid->PicSizeInMbs; mb++)
+  {
+    Macroblock *currMB = &p_Vid->mb_data[mb];
+    int mb_x = p_Vid->PicPos[mb].x;
+    int mb_y = p_Vid->PicPos[mb].y;
+
+    for (k = 0; k < p_Inp->NoOfDecoders; k++)
+    {
+      if (mb_error_map[k][mb_y][mb_x])
+      {
+        currMB->mb_x    = (short) mb_x;
+        currMB->mb_y    = (short) mb_y;
+        currMB->block_x = currMB->mb_x << 2;
+        currMB->block_y = currMB->mb_y << 2;
+        currMB->pix_x   = currMB->block_x << 2;
+        currMB->pix_y   = currMB->block_y << 2;
+        break;
+      }
+    }
+  }
+
+  if (!p_Vid->mb_aff_frame_flag)
+  {
+    if ((deblock_info = (MbDeblockInfo *) malloc(p_Vid->PicSizeInMbs * sizeof(MbDeblockInfo))) == NULL)
+      no_mem_exit("UpdateDecoders: deblock_info");
+    GetDeblockInfo(p_Vid, deblock_info);
+  }
+
+#if defined(OPENMP)
+#pragma omp parallel for schedule(dynamic, 1) if (deblock_info != NULL)
+#endif
   for (k = 0; k < p_Inp->NoOfDecoders; k++)
   {
-    Build_Status_Map(p_Vid, p_Inp, enc_pic->de_mem->mb_error_map[k]); // simulates the packet losses
     p_Vid->error_conceal_picture(p_Vid, enc_pic, k); 
-    DeblockFrame (p_Vid, enc_pic->de_mem->p_dec_img[0][k], NULL);
+    if (deblock_info != NULL)
+      DeblockFramePlane (p_Vid, enc_pic->de_mem->p_dec_img[0][k], deblock_info);
+    else
+      DeblockFrame (p_Vid, enc_pic->de_mem->p_dec_img[0][k], NULL);
   }
+
+  free_pointer(deblock_info);
 }
 
 
@@ -595,6 +643,7 @@ static void get_predicted_concealment_mb(Macroblock* currMB, StorablePicture* en
  *    Performs copy error concealment for macroblocks with errors.
  *  Note: Currently assumes that the reference picture lists remain the same for all 
  *        slices of a picture. 
+ *        The positions of the lost macroblocks are set up by UpdateDecoders().
  *  
  *************************************************************************************
  */
@@ -611,17 +660,9 @@ void copy_conceal_picture(VideoParameters *p_Vid, StorablePicture *enc_pic, int
   for (mb = 0; mb < p_Vid->PicSizeInMbs; mb++)
   {
     currMB = &p_Vid->mb_data[mb];
-    currMB->mb_x = PicPos[mb].x;
-    currMB->mb_y = PicPos[mb].y;
-    mb_error = mb_error_map[currMB->mb_y][currMB->mb_x];
+    mb_error = mb_error_map[PicPos[mb].y][PicPos[mb].x];
     if (mb_error)
-    {      
-      currMB->block_x = currMB ->mb_x << 2;
-      currMB->block_y = currMB->mb_y << 2;
-      currMB->pix_x   = currMB->block_x << 2;
-      currMB->pix_y   = currMB->block_y << 2;
       copy_conceal_mb(currMB, enc_pic, decoder, mb_error, refPic);
-    }
   }
 }
 
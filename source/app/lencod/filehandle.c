@@ -21,6 +21,7 @@
 #include "annexb.h"
 #include "parset.h"
 #include "mbuffer.h"
+#include "async_output.h"
 
 
 /*!
@@ -39,6 +40,7 @@ void error(char *text, int code)
   fprintf(stderr, "%s\n", text);
   flush_dpb(p_Enc->p_Vid->p_Dpb_layer[0], &p_Enc->p_Inp->output);
   flush_dpb(p_Enc->p_Vid->p_Dpb_layer[1], &p_Enc->p_Inp->output);
+  flush_async_output(p_Enc->p_Vid);
   exit(code);
 }
 
@@ -243,6 +245,9 @@ int terminate_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
   // Mainly flushing of everything
   // Add termination symbol, etc.
 
+  // queued NAL units have to reach the file before it is closed
+  flush_async_output(p_Vid);
+
   switch(p_Inp->of_mode)
   {
   case PAR_OF_ANNEXB:
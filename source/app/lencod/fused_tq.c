@@ -0,0 +1,308 @@
+/*!
+ *************************************************************************************
+ * \file fused_tq.c
+ *
+ * \brief
+ *    Fused transform, quantization and reconstruction of luma 4x4 and 8x8 blocks
+ *    for the normal and the adaptive rounding quantizers.
+ *
+ *    The residual block is loaded once and kept in registers through the forward
+ *    transform, quantization, dequantization, inverse transform and reconstruction.
+ *    Only the levels go through a small aligned buffer so that they can be run
+ *    length coded in scan order. The results are bit exact with the sequence
+ *    forwardNxN / quant_NxN_normal (or _around) / inverseNxN / sample_reconstruct,
+ *    which is also what builds without SIMD support execute.
+ *
+ *************************************************************************************
+ */
+
+#include <limits.h>
+
+#include "global.h"
+#include "blk_prediction.h"
+#include "transform.h"
+#include "md_common.h"
+#include "simd.h"
+#include "fused_tq.h"
+
+#if defined(JM_SIMD)
+//! Per block constants of the vectorized quantizer
+typedef struct fused_quant_consts
+{
+  __m128i q_bits;     //!< quantization shift
+  __m128i qp_per;     //!< dequantization scale shift
+  __m128i limit;      //!< largest level magnitude
+  __m128i dq_rnd;     //!< dequantization rounding
+  __m128i dq_bits;    //!< dequantization shift
+  __m128i ar_weight;  //!< adaptive rounding weight
+  __m128i ar_rnd;     //!< adaptive rounding offset rounding
+  __m128i ar_bits;    //!< adaptive rounding offset shift
+} FusedQuantConsts;
+
+static void init_fused_quant_consts(FusedQuantConsts *k, VideoParameters *p_Vid, int q_bits, int qp_per, int limit, int dq_bits)
+{
+  k->q_bits    = _mm_cvtsi32_si128(q_bits);
+  k->qp_per    = _mm_cvtsi32_si128(qp_per);
+  k->limit     = _mm_set1_epi32(limit);
+  k->dq_rnd    = _mm_set1_epi32(1 << (dq_bits - 1));
+  k->dq_bits   = _mm_cvtsi32_si128(dq_bits);
+  k->ar_weight = _mm_set1_epi32(p_Vid->AdaptRndWeight);
+  k->ar_rnd    = _mm_set1_epi32(1 << q_bits);
+  k->ar_bits   = _mm_cvtsi32_si128(q_bits + 1);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Quantize four coefficients of a row, return the dequantized values
+ *    and the signed levels. If adjust is given, the adaptive rounding
+ *    offsets of quant_NxN_around are stored there.
+ ************************************************************************
+ */
+static inline __m128i quant_dequant_row(__m128i coef, const LevelQuantParams *q, const FusedQuantConsts *k, __m128i *level, int *adjust)
+{
+  __m128i scale  = _mm_setr_epi32(q[0].ScaleComp,    q[1].ScaleComp,    q[2].ScaleComp,    q[3].ScaleComp);
+  __m128i offset = _mm_setr_epi32(q[0].OffsetComp,   q[1].OffsetComp,   q[2].OffsetComp,   q[3].OffsetComp);
+  __m128i iscale = _mm_setr_epi32(q[0].InvScaleComp, q[1].InvScaleComp, q[2].InvScaleComp, q[3].InvScaleComp);
+  __m128i scaled = _mm_mullo_epi32(_mm_abs_epi32(coef), scale);
+  __m128i lev    = _mm_min_epi32(_mm_sra_epi32(_mm_add_epi32(scaled, offset), k->q_bits), k->limit);
+
+  // zero coefficients give zero levels, as in the scalar quantizers
+  *level = _mm_sign_epi32(lev, coef);
+
+  if (adjust != NULL)
+  {
+    __m128i adj = _mm_mullo_epi32(k->ar_weight, _mm_sub_epi32(scaled, _mm_sll_epi32(lev, k->q_bits)));
+
+    adj = _mm_sra_epi32(_mm_add_epi32(adj, k->ar_rnd), k->ar_bits);
+    _mm_storeu_si128((__m128i *) adjust, _mm_andnot_si128(_mm_cmpeq_epi32(*level, _mm_setzero_si128()), adj));
+  }
+
+  return _mm_sra_epi32(_mm_add_epi32(_mm_sll_epi32(_mm_mullo_epi32(*level, iscale), k->qp_per), k->dq_rnd), k->dq_bits);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Run length coding of quantized levels in scan order
+ ************************************************************************
+ */
+static int run_level_scan(const int *levels, int width, const byte *p_scan, int count, int *ACL, int *ACR, const byte *c_cost, int *coeff_cost)
+{
+  int k, level, run = 0;
+  int nonzero = FALSE;
+
+  for (k = 0; k < count; ++k, p_scan += 2)
+  {
+    level = levels[p_scan[1] * width + p_scan[0]];
+    if (level != 0)
+    {
+      *coeff_cost += (iabs(level) > 1) ? MAX_VALUE : c_cost[run];
+      *ACL++  = level;
+      *ACR++  = run;
+      run     = 0;
+      nonzero = TRUE;
+    }
+    else
+    {
+      ++run;
+    }
+  }
+
+  *ACL = 0;
+
+  return nonzero;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Add the inverse transformed rows to the prediction
+ ************************************************************************
+ */
+static inline void reconstruct_row(imgpel *cur, const imgpel *pred, __m128i res, __m128i vrnd, int dq_bits, __m128i vmax)
+{
+  res = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(res, vrnd), dq_bits), simd_load_pel4(pred));
+  simd_store_pel4(cur, _mm_min_epi32(_mm_max_epi32(res, _mm_setzero_si128()), vmax));
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Transform, quantize and reconstruct a luma 4x4 block with the normal
+ *    or the adaptive rounding quantizer (q_method->fadjust set).
+ ************************************************************************
+ */
+int fused_tq_luma_4x4(Macroblock *currMB, ColorPlane pl, QuantMethods *q_method)
+{
+  Slice *currSlice = currMB->p_Slice;
+  VideoParameters *p_Vid = currMB->p_Vid;
+  int block_x = q_method->block_x;
+  int block_y = q_method->block_y;
+  int pic_x   = currMB->pix_x + block_x;
+  int **mb_ores = currSlice->mb_ores[pl];
+  int **mb_rres = currSlice->mb_rres[pl];
+  int **tblock  = currSlice->tblk16x16;
+  imgpel **mb_pred = &currSlice->mb_pred[pl][block_y];
+  imgpel **img_enc = &p_Vid->enc_picture->p_curr_img[currMB->pix_y + block_y];
+  int nonzero = FALSE;
+
+#if defined(JM_SIMD)
+  int qp_per = p_Vid->p_Quant->qp_per_matrix[q_method->qp];
+  int **fadjust = q_method->fadjust;
+  FusedQuantConsts k;
+  __m128i v[BLOCK_SIZE], levels[BLOCK_SIZE];
+  __m128i any = _mm_setzero_si128();
+  int j;
+
+  init_fused_quant_consts(&k, p_Vid, Q_BITS + qp_per, qp_per, currSlice->symbol_mode == CAVLC ? CAVLC_LEVEL_LIMIT : INT_MAX, 4);
+
+  for (j = 0; j < BLOCK_SIZE; ++j)
+    v[j] = _mm_loadu_si128((__m128i *) &mb_ores[block_y + j][block_x]);
+
+  simd_forward4x4(v);
+
+  for (j = 0; j < BLOCK_SIZE; ++j)
+  {
+    v[j] = quant_dequant_row(v[j], q_method->q_params[j], &k, &levels[j], fadjust ? &fadjust[j][block_x] : NULL);
+    any  = _mm_or_si128(any, levels[j]);
+    _mm_storeu_si128((__m128i *) &tblock[block_y + j][block_x], v[j]);
+  }
+
+  if (!_mm_testz_si128(any, any))
+    nonzero = run_level_scan((int *) levels, BLOCK_SIZE, &q_method->pos_scan[0][0], 16, q_method->ACLevel, q_method->ACRun, q_method->c_cost, q_method->coeff_cost);
+  else
+    q_method->ACLevel[0] = 0;
+
+  if (nonzero)
+  {
+    const __m128i vrnd = _mm_set1_epi32(1 << (DQ_BITS - 1));
+    const __m128i vmax = _mm_set1_epi32(p_Vid->max_imgpel_value);
+
+    simd_inverse4x4(v);
+    for (j = 0; j < BLOCK_SIZE; ++j)
+    {
+      _mm_storeu_si128((__m128i *) &mb_rres[block_y + j][block_x], v[j]);
+      reconstruct_row(&img_enc[j][pic_x], &mb_pred[j][block_x], v[j], vrnd, DQ_BITS, vmax);
+    }
+  }
+#else
+  forward4x4(mb_ores, tblock, block_y, block_x);
+
+  nonzero = currSlice->quant_4x4(currMB, &tblock[block_y], q_method);
+
+  if (nonzero)
+  {
+    inverse4x4(tblock, mb_rres, block_y, block_x);
+    sample_reconstruct (img_enc, mb_pred, &mb_rres[block_y], block_x, pic_x, BLOCK_SIZE, BLOCK_SIZE, p_Vid->max_imgpel_value, DQ_BITS);
+  }
+#endif
+  else
+  {
+    copy_image_data_4x4(img_enc, mb_pred, pic_x, block_x);
+  }
+
+  return nonzero;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Transform, quantize and reconstruct a luma 8x8 block with the normal
+ *    or the adaptive rounding quantizer (q_method->fadjust set). cofAC
+ *    selects the four interleaved CAVLC scans, NULL the single scan.
+ ************************************************************************
+ */
+int fused_tq_luma_8x8(Macroblock *currMB, ColorPlane pl, QuantMethods *q_method, int ***cofAC)
+{
+  Slice *currSlice = currMB->p_Slice;
+  VideoParameters *p_Vid = currMB->p_Vid;
+  int block_x = q_method->block_x;
+  int block_y = q_method->block_y;
+  int pic_x   = currMB->pix_x + block_x;
+  int **mb_ores = currSlice->mb_ores[pl];
+  int **mb_rres = currSlice->mb_rres[pl];
+  imgpel **mb_pred = &currSlice->mb_pred[pl][block_y];
+  imgpel **img_enc = &p_Vid->enc_picture->p_curr_img[currMB->pix_y + block_y];
+  int nonzero = FALSE;
+
+#if defined(JM_SIMD)
+  int qp_per = p_Vid->p_Quant->qp_per_matrix[q_method->qp];
+  int **fadjust = q_method->fadjust;
+  FusedQuantConsts c;
+  __m128i v[2 * BLOCK_SIZE_8x8], levels[2 * BLOCK_SIZE_8x8];
+  __m128i any = _mm_setzero_si128();
+  int j, k;
+
+  init_fused_quant_consts(&c, p_Vid, Q_BITS_8 + qp_per, qp_per, cofAC != NULL ? CAVLC_LEVEL_LIMIT : INT_MAX, 6);
+
+  for (j = 0; j < BLOCK_SIZE_8x8; ++j)
+  {
+    v[2 * j    ] = _mm_loadu_si128((__m128i *) &mb_ores[block_y + j][block_x    ]);
+    v[2 * j + 1] = _mm_loadu_si128((__m128i *) &mb_ores[block_y + j][block_x + 4]);
+  }
+
+  simd_forward8x8(v);
+
+  for (j = 0; j < BLOCK_SIZE_8x8; ++j)
+  {
+    for (k = 0; k < 2; ++k)
+    {
+      __m128i *vk = &v[2 * j + k];
+      *vk = quant_dequant_row(*vk, &q_method->q_params[j][4 * k], &c, &levels[2 * j + k], fadjust ? &fadjust[j][block_x + 4 * k] : NULL);
+      any = _mm_or_si128(any, levels[2 * j + k]);
+      _mm_storeu_si128((__m128i *) &mb_rres[block_y + j][block_x + 4 * k], *vk);
+    }
+  }
+
+  if (cofAC != NULL)
+  {
+    for (k = 0; k < 4; ++k)
+    {
+      if (!_mm_testz_si128(any, any))
+        nonzero |= run_level_scan((int *) levels, BLOCK_SIZE_8x8, &q_method->pos_scan[16 * k][0], 16, cofAC[k][0], cofAC[k][1], q_method->c_cost, q_method->coeff_cost);
+      else
+        cofAC[k][0][0] = 0;
+    }
+  }
+  else if (!_mm_testz_si128(any, any))
+    nonzero = run_level_scan((int *) levels, BLOCK_SIZE_8x8, &q_method->pos_scan[0][0], 64, q_method->ACLevel, q_method->ACRun, q_method->c_cost, q_method->coeff_cost);
+  else
+    q_method->ACLevel[0] = 0;
+
+  if (nonzero)
+  {
+    const __m128i vrnd = _mm_set1_epi32(1 << (DQ_BITS_8 - 1));
+    const __m128i vmax = _mm_set1_epi32(p_Vid->max_imgpel_value);
+
+    simd_inverse8x8(v);
+    for (j = 0; j < BLOCK_SIZE_8x8; ++j)
+    {
+      _mm_storeu_si128((__m128i *) &mb_rres[block_y + j][block_x    ], v[2 * j    ]);
+      _mm_storeu_si128((__m128i *) &mb_rres[block_y + j][block_x + 4], v[2 * j + 1]);
+      reconstruct_row(&img_enc[j][pic_x    ], &mb_pred[j][block_x    ], v[2 * j    ], vrnd, DQ_BITS_8, vmax);
+      reconstruct_row(&img_enc[j][pic_x + 4], &mb_pred[j][block_x + 4], v[2 * j + 1], vrnd, DQ_BITS_8, vmax);
+    }
+  }
+#else
+  forward8x8(mb_ores, mb_rres, block_y, block_x);
+
+  if (cofAC != NULL)
+    nonzero = currSlice->quant_8x8cavlc(currMB, &mb_rres[block_y], q_method, cofAC);
+  else
+    nonzero = currSlice->quant_8x8(currMB, &mb_rres[block_y], q_method);
+
+  if (nonzero)
+  {
+    inverse8x8(&mb_rres[block_y], &mb_rres[block_y], block_x);
+    sample_reconstruct (img_enc, mb_pred, &mb_rres[block_y], block_x, pic_x, BLOCK_SIZE_8x8, BLOCK_SIZE_8x8, p_Vid->max_imgpel_value, DQ_BITS_8);
+  }
+#endif
+  else
+  {
+    copy_image_data_8x8(img_enc, mb_pred, pic_x, block_x);
+  }
+
+  return nonzero;
+}
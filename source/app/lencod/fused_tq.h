@@ -0,0 +1,20 @@
+/*!
+ ************************************************************************
+ * \file
+ *     fused_tq.h
+ *
+ * \brief
+ *    Fused transform, quantization and reconstruction of luma blocks
+ ************************************************************************
+ */
+
+#ifndef _FUSED_TQ_H_
+#define _FUSED_TQ_H_
+
+#include "global.h"
+
+extern int fused_tq_luma_4x4 (Macroblock *currMB, ColorPlane pl, QuantMethods *q_method);
+extern int fused_tq_luma_8x8 (Macroblock *currMB, ColorPlane pl, QuantMethods *q_method, int ***cofAC);
+
+#endif
+
@@ -17,6 +17,7 @@
 #include "mb_access.h"
 #include "get_block_otf.h"
 #include "refbuf_otf.h"
+#include "otf_cache.h"
 
 
 /*!
@@ -748,27 +749,21 @@ static void get_luma_31(imgpel *block, imgpel **cur_imgY, int block_size_y, int
 /*!
  ************************************************************************
  * \brief
- *    Interpolation on-the-fly of 1/4 subpixel
+ *    Interpolate a block at an already clipped full pel position
  ************************************************************************
  */ 
-
-static inline void get_block_luma_otf(  VideoParameters *p_Vid,  //!< video encoding parameters for current picture
+static inline void get_block_luma_pos( VideoParameters *p_Vid,  //!< video encoding parameters for current picture
                       imgpel*   mpred,         //!< array of prediction values (row by row)
                       int*   tmp_pred,         //!< array of temporary prediction values (row by row), used for some hal-pel interpolations
-                      int    pic_pix_x,        //!< motion shifted horizontal coordinate of block
-                      int    pic_pix_y,        //!< motion shifted vertical   coordinate of block
+                      imgpel **ref_block,      //!< full pel reference plane
+                      int    x_pos,            //!< full pel horizontal coordinate of block
+                      int    y_pos,            //!< full pel vertical   coordinate of block
+                      int    dx,               //!< horizontal sub-pel phase
+                      int    dy,               //!< vertical   sub-pel phase
                       int    block_size_x,   //!< horizontal block size
-                      int    block_size_y,   //!< vertical block size
-                      StorablePicture *ref,    //!< reference picture list
-                      int    pl                //!< plane
+                      int    block_size_y    //!< vertical block size
                     )
 {
-  imgpel **ref_block = (p_Vid->P444_joined && pl>PLANE_Y)? ref->imgUV[pl-1] : ref->imgY;
-  int    dx = (pic_pix_x & 0x03);
-  int    dy = (pic_pix_y & 0x03);
-  int    x_pos = iClip3(-IMG_PAD_SIZE_X+2,  ref->size_x_pad-2, pic_pix_x>>2);
-  int    y_pos = iClip3(-IMG_PAD_SIZE_Y+2, ref->size_y_pad-2, pic_pix_y>>2);
-
   if (dx == 0 && dy == 0)
     get_block_00(mpred, &(ref_block[y_pos][x_pos]), block_size_y, block_size_x, p_Vid->padded_size_x);
   else
@@ -827,6 +822,30 @@ static inline void get_block_luma_otf(  VideoParameters *p_Vid,  //!< video enco
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Interpolation on-the-fly of 1/4 subpixel
+ ************************************************************************
+ */ 
+static inline void get_block_luma_otf(  VideoParameters *p_Vid,  //!< video encoding parameters for current picture
+                      imgpel*   mpred,         //!< array of prediction values (row by row)
+                      int*   tmp_pred,         //!< array of temporary prediction values (row by row), used for some hal-pel interpolations
+                      int    pic_pix_x,        //!< motion shifted horizontal coordinate of block
+                      int    pic_pix_y,        //!< motion shifted vertical   coordinate of block
+                      int    block_size_x,   //!< horizontal block size
+                      int    block_size_y,   //!< vertical block size
+                      StorablePicture *ref,    //!< reference picture list
+                      int    pl                //!< plane
+                    )
+{
+  imgpel **ref_block = (p_Vid->P444_joined && pl>PLANE_Y)? ref->imgUV[pl-1] : ref->imgY;
+  int    x_pos = iClip3(-IMG_PAD_SIZE_X+2,  ref->size_x_pad-2, pic_pix_x>>2);
+  int    y_pos = iClip3(-IMG_PAD_SIZE_Y+2, ref->size_y_pad-2, pic_pix_y>>2);
+
+  get_block_luma_pos(p_Vid, mpred, tmp_pred, ref_block, x_pos, y_pos, pic_pix_x & 0x03, pic_pix_y & 0x03, block_size_x, block_size_y);
+}
+
 void get_block_luma_otf_L2(  VideoParameters *p_Vid,  //!< video encoding parameters for current picture
                       imgpel*   mpred,         //!< array of prediction values (row by row)
                       int*   tmp_pred,         //!< array of temporary prediction values (row by row), used for some hal-pel interpolations
@@ -871,6 +890,88 @@ void get_block_luma_otf_L1(  VideoParameters *p_Vid,  //!< video encoding parame
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Sub-pel block served from the interpolated tile cache (OTF_L3).
+ *
+ *    Blocks that touch the outer two columns/rows of the padding, or
+ *    whose position would be clipped by get_block_luma_otf, are
+ *    interpolated directly so that the result is identical to OTF_L2.
+ ************************************************************************
+ */ 
+void get_block_luma_otf_L3(  VideoParameters *p_Vid,  //!< video encoding parameters for current picture
+                      imgpel*   mpred,         //!< array of prediction values (row by row)
+                      int*   tmp_pred,         //!< array of temporary prediction values (row by row), used for some hal-pel interpolations
+                      int    pic_pix_x,        //!< motion shifted horizontal coordinate of block
+                      int    pic_pix_y,        //!< motion shifted vertical   coordinate of block
+                      int    block_size_x,   //!< horizontal block size
+                      int    block_size_y,   //!< vertical block size
+                      StorablePicture *ref,    //!< reference picture list
+                      int    pl                //!< plane
+                    )
+{
+  OTFTileCache *p_cache = p_Vid->p_OtfCache;
+  int dx = (pic_pix_x & 0x03);
+  int dy = (pic_pix_y & 0x03);
+  int x_pos = pic_pix_x >> 2;
+  int y_pos = pic_pix_y >> 2;
+  // region in which the 6 tap filters stay inside the padded plane
+  int x_min = -IMG_PAD_SIZE_X + 2;
+  int y_min = -IMG_PAD_SIZE_Y + 2;
+  int x_max = ref->size_x + IMG_PAD_SIZE_X - 3;
+  int y_max = ref->size_y + IMG_PAD_SIZE_Y - 3;
+
+  if ((dx == 0 && dy == 0) 
+    || x_pos < x_min || x_pos > ref->size_x_pad - 2 || x_pos + block_size_x > x_max
+    || y_pos < y_min || y_pos > ref->size_y_pad - 2 || y_pos + block_size_y > y_max)
+  {
+    get_block_luma_otf( p_Vid, mpred, tmp_pred, pic_pix_x, pic_pix_y, block_size_x, block_size_y, ref, pl ) ;
+  }
+  else
+  {
+    imgpel **ref_block = (p_Vid->P444_joined && pl>PLANE_Y)? ref->imgUV[pl-1] : ref->imgY;
+    int phase = (dy << 2) + dx;
+    int x, y, j, hit;
+    int y_end = y_pos + block_size_y;
+    int x_end = x_pos + block_size_x;
+
+    for (y = y_pos; y < y_end; )
+    {
+      int tile_y = (y - y_min) / OTF_TILE_SIZE;
+      int tile_y0 = y_min + tile_y * OTF_TILE_SIZE;
+      int rows = imin(tile_y0 + OTF_TILE_SIZE, y_end) - y;
+
+      for (x = x_pos; x < x_end; )
+      {
+        int tile_x = (x - x_min) / OTF_TILE_SIZE;
+        int tile_x0 = x_min + tile_x * OTF_TILE_SIZE;
+        int cols = imin(tile_x0 + OTF_TILE_SIZE, x_end) - x;
+        OTFTile *tile = get_otf_cache_tile(p_cache, ref_block, ref->otf_cache_id, phase, tile_x, tile_y, &hit);
+        imgpel *src, *dst;
+
+        if (!hit)
+        {
+          tile->width  = imin(OTF_TILE_SIZE, x_max - tile_x0);
+          tile->height = imin(OTF_TILE_SIZE, y_max - tile_y0);
+          get_block_luma_pos(p_Vid, tile->data, p_cache->tmp_res, ref_block, tile_x0, tile_y0, dx, dy, tile->width, tile->height);
+        }
+
+        src = tile->data + (y - tile_y0) * tile->width + (x - tile_x0);
+        dst = mpred + (y - y_pos) * block_size_x + (x - x_pos);
+        for (j = 0; j < rows; ++j)
+        {
+          memcpy(dst, src, cols * sizeof(imgpel));
+          src += tile->width;
+          dst += block_size_x;
+        }
+        x += cols;
+      }
+      y += rows;
+    }
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -36,6 +36,18 @@ void get_block_luma_otf_L1(  VideoParameters *p_Vid,  //!< video encoding parame
                     ) ;
 
 
+void get_block_luma_otf_L3(  VideoParameters *p_Vid,  //!< video encoding parameters for current picture
+                      imgpel*   mpred,         //!< array of prediction values (row by row)
+                      int*   tmp_pred,         //!< array of temporary prediction values (row by row), used for some hal-pel interpolations
+                      int    pic_pix_x,        //!< motion shifted horizontal coordinate of block
+                      int    pic_pix_y,        //!< motion shifted vertical   coordinate of block
+                      int    block_size_x,   //!< horizontal block size
+                      int    block_size_y,   //!< vertical block size
+                      StorablePicture *ref,    //!< reference picture list
+                      int    pl                //!< plane
+                    ) ;
+
+
 void get_block_chroma_otf_L2 ( VideoParameters *p_Vid, //!< video encoding parameters for current picture
                         imgpel* mpred,          //!< array to store prediction values
                         int*   tmp_pred,
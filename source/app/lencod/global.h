@@ -112,6 +112,9 @@ struct encoding_environment
   int           *Ecodestrm_len;
   int           C;
   int           E;
+  unsigned int  Eepoch;         //!< rate estimation epoch (0: real arithmetic coding)
+  int64         Eest_bits;      //!< estimated rate in units of 1/32768 bit
+  struct ctx_undo_log *Elog;    //!< journal of context changes for RDO coding states (NULL: off)
 };
 
 //! struct for context management
@@ -120,8 +123,45 @@ struct bi_context_type
   unsigned long  count;
   byte state; //uint16 state;         // index into state-table CP
   unsigned char  MPS;           // Least Probable Symbol 0/1 CP  
+  byte           est_state;     //!< shadow state used by the rate estimation
+  unsigned char  est_MPS;       //!< shadow MPS used by the rate estimation
+  unsigned int   est_epoch;     //!< estimation epoch the shadow belongs to
 };
 
+//! context model and its value before a change
+typedef struct ctx_undo_entry
+{
+  BiContextTypePtr ctx;
+  BiContextType    saved;
+  unsigned int     id;          //!< unique number of the change
+} CtxUndoEntry;
+
+//! context values saved by a coding state: the contexts changed since the previous checkpoint
+typedef struct ctx_checkpoint
+{
+  int           first;         //!< index of the first value in CtxUndoLog::values
+  int           num_values;
+  int           mark;          //!< log size when the checkpoint was taken
+  unsigned int  id;            //!< id of the last log entry at that time
+} CtxCheckpoint;
+
+//! journal of context changes, undone to restore a coding state
+typedef struct ctx_undo_log
+{
+  CtxUndoEntry *entries;
+  int           size;
+  int           max_size;
+  unsigned int  next_id;
+  int           low_size;      //!< lowest log size since the last checkpoint
+
+  CtxUndoEntry  *values;       //!< context values of the checkpoints of the macroblock, followed by the contexts undone since the last one
+  int            num_values;
+  int            max_values;
+  CtxCheckpoint *checkpoints;
+  int            num_checkpoints;
+  int            max_checkpoints;
+} CtxUndoLog;
+
 
 
 /**********************************************************************
@@ -285,6 +325,7 @@ typedef struct me_block
   MotionVector     mv[2];            //!< motion vectors (L0/L1)
   PixelPos         block[4];
   struct slice    *p_Slice;
+  struct epzs_params *p_EPZS;      //!< EPZS state used by the search (a per thread copy with ParallelRefME)
   struct search_window searchRange;
   int              cost;           //!< Rate Distortion cost
   imgpel         **orig_pic;      //!< Block Data
@@ -551,6 +592,7 @@ typedef struct slice
 {
   struct video_par    *p_Vid;   // pointer to the original video structure
   InputParameters     *p_Inp;   // pointer to the input parameters
+  struct mem_arena    *p_Arena; // arena holding the slice and its scratch buffers (NULL for lite slices)
   pic_parameter_set_rbsp_t *active_pps;
   seq_parameter_set_rbsp_t *active_sps;
 
@@ -573,6 +615,7 @@ typedef struct slice
   int                 disthres;
   int                 Transform8x8Mode;
   int                 rdoq_motion_copy;
+  distblk             rdoq_mode_cost[MAXMODE];  //!< RD cost of each mode at the master QP (RDOQ_CP_Mode = 2)
   // RDOQ at the slice level (note this allows us to reduce passed parameters, 
   // but also could enable RDOQ control at the slice level.
   int                 UseRDOQuant;
@@ -619,6 +662,7 @@ typedef struct slice
   DataPartition       *partArr;     //!< array of partitions
   MotionInfoContexts  *mot_ctx;     //!< pointer to struct of context models for use in CABAC
   TextureInfoContexts *tex_ctx;     //!< pointer to struct of context models for use in CABAC
+  unsigned int         cabac_est_epoch; //!< last CABAC rate estimation epoch handed out
 
   int                 mvscale[6][MAX_REFERENCE_PICTURES];
   char                direct_spatial_mv_pred_flag;              //!< Direct Mode type to be used (0: Temporal, 1: Spatial)
@@ -691,6 +735,9 @@ typedef struct slice
   double norm_factor_8x8;
   int    norm_shift_4x4;
   int    norm_shift_8x8;
+  double est_err_4x4[6][4][4];      //!< estErr4x4 / norm_factor_4x4 per qp_rem
+  double est_err_8x8[6][8][8];      //!< estErr8x8 / norm_factor_8x8 per qp_rem
+  struct rdoq_cache *p_RDOQCache;   //!< CABAC trellis results of the current macroblock
 
   imgpel ****mpr_4x4;           //!< prediction samples for   4x4 intra prediction modes
   imgpel ****mpr_8x8;           //!< prediction samples for   8x8 intra prediction modes
@@ -707,6 +754,8 @@ typedef struct slice
 
   struct rdo_structure    *p_RDO;
   struct epzs_params      *p_EPZS;  
+  struct ref_me_thread_ctx *p_RefMECtx;  //!< per thread EPZS scratch of the concurrent reference search (ParallelRefME)
+  int                      num_RefMECtx;
 
   // This should be the right location for this
   struct storable_picture **listX[6];
@@ -834,6 +883,31 @@ typedef struct prev_coding_stats
 } PrevCodingStats;
 #endif
 
+//! Coding state printed in the report line of a picture
+typedef struct frame_report
+{
+  char pic_type[4];
+  int  frame_no;
+  int  frm_no_in_file;
+  int  view_id;
+  int  cur_bits;              //!< bits of the picture
+  int  nvb_bits;              //!< parameter set bits sent with the picture
+  int  fdn_bits;              //!< filler data bits
+  int  nvb_line;              //!< a parameter set line precedes the picture line
+  int  wp_method;
+  int  AverageFrameQP;
+  int  lambda;
+  int  tmp_time;
+  int  me_time;
+  int  fld_flag;
+  int  intras;
+  int  direct_mode;
+  int  num_ref_idx_l0_active;
+  int  num_ref_idx_l1_active;
+  int  rd_pass;
+  int  nal_reference_idc;
+} FrameReport;
+
 //! DistortionParams
 typedef struct distortion_metric
 {
@@ -987,6 +1061,18 @@ typedef struct video_par
   //Hierarchical Motion Estimation structure
   struct hme_info *pHMEInfo;  //!< HME information
   int    is_hme;
+
+  struct otf_tile_cache *p_OtfCache; //!< interpolated tile cache (OTF_L3)
+  struct me_cache *p_MECache;        //!< motion estimation results of earlier coding passes
+  struct mem_arena *p_SliceArenas;   //!< pool of reset slice arenas
+  struct rt_control *p_RTCtrl;       //!< real-time complexity control (RTTargetFPS)
+  struct lookahead  *p_Lookahead;    //!< lookahead pre-analysis (LookaheadFrames)
+  struct metric_engine *p_Metrics;   //!< background quality metric computation (AsyncMetrics)
+  struct async_output  *p_Output;    //!< background bitstream and reconstruction writer (AsyncOutput)
+  int64 intra_presel_blocks;         //!< 4x4/8x8 blocks ranked by IntraRDOCandidates
+  int64 intra_presel_modes;          //!< available intra modes of these blocks
+  int64 intra_presel_checked;        //!< intra modes that got a full RD evaluation
+  int    num_segments;               //!< IDR segments coded by concurrent processes (SegmentParallel)
  
   ImageData imgData;           //!< Image data to be encoded
   ImageData imgData0;          //!< Input Image Data
@@ -1204,6 +1290,7 @@ typedef struct video_par
   int          frm_iter;   //!< frame variations to create (useful for multiple coding passes)
 
   unsigned int field_picture;
+  int          skip_field_coding; //!< field pair only evaluated concurrently (ConcurrentFieldDecision) and lost the frame/field decision
   signed int toppoc;       //!< poc for this frame or field
   signed int bottompoc;    //!< for completeness - poc of bottom field of a frame (always = poc+1)
   signed int framepoc;     //!< min (toppoc, bottompoc)
@@ -1458,8 +1545,8 @@ typedef struct video_par
   void (*GetStrengthVer)    (byte Strength[16], Macroblock *MbQ, int edge, int mvlimit);
   void (*GetStrengthHor)    (byte Strength[16], Macroblock *MbQ, int edge, int mvlimit);
   void (*EdgeLoopLumaHor)   (ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width);
-  void (*EdgeLoopLumaVer)   (ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge);
-  void (*EdgeLoopChromaVer)(imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int uv);
+  void (*EdgeLoopLumaVer)   (ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width);
+  void (*EdgeLoopChromaVer)(imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width, int uv);
   void (*EdgeLoopChromaHor)(imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width, int uv);
 
   // We should move these at the slice level at some point.
@@ -1586,6 +1673,10 @@ extern void select_plane               (VideoParameters *p_Vid, ColorPlane color
 extern void select_transform           (Macroblock *currMB);
 extern void set_slice_type             (VideoParameters *p_Vid, InputParameters *p_Inp, int slice_type);
 extern void free_encoder_memory        (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void encode_frames              (VideoParameters *p_Vid, InputParameters *p_Inp, int first, int last);
+extern void start_input                (InputParameters *p_Inp, VideoDataFile *input_file);
+extern int  encoder_main               (int argc, char **argv);
+extern int  encoder_main_8bit          (InputParameters *p_Inp);
 extern void output_SP_coefficients     (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void read_SP_coefficients       (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void init_redundant_frame       (VideoParameters *p_Vid, InputParameters *p_Inp);
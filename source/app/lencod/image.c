@@ -68,6 +68,30 @@
 #include "md_common.h"
 #include "me_epzs_common.h"
 #include "me_hme.h"
+#include "otf_cache.h"
+#include "me_cache.h"
+#include "rt_control.h"
+#include "lookahead.h"
+#include "img_dist_async.h"
+
+#if !(defined(WIN32) || defined(WIN64))
+#include <sys/wait.h>
+#endif
+
+//! Field pair candidate of the frame/field decision coded by a separate process
+typedef struct field_candidate
+{
+  int pid;                 //!< process coding the field pair (-1: coded in sequence)
+  int fd;                  //!< read end of the result pipe
+} FieldCandidate;
+
+//! Data of the field pair candidate needed by picture_structure_decision
+typedef struct field_candidate_result
+{
+  DistMetric distortion;   //!< distortion of both fields (kept in the top field)
+  int        top_bits;
+  int        bot_bits;
+} FieldCandidateResult;
 
 extern void UpdateDecoders            (VideoParameters *p_Vid, InputParameters *p_Inp, StorablePicture *enc_pic);
 
@@ -83,6 +107,9 @@ static void writeout_picture          (VideoParameters *p_Vid, Picture *pic);
 #endif
 static byte picture_structure_decision(VideoParameters *p_Vid, Picture *frame, Picture *top, Picture *bot);
 static void distortion_fld            (VideoParameters *p_Vid, InputParameters *p_Inp, Picture *field_pic, ImageData *imgData);
+static void prepare_field_pair        (VideoParameters *p_Vid);
+static void start_field_candidate     (VideoParameters *p_Vid, Picture *top, Picture *bottom, FieldCandidate *cand);
+static int  finish_field_candidate    (VideoParameters *p_Vid, Picture *top, Picture *bottom, FieldCandidate *cand);
 
 static void field_mode_buffer (VideoParameters *p_Vid);
 static void frame_mode_buffer (VideoParameters *p_Vid);
@@ -92,11 +119,12 @@ static void put_buffer_frame  (VideoParameters *p_Vid);
 static void put_buffer_top    (VideoParameters *p_Vid);
 static void put_buffer_bot    (VideoParameters *p_Vid);
 
-static void ReportFirstframe   (VideoParameters *p_Vid, int64 tmp_time);
-static void ReportI            (VideoParameters *p_Vid, int64 tmp_time);
-static void ReportP            (VideoParameters *p_Vid, int64 tmp_time);
-static void ReportB            (VideoParameters *p_Vid, int64 tmp_time);
-static void ReportNALNonVLCBits(VideoParameters *p_Vid, int64 tmp_time);
+static void get_frame_report   (VideoParameters *p_Vid, FrameReport *r, int64 tmp_time);
+static void ReportFirstframe   (VideoParameters *p_Vid, FrameReport *r);
+static void ReportI            (VideoParameters *p_Vid, FrameReport *r);
+static void ReportP            (VideoParameters *p_Vid, FrameReport *r);
+static void ReportB            (VideoParameters *p_Vid, FrameReport *r);
+static void ReportNALNonVLCBits(VideoParameters *p_Vid, FrameReport *r);
 
 extern void rd_picture_coding(VideoParameters *p_Vid, InputParameters *p_Inp);
 
@@ -766,6 +794,130 @@ void perform_encode_field(VideoParameters *p_Vid)
   p_Vid->fld_flag = TRUE;
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets up the coding of the field pair candidate of the frame/field
+ *    decision
+ ************************************************************************
+ */
+static void prepare_field_pair(VideoParameters *p_Vid)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  DecRefPicMarking_t *tmp_drpm;
+
+  if ( p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE )
+    p_Vid->p_rc_gen->FieldControl=1;
+  p_Vid->write_macroblock = FALSE;
+  p_Vid->bot_MB = FALSE;
+
+  p_Vid->field_picture = 1;  // we encode fields
+
+  //Free frame based dec_ref_pic_marking_buffer
+  while (p_Vid->dec_ref_pic_marking_buffer)
+  {
+    tmp_drpm = p_Vid->dec_ref_pic_marking_buffer;
+    p_Vid->dec_ref_pic_marking_buffer = tmp_drpm->Next;
+    free(tmp_drpm);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts coding the field pair candidate in a child process so that
+ *    it runs concurrently with the frame candidate coded by the caller.
+ *    The child works on a private copy of the whole encoder state, which
+ *    is simply dropped when it exits; only the rate and distortion
+ *    needed by picture_structure_decision are sent back. On failure
+ *    cand->pid is -1 and the field pair is coded in sequence.
+ ************************************************************************
+ */
+static void start_field_candidate(VideoParameters *p_Vid, Picture *top, Picture *bottom, FieldCandidate *cand)
+{
+#if !(defined(WIN32) || defined(WIN64))
+  int fd[2];
+  FieldCandidateResult result;
+
+  cand->pid = -1;
+  if (pipe(fd) != 0)
+    return;
+
+  fflush(stdout);
+  if ((cand->pid = fork()) == 0)
+  {
+    ssize_t ret;
+
+    close(fd[0]);
+    // the reconstruction belongs to the parent; nothing must be written from here
+    p_Vid->p_dec = p_Vid->p_dec2 = -1;
+    // and the output writer thread only exists in the parent
+    p_Vid->p_Output = NULL;
+
+    prepare_field_pair(p_Vid);
+    field_picture(p_Vid, top, bottom);
+
+    result.distortion = top->distortion;
+    result.top_bits   = top->bits_per_picture;
+    result.bot_bits   = bottom->bits_per_picture;
+    ret = write(fd[1], &result, sizeof(FieldCandidateResult));
+    _exit(ret == (ssize_t) sizeof(FieldCandidateResult) ? 0 : 1);
+  }
+
+  close(fd[1]);
+  if (cand->pid < 0)
+    close(fd[0]);
+  else
+    cand->fd = fd[0];
+#else
+  cand->pid = -1;
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Collects the result of start_field_candidate into the top and
+ *    bottom field pictures. Returns TRUE if they hold the rate and
+ *    distortion of the field pair, which then still has to be coded by
+ *    the caller if it wins the decision (p_Vid->skip_field_coding).
+ ************************************************************************
+ */
+static int finish_field_candidate(VideoParameters *p_Vid, Picture *top, Picture *bottom, FieldCandidate *cand)
+{
+#if !(defined(WIN32) || defined(WIN64))
+  FieldCandidateResult result;
+  ssize_t size = 0, ret;
+  int status = 0;
+
+  if (cand->pid <= 0)
+    return FALSE;
+
+  while (size < (ssize_t) sizeof(FieldCandidateResult))
+  {
+    ret = read(cand->fd, (byte *) &result + size, sizeof(FieldCandidateResult) - size);
+    if (ret <= 0)
+      break;
+    size += ret;
+  }
+  close(cand->fd);
+  waitpid(cand->pid, &status, 0);
+  cand->pid = -1;
+
+  if (top == NULL || size != (ssize_t) sizeof(FieldCandidateResult) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    return FALSE;
+
+  top->distortion       = result.distortion;
+  top->bits_per_picture = result.top_bits;
+  bottom->bits_per_picture = result.bot_bits;
+  p_Vid->skip_field_coding = TRUE;
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
 void perform_encode_frame(VideoParameters *p_Vid)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
@@ -774,6 +926,7 @@ void perform_encode_frame(VideoParameters *p_Vid)
   int num_ref_idx_l1 = 0;
 
   int frame_type;
+  FieldCandidate fld_cand;
 
   //Rate control
   if ( p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE )
@@ -795,12 +948,26 @@ void perform_encode_frame(VideoParameters *p_Vid)
     if (p_Vid->type!=I_SLICE && p_Vid->type!=SI_SLICE)
       invoke_HME(p_Vid, 0);
   }
+
+  // with ConcurrentFieldDecision the field pair is coded by a child process while the frame is coded here
+  p_Vid->skip_field_coding = FALSE;
+  fld_cand.pid = -1;
+  if (p_Inp->ConcurrentFieldDecision)
+  {
+#if (MVC_EXTENSION_ENABLE)
+    start_field_candidate(p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1], &fld_cand);
+#else
+    start_field_candidate(p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1], &fld_cand);
+#endif
+  }
     
 #if (MVC_EXTENSION_ENABLE)
   if(p_Vid->view_id!=1 || !p_Vid->sec_view_force_fld)
   {
 #endif
-    if ((p_Vid->type == B_SLICE || p_Vid->type == P_SLICE || p_Vid->type==I_SLICE) && p_Inp->RDPictureDecision)
+    // the extra coding passes are not worth it for frames the pre-analysis found static
+    if ((p_Vid->type == B_SLICE || p_Vid->type == P_SLICE || p_Vid->type==I_SLICE) && p_Inp->RDPictureDecision
+      && !lookahead_is_static(p_Vid->p_Lookahead, p_Vid->frame_no))
     {
       frame_picture_mp (p_Vid, p_Inp); 
     }
@@ -837,28 +1004,15 @@ void perform_encode_frame(VideoParameters *p_Vid)
   if (p_Inp->PicInterlace == ADAPTIVE_CODING)
 #endif
   {
-    DecRefPicMarking_t *tmp_drpm;
-
-    if ( p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE )
-      p_Vid->p_rc_gen->FieldControl=1;
-    p_Vid->write_macroblock = FALSE;
-    p_Vid->bot_MB = FALSE;
-
     frame_type = p_Vid->type;
 
-    p_Vid->field_picture = 1;  // we encode fields
-   
-    //Free frame based dec_ref_pic_marking_buffer
-    while (p_Vid->dec_ref_pic_marking_buffer)
+#if (MVC_EXTENSION_ENABLE)
+    if (!finish_field_candidate(p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1], &fld_cand))
     {
-      tmp_drpm = p_Vid->dec_ref_pic_marking_buffer;
-      p_Vid->dec_ref_pic_marking_buffer = tmp_drpm->Next;
-      free(tmp_drpm);
+      prepare_field_pair(p_Vid);
+      field_picture (p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1]);
     }
 
-#if (MVC_EXTENSION_ENABLE)
-    field_picture (p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1]);
-
     if(p_Inp->num_of_views==1 || p_Vid->view_id==0)  // first view will make the decision
     {
       if(p_Vid->rd_pass == 0)
@@ -868,6 +1022,14 @@ void perform_encode_frame(VideoParameters *p_Vid)
       else
         p_Vid->fld_flag = picture_structure_decision (p_Vid, p_Vid->frame_pic[2], p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1]);
 
+      // the concurrently evaluated field pair won: code it for real
+      if (p_Vid->skip_field_coding && p_Vid->fld_flag)
+      {
+        p_Vid->skip_field_coding = FALSE;
+        prepare_field_pair(p_Vid);
+        field_picture (p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1]);
+      }
+
       p_Vid->sec_view_force_fld = p_Vid->fld_flag;    // store 1st view decision, same coding structure to be used for second view
     }
     else
@@ -875,7 +1037,11 @@ void perform_encode_frame(VideoParameters *p_Vid)
       p_Vid->fld_flag = (byte) p_Vid->sec_view_force_fld;
     }
 #else
-    field_picture (p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1]);
+    if (!finish_field_candidate(p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1], &fld_cand))
+    {
+      prepare_field_pair(p_Vid);
+      field_picture (p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1]);
+    }
 
     if(p_Vid->rd_pass == 0)
       p_Vid->fld_flag = picture_structure_decision (p_Vid, p_Vid->frame_pic[0], p_Vid->field_pic[0], p_Vid->field_pic[1]);
@@ -883,6 +1049,14 @@ void perform_encode_frame(VideoParameters *p_Vid)
       p_Vid->fld_flag = picture_structure_decision (p_Vid, p_Vid->frame_pic[1], p_Vid->field_pic[0], p_Vid->field_pic[1]);
     else
       p_Vid->fld_flag = picture_structure_decision (p_Vid, p_Vid->frame_pic[2], p_Vid->field_pic[0], p_Vid->field_pic[1]);
+
+    // the concurrently evaluated field pair won: code it for real
+    if (p_Vid->skip_field_coding && p_Vid->fld_flag)
+    {
+      p_Vid->skip_field_coding = FALSE;
+      prepare_field_pair(p_Vid);
+      field_picture (p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1]);
+    }
 #endif
 
     if ( p_Vid->fld_flag )
@@ -904,7 +1078,10 @@ void perform_encode_frame(VideoParameters *p_Vid)
       p_Vid->p_rc_gen->FieldFrame = !(p_Vid->fld_flag) ? 1 : 0;
   }
   else
+  {
+    finish_field_candidate(p_Vid, NULL, NULL, &fld_cand);
     p_Vid->fld_flag = FALSE;
+  }
 
   p_Vid->SumFrameQP = tmpFrameQP;
   p_Vid->num_ref_idx_l0_active = num_ref_idx_l0;
@@ -959,6 +1136,7 @@ void store_coded_picture(DecodedPictureBuffer *p_Dpb)
   VideoParameters *p_Vid = p_Dpb->p_Vid;
   InputParameters *p_Inp = p_Vid->p_Inp;
   unsigned int profile_idc = p_Vid->active_sps->profile_idc;
+  int i;
 
 #if (MVC_EXTENSION_ENABLE)
   if ( (p_Inp->PicInterlace == ADAPTIVE_CODING) && ((p_Dpb->layer_id == 0 ) || !is_MVC_profile(profile_idc)))
@@ -987,7 +1165,17 @@ void store_coded_picture(DecodedPictureBuffer *p_Dpb)
     {
       update_global_stats(p_Inp, p_Vid->p_Stats, &p_Vid->enc_frame_picture[p_Vid->rd_pass]->stats);
       // replace top with frame
-      if (p_Vid->rd_pass==2)
+      if (p_Vid->skip_field_coding)
+      {
+        // the field pair was only evaluated by another process, there is no top field to replace
+        store_picture_in_dpb(p_Dpb, p_Vid->enc_frame_picture[p_Vid->rd_pass], &p_Inp->output);
+        for (i = 0; i < 3; ++i)
+        {
+          if (i != p_Vid->rd_pass)
+            free_storable_picture(p_Vid, p_Vid->enc_frame_picture[i]);
+        }
+      }
+      else if (p_Vid->rd_pass==2)
       {
         replace_top_pic_with_frame(p_Dpb, p_Vid->enc_frame_picture[2], &p_Inp->output);
         free_storable_picture     (p_Vid, p_Vid->enc_frame_picture[0]);
@@ -1008,7 +1196,8 @@ void store_coded_picture(DecodedPictureBuffer *p_Dpb)
           free_storable_picture     (p_Vid, p_Vid->enc_frame_picture[2]);
         }
       }
-      free_storable_picture(p_Vid, p_Vid->enc_field_picture[1]);
+      if (!p_Vid->skip_field_coding)
+        free_storable_picture(p_Vid, p_Vid->enc_field_picture[1]);
     }
   }
   else
@@ -1191,9 +1380,11 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   TIME_T start_time;
   TIME_T end_time;
   int64  tmp_time;
+  FrameReport report;
 
   p_Vid->me_time = 0;
   p_Vid->rd_pass = 0;
+  me_cache_new_picture(p_Vid);
 
   if( (p_Inp->separate_colour_plane_flag != 0) )
   {
@@ -1399,16 +1590,17 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   tmp_time  = timediff(&start_time, &end_time);
   p_Vid->tot_time += tmp_time;
   tmp_time  = timenorm(tmp_time);
+  if (p_Vid->p_RTCtrl != NULL)
+    rt_control_update(p_Vid, tmp_time);
   p_Vid->me_time   = timenorm(p_Vid->me_time);
-  if (p_Vid->p_Stats->bit_ctr_parametersets_n!=0 && p_Inp->Verbose != 3)
-    ReportNALNonVLCBits(p_Vid, tmp_time);
+  get_frame_report(p_Vid, &report, tmp_time);
 
 #if (MVC_EXTENSION_ENABLE)
   if (p_Vid->curr_frm_idx == 0 && !p_Vid->view_id)
 #else
   if (p_Vid->curr_frm_idx == 0)
 #endif
-    ReportFirstframe(p_Vid, tmp_time);
+    ReportFirstframe(p_Vid, &report);
   else
   {
     bits = update_video_stats(p_Vid);
@@ -1417,20 +1609,26 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
     {
     case I_SLICE:
     case SI_SLICE:
-      ReportI(p_Vid, tmp_time);
+      ReportI(p_Vid, &report);
       break;
     case B_SLICE:
-      ReportB(p_Vid, tmp_time);
+      ReportB(p_Vid, &report);
       break;
     case SP_SLICE:
-      ReportP(p_Vid, tmp_time);
+      ReportP(p_Vid, &report);
       break;
     case P_SLICE:
     default:
-      ReportP(p_Vid, tmp_time);
+      ReportP(p_Vid, &report);
     }
   }
 
+  // with AsyncMetrics the line is printed once the quality metrics of the picture are known
+  if (p_Vid->p_Metrics != NULL)
+    queue_frame_report(p_Vid, &report);
+  else
+    print_frame_report(p_Vid, &report, p_Vid->p_Dist->metric);
+
   if (p_Inp->Verbose == 0)
   {
     //for (i = 0; i <= (p_Vid->number & 0x0F); i++)
@@ -2233,6 +2431,7 @@ void UnifiedOneForthPix ( VideoParameters *p_Vid, StorablePicture *s)
   {
     // perform  padding ( copying borders) that is implicitly done above if p_Inp->OnTheFlyFractMCP=0
     OtfCompatibility_copyWithPadding( s->imgY, s->imgY, s->size_x, s->size_y, IMG_PAD_SIZE_X, IMG_PAD_SIZE_Y ) ;
+    s->otf_cache_id = get_otf_cache_id(p_Vid);
     OtfCompatibility_copyWithPadding( s->imgUV[0], s->imgUV[0], s->size_x_cr, s->size_y_cr, p_Vid->pad_size_uv_x,p_Vid->pad_size_uv_y ) ;
     OtfCompatibility_copyWithPadding( s->imgUV[1], s->imgUV[1], s->size_x_cr, s->size_y_cr, p_Vid->pad_size_uv_x, p_Vid->pad_size_uv_y ) ;
   }
@@ -2282,6 +2481,7 @@ void UnifiedOneForthPix_JV (VideoParameters *p_Vid, int nplane, StorablePicture
   {
     // perform  padding ( copying borders) that is implicitly done above if p_Inp->OnTheFlyFractMCP=0
      OtfCompatibility_copyWithPadding( s->p_img[nplane], s->p_img[nplane], s->size_x, s->size_y, IMG_PAD_SIZE_X, IMG_PAD_SIZE_Y ) ;
+     s->otf_cache_id = get_otf_cache_id(p_Vid);
   }
 }
 
@@ -2296,18 +2496,22 @@ Boolean dummy_slice_too_big (int bits_slice)
   return FALSE;
 }
 
-static void ReportSimple(VideoParameters *p_Vid, char *pic_type, int cur_bits, DistMetric *metric, int tmp_time)
+static void ReportSimple(VideoParameters *p_Vid, FrameReport *r, DistMetric *metric)
 {
+  char *pic_type   = r->pic_type;
+  int  cur_bits    = r->cur_bits;
+  int  tmp_time    = r->tmp_time;
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Vid->p_Inp->num_of_views == 2 )
   {
-    if ( p_Vid->fld_flag && p_Vid->view_id == 0 )
+    if ( r->fld_flag && r->view_id == 0 )
     {
-      p_Vid->prev_cs.frm_no_in_file = p_Vid->frm_no_in_file;
-      p_Vid->prev_cs.view_id = p_Vid->view_id;
+      p_Vid->prev_cs.frm_no_in_file = r->frm_no_in_file;
+      p_Vid->prev_cs.view_id = r->view_id;
       p_Vid->prev_cs.cur_bits = cur_bits;
       strcpy( p_Vid->prev_cs.pic_type, pic_type );
-      p_Vid->prev_cs.AverageFrameQP = p_Vid->AverageFrameQP;
+      p_Vid->prev_cs.AverageFrameQP = r->AverageFrameQP;
       p_Vid->prev_cs.lambda = 0;
       p_Vid->prev_cs.psnr_value[0] = metric->value[0];
       p_Vid->prev_cs.psnr_value[1] = metric->value[1];
@@ -2316,16 +2520,16 @@ static void ReportSimple(VideoParameters *p_Vid, char *pic_type, int cur_bits, D
       p_Vid->prev_cs.ssim_value[1] = 0;
       p_Vid->prev_cs.ssim_value[2] = 0;
       p_Vid->prev_cs.tmp_time = tmp_time;
-      p_Vid->prev_cs.me_time = (int)p_Vid->me_time;
-      p_Vid->prev_cs.fld_flag = p_Vid->fld_flag;
-      p_Vid->prev_cs.intras = p_Vid->intras;
+      p_Vid->prev_cs.me_time = (int)r->me_time;
+      p_Vid->prev_cs.fld_flag = r->fld_flag;
+      p_Vid->prev_cs.intras = r->intras;
       p_Vid->prev_cs.direct_mode = 0;
-      p_Vid->prev_cs.num_ref_idx_l0_active = p_Vid->num_ref_idx_l0_active;
-      p_Vid->prev_cs.num_ref_idx_l1_active = p_Vid->num_ref_idx_l1_active;
-      p_Vid->prev_cs.rd_pass = p_Vid->rd_pass;
-      p_Vid->prev_cs.nal_reference_idc = p_Vid->nal_reference_idc;
+      p_Vid->prev_cs.num_ref_idx_l0_active = r->num_ref_idx_l0_active;
+      p_Vid->prev_cs.num_ref_idx_l1_active = r->num_ref_idx_l1_active;
+      p_Vid->prev_cs.rd_pass = r->rd_pass;
+      p_Vid->prev_cs.nal_reference_idc = r->nal_reference_idc;
     }
-    else if ( p_Vid->fld_flag && p_Vid->view_id == 1 )
+    else if ( r->fld_flag && r->view_id == 1 )
     {
       printf ("%05d(%3s)  %1d  %8d   %2d %7.3f %7.3f %7.3f %9d %7d    %3s    %d\n",
         p_Vid->prev_cs.frm_no_in_file, p_Vid->prev_cs.pic_type, p_Vid->prev_cs.view_id,
@@ -2336,48 +2540,55 @@ static void ReportSimple(VideoParameters *p_Vid, char *pic_type, int cur_bits, D
         p_Vid->prev_cs.fld_flag ? "FLD" : "FRM", 
         p_Vid->prev_cs.nal_reference_idc);
       printf ("%05d(%3s)  %1d  %8d   %2d %7.3f %7.3f %7.3f %9d %7d    %3s    %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, 
+        r->frm_no_in_file, pic_type, r->view_id, 
         (int)(p_Vid->p_Stats->bit_ctr_v[1] - p_Vid->p_Stats->bit_ctr_n_v[1]) + (int)(p_Vid->p_Stats->bit_ctr_filler_data_v[1] - p_Vid->p_Stats->bit_ctr_filler_data_n_v[1]), 
-        p_Vid->AverageFrameQP,
+        r->AverageFrameQP,
         metric->value[0], metric->value[1], metric->value[2], 
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", 
-        p_Vid->nal_reference_idc);      
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", 
+        r->nal_reference_idc);      
     }
     else
     {
       printf ("%05d(%3s)  %1d  %8d   %2d %7.3f %7.3f %7.3f %9d %7d    %3s    %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, cur_bits, 
-        p_Vid->AverageFrameQP,
+        r->frm_no_in_file, pic_type, r->view_id, cur_bits, 
+        r->AverageFrameQP,
         metric->value[0], metric->value[1], metric->value[2], 
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", 
-        p_Vid->nal_reference_idc);
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", 
+        r->nal_reference_idc);
     }
   }
   else
 #endif
   printf ("%05d(%3s)%8d   %2d %7.3f %7.3f %7.3f %9d %7d    %3s    %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, 
-    p_Vid->AverageFrameQP,
+    r->frm_no_in_file, pic_type, cur_bits, 
+    r->AverageFrameQP,
     metric->value[0], metric->value[1], metric->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", 
-    p_Vid->nal_reference_idc);
+    tmp_time, (int) r->me_time,
+    r->fld_flag ? "FLD" : "FRM", 
+    r->nal_reference_idc);
 }
 
-static void ReportVerbose(VideoParameters *p_Vid, char *pic_type, int cur_bits, int wp_method, int lambda, DistMetric *mPSNR, int tmp_time, int direct_mode)
+static void ReportVerbose(VideoParameters *p_Vid, FrameReport *r, DistMetric *mPSNR)
 {
+  char *pic_type   = r->pic_type;
+  int  cur_bits    = r->cur_bits;
+  int  wp_method   = r->wp_method;
+  int  lambda      = r->lambda;
+  int  tmp_time    = r->tmp_time;
+  int  direct_mode = r->direct_mode;
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Vid->p_Inp->num_of_views == 2 )
   {
-    if ( p_Vid->fld_flag && p_Vid->view_id == 0 )
+    if ( r->fld_flag && r->view_id == 0 )
     {
-      p_Vid->prev_cs.frm_no_in_file = p_Vid->frm_no_in_file;
-      p_Vid->prev_cs.view_id = p_Vid->view_id;
+      p_Vid->prev_cs.frm_no_in_file = r->frm_no_in_file;
+      p_Vid->prev_cs.view_id = r->view_id;
       p_Vid->prev_cs.cur_bits = cur_bits;
       strcpy( p_Vid->prev_cs.pic_type, pic_type );
-      p_Vid->prev_cs.AverageFrameQP = p_Vid->AverageFrameQP;
+      p_Vid->prev_cs.AverageFrameQP = r->AverageFrameQP;
       p_Vid->prev_cs.lambda = 0;
       p_Vid->prev_cs.psnr_value[0] = mPSNR->value[0];
       p_Vid->prev_cs.psnr_value[1] = mPSNR->value[1];
@@ -2386,16 +2597,16 @@ static void ReportVerbose(VideoParameters *p_Vid, char *pic_type, int cur_bits,
       p_Vid->prev_cs.ssim_value[1] = 0;
       p_Vid->prev_cs.ssim_value[2] = 0;
       p_Vid->prev_cs.tmp_time = tmp_time;
-      p_Vid->prev_cs.me_time = (int)p_Vid->me_time;
-      p_Vid->prev_cs.fld_flag = p_Vid->fld_flag;
-      p_Vid->prev_cs.intras = p_Vid->intras;
+      p_Vid->prev_cs.me_time = (int)r->me_time;
+      p_Vid->prev_cs.fld_flag = r->fld_flag;
+      p_Vid->prev_cs.intras = r->intras;
       p_Vid->prev_cs.direct_mode = direct_mode;
-      p_Vid->prev_cs.num_ref_idx_l0_active = p_Vid->num_ref_idx_l0_active;
-      p_Vid->prev_cs.num_ref_idx_l1_active = p_Vid->num_ref_idx_l1_active;
-      p_Vid->prev_cs.rd_pass = p_Vid->rd_pass;
-      p_Vid->prev_cs.nal_reference_idc = p_Vid->nal_reference_idc;
+      p_Vid->prev_cs.num_ref_idx_l0_active = r->num_ref_idx_l0_active;
+      p_Vid->prev_cs.num_ref_idx_l1_active = r->num_ref_idx_l1_active;
+      p_Vid->prev_cs.rd_pass = r->rd_pass;
+      p_Vid->prev_cs.nal_reference_idc = r->nal_reference_idc;
     }
-    else if ( p_Vid->fld_flag && p_Vid->view_id == 1 )
+    else if ( r->fld_flag && r->view_id == 1 )
     {
       printf ("%05d(%3s)  %1d  %8d %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
         p_Vid->prev_cs.frm_no_in_file, p_Vid->prev_cs.pic_type, p_Vid->prev_cs.view_id,
@@ -2406,50 +2617,58 @@ static void ReportVerbose(VideoParameters *p_Vid, char *pic_type, int cur_bits,
         p_Vid->prev_cs.fld_flag ? "FLD" : "FRM", p_Vid->prev_cs.intras, p_Vid->prev_cs.direct_mode,
         p_Vid->prev_cs.num_ref_idx_l0_active, p_Vid->prev_cs.num_ref_idx_l1_active, p_Vid->prev_cs.rd_pass, p_Vid->prev_cs.nal_reference_idc);
       printf ("%05d(%3s)  %1d  %8d %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, 
+        r->frm_no_in_file, pic_type, r->view_id, 
         (int)(p_Vid->p_Stats->bit_ctr_v[1] - p_Vid->p_Stats->bit_ctr_n_v[1]) + (int)(p_Vid->p_Stats->bit_ctr_filler_data_v[1] - p_Vid->p_Stats->bit_ctr_filler_data_n_v[1]), wp_method,
-        p_Vid->AverageFrameQP, lambda, 
+        r->AverageFrameQP, lambda, 
         mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-        p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+        r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
     }
     else
     {
       printf ("%05d(%3s)  %1d  %8d %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, cur_bits, wp_method,
-        p_Vid->AverageFrameQP, lambda, 
+        r->frm_no_in_file, pic_type, r->view_id, cur_bits, wp_method,
+        r->AverageFrameQP, lambda, 
         mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-        p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+        r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
     }
   }
   else
 #endif
   {
   printf ("%05d(%3s)%8d %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, pic_type, cur_bits, wp_method,
+    r->AverageFrameQP, lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    tmp_time, (int) r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
   }
 }
 
-static void ReportVerboseNVB(VideoParameters *p_Vid, char *pic_type, int cur_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, int tmp_time, int direct_mode)
+static void ReportVerboseNVB(VideoParameters *p_Vid, FrameReport *r, DistMetric *mPSNR)
 {
+  char *pic_type   = r->pic_type;
+  int  cur_bits    = r->cur_bits + r->nvb_bits;
+  int  nvb_bits    = r->nvb_bits;
+  int  wp_method   = r->wp_method;
+  int  lambda      = r->lambda;
+  int  tmp_time    = r->tmp_time;
+  int  direct_mode = r->direct_mode;
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Vid->num_of_layers == 2 )
   {
-    if ( p_Vid->fld_flag && p_Vid->view_id == 0 )
+    if ( r->fld_flag && r->view_id == 0 )
     {
-      p_Vid->prev_cs.frm_no_in_file = p_Vid->frm_no_in_file;
-      p_Vid->prev_cs.view_id = p_Vid->view_id;
+      p_Vid->prev_cs.frm_no_in_file = r->frm_no_in_file;
+      p_Vid->prev_cs.view_id = r->view_id;
       p_Vid->prev_cs.cur_bits = cur_bits;
       strcpy( p_Vid->prev_cs.pic_type, pic_type );
-      p_Vid->prev_cs.AverageFrameQP = p_Vid->AverageFrameQP;
+      p_Vid->prev_cs.AverageFrameQP = r->AverageFrameQP;
       p_Vid->prev_cs.lambda = 0;
       p_Vid->prev_cs.psnr_value[0] = mPSNR->value[0];
       p_Vid->prev_cs.psnr_value[1] = mPSNR->value[1];
@@ -2458,16 +2677,16 @@ static void ReportVerboseNVB(VideoParameters *p_Vid, char *pic_type, int cur_bit
       p_Vid->prev_cs.ssim_value[1] = 0;
       p_Vid->prev_cs.ssim_value[2] = 0;
       p_Vid->prev_cs.tmp_time = tmp_time;
-      p_Vid->prev_cs.me_time = (int)p_Vid->me_time;
-      p_Vid->prev_cs.fld_flag = p_Vid->fld_flag;
-      p_Vid->prev_cs.intras = p_Vid->intras;
+      p_Vid->prev_cs.me_time = (int)r->me_time;
+      p_Vid->prev_cs.fld_flag = r->fld_flag;
+      p_Vid->prev_cs.intras = r->intras;
       p_Vid->prev_cs.direct_mode = direct_mode;
-      p_Vid->prev_cs.num_ref_idx_l0_active = p_Vid->num_ref_idx_l0_active;
-      p_Vid->prev_cs.num_ref_idx_l1_active = p_Vid->num_ref_idx_l1_active;
-      p_Vid->prev_cs.rd_pass = p_Vid->rd_pass;
-      p_Vid->prev_cs.nal_reference_idc = p_Vid->nal_reference_idc;
+      p_Vid->prev_cs.num_ref_idx_l0_active = r->num_ref_idx_l0_active;
+      p_Vid->prev_cs.num_ref_idx_l1_active = r->num_ref_idx_l1_active;
+      p_Vid->prev_cs.rd_pass = r->rd_pass;
+      p_Vid->prev_cs.nal_reference_idc = r->nal_reference_idc;
     }
-    else if ( p_Vid->fld_flag && p_Vid->view_id == 1 )
+    else if ( r->fld_flag && r->view_id == 1 )
     {
       printf ("%05d(%3s)  %1d  %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
         p_Vid->prev_cs.frm_no_in_file, p_Vid->prev_cs.pic_type, p_Vid->prev_cs.view_id,
@@ -2479,53 +2698,62 @@ static void ReportVerboseNVB(VideoParameters *p_Vid, char *pic_type, int cur_bit
         p_Vid->prev_cs.fld_flag ? "FLD" : "FRM", p_Vid->prev_cs.intras, p_Vid->prev_cs.direct_mode,
         p_Vid->prev_cs.num_ref_idx_l0_active, p_Vid->prev_cs.num_ref_idx_l1_active, p_Vid->prev_cs.rd_pass, p_Vid->prev_cs.nal_reference_idc);
       printf ("%05d(%3s)  %1d  %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, 
+        r->frm_no_in_file, pic_type, r->view_id, 
         (int)(p_Vid->p_Stats->bit_ctr_v[1] - p_Vid->p_Stats->bit_ctr_n_v[1]) 
         + (int)(p_Vid->p_Stats->bit_ctr_filler_data_v[1] - p_Vid->p_Stats->bit_ctr_filler_data_n_v[1]) + p_Vid->p_Stats->bit_ctr_parametersets_n_v[1], 
         p_Vid->p_Stats->bit_ctr_parametersets_n_v[1], wp_method,
-        p_Vid->AverageFrameQP, lambda, 
+        r->AverageFrameQP, lambda, 
         mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-        p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+        r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
     }
     else
     {
       printf ("%05d(%3s)  %1d  %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d  %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, cur_bits, nvb_bits, wp_method,
-        p_Vid->AverageFrameQP, lambda, 
+        r->frm_no_in_file, pic_type, r->view_id, cur_bits, nvb_bits, wp_method,
+        r->AverageFrameQP, lambda, 
         mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-        p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc, p_Vid->iInterViewMBs);
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+        r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc, p_Vid->iInterViewMBs);
     }
   }
   else
 #endif
   {
     printf ("%05d(%3s)%8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-      p_Vid->frm_no_in_file, pic_type, cur_bits, nvb_bits, wp_method,
-      p_Vid->AverageFrameQP, lambda, 
+      r->frm_no_in_file, pic_type, cur_bits, nvb_bits, wp_method,
+      r->AverageFrameQP, lambda, 
       mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-      tmp_time, (int) p_Vid->me_time,
-      p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-      p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+      tmp_time, (int) r->me_time,
+      r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+      r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
 
   }
 }
 
-static void ReportVerboseFDN(VideoParameters *p_Vid, char *pic_type, int cur_bits, int fdn_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, int tmp_time, int direct_mode)
+static void ReportVerboseFDN(VideoParameters *p_Vid, FrameReport *r, DistMetric *mPSNR)
 {
+  char *pic_type   = r->pic_type;
+  int  cur_bits    = r->cur_bits + r->nvb_bits;
+  int  fdn_bits    = r->fdn_bits;
+  int  nvb_bits    = r->nvb_bits;
+  int  wp_method   = r->wp_method;
+  int  lambda      = r->lambda;
+  int  tmp_time    = r->tmp_time;
+  int  direct_mode = r->direct_mode;
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Vid->p_Inp->num_of_views == 2 )
   {
-    if ( p_Vid->fld_flag && p_Vid->view_id == 0 )
+    if ( r->fld_flag && r->view_id == 0 )
     {
-      p_Vid->prev_cs.frm_no_in_file = p_Vid->frm_no_in_file;
-      p_Vid->prev_cs.view_id = p_Vid->view_id;
+      p_Vid->prev_cs.frm_no_in_file = r->frm_no_in_file;
+      p_Vid->prev_cs.view_id = r->view_id;
       p_Vid->prev_cs.cur_bits = cur_bits;
       strcpy( p_Vid->prev_cs.pic_type, pic_type );
-      p_Vid->prev_cs.AverageFrameQP = p_Vid->AverageFrameQP;
+      p_Vid->prev_cs.AverageFrameQP = r->AverageFrameQP;
       p_Vid->prev_cs.lambda = 0;
       p_Vid->prev_cs.psnr_value[0] = mPSNR->value[0];
       p_Vid->prev_cs.psnr_value[1] = mPSNR->value[1];
@@ -2534,16 +2762,16 @@ static void ReportVerboseFDN(VideoParameters *p_Vid, char *pic_type, int cur_bit
       p_Vid->prev_cs.ssim_value[1] = 0;
       p_Vid->prev_cs.ssim_value[2] = 0;
       p_Vid->prev_cs.tmp_time = tmp_time;
-      p_Vid->prev_cs.me_time = (int)p_Vid->me_time;
-      p_Vid->prev_cs.fld_flag = p_Vid->fld_flag;
-      p_Vid->prev_cs.intras = p_Vid->intras;
+      p_Vid->prev_cs.me_time = (int)r->me_time;
+      p_Vid->prev_cs.fld_flag = r->fld_flag;
+      p_Vid->prev_cs.intras = r->intras;
       p_Vid->prev_cs.direct_mode = direct_mode;
-      p_Vid->prev_cs.num_ref_idx_l0_active = p_Vid->num_ref_idx_l0_active;
-      p_Vid->prev_cs.num_ref_idx_l1_active = p_Vid->num_ref_idx_l1_active;
-      p_Vid->prev_cs.rd_pass = p_Vid->rd_pass;
-      p_Vid->prev_cs.nal_reference_idc = p_Vid->nal_reference_idc;
+      p_Vid->prev_cs.num_ref_idx_l0_active = r->num_ref_idx_l0_active;
+      p_Vid->prev_cs.num_ref_idx_l1_active = r->num_ref_idx_l1_active;
+      p_Vid->prev_cs.rd_pass = r->rd_pass;
+      p_Vid->prev_cs.nal_reference_idc = r->nal_reference_idc;
     }
-    else if ( p_Vid->fld_flag && p_Vid->view_id == 1 )
+    else if ( r->fld_flag && r->view_id == 1 )
     {
       printf ("%05d(%3s)  %1d  %8d %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
         p_Vid->prev_cs.frm_no_in_file, p_Vid->prev_cs.pic_type, p_Vid->prev_cs.view_id,
@@ -2557,183 +2785,257 @@ static void ReportVerboseFDN(VideoParameters *p_Vid, char *pic_type, int cur_bit
         p_Vid->prev_cs.fld_flag ? "FLD" : "FRM", p_Vid->prev_cs.intras, p_Vid->prev_cs.direct_mode,
         p_Vid->prev_cs.num_ref_idx_l0_active, p_Vid->prev_cs.num_ref_idx_l1_active, p_Vid->prev_cs.rd_pass, p_Vid->prev_cs.nal_reference_idc);
       printf ("%05d(%3s)  %1d  %8d %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, 
+        r->frm_no_in_file, pic_type, r->view_id, 
         (int)(p_Vid->p_Stats->bit_ctr_v[1] - p_Vid->p_Stats->bit_ctr_n_v[1]) 
         + (int)(p_Vid->p_Stats->bit_ctr_filler_data_v[1] - p_Vid->p_Stats->bit_ctr_filler_data_n_v[1]) + p_Vid->p_Stats->bit_ctr_parametersets_n_v[1], 
         (int)(p_Vid->p_Stats->bit_ctr_filler_data_v[1] - p_Vid->p_Stats->bit_ctr_filler_data_n_v[1]), 
         p_Vid->p_Stats->bit_ctr_parametersets_n_v[1], 
         wp_method,
-        p_Vid->AverageFrameQP, lambda, 
+        r->AverageFrameQP, lambda, 
         mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-        p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+        r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
     }
     else
     {
       printf ("%05d(%3s)  %1d  %8d %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-        p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, cur_bits, fdn_bits, nvb_bits, wp_method,
-        p_Vid->AverageFrameQP, lambda, 
+        r->frm_no_in_file, pic_type, r->view_id, cur_bits, fdn_bits, nvb_bits, wp_method,
+        r->AverageFrameQP, lambda, 
         mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-        tmp_time, (int) p_Vid->me_time,
-        p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-        p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+        tmp_time, (int) r->me_time,
+        r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+        r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
     }
   }
   else
 #endif
   {
   printf ("%05d(%3s)%8d %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, fdn_bits, nvb_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, pic_type, cur_bits, fdn_bits, nvb_bits, wp_method,
+    r->AverageFrameQP, lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    tmp_time, (int) r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
   }
 }
 
-static void ReportVerboseSSIM(VideoParameters *p_Vid, char *pic_type, int cur_bits, int wp_method, int lambda, DistMetric *mPSNR, DistMetric *mSSIM,int tmp_time, int direct_mode)
+static void ReportVerboseSSIM(VideoParameters *p_Vid, FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM)
 {
+  char *pic_type   = r->pic_type;
+  int  cur_bits    = r->cur_bits;
+  int  wp_method   = r->wp_method;
+  int  lambda      = r->lambda;
+  int  tmp_time    = r->tmp_time;
+  int  direct_mode = r->direct_mode;
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Vid->p_Inp->num_of_views == 2 )
   {
     printf ("%05d(%3s)  %1d  %8d %1d %2d %4d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-      p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, cur_bits, wp_method,
-      p_Vid->AverageFrameQP, lambda, 
+      r->frm_no_in_file, pic_type, r->view_id, cur_bits, wp_method,
+      r->AverageFrameQP, lambda, 
       mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
       mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-      tmp_time, (int) p_Vid->me_time,
-      p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-      p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active,p_Vid->rd_pass, p_Vid->nal_reference_idc);
+      tmp_time, (int) r->me_time,
+      r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+      r->num_ref_idx_l0_active, r->num_ref_idx_l1_active,r->rd_pass, r->nal_reference_idc);
   }
   else
 #endif
   {
   printf ("%05d(%3s)%8d %1d %2d %4d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, pic_type, cur_bits, wp_method,
+    r->AverageFrameQP, lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
     mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active,p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    tmp_time, (int) r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active,r->rd_pass, r->nal_reference_idc);
   }
 }
 
-static void ReportVerboseNVBSSIM(VideoParameters *p_Vid, char *pic_type, int cur_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, DistMetric *mSSIM,int tmp_time, int direct_mode)
+static void ReportVerboseNVBSSIM(VideoParameters *p_Vid, FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM)
 {
+  char *pic_type   = r->pic_type;
+  int  cur_bits    = r->cur_bits + r->nvb_bits;
+  int  nvb_bits    = r->nvb_bits;
+  int  wp_method   = r->wp_method;
+  int  lambda      = r->lambda;
+  int  tmp_time    = r->tmp_time;
+  int  direct_mode = r->direct_mode;
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Vid->p_Inp->num_of_views == 2 )
   {
     printf ("%05d(%3s)  %1d  %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-      p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, cur_bits, nvb_bits, wp_method,
-      p_Vid->AverageFrameQP, lambda, 
+      r->frm_no_in_file, pic_type, r->view_id, cur_bits, nvb_bits, wp_method,
+      r->AverageFrameQP, lambda, 
       mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
       mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-      tmp_time, (int) p_Vid->me_time,
-      p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-      p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+      tmp_time, (int) r->me_time,
+      r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+      r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
   }
   else
 #endif
   {
   printf ("%05d(%3s)%8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, nvb_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, pic_type, cur_bits, nvb_bits, wp_method,
+    r->AverageFrameQP, lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
     mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    tmp_time, (int) r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
   }
 }
 
-static void ReportVerboseFDNSSIM(VideoParameters *p_Vid, char *pic_type, int cur_bits, int fdn_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, DistMetric *mSSIM,int tmp_time, int direct_mode)
+static void ReportVerboseFDNSSIM(VideoParameters *p_Vid, FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM)
 {
+  char *pic_type   = r->pic_type;
+  int  cur_bits    = r->cur_bits + r->nvb_bits;
+  int  fdn_bits    = r->fdn_bits;
+  int  nvb_bits    = r->nvb_bits;
+  int  wp_method   = r->wp_method;
+  int  lambda      = r->lambda;
+  int  tmp_time    = r->tmp_time;
+  int  direct_mode = r->direct_mode;
+
 #if (MVC_EXTENSION_ENABLE)
   if ( p_Vid->p_Inp->num_of_views == 2 )
   {
     printf ("%05d(%3s)  %1d  %8d %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-      p_Vid->frm_no_in_file, pic_type, p_Vid->view_id, cur_bits, fdn_bits, nvb_bits, wp_method,
-      p_Vid->AverageFrameQP, lambda, 
+      r->frm_no_in_file, pic_type, r->view_id, cur_bits, fdn_bits, nvb_bits, wp_method,
+      r->AverageFrameQP, lambda, 
       mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
       mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-      tmp_time, (int) p_Vid->me_time,
-      p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-      p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+      tmp_time, (int) r->me_time,
+      r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+      r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
   }
   else
 #endif
   {
   printf ("%05d(%3s)%8d %8d %3d  %1d %2d %4d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, fdn_bits, nvb_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, pic_type, cur_bits, fdn_bits, nvb_bits, wp_method,
+    r->AverageFrameQP, lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
     mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    tmp_time, (int) r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
   }
 }
 
 
-static void ReportNALNonVLCBits(VideoParameters *p_Vid, int64 tmp_time)
+static void ReportNALNonVLCBits(VideoParameters *p_Vid, FrameReport *r)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
-  StatParameters *p_Stats = p_Vid->p_Stats;
 
   //! Need to add type (i.e. SPS, PPS, SEI etc).
 #if (MVC_EXTENSION_ENABLE)
   if (p_Inp->num_of_views == 2)
   {
     if (p_Inp->Verbose != 0)
-      printf ("%05d(NVB)     %8d \n", p_Vid->frame_no, p_Stats->bit_ctr_parametersets_n);
+      printf ("%05d(NVB)     %8d \n", r->frame_no, r->nvb_bits);
   }
   else
 #endif
   {
     if (p_Inp->Verbose != 0)
-      printf ("%05d(NVB)%8d \n", p_Vid->frame_no, p_Stats->bit_ctr_parametersets_n);
+      printf ("%05d(NVB)%8d \n", r->frame_no, r->nvb_bits);
   }
 }
 
-static void ReportFirstframe(VideoParameters *p_Vid, int64 tmp_time)
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints the report line(s) of a coded picture with its quality
+ *    metrics
+ ************************************************************************
+ */
+void print_frame_report(VideoParameters *p_Vid, FrameReport *r, DistMetric *metric)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
-  StatParameters *stats = p_Vid->p_Stats;
 
-  int cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
+  if (r->nvb_line)
+    ReportNALNonVLCBits(p_Vid, r);
 
   if (p_Inp->Verbose == 1)
   {
-    ReportSimple(p_Vid, "IDR", cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
+    ReportSimple(p_Vid, r, &metric[PSNR]);
   }
   else if (p_Inp->Verbose == 2)
   {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
     if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseSSIM(p_Vid, "IDR", cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
+      ReportVerboseSSIM(p_Vid, r, &metric[PSNR], &metric[SSIM]);
     else
-      ReportVerbose(p_Vid, "IDR", cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
+      ReportVerbose(p_Vid, r, &metric[PSNR]);
   }
   else if (p_Inp->Verbose == 3)
   {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
     if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseNVBSSIM(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
+      ReportVerboseNVBSSIM(p_Vid, r, &metric[PSNR], &metric[SSIM]);
     else
-      ReportVerboseNVB(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
+      ReportVerboseNVB(p_Vid, r, &metric[PSNR]);
   }
   else if (p_Inp->Verbose == 4)
   {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
     if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseFDNSSIM(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
+      ReportVerboseFDNSSIM(p_Vid, r, &metric[PSNR], &metric[SSIM]);
     else
-      ReportVerboseFDN(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
+      ReportVerboseFDN(p_Vid, r, &metric[PSNR]);
   }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Captures the coding state printed in the report line of the
+ *    current picture
+ ************************************************************************
+ */
+static void get_frame_report(VideoParameters *p_Vid, FrameReport *r, int64 tmp_time)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  StatParameters *stats = p_Vid->p_Stats;
+
+  r->nvb_line              = (stats->bit_ctr_parametersets_n != 0 && p_Inp->Verbose != 3);
+  r->frame_no              = p_Vid->frame_no;
+  r->frm_no_in_file        = p_Vid->frm_no_in_file;
+  r->view_id               = p_Vid->view_id;
+  r->AverageFrameQP        = p_Vid->AverageFrameQP;
+  r->tmp_time              = (int) tmp_time;
+  r->me_time               = (int) p_Vid->me_time;
+  r->fld_flag              = p_Vid->fld_flag;
+  r->intras                = p_Vid->intras;
+  r->num_ref_idx_l0_active = p_Vid->num_ref_idx_l0_active;
+  r->num_ref_idx_l1_active = p_Vid->num_ref_idx_l1_active;
+  r->rd_pass               = p_Vid->rd_pass;
+  r->nal_reference_idc     = p_Vid->nal_reference_idc;
+  r->wp_method             = 0;
+  r->direct_mode           = 0;
+}
+
+//! Bits of the current picture
+static void get_report_bits(StatParameters *stats, FrameReport *r)
+{
+  r->cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
+    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
+  r->fdn_bits = (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
+  r->nvb_bits = stats->bit_ctr_parametersets_n;
+}
+
+static void ReportFirstframe(VideoParameters *p_Vid, FrameReport *r)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  StatParameters *stats = p_Vid->p_Stats;
+
+  get_report_bits(stats, r);
+  strcpy(r->pic_type, "IDR");
+  r->lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
 
   stats->bit_counter[I_SLICE] = stats->bit_ctr;
 #if (MVC_EXTENSION_ENABLE)
@@ -2750,150 +3052,49 @@ static void ReportFirstframe(VideoParameters *p_Vid, int64 tmp_time)
   stats->bit_ctr = 0;
 }
 
-static void ReportI(VideoParameters *p_Vid, int64 tmp_time)
+static void ReportI(VideoParameters *p_Vid, FrameReport *r)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
-  StatParameters *stats = p_Vid->p_Stats;
-  char pic_type[4];
-  int  cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
 
+  get_report_bits(p_Vid->p_Stats, r);
   if ((p_Inp->redundant_pic_flag == 0) || !p_Vid->redundant_coding )
   {
     if (p_Vid->currentPicture->idr_flag == TRUE)
-      strcpy(pic_type,"IDR");
+      strcpy(r->pic_type,"IDR");
     else if ( p_Vid->type == SI_SLICE )
-      strcpy(pic_type,"SI ");
+      strcpy(r->pic_type,"SI ");
     else
-      strcpy(pic_type," I ");
+      strcpy(r->pic_type," I ");
   }
   else
-    strcpy(pic_type,"R");
+    strcpy(r->pic_type,"R");
 
-  if (p_Inp->Verbose == 1)
-  {
-    ReportSimple(p_Vid, pic_type, cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
-  }
-  else if (p_Inp->Verbose == 2)
-  {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
-    if (p_Inp->Distortion[SSIM] == 1)
-    {
-      ReportVerboseSSIM(p_Vid, pic_type, cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    }
-    else
-    {
-      ReportVerbose(p_Vid, pic_type, cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-    }
-  }
-  else if (p_Inp->Verbose == 3)
-  {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
-    if (p_Inp->Distortion[SSIM] == 1)
-    {
-      ReportVerboseNVBSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    }
-    else
-    {
-      ReportVerboseNVB(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-    }
-  }
-  else if (p_Inp->Verbose == 4)
-  {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
-    if (p_Inp->Distortion[SSIM] == 1)
-    {
-      ReportVerboseFDNSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    }
-    else
-    {
-      ReportVerboseFDN(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-    }
-  }
+  r->lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->masterQP][F_PEL];
 }
 
-static void ReportB(VideoParameters *p_Vid, int64 tmp_time)
+static void ReportB(VideoParameters *p_Vid, FrameReport *r)
 {
-  InputParameters *p_Inp = p_Vid->p_Inp;
-  StatParameters *stats = p_Vid->p_Stats;
-
-  int cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
-
-  if (p_Inp->Verbose == 1)
-  {
-    ReportSimple(p_Vid, " B ", cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
-  }
-  else if (p_Inp->Verbose == 2)
-  {
-    int lambda = (int) p_Vid->lambda_me[B_SLICE][p_Vid->masterQP][F_PEL];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseSSIM(p_Vid, " B ", cur_bits, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-    else
-      ReportVerbose(p_Vid, " B ", cur_bits, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-  }
-  else if (p_Inp->Verbose == 3)
-  {
-    int lambda = (int) p_Vid->lambda_me[B_SLICE][p_Vid->masterQP][F_PEL];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseNVBSSIM(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-    else
-      ReportVerboseNVB(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-  }
-  else if (p_Inp->Verbose == 4)
-  {
-    int lambda = (int) p_Vid->lambda_me[B_SLICE][p_Vid->masterQP][F_PEL];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseFDNSSIM(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-    else
-      ReportVerboseFDN(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-  }
+  get_report_bits(p_Vid->p_Stats, r);
+  strcpy(r->pic_type, " B ");
+  r->lambda      = (int) p_Vid->lambda_me[B_SLICE][p_Vid->masterQP][F_PEL];
+  r->wp_method   = p_Vid->active_pps->weighted_bipred_idc;
+  r->direct_mode = p_Vid->direct_spatial_mv_pred_flag;
 }
 
-static void ReportP(VideoParameters *p_Vid, int64 tmp_time)
+static void ReportP(VideoParameters *p_Vid, FrameReport *r)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
-  StatParameters *stats = p_Vid->p_Stats;
-
-  char pic_type[4];
-  int  cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
 
+  get_report_bits(p_Vid->p_Stats, r);
   if (p_Vid->type == SP_SLICE)
-    strcpy(pic_type,"SP ");
+    strcpy(r->pic_type,"SP ");
   else if ((p_Inp->redundant_pic_flag == 0) || !p_Vid->redundant_coding )
-    strcpy(pic_type," P ");
+    strcpy(r->pic_type," P ");
   else
-    strcpy(pic_type," R ");
+    strcpy(r->pic_type," R ");
 
-  if (p_Inp->Verbose == 1)
-  {
-    ReportSimple(p_Vid, pic_type, cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
-  }
-  else if (p_Inp->Verbose == 2)
-  {
-    int lambda = (int) p_Vid->lambda_me[P_SLICE][p_Vid->masterQP][F_PEL];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseSSIM(p_Vid, pic_type, cur_bits, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    else
-      ReportVerbose(p_Vid, pic_type, cur_bits, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-  }
-  else if (p_Inp->Verbose == 3)
-  {
-    int lambda = (int) p_Vid->lambda_me[P_SLICE][p_Vid->masterQP][F_PEL];        
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseNVBSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    else
-      ReportVerboseNVB(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-  }
-  else if (p_Inp->Verbose == 4)
-  {
-    int lambda = (int) p_Vid->lambda_me[P_SLICE][p_Vid->masterQP][F_PEL];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseFDNSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    else
-      ReportVerboseFDN(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-  }
+  r->lambda    = (int) p_Vid->lambda_me[P_SLICE][p_Vid->masterQP][F_PEL];
+  r->wp_method = p_Vid->active_pps->weighted_pred_flag;
 }
 
 /*!
@@ -50,6 +50,7 @@ extern void    store_coding_info     ( VideoParameters *p_Vid, CodingInfo *codin
 extern void    store_coding_and_rc_info( VideoParameters *p_Vid, CodingInfo *coding_info );
 extern void    swap_frame_buffer     ( VideoParameters *p_Vid, int a, int b );
 extern void    frame_picture_mp_exit ( VideoParameters *p_Vid, CodingInfo *coding_info );
+extern void    print_frame_report    ( VideoParameters *p_Vid, FrameReport *r, DistMetric *metric );
 
 
 extern void GenerateImagePyramid(VideoParameters *p_Vid, int size_x, int size_y, imgpel ***pHmeImage, int offset_x, int offset_y);
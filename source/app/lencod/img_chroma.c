@@ -21,6 +21,43 @@
 #include "global.h"
 #include "image.h"
 #include "img_chroma.h"
+#include "simd.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Bilinear chroma interpolation of one line of samples
+ ************************************************************************
+ */
+static inline void chroma_bilinear_line(imgpel *wBufDst, const imgpel *wBufSrc0, const imgpel *wBufSrc1, int count, int weight00, int weight01, int weight10, int weight11)
+{
+  int i = 0;
+  int cur_value;
+
+#if defined(JM_SIMD)
+  {
+    const __m128i w00 = _mm_set1_epi32(weight00);
+    const __m128i w01 = _mm_set1_epi32(weight01);
+    const __m128i w10 = _mm_set1_epi32(weight10);
+    const __m128i w11 = _mm_set1_epi32(weight11);
+    const __m128i rnd = _mm_set1_epi32(32);
+
+    for (; i < count - 3; i += 4)
+    {
+      __m128i v0 = _mm_add_epi32(_mm_mullo_epi32(w00, simd_load_pel4(&wBufSrc0[i])), _mm_mullo_epi32(w01, simd_load_pel4(&wBufSrc0[i + 1])));
+      __m128i v1 = _mm_add_epi32(_mm_mullo_epi32(w10, simd_load_pel4(&wBufSrc1[i])), _mm_mullo_epi32(w11, simd_load_pel4(&wBufSrc1[i + 1])));
+      simd_store_pel4(&wBufDst[i], _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(v0, v1), rnd), 6));
+    }
+  }
+#endif
+
+  for (; i < count; i++)
+  {
+    cur_value  = weight00 * wBufSrc0[i    ] + weight10 * wBufSrc1[i    ];
+    cur_value += weight01 * wBufSrc0[i + 1] + weight11 * wBufSrc1[i + 1];
+    wBufDst[i] = (imgpel) rshift_rnd_sf(cur_value, 6);
+  }
+}
 
 
 static void generateChroma00( VideoParameters *p_Vid, int size_x_minus1, int size_y_minus1, imgpel **wImgDst, imgpel **imgUV)
@@ -88,7 +125,6 @@ static void generateChroma01( VideoParameters *p_Vid, int size_x_minus1, int siz
 {
   int i;//, j;
   int jpad = -p_Vid->pad_size_uv_y;
-  int cur_value;
   imgpel *wBufDst;
   imgpel *wBufSrc0;
 
@@ -100,12 +136,9 @@ static void generateChroma01( VideoParameters *p_Vid, int size_x_minus1, int siz
     *(wBufDst++) = *wBufSrc0;
   }
 
-  for (i = 0; i < size_x_minus1; i++)
-  {
-    cur_value  = weight00 * (*wBufSrc0++);
-    cur_value += weight01 * (*wBufSrc0  );
-    *(wBufDst++) = (imgpel) rshift_rnd_sf(cur_value, 6);
-  }
+  chroma_bilinear_line(wBufDst, wBufSrc0, wBufSrc0, size_x_minus1, weight00, weight01, 0, 0);
+  wBufDst  += size_x_minus1;
+  wBufSrc0 += size_x_minus1;
 
   for (i = -1; i < p_Vid->pad_size_uv_x; i++)
   {
@@ -127,12 +160,9 @@ static void generateChroma01( VideoParameters *p_Vid, int size_x_minus1, int siz
       *(wBufDst++) = *wBufSrc0;
     }
 
-    for (i = 0; i < size_x_minus1; i++)
-    {
-      cur_value  = weight00 * (*wBufSrc0++);
-      cur_value += weight01 * (*wBufSrc0  );
-      *(wBufDst++) = (imgpel) rshift_rnd_sf(cur_value, 6);
-    }
+    chroma_bilinear_line(wBufDst, wBufSrc0, wBufSrc0, size_x_minus1, weight00, weight01, 0, 0);
+    wBufDst  += size_x_minus1;
+    wBufSrc0 += size_x_minus1;
 
     for (i = -1; i < p_Vid->pad_size_uv_x; i++)
     {
@@ -195,11 +225,10 @@ static void generateChroma10(VideoParameters *p_Vid, int size_x_minus1, int size
       *(wBufDst++) = (imgpel) cur_value;
     }
 
-    for (i = 0; i < size_x_minus1; i++)
-    {
-      cur_value  = weight00 * (*wBufSrc0++) + weight10 * (*wBufSrc1++);
-      *(wBufDst++) = (imgpel) rshift_rnd_sf(cur_value, 6);
-    }
+    chroma_bilinear_line(wBufDst, wBufSrc0, wBufSrc1, size_x_minus1, weight00, 0, weight10, 0);
+    wBufDst  += size_x_minus1;
+    wBufSrc0 += size_x_minus1;
+    wBufSrc1 += size_x_minus1;
 
     cur_value = rshift_rnd_sf(weight00 * (*wBufSrc0) + weight10 * (*wBufSrc1), 6 );
     for (i = -1; i < p_Vid->pad_size_uv_x; i++)
@@ -257,12 +286,9 @@ static void generateChromaXX( VideoParameters *p_Vid, int size_x_minus1, int siz
     *(wBufDst++) = *wBufSrc0;
   }
 
-  for (i = 0; i < size_x_minus1; i++)
-  {
-    cur_value  = weight0010 * (*wBufSrc0++);
-    cur_value += weight0111 * (*wBufSrc0  );
-    *(wBufDst++) = (imgpel) rshift_rnd_sf(cur_value, 6);
-  }
+  chroma_bilinear_line(wBufDst, wBufSrc0, wBufSrc0, size_x_minus1, weight0010, weight0111, 0, 0);
+  wBufDst  += size_x_minus1;
+  wBufSrc0 += size_x_minus1;
 
   for (i = -1; i < p_Vid->pad_size_uv_x; i++)
   {
@@ -286,12 +312,10 @@ static void generateChromaXX( VideoParameters *p_Vid, int size_x_minus1, int siz
       *(wBufDst++) = (imgpel) cur_value;
     }
 
-    for (i = 0; i < size_x_minus1; i++)
-    {
-      cur_value  = weight00 * (*wBufSrc0++) + weight10 * (*wBufSrc1++);
-      cur_value += weight01 * (*wBufSrc0  ) + weight11 * (*wBufSrc1  );
-      *(wBufDst++) = (imgpel) rshift_rnd_sf(cur_value, 6);
-    }
+    chroma_bilinear_line(wBufDst, wBufSrc0, wBufSrc1, size_x_minus1, weight00, weight01, weight10, weight11);
+    wBufDst  += size_x_minus1;
+    wBufSrc0 += size_x_minus1;
+    wBufSrc1 += size_x_minus1;
 
     cur_value = rshift_rnd_sf(weight0001 * (*wBufSrc0) + weight1011 * (*wBufSrc1), 6 );
     for (i = -1; i < p_Vid->pad_size_uv_x; i++)
@@ -308,12 +332,9 @@ static void generateChromaXX( VideoParameters *p_Vid, int size_x_minus1, int siz
       *(wBufDst++) = *wBufSrc0;
     }
 
-    for (i = 0; i < size_x_minus1; i++)
-    {
-      cur_value  = weight0010 * (*wBufSrc0++);
-      cur_value += weight0111 * (*wBufSrc0  );
-      *(wBufDst++) = (imgpel) rshift_rnd_sf(cur_value, 6);
-    }
+    chroma_bilinear_line(wBufDst, wBufSrc0, wBufSrc0, size_x_minus1, weight0010, weight0111, 0, 0);
+    wBufDst  += size_x_minus1;
+    wBufSrc0 += size_x_minus1;
 
     for (i = -1; i < p_Vid->pad_size_uv_x; i++)
     {
@@ -337,7 +358,7 @@ static void generateChromaXX( VideoParameters *p_Vid, int size_x_minus1, int siz
  */
 void getSubImagesChroma( VideoParameters *p_Vid, StorablePicture *s )
 {
-  int uv, k, l, m;
+  int uv, k, l, m, n;
   int weight00, weight01, weight10, weight11;
   int subimages_y, subimages_x, subx, suby;
   int size_x_minus1, size_y_minus1;
@@ -396,42 +417,46 @@ void getSubImagesChroma( VideoParameters *p_Vid, StorablePicture *s )
     }
   }
 
-  // U or V
-  for ( uv = 0; uv < 2; uv++ )
+  // all (2 * subimages_y * subimages_x) sub-images are independent of each other
+#if defined(OPENMP)
+#pragma omp parallel for private(uv, suby, subx, k, l, m, mm, kk, weight00, weight01, weight10, weight11, curr_img, curr_img_sub)
+#endif
+  for ( n = 0; n < 2 * subimages_y * subimages_x; n++ )
   {
+    // U or V
+    uv   = n / (subimages_y * subimages_x);
+    suby = (n / subimages_x) % subimages_y;
+    subx = n % subimages_x;
+    k    = suby * mul_y;
+    l    = subx * mul_x;
+
     curr_img     = s->imgUV[uv];
     curr_img_sub = s->p_img_sub[uv + 1];
 
-    for ( suby = 0, k = 0; suby < subimages_y; suby++, k += mul_y )
+    m = (8 - k);
+    mm = m << 3;
+    kk = k << 3;
+    weight01 = m * l;
+    weight00 = mm - weight01;
+    weight11 = k * l;
+    weight10 = kk - weight11;
+
+    // Lets break things into cases
+    if (weight01 == 0 && weight10 == 0 && weight11 == 0) // integer
+    {
+      generateChroma00( p_Vid, size_x_minus1, size_y_minus1, curr_img_sub[suby][subx], curr_img);
+    }
+    else if (weight10 == 0 && weight11 == 0) // horizontal
+    {
+      generateChroma01( p_Vid, size_x_minus1, size_y_minus1, weight00, weight01, curr_img_sub[suby][subx], curr_img);
+    }
+    else if (weight01 == 0 && weight11 == 0) // vertical
+    {
+      generateChroma10( p_Vid, size_x_minus1, size_y_minus1, weight00, weight10, curr_img_sub[suby][subx], curr_img);
+    }
+    else //diagonal
     {
-      m = (8 - k);
-      mm = m << 3;
-      kk = k << 3;
-      for ( subx = 0, l = 0; subx < subimages_x; subx++, l += mul_x )
-      {
-        weight01 = m * l;
-        weight00 = mm - weight01;
-        weight11 = k * l;
-        weight10 = kk - weight11;         
-
-        // Lets break things into cases
-        if (weight01 == 0 && weight10 == 0 && weight11 == 0) // integer
-        {
-          generateChroma00( p_Vid, size_x_minus1, size_y_minus1, curr_img_sub[suby][subx], curr_img);
-        }
-        else if (weight10 == 0 && weight11 == 0) // horizontal
-        {
-           generateChroma01( p_Vid, size_x_minus1, size_y_minus1, weight00, weight01, curr_img_sub[suby][subx], curr_img);
-        }
-        else if (weight01 == 0 && weight11 == 0) // vertical
-        {
-          generateChroma10( p_Vid, size_x_minus1, size_y_minus1, weight00, weight10, curr_img_sub[suby][subx], curr_img);
-        }
-        else //diagonal
-        {
-          generateChromaXX( p_Vid, size_x_minus1, size_y_minus1, weight00, weight01, weight10, weight11, curr_img_sub[suby][subx], curr_img);
-        }          
-      }
+      generateChromaXX( p_Vid, size_x_minus1, size_y_minus1, weight00, weight01, weight10, weight11, curr_img_sub[suby][subx], curr_img);
     }
   }
 }
@@ -0,0 +1,329 @@
+/*!
+ *************************************************************************************
+ * \file img_dist_async.c
+ *
+ * \brief
+ *    Asynchronous quality metrics.
+ *
+ *    With AsyncMetrics=1 the PSNR, SSIM and MS-SSIM of a coded picture are not
+ *    computed at the end of encode_one_frame() but by a worker thread, while
+ *    the encoder moves on to the next picture. The source and reconstructed
+ *    planes are copied into a queue slot first, since both buffers are reused
+ *    (next input picture, DPB) before the worker gets to them.
+ *
+ *    The report line of a picture is printed, and the sequence averages are
+ *    updated, once its metrics are known. This happens strictly in coding
+ *    order with the frame counters captured when the picture was queued, so
+ *    the output is the same as with the metrics computed in sequence.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "enc_statistics.h"
+#include "image.h"
+#include "img_distortion.h"
+#include "img_dist_snr.h"
+#include "img_dist_ssim.h"
+#include "img_dist_ms_ssim.h"
+#include "img_dist_async.h"
+
+#if !(defined(WIN32) || defined(WIN64))
+#define METRIC_THREAD
+#include <pthread.h>
+#endif
+
+//! Picture waiting for its metrics and report
+typedef struct metric_job
+{
+  ImageStructure ref;                        //!< copy of the source picture
+  ImageStructure src;                        //!< copy of the reconstructed picture
+  DistMetric     metric[TOTAL_DIST_TYPES];   //!< metrics of the picture
+  int            frame_ctr;                  //!< coded pictures, for the sequence averages
+  int            slice_type;                 //!< picture type, for the per type averages
+  int            type_ctr;                   //!< coded pictures of this type
+  FrameReport    report;                     //!< report line of the picture
+} MetricJob;
+
+typedef struct metric_engine
+{
+  VideoParameters *p_Vid;
+  MetricJob job[METRIC_QUEUE_SIZE];
+  int64     queued;       //!< pictures queued
+  int64     computed;     //!< pictures with computed metrics
+  int64     reported;     //!< pictures reported
+  int       threaded;     //!< metrics are computed by the worker thread
+#if defined(METRIC_THREAD)
+  int             stop;
+  pthread_t       thread;
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+#endif
+} MetricEngine;
+
+static void compute_job_metrics(VideoParameters *p_Vid, MetricJob *job)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+
+  find_snr_values(p_Vid, &job->ref, &job->src, &job->metric[SSE], &job->metric[PSNR]);
+  if (p_Inp->Distortion[SSIM] == 1)
+    find_ssim_values(p_Vid, p_Inp, &job->ref, &job->src, &job->metric[SSIM]);
+  if (p_Inp->Distortion[MS_SSIM] == 1)
+    find_ms_ssim_values(p_Vid, p_Inp, &job->ref, &job->src, &job->metric[MS_SSIM]);
+}
+
+#if defined(METRIC_THREAD)
+static void *metric_worker(void *arg)
+{
+  MetricEngine *p_me = (MetricEngine *) arg;
+
+  pthread_mutex_lock(&p_me->lock);
+  for (;;)
+  {
+    MetricJob *job;
+
+    while (p_me->computed == p_me->queued && !p_me->stop)
+      pthread_cond_wait(&p_me->cond, &p_me->lock);
+    if (p_me->computed == p_me->queued)
+      break;
+
+    job = &p_me->job[p_me->computed % METRIC_QUEUE_SIZE];
+    pthread_mutex_unlock(&p_me->lock);
+
+    compute_job_metrics(p_me->p_Vid, job);
+
+    pthread_mutex_lock(&p_me->lock);
+    p_me->computed++;
+    pthread_cond_broadcast(&p_me->cond);
+  }
+  pthread_mutex_unlock(&p_me->lock);
+
+  return NULL;
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Updates the averages with the metrics of a picture and prints its
+ *    report line
+ ************************************************************************
+ */
+static void report_job(VideoParameters *p_Vid, MetricJob *job)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+  int k;
+
+  for (k = 0; k < TOTAL_DIST_TYPES; ++k)
+  {
+    if (k == SSE || k == PSNR || ((k == SSIM || k == MS_SSIM) && p_Inp->Distortion[k] == 1))
+    {
+      memcpy(p_Dist->metric[k].value, job->metric[k].value, 3 * sizeof(float));
+      accumulate_average(&p_Dist->metric[k], job->frame_ctr);
+      accumulate_avslice(&p_Dist->metric[k], job->slice_type, job->type_ctr);
+    }
+  }
+
+  print_frame_report(p_Vid, &job->report, p_Dist->metric);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reports the queued pictures in coding order: pictures before
+ *    wait_until are waited for, later ones are reported only if their
+ *    metrics are already known
+ ************************************************************************
+ */
+static void report_pictures(MetricEngine *p_me, int64 wait_until)
+{
+  while (p_me->reported < p_me->queued)
+  {
+#if defined(METRIC_THREAD)
+    if (p_me->threaded)
+    {
+      pthread_mutex_lock(&p_me->lock);
+      if (p_me->reported >= wait_until && p_me->computed <= p_me->reported)
+      {
+        pthread_mutex_unlock(&p_me->lock);
+        break;
+      }
+      while (p_me->computed <= p_me->reported)
+        pthread_cond_wait(&p_me->cond, &p_me->lock);
+      pthread_mutex_unlock(&p_me->lock);
+    }
+#endif
+    report_job(p_me->p_Vid, &p_me->job[p_me->reported % METRIC_QUEUE_SIZE]);
+    p_me->reported++;
+  }
+}
+
+static void copy_planes(ImageStructure *dst, ImageStructure *src, int yuv_format)
+{
+  int k, j;
+
+  dst->format = src->format;
+  for (k = 0; k < (yuv_format != YUV400 ? 3 : 1); ++k)
+  {
+    int width  = src->format.width [k == 0 ? 0 : 1];
+    int height = src->format.height[k == 0 ? 0 : 1];
+
+    for (j = 0; j < height; ++j)
+      memcpy(dst->data[k][j], src->data[k][j], width * sizeof(imgpel));
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts the metric worker. Without threads (or if the thread cannot
+ *    be created) the metrics are computed when a picture is queued.
+ ************************************************************************
+ */
+void init_metric_engine(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  MetricEngine *p_me;
+  int i, k;
+
+  if ((p_me = (MetricEngine *) calloc(1, sizeof(MetricEngine))) == NULL)
+    no_mem_exit("init_metric_engine: p_me");
+  p_me->p_Vid = p_Vid;
+
+  for (i = 0; i < METRIC_QUEUE_SIZE; ++i)
+  {
+    MetricJob *job = &p_me->job[i];
+
+    for (k = 0; k < (p_Vid->yuv_format != YUV400 ? 3 : 1); ++k)
+    {
+      int width  = p_Inp->output.width [k == 0 ? 0 : 1];
+      int height = p_Inp->output.height[k == 0 ? 0 : 1];
+
+      get_mem2Dpel(&job->ref.data[k], height, width);
+      get_mem2Dpel(&job->src.data[k], height, width);
+    }
+  }
+
+#if defined(METRIC_THREAD)
+  pthread_mutex_init(&p_me->lock, NULL);
+  pthread_cond_init(&p_me->cond, NULL);
+  p_me->threaded = (pthread_create(&p_me->thread, NULL, metric_worker, p_me) == 0);
+#endif
+
+  p_Vid->p_Metrics = p_me;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reports the pending pictures, stops the worker and releases the
+ *    queue
+ ************************************************************************
+ */
+void free_metric_engine(VideoParameters *p_Vid)
+{
+  MetricEngine *p_me = p_Vid->p_Metrics;
+  int i, k;
+
+  if (p_me == NULL)
+    return;
+
+  flush_metrics(p_Vid);
+
+#if defined(METRIC_THREAD)
+  if (p_me->threaded)
+  {
+    pthread_mutex_lock(&p_me->lock);
+    p_me->stop = 1;
+    pthread_cond_broadcast(&p_me->cond);
+    pthread_mutex_unlock(&p_me->lock);
+    pthread_join(p_me->thread, NULL);
+  }
+  pthread_cond_destroy(&p_me->cond);
+  pthread_mutex_destroy(&p_me->lock);
+#endif
+
+  for (i = 0; i < METRIC_QUEUE_SIZE; ++i)
+  {
+    for (k = 0; k < 3; ++k)
+    {
+      if (p_me->job[i].ref.data[k] != NULL)
+        free_mem2Dpel(p_me->job[i].ref.data[k]);
+      if (p_me->job[i].src.data[k] != NULL)
+        free_mem2Dpel(p_me->job[i].src.data[k]);
+    }
+  }
+
+  free(p_me);
+  p_Vid->p_Metrics = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Queues the metrics of the current picture (called in place of
+ *    compute_distortion). If the queue is full, the oldest picture is
+ *    reported first.
+ ************************************************************************
+ */
+void queue_frame_metrics(VideoParameters *p_Vid, ImageData *imgData)
+{
+  MetricEngine *p_me = p_Vid->p_Metrics;
+  MetricJob *job;
+  ImageStructure imgSRC, imgREF;
+
+  report_pictures(p_me, p_me->queued - METRIC_QUEUE_SIZE + 1);
+
+  job = &p_me->job[p_me->queued % METRIC_QUEUE_SIZE];
+  select_img(p_Vid, &imgSRC, &imgREF, imgData);
+  copy_planes(&job->ref, &imgREF, p_Vid->yuv_format);
+  copy_planes(&job->src, &imgSRC, p_Vid->yuv_format);
+  job->frame_ctr  = p_Vid->p_Dist->frame_ctr;
+  job->slice_type = p_Vid->type;
+  job->type_ctr   = p_Vid->p_Stats->frame_ctr[p_Vid->type];
+
+#if defined(METRIC_THREAD)
+  if (p_me->threaded)
+  {
+    pthread_mutex_lock(&p_me->lock);
+    p_me->queued++;
+    pthread_cond_broadcast(&p_me->cond);
+    pthread_mutex_unlock(&p_me->lock);
+    return;
+  }
+#endif
+
+  compute_job_metrics(p_Vid, job);
+  p_me->queued++;
+  p_me->computed++;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Attaches the report line to the last queued picture and prints the
+ *    pictures whose metrics are ready
+ ************************************************************************
+ */
+void queue_frame_report(VideoParameters *p_Vid, FrameReport *r)
+{
+  MetricEngine *p_me = p_Vid->p_Metrics;
+
+  p_me->job[(p_me->queued - 1) % METRIC_QUEUE_SIZE].report = *r;
+  report_pictures(p_me, p_me->reported);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Waits for the metrics of all queued pictures and reports them
+ ************************************************************************
+ */
+void flush_metrics(VideoParameters *p_Vid)
+{
+  MetricEngine *p_me = p_Vid->p_Metrics;
+
+  if (p_me != NULL)
+    report_pictures(p_me, p_me->queued);
+}
@@ -0,0 +1,26 @@
+/*!
+ ************************************************************************
+ * \file
+ *     img_dist_async.h
+ *
+ * \brief
+ *    Quality metrics (PSNR, SSIM, MS-SSIM) of the coded pictures computed
+ *    by a background worker while the following pictures are encoded
+ ************************************************************************
+ */
+
+#ifndef _IMG_DIST_ASYNC_H_
+#define _IMG_DIST_ASYNC_H_
+
+#include "global.h"
+
+#define METRIC_QUEUE_SIZE 3   //!< pictures that can wait for their metrics
+
+extern void init_metric_engine (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void free_metric_engine (VideoParameters *p_Vid);
+extern void queue_frame_metrics(VideoParameters *p_Vid, ImageData *imgData);
+extern void queue_frame_report (VideoParameters *p_Vid, FrameReport *r);
+extern void flush_metrics      (VideoParameters *p_Vid);
+
+#endif
+
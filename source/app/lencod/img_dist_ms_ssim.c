@@ -17,6 +17,7 @@
 #include "contributors.h"
 #include "global.h"
 #include "img_distortion.h"
+#include "img_dist_ssim.h"
 #include "enc_statistics.h"
 #include "memalloc.h"
 #include "math.h"
@@ -52,33 +53,23 @@ float compute_structural_components (VideoParameters *p_Vid, InputParameters *p_
   float varOrg, varEnc, covOrgEnc;
   int imeanOrg, imeanEnc, ivarOrg, ivarEnc, icovOrgEnc;
   float cur_distortion = 0.0;
-  int i, j, n, m, win_cnt = 0;
+  int i, win_cnt = 0;
   int overlapSize = p_Inp->SSIMOverlapSize;
+  SSIMWindows win;
 
   max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
   C2 = K2 * K2 * max_pix_value_sqd;
 
-  for (j = 0; j <= height - win_height; j += overlapSize)
+  init_ssim_windows(&win, refImg, encImg, height, width, win_height, win_width, overlapSize);
+  while (next_ssim_window_row(&win))
   {
-    for (i = 0; i <= width - win_width; i += overlapSize)
+    for (i = 0; i < win.count; i++)
     {
-      imeanOrg = 0;
-      imeanEnc = 0; 
-      ivarOrg  = 0;
-      ivarEnc  = 0;
-      icovOrgEnc = 0;
-
-      for ( n = j;n < j + win_height;n ++)
-      {
-        for (m = i;m < i + win_width;m ++)
-        {
-          imeanOrg   += refImg[n][m];
-          imeanEnc   += encImg[n][m];
-          ivarOrg    += refImg[n][m] * refImg[n][m];
-          ivarEnc    += encImg[n][m] * encImg[n][m];
-          icovOrgEnc += refImg[n][m] * encImg[n][m];
-        }
-      }
+      imeanOrg   = win.sum[SSIM_SUM_REF][i];
+      imeanEnc   = win.sum[SSIM_SUM_ENC][i];
+      ivarOrg    = win.sum[SSIM_SUM_REF_SQ][i];
+      ivarEnc    = win.sum[SSIM_SUM_ENC_SQ][i];
+      icovOrgEnc = win.sum[SSIM_SUM_REF_ENC][i];
 
       meanOrg = (float) imeanOrg / win_pixels;
       meanEnc = (float) imeanEnc / win_pixels;
@@ -94,6 +85,7 @@ float compute_structural_components (VideoParameters *p_Vid, InputParameters *p_
       win_cnt++;
     }
   }
+  free_ssim_windows(&win);
 
   cur_distortion /= (float) win_cnt;
 
@@ -112,27 +104,20 @@ float compute_luminance_component (VideoParameters *p_Vid, InputParameters *p_In
   float mb_ssim, meanOrg, meanEnc;
   int imeanOrg, imeanEnc;
   float cur_distortion = 0.0;
-  int i, j, n, m, win_cnt = 0;
+  int i, win_cnt = 0;
   int overlapSize = p_Inp->SSIMOverlapSize;
+  SSIMWindows win;
 
   max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
   C1 = K1 * K1 * max_pix_value_sqd;
 
-  for (j = 0; j <= height - win_height; j += overlapSize)
+  init_ssim_windows(&win, refImg, encImg, height, width, win_height, win_width, overlapSize);
+  while (next_ssim_window_row(&win))
   {
-    for (i = 0; i <= width - win_width; i += overlapSize)
+    for (i = 0; i < win.count; i++)
     {
-      imeanOrg = 0;
-      imeanEnc = 0; 
-      
-      for ( n = j;n < j + win_height;n ++)
-      {
-        for (m = i;m < i + win_width;m ++)
-        {
-          imeanOrg   += refImg[n][m];
-          imeanEnc   += encImg[n][m];
-        }
-      }
+      imeanOrg = win.sum[SSIM_SUM_REF][i];
+      imeanEnc = win.sum[SSIM_SUM_ENC][i];
 
       meanOrg = (float) imeanOrg / win_pixels;
       meanEnc = (float) imeanEnc / win_pixels;
@@ -144,6 +129,7 @@ float compute_luminance_component (VideoParameters *p_Vid, InputParameters *p_In
       win_cnt++;
     }
   }
+  free_ssim_windows(&win);
 
   cur_distortion /= (float) win_cnt;
 
@@ -329,9 +315,8 @@ float compute_ms_ssim(VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **r
  *    Find MS-SSIM for all three components
  ************************************************************************
  */
-void find_ms_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
+void find_ms_ssim_values (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
 {
-  DistortionParams *p_Dist = p_Vid->p_Dist;
   FrameFormat *format = &ref->format;
 
   metricSSIM->value[0] = compute_ms_ssim (p_Vid, p_Inp, ref->data[0], src->data[0], format->height[0], format->width[0], BLOCK_SIZE_8x8, BLOCK_SIZE_8x8, 0);
@@ -341,7 +326,19 @@ void find_ms_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructur
     metricSSIM->value[1]  = compute_ms_ssim (p_Vid, p_Inp, ref->data[1], src->data[1], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 1);
     metricSSIM->value[2]  = compute_ms_ssim (p_Vid, p_Inp, ref->data[2], src->data[2], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 2);
   }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Find MS-SSIM for all three components and update the averages
+ ************************************************************************
+ */
+void find_ms_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
+{
+  DistortionParams *p_Dist = p_Vid->p_Dist;
 
+  find_ms_ssim_values(p_Vid, p_Inp, ref, src, metricSSIM);
   {
     accumulate_average(metricSSIM,  p_Dist->frame_ctr);
     accumulate_avslice(metricSSIM,  p_Vid->type, p_Vid->p_Stats->frame_ctr[p_Vid->type]);
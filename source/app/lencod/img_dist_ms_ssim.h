@@ -20,6 +20,7 @@
 #define _IMG_DIST_MS_SSIM_H_
 #include "img_distortion.h"
 
+extern void find_ms_ssim_values (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricMS_SSIM);
 extern void find_ms_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricMS_SSIM);
 
 #endif
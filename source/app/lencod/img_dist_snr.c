@@ -27,9 +27,8 @@
  *    Find SNR for all three components
  ************************************************************************
  */
-void find_snr(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSE, DistMetric *metricPSNR)
+void find_snr_values(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSE, DistMetric *metricPSNR)
 {
-  DistortionParams *p_Dist = p_Vid->p_Dist;
   FrameFormat *format = &imgREF->format;
   // Luma.
   metricSSE ->value[0] = (float) compute_SSE(imgREF->data[0], imgSRC->data[0], 0, 0, format->height[0], format->width[0]);
@@ -42,6 +41,22 @@ void find_snr(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *im
     metricSSE ->value[2] = (float) compute_SSE(imgREF->data[2], imgSRC->data[2], 0, 0, format->height[1], format->width[1]);
     metricPSNR->value[2] = psnr(format->max_value_sq[2], format->size_cmp[2], metricSSE->value[2]);
   }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Find PSNR for all three components and update the averages
+ ************************************************************************
+ */
+void find_snr(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSE, DistMetric *metricPSNR)
+{
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+#if (MVC_EXTENSION_ENABLE)
+  FrameFormat *format = &imgREF->format;
+#endif
+
+  find_snr_values(p_Vid, imgREF, imgSRC, metricSSE, metricPSNR);
 #if (MVC_EXTENSION_ENABLE)
   if (p_Vid->p_Inp->num_of_views == 2)
   {
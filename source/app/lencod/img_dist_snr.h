@@ -18,6 +18,7 @@
 #define _IMG_DIST_SNR_H_
 #include "img_distortion.h"
 
+extern void find_snr_values(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSE, DistMetric *metricPSNR);
 extern void find_snr(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric metricSSE[3], DistMetric metricPSNR[3]);
 
 #endif
@@ -16,10 +16,179 @@
 #include "contributors.h"
 #include "global.h"
 #include "img_distortion.h"
+#include "img_dist_ssim.h"
 #include "enc_statistics.h"
+#include "simd.h"
 
 //#define UNBIASED_VARIANCE // unbiased estimation of the variance
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Computes the integral image line k (sums over the lines above k and
+ *    the columns left of x) of all SSIM sums from line k - 1 and image
+ *    row k - 1
+ ************************************************************************
+ */
+static void ssim_integral_line(SSIMWindows *p_win, int k)
+{
+  int ring = p_win->win_height + 1;
+  imgpel *ref = p_win->ref[k - 1];
+  imgpel *enc = p_win->enc[k - 1];
+  uint32 *prev[SSIM_SUMS], *cur[SSIM_SUMS];
+  uint32 s[SSIM_SUMS] = {0};
+  int i, x = 0;
+
+  for (i = 0; i < SSIM_SUMS; ++i)
+  {
+    prev[i] = p_win->line[i][(k - 1) % ring];
+    cur[i]  = p_win->line[i][k % ring];
+    cur[i][0] = 0;
+  }
+
+#if defined(JM_SIMD)
+  {
+    __m128i carry[SSIM_SUMS], v[SSIM_SUMS];
+
+    for (i = 0; i < SSIM_SUMS; ++i)
+      carry[i] = _mm_setzero_si128();
+
+    for (; x <= p_win->width - 4; x += 4)
+    {
+      __m128i r = simd_load_pel4(&ref[x]);
+      __m128i e = simd_load_pel4(&enc[x]);
+
+      v[SSIM_SUM_REF]     = r;
+      v[SSIM_SUM_ENC]     = e;
+      v[SSIM_SUM_REF_SQ]  = _mm_mullo_epi32(r, r);
+      v[SSIM_SUM_ENC_SQ]  = _mm_mullo_epi32(e, e);
+      v[SSIM_SUM_REF_ENC] = _mm_mullo_epi32(r, e);
+
+      for (i = 0; i < SSIM_SUMS; ++i)
+      {
+        // running sum along the row, then the column sums from the line above
+        v[i] = _mm_add_epi32(v[i], _mm_slli_si128(v[i], 4));
+        v[i] = _mm_add_epi32(v[i], _mm_slli_si128(v[i], 8));
+        v[i] = _mm_add_epi32(v[i], carry[i]);
+        carry[i] = _mm_shuffle_epi32(v[i], _MM_SHUFFLE(3, 3, 3, 3));
+        _mm_storeu_si128((__m128i *) &cur[i][x + 1], _mm_add_epi32(v[i], _mm_loadu_si128((__m128i *) &prev[i][x + 1])));
+      }
+    }
+    for (i = 0; i < SSIM_SUMS; ++i)
+      s[i] = (uint32) _mm_cvtsi128_si32(carry[i]);
+  }
+#endif
+
+  for (; x < p_win->width; ++x)
+  {
+    uint32 r = ref[x], e = enc[x];
+
+    s[SSIM_SUM_REF]     += r;
+    s[SSIM_SUM_ENC]     += e;
+    s[SSIM_SUM_REF_SQ]  += r * r;
+    s[SSIM_SUM_ENC_SQ]  += e * e;
+    s[SSIM_SUM_REF_ENC] += r * e;
+    for (i = 0; i < SSIM_SUMS; ++i)
+      cur[i][x + 1] = prev[i][x + 1] + s[i];
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prepares the window sums of a reference/encoded plane pair for
+ *    windows of win_height x win_width samples placed every step
+ *    samples. Only win_height + 1 lines of the integral images are
+ *    kept.
+ ************************************************************************
+ */
+void init_ssim_windows(SSIMWindows *p_win, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int step)
+{
+  int ring = win_height + 1;
+  int i, k;
+
+  p_win->ref        = refImg;
+  p_win->enc        = encImg;
+  p_win->height     = height;
+  p_win->width      = width;
+  p_win->win_height = win_height;
+  p_win->win_width  = win_width;
+  p_win->step       = step;
+  p_win->count      = (width >= win_width) ? (width - win_width) / step + 1 : 0;
+  p_win->next_row   = 0;
+  p_win->lines      = 1;
+
+  if ((p_win->buf = (uint32 *) calloc((size_t) SSIM_SUMS * ring * (width + 4), sizeof(uint32))) == NULL)
+    no_mem_exit("init_ssim_windows: p_win->buf");
+  if ((p_win->sums = (int *) calloc((size_t) SSIM_SUMS * imax(1, p_win->count), sizeof(int))) == NULL)
+    no_mem_exit("init_ssim_windows: p_win->sums");
+
+  for (i = 0; i < SSIM_SUMS; ++i)
+  {
+    for (k = 0; k < ring; ++k)
+      p_win->line[i][k] = p_win->buf + ((size_t) i * ring + k) * (width + 4);
+    p_win->sum[i] = p_win->sums + i * imax(1, p_win->count);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Advances to the next row of windows and fills p_win->sum[] with
+ *    the sums of its p_win->count windows. Returns 0 past the last row.
+ *    The sums wrap modulo 2^32 exactly as the direct int sums would.
+ ************************************************************************
+ */
+int next_ssim_window_row(SSIMWindows *p_win)
+{
+  int ring = p_win->win_height + 1;
+  int top  = p_win->next_row;
+  int bot  = top + p_win->win_height;
+  int ww   = p_win->win_width;
+  int i, n;
+
+  if (bot > p_win->height || p_win->count == 0)
+    return 0;
+
+  while (p_win->lines <= bot)
+    ssim_integral_line(p_win, p_win->lines++);
+
+  for (i = 0; i < SSIM_SUMS; ++i)
+  {
+    uint32 *t = p_win->line[i][top % ring];
+    uint32 *b = p_win->line[i][bot % ring];
+    int *sum = p_win->sum[i];
+
+    n = 0;
+#if defined(JM_SIMD)
+    if (p_win->step == 1)
+    {
+      for (; n <= p_win->count - 4; n += 4)
+      {
+        __m128i v = _mm_sub_epi32(_mm_loadu_si128((__m128i *) &b[n + ww]), _mm_loadu_si128((__m128i *) &b[n]));
+        v = _mm_sub_epi32(v, _mm_loadu_si128((__m128i *) &t[n + ww]));
+        v = _mm_add_epi32(v, _mm_loadu_si128((__m128i *) &t[n]));
+        _mm_storeu_si128((__m128i *) &sum[n], v);
+      }
+    }
+#endif
+    for (; n < p_win->count; ++n)
+    {
+      int x = n * p_win->step;
+      sum[n] = (int) (b[x + ww] - b[x] - t[x + ww] + t[x]);
+    }
+  }
+
+  p_win->next_row += p_win->step;
+  return 1;
+}
+
+void free_ssim_windows(SSIMWindows *p_win)
+{
+  free(p_win->buf);
+  free(p_win->sums);
+}
+
 float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp)
 {
 
@@ -36,34 +205,24 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
   float varOrg, varEnc, covOrgEnc;
   int imeanOrg, imeanEnc, ivarOrg, ivarEnc, icovOrgEnc;
   float cur_distortion = 0.0;
-  int i, j, n, m, win_cnt = 0;
+  int i, win_cnt = 0;
   int overlapSize = p_Inp->SSIMOverlapSize;
+  SSIMWindows win;
 
   max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
   C1 = K1 * K1 * max_pix_value_sqd;
   C2 = K2 * K2 * max_pix_value_sqd;
 
-  for (j = 0; j <= height - win_height; j += overlapSize)
+  init_ssim_windows(&win, refImg, encImg, height, width, win_height, win_width, overlapSize);
+  while (next_ssim_window_row(&win))
   {
-    for (i = 0; i <= width - win_width; i += overlapSize)
+    for (i = 0; i < win.count; i++)
     {
-      imeanOrg = 0;
-      imeanEnc = 0; 
-      ivarOrg  = 0;
-      ivarEnc  = 0;
-      icovOrgEnc = 0;
-
-      for ( n = j;n < j + win_height;n ++)
-      {
-        for (m = i;m < i + win_width;m ++)
-        {
-          imeanOrg   += refImg[n][m];
-          imeanEnc   += encImg[n][m];
-          ivarOrg    += refImg[n][m] * refImg[n][m];
-          ivarEnc    += encImg[n][m] * encImg[n][m];
-          icovOrgEnc += refImg[n][m] * encImg[n][m];
-        }
-      }
+      imeanOrg   = win.sum[SSIM_SUM_REF][i];
+      imeanEnc   = win.sum[SSIM_SUM_ENC][i];
+      ivarOrg    = win.sum[SSIM_SUM_REF_SQ][i];
+      ivarEnc    = win.sum[SSIM_SUM_ENC_SQ][i];
+      icovOrgEnc = win.sum[SSIM_SUM_REF_ENC][i];
 
       meanOrg = (float) imeanOrg / win_pixels;
       meanEnc = (float) imeanEnc / win_pixels;
@@ -79,6 +238,7 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
       win_cnt++;
     }
   }
+  free_ssim_windows(&win);
 
   cur_distortion /= (float) win_cnt;
 
@@ -94,9 +254,8 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
  *    Find SSIM for all three components
  ************************************************************************
  */
-void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
+void find_ssim_values (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
 {
-  DistortionParams *p_Dist = p_Vid->p_Dist;
   FrameFormat *format = &ref->format;
 
   metricSSIM->value[0] = compute_ssim (p_Vid, p_Inp, ref->data[0], src->data[0], format->height[0], format->width[0], BLOCK_SIZE_8x8, BLOCK_SIZE_8x8, 0);
@@ -106,7 +265,19 @@ void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *
     metricSSIM->value[1]  = compute_ssim (p_Vid, p_Inp, ref->data[1], src->data[1], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 1);
     metricSSIM->value[2]  = compute_ssim (p_Vid, p_Inp, ref->data[2], src->data[2], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 2);
   }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Find SSIM for all three components and update the averages
+ ************************************************************************
+ */
+void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
+{
+  DistortionParams *p_Dist = p_Vid->p_Dist;
 
+  find_ssim_values(p_Vid, p_Inp, ref, src, metricSSIM);
   {
     accumulate_average(metricSSIM,  p_Dist->frame_ctr);
     accumulate_avslice(metricSSIM,  p_Vid->type, p_Vid->p_Stats->frame_ctr[p_Vid->type]);
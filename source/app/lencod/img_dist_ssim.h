@@ -20,7 +20,41 @@
 #define _IMG_DIST_SSIM_H_
 #include "img_distortion.h"
 
-extern void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric metricSSIM[3]);
+//! Sums of an SSIM window
+enum {
+  SSIM_SUM_REF = 0,     //!< reference samples
+  SSIM_SUM_ENC,         //!< encoded samples
+  SSIM_SUM_REF_SQ,      //!< squared reference samples
+  SSIM_SUM_ENC_SQ,      //!< squared encoded samples
+  SSIM_SUM_REF_ENC,     //!< products of reference and encoded samples
+  SSIM_SUMS
+};
+
+#define SSIM_MAX_WIN_HEIGHT  16   //!< largest window height (chroma windows of 4:4:4 content)
+
+//! Window sums of a reference/encoded plane pair, row of windows by row of windows
+typedef struct ssim_windows
+{
+  imgpel **ref;
+  imgpel **enc;
+  int    height, width;
+  int    win_height, win_width;
+  int    step;                                          //!< window spacing (SSIMOverlapSize)
+  int    count;                                         //!< windows per row
+  int    next_row;                                      //!< top line of the next row of windows
+  int    lines;                                         //!< integral image lines computed so far
+  uint32 *line[SSIM_SUMS][SSIM_MAX_WIN_HEIGHT + 1];     //!< ring of the last integral image lines
+  int    *sum[SSIM_SUMS];                               //!< window sums of the current row of windows
+  uint32 *buf;
+  int    *sums;
+} SSIMWindows;
+
+extern void  init_ssim_windows   (SSIMWindows *p_win, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int step);
+extern int   next_ssim_window_row(SSIMWindows *p_win);
+extern void  free_ssim_windows   (SSIMWindows *p_win);
+extern float compute_ssim        (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp);
+extern void  find_ssim_values    (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSIM);
+extern void  find_ssim           (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSIM);
 
 #endif
 
@@ -46,6 +46,7 @@
 #include "img_dist_snr.h"
 #include "img_dist_ssim.h"
 #include "img_dist_ms_ssim.h"
+#include "img_dist_async.h"
 #include "cconv_yuv2rgb.h"
 
 
@@ -187,7 +188,11 @@ void compute_distortion(VideoParameters *p_Vid, ImageData *imgData)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
   DistortionParams *p_Dist = p_Vid->p_Dist;
-  if (p_Inp->Verbose != 0)
+  if (p_Vid->p_Metrics != NULL)
+  {
+    queue_frame_metrics(p_Vid, imgData);
+  }
+  else if (p_Inp->Verbose != 0)
   {
     select_img(p_Vid, &p_Vid->imgSRC, &p_Vid->imgREF, imgData);
 
@@ -22,6 +22,7 @@
 #include "image.h"
 #include "img_luma.h"
 #include "memalloc.h"
+#include "simd.h"
 
 
 /*!
@@ -133,6 +134,180 @@ static void getSubImageInteger_s( StorablePicture *s, imgpel **dstImg, imgpel **
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Six tap filtering of one line of positions in horizontal direction.
+ *    Position i uses samples src[i-2] .. src[i+3]. Both the unclipped
+ *    intermediate value and the clipped sample are stored.
+ ************************************************************************
+ */
+static inline void six_tap_hor_line(int *iDst, imgpel *wDst, const imgpel *src, int count, int max_imgpel_value)
+{
+  const int tap0 = ONE_FOURTH_TAP[0][0];
+  const int tap1 = ONE_FOURTH_TAP[0][1];
+  const int tap2 = ONE_FOURTH_TAP[0][2];
+  int i = 0, is;
+
+#if defined(JM_SIMD)
+  {
+    const __m128i vtap0 = _mm_set1_epi32(tap0);
+    const __m128i vtap1 = _mm_set1_epi32(tap1);
+    const __m128i vtap2 = _mm_set1_epi32(tap2);
+    const __m128i vrnd  = _mm_set1_epi32(16);
+    const __m128i vmax  = _mm_set1_epi32(max_imgpel_value);
+    const __m128i vzero = _mm_setzero_si128();
+
+    for (; i < count - 3; i += 4)
+    {
+      __m128i a = _mm_add_epi32(simd_load_pel4(&src[i    ]), simd_load_pel4(&src[i + 1]));
+      __m128i b = _mm_add_epi32(simd_load_pel4(&src[i - 1]), simd_load_pel4(&src[i + 2]));
+      __m128i c = _mm_add_epi32(simd_load_pel4(&src[i - 2]), simd_load_pel4(&src[i + 3]));
+      __m128i v = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(a, vtap0), _mm_mullo_epi32(b, vtap1)), _mm_mullo_epi32(c, vtap2));
+
+      _mm_storeu_si128((__m128i *) &iDst[i], v);
+      v = _mm_srai_epi32(_mm_add_epi32(v, vrnd), 5);
+      simd_store_pel4(&wDst[i], _mm_min_epi32(_mm_max_epi32(v, vzero), vmax));
+    }
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    is =
+      (tap0 * (src[i    ] + src[i + 1]) +
+      tap1 *  (src[i - 1] + src[i + 2]) +
+      tap2 *  (src[i - 2] + src[i + 3]));
+
+    iDst[i] = is;
+    wDst[i] = (imgpel) iClip1 ( max_imgpel_value, rshift_rnd_sf( is, 5 ) );
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Six tap filtering of one line in vertical direction. The six source
+ *    lines are given in filter tap order (A/D center, B/E, C/F outer).
+ ************************************************************************
+ */
+static inline void six_tap_ver_line(imgpel *wDst, const imgpel *srcA, const imgpel *srcB, const imgpel *srcC,
+                                    const imgpel *srcD, const imgpel *srcE, const imgpel *srcF, int count, int max_imgpel_value)
+{
+  const int tap0 = ONE_FOURTH_TAP[0][0];
+  const int tap1 = ONE_FOURTH_TAP[0][1];
+  const int tap2 = ONE_FOURTH_TAP[0][2];
+  int i = 0, is;
+
+#if defined(JM_SIMD)
+  {
+    const __m128i vtap0 = _mm_set1_epi32(tap0);
+    const __m128i vtap1 = _mm_set1_epi32(tap1);
+    const __m128i vtap2 = _mm_set1_epi32(tap2);
+    const __m128i vrnd  = _mm_set1_epi32(16);
+    const __m128i vmax  = _mm_set1_epi32(max_imgpel_value);
+    const __m128i vzero = _mm_setzero_si128();
+
+    for (; i < count - 3; i += 4)
+    {
+      __m128i a = _mm_add_epi32(simd_load_pel4(&srcA[i]), simd_load_pel4(&srcD[i]));
+      __m128i b = _mm_add_epi32(simd_load_pel4(&srcB[i]), simd_load_pel4(&srcE[i]));
+      __m128i c = _mm_add_epi32(simd_load_pel4(&srcC[i]), simd_load_pel4(&srcF[i]));
+      __m128i v = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(a, vtap0), _mm_mullo_epi32(b, vtap1)), _mm_mullo_epi32(c, vtap2));
+
+      v = _mm_srai_epi32(_mm_add_epi32(v, vrnd), 5);
+      simd_store_pel4(&wDst[i], _mm_min_epi32(_mm_max_epi32(v, vzero), vmax));
+    }
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    is =
+      (tap0 * (srcA[i] + srcD[i]) +
+      tap1 *  (srcB[i] + srcE[i]) +
+      tap2 *  (srcC[i] + srcF[i]));
+
+    wDst[i] = (imgpel) iClip1 ( max_imgpel_value, rshift_rnd_sf( is, 5 ) );
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Six tap filtering of one line in vertical direction using the
+ *    unclipped horizontal intermediate values (center half-pel position)
+ ************************************************************************
+ */
+static inline void six_tap_ver_line_tmp(imgpel *wDst, const int *srcA, const int *srcB, const int *srcC,
+                                        const int *srcD, const int *srcE, const int *srcF, int count, int max_imgpel_value)
+{
+  const int tap0 = ONE_FOURTH_TAP[0][0];
+  const int tap1 = ONE_FOURTH_TAP[0][1];
+  const int tap2 = ONE_FOURTH_TAP[0][2];
+  int i = 0, is;
+
+#if defined(JM_SIMD)
+  {
+    const __m128i vtap0 = _mm_set1_epi32(tap0);
+    const __m128i vtap1 = _mm_set1_epi32(tap1);
+    const __m128i vtap2 = _mm_set1_epi32(tap2);
+    const __m128i vrnd  = _mm_set1_epi32(512);
+    const __m128i vmax  = _mm_set1_epi32(max_imgpel_value);
+    const __m128i vzero = _mm_setzero_si128();
+
+    for (; i < count - 3; i += 4)
+    {
+      __m128i a = _mm_add_epi32(_mm_loadu_si128((const __m128i *) &srcA[i]), _mm_loadu_si128((const __m128i *) &srcD[i]));
+      __m128i b = _mm_add_epi32(_mm_loadu_si128((const __m128i *) &srcB[i]), _mm_loadu_si128((const __m128i *) &srcE[i]));
+      __m128i c = _mm_add_epi32(_mm_loadu_si128((const __m128i *) &srcC[i]), _mm_loadu_si128((const __m128i *) &srcF[i]));
+      __m128i v = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(a, vtap0), _mm_mullo_epi32(b, vtap1)), _mm_mullo_epi32(c, vtap2));
+
+      v = _mm_srai_epi32(_mm_add_epi32(v, vrnd), 10);
+      simd_store_pel4(&wDst[i], _mm_min_epi32(_mm_max_epi32(v, vzero), vmax));
+    }
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    is =
+      (tap0 * (srcA[i] + srcD[i]) +
+      tap1 *  (srcB[i] + srcE[i]) +
+      tap2 *  (srcC[i] + srcF[i]));
+
+    wDst[i] = (imgpel) iClip1 ( max_imgpel_value, rshift_rnd_sf( is, 10 ) );
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Rounded average of two lines of samples
+ ************************************************************************
+ */
+static inline void bilinear_line(imgpel *wDst, const imgpel *srcL, const imgpel *srcR, int count)
+{
+  int i = 0;
+
+#if defined(JM_SIMD)
+  for (; i < count - 7; i += 8)
+  {
+#if (IMGTYPE == 0)
+    __m128i v = _mm_avg_epu16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *) &srcL[i])), _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *) &srcR[i])));
+#else
+    __m128i v = _mm_avg_epu16(_mm_loadu_si128((const __m128i *) &srcL[i]), _mm_loadu_si128((const __m128i *) &srcR[i]));
+#endif
+    simd_store_pel8(&wDst[i], v);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    wDst[i] = (imgpel) rshift_rnd_sf( srcL[i] + srcR[i], 1 );
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -150,92 +325,66 @@ static void getSubImageInteger_s( StorablePicture *s, imgpel **dstImg, imgpel **
  */
 static void getHorSubImageSixTap( VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg, imgpel **srcImg)
 {
-  int is, jpad, ipad;
+  int jpad;
   int ypadded_size = s->size_y_padded;
   int xpadded_size = s->size_x_padded;
-
-  imgpel *wBufSrc, *wBufDst;
-  imgpel *srcImgA, *srcImgB, *srcImgC, *srcImgD, *srcImgE, *srcImgF;
-  int *iBufDst;
+  int max_imgpel_value = p_Vid->max_imgpel_value;
   const int tap0 = ONE_FOURTH_TAP[0][0];
   const int tap1 = ONE_FOURTH_TAP[0][1];
   const int tap2 = ONE_FOURTH_TAP[0][2];
 
+#if defined(OPENMP)
+#pragma omp parallel for
+#endif
   for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
   {
-    wBufSrc = srcImg[jpad]-IMG_PAD_SIZE_X; 
-    wBufDst = dstImg[jpad]-IMG_PAD_SIZE_X; 
-    iBufDst = p_Vid->imgY_sub_tmp[jpad]-IMG_PAD_SIZE_X;
-
-    srcImgA = &wBufSrc[0];
-    srcImgB = &wBufSrc[0];      
-    srcImgC = &wBufSrc[0];
-    srcImgD = &wBufSrc[1];
-    srcImgE = &wBufSrc[2];
-    srcImgF = &wBufSrc[3];
+    imgpel *wBufSrc = srcImg[jpad]-IMG_PAD_SIZE_X;
+    imgpel *wBufDst = dstImg[jpad]-IMG_PAD_SIZE_X;
+    int    *iBufDst = p_Vid->imgY_sub_tmp[jpad]-IMG_PAD_SIZE_X;
+    int is, ipad;
 
     // left padded area
     is =
-      (tap0 * (*srcImgA++ + *srcImgD++) +
-      tap1 *  (*srcImgB   + *srcImgE++) +
-      tap2 *  (*srcImgC   + *srcImgF++));
+      (tap0 * (wBufSrc[0] + wBufSrc[1]) +
+      tap1 *  (wBufSrc[0] + wBufSrc[2]) +
+      tap2 *  (wBufSrc[0] + wBufSrc[3]));
 
-    *iBufDst++ =  is;
-    *wBufDst++ = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );      
+    iBufDst[0] =  is;
+    wBufDst[0] = (imgpel) iClip1 ( max_imgpel_value, rshift_rnd_sf( is, 5 ) );
 
     is =
-      (tap0 * (*srcImgA++ + *srcImgD++) +
-      tap1 *  (*srcImgB++ + *srcImgE++) +
-      tap2 *  (*srcImgC   + *srcImgF++));
+      (tap0 * (wBufSrc[1] + wBufSrc[2]) +
+      tap1 *  (wBufSrc[0] + wBufSrc[3]) +
+      tap2 *  (wBufSrc[0] + wBufSrc[4]));
 
-    *iBufDst++ =  is;
-    *wBufDst++ = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );      
+    iBufDst[1] =  is;
+    wBufDst[1] = (imgpel) iClip1 ( max_imgpel_value, rshift_rnd_sf( is, 5 ) );
 
     // center
-    for (ipad = 2; ipad < xpadded_size - 4; ipad++)
-    {
-      is =
-        (tap0 * (*srcImgA++ + *srcImgD++) +
-        tap1 *  (*srcImgB++ + *srcImgE++) +
-        tap2 *  (*srcImgC++ + *srcImgF++));
-
-      *iBufDst++ =  is;
-      *wBufDst++ = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );      
-    }
-
-    is = (
-      tap0 * (*srcImgA++ + *srcImgD++) +
-      tap1 * (*srcImgB++ + *srcImgE++) +
-      tap2 * (*srcImgC++ + *srcImgF  ));
-
-    *iBufDst++ =  is;
-    *wBufDst++ = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );      
+    six_tap_hor_line(&iBufDst[2], &wBufDst[2], &wBufSrc[2], xpadded_size - 6, max_imgpel_value);
 
     // right padded area
+    ipad = xpadded_size - 4;
     is = (
-      tap0 * (*srcImgA++ + *srcImgD++) +
-      tap1 * (*srcImgB++ + *srcImgE) +
-      tap2 * (*srcImgC++ + *srcImgF));
-
-    *iBufDst++ =  is;
-    *wBufDst++ = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );      
-
-    is = (
-      tap0 * (*srcImgA++ + *srcImgD) +
-      tap1 * (*srcImgB++ + *srcImgE) +
-      tap2 * (*srcImgC++ + *srcImgF));
+      tap0 * (wBufSrc[ipad    ] + wBufSrc[ipad + 1]) +
+      tap1 * (wBufSrc[ipad - 1] + wBufSrc[ipad + 2]) +
+      tap2 * (wBufSrc[ipad - 2] + wBufSrc[ipad + 3]));
 
-    *iBufDst++ =  is;
-    *wBufDst++ = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );      
+    iBufDst[ipad] =  is;
+    wBufDst[ipad] = (imgpel) iClip1 ( max_imgpel_value, rshift_rnd_sf( is, 5 ) );
 
-    is = (
-      tap0 * (*srcImgA + *srcImgD) +
-      tap1 * (*srcImgB + *srcImgE) +
-      tap2 * (*srcImgC + *srcImgF));
+    for (ipad = xpadded_size - 3; ipad < xpadded_size; ipad++)
+    {
+      int right = xpadded_size - 1;
 
-    *iBufDst =  is;
-    *wBufDst = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );      
+      is = (
+        tap0 * (wBufSrc[ipad    ] + wBufSrc[imin(ipad + 1, right)]) +
+        tap1 * (wBufSrc[ipad - 1] + wBufSrc[imin(ipad + 2, right)]) +
+        tap2 * (wBufSrc[ipad - 2] + wBufSrc[right]));
 
+      iBufDst[ipad] =  is;
+      wBufDst[ipad] = (imgpel) iClip1 ( max_imgpel_value, rshift_rnd_sf( is, 5 ) );
+    }
   }
 }
 
@@ -256,78 +405,27 @@ static void getHorSubImageSixTap( VideoParameters *p_Vid, StorablePicture *s, im
  */
 static void getVerSubImageSixTap( VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg, imgpel **srcImg)
 {
-  int is, jpad, ipad;
+  int jpad;
   int ypadded_size = s->size_y_padded;
   int xpadded_size = s->size_x_padded;
   int maxy = ypadded_size - 1-IMG_PAD_SIZE_Y;
+  int max_imgpel_value = p_Vid->max_imgpel_value;
 
-  imgpel *wxLineDst;
-  imgpel *srcImgA, *srcImgB, *srcImgC, *srcImgD, *srcImgE, *srcImgF;
-  const int tap0 = ONE_FOURTH_TAP[0][0];
-  const int tap1 = ONE_FOURTH_TAP[0][1];
-  const int tap2 = ONE_FOURTH_TAP[0][2];
-
-  // branches within the j loop
-  // top
-  for (jpad = -IMG_PAD_SIZE_Y; jpad < 2-IMG_PAD_SIZE_Y; jpad++)
-  {
-    wxLineDst = dstImg[jpad]-IMG_PAD_SIZE_X;
-    srcImgA = srcImg[jpad ]-IMG_PAD_SIZE_X;
-    srcImgB = srcImg[0-IMG_PAD_SIZE_Y]-IMG_PAD_SIZE_X;      
-    srcImgC = srcImg[0-IMG_PAD_SIZE_Y]-IMG_PAD_SIZE_X;
-    srcImgD = srcImg[jpad + 1]-IMG_PAD_SIZE_X;
-    srcImgE = srcImg[jpad + 2]-IMG_PAD_SIZE_X;
-    srcImgF = srcImg[jpad + 3]-IMG_PAD_SIZE_X;
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      is =
-        (tap0 * (*srcImgA++ + *srcImgD++) +
-        tap1 *  (*srcImgB++ + *srcImgE++) +
-        tap2 *  (*srcImgC++ + *srcImgF++));
-
-      wxLineDst[ipad] = (imgpel) iClip1 (p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );
-    }
-  }
-  // center
-  for (jpad = 2-IMG_PAD_SIZE_Y; jpad < ypadded_size - 3-IMG_PAD_SIZE_Y; jpad++)
-  {
-    wxLineDst = dstImg[jpad]-IMG_PAD_SIZE_X;
-    srcImgA = srcImg[jpad ]-IMG_PAD_SIZE_X;
-    srcImgB = srcImg[jpad - 1]-IMG_PAD_SIZE_X;      
-    srcImgC = srcImg[jpad - 2]-IMG_PAD_SIZE_X;
-    srcImgD = srcImg[jpad + 1]-IMG_PAD_SIZE_X;
-    srcImgE = srcImg[jpad + 2]-IMG_PAD_SIZE_X;
-    srcImgF = srcImg[jpad + 3]-IMG_PAD_SIZE_X;
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      is =
-        (tap0 * (*srcImgA++ + *srcImgD++) +
-        tap1 *  (*srcImgB++ + *srcImgE++) +
-        tap2 *  (*srcImgC++ + *srcImgF++));
-
-      wxLineDst[ipad] = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );
-    }
-  }
-
-  // bottom
-  for (jpad = ypadded_size - 3-IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
+  // source lines are clamped to the padded picture, the top and bottom rows
+  // thus need no special treatment
+#if defined(OPENMP)
+#pragma omp parallel for
+#endif
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
   {
-    wxLineDst = dstImg[jpad]-IMG_PAD_SIZE_X;
-    srcImgA = srcImg[jpad ]-IMG_PAD_SIZE_X;
-    srcImgB = srcImg[jpad - 1]-IMG_PAD_SIZE_X;      
-    srcImgC = srcImg[jpad - 2]-IMG_PAD_SIZE_X;
-    srcImgD = srcImg[imin (maxy, jpad + 1)]-IMG_PAD_SIZE_X;
-    srcImgE = srcImg[maxy]-IMG_PAD_SIZE_X;
-    srcImgF = srcImg[maxy]-IMG_PAD_SIZE_X;
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      is =
-        (tap0 * (*srcImgA++ + *srcImgD++) +
-        tap1 *  (*srcImgB++ + *srcImgE++) +
-        tap2 *  (*srcImgC++ + *srcImgF++));
-
-      wxLineDst[ipad] = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 5 ) );
-    }
+    six_tap_ver_line(dstImg[jpad]-IMG_PAD_SIZE_X,
+      srcImg[jpad                              ]-IMG_PAD_SIZE_X,
+      srcImg[imax(jpad - 1, -IMG_PAD_SIZE_Y)   ]-IMG_PAD_SIZE_X,
+      srcImg[imax(jpad - 2, -IMG_PAD_SIZE_Y)   ]-IMG_PAD_SIZE_X,
+      srcImg[imin(jpad + 1, maxy)              ]-IMG_PAD_SIZE_X,
+      srcImg[imin(jpad + 2, maxy)              ]-IMG_PAD_SIZE_X,
+      srcImg[imin(jpad + 3, maxy)              ]-IMG_PAD_SIZE_X,
+      xpadded_size, max_imgpel_value);
   }
 }
 
@@ -346,79 +444,26 @@ static void getVerSubImageSixTap( VideoParameters *p_Vid, StorablePicture *s, im
  */
 static void getVerSubImageSixTapTmp( VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg)
 {
-  int is, jpad, ipad;
+  int jpad;
   int ypadded_size = s->size_y_padded;
   int xpadded_size = s->size_x_padded;
   int maxy = ypadded_size - 1-IMG_PAD_SIZE_Y;
+  int max_imgpel_value = p_Vid->max_imgpel_value;
+  int **tmp = p_Vid->imgY_sub_tmp;
 
-  imgpel *wxLineDst;
-  int *srcImgA, *srcImgB, *srcImgC, *srcImgD, *srcImgE, *srcImgF;
-  const int tap0 = ONE_FOURTH_TAP[0][0];
-  const int tap1 = ONE_FOURTH_TAP[0][1];
-  const int tap2 = ONE_FOURTH_TAP[0][2];
-
-  // top
-  for (jpad = -IMG_PAD_SIZE_Y; jpad < 2-IMG_PAD_SIZE_Y; jpad++)
-  {
-    wxLineDst = dstImg[jpad]-IMG_PAD_SIZE_X;
-    srcImgA = p_Vid->imgY_sub_tmp[jpad ]-IMG_PAD_SIZE_X;
-    srcImgB = p_Vid->imgY_sub_tmp[0-IMG_PAD_SIZE_Y]-IMG_PAD_SIZE_X;     
-    srcImgC = p_Vid->imgY_sub_tmp[0-IMG_PAD_SIZE_Y]-IMG_PAD_SIZE_X;
-    srcImgD = p_Vid->imgY_sub_tmp[jpad + 1]-IMG_PAD_SIZE_X;
-    srcImgE = p_Vid->imgY_sub_tmp[jpad + 2]-IMG_PAD_SIZE_X;
-    srcImgF = p_Vid->imgY_sub_tmp[jpad + 3]-IMG_PAD_SIZE_X;
-
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      is =
-        (tap0 * (*srcImgA++ + *srcImgD++) +
-        tap1 *  (*srcImgB++ + *srcImgE++) +
-        tap2 *  (*srcImgC++ + *srcImgF++));
-
-      wxLineDst[ipad] = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 10 ) );
-    }
-  }
-
-  // center
-  for (jpad = 2-IMG_PAD_SIZE_Y; jpad < ypadded_size - 3-IMG_PAD_SIZE_Y; jpad++)
-  {
-    wxLineDst = dstImg[jpad]-IMG_PAD_SIZE_X;
-    srcImgA = p_Vid->imgY_sub_tmp[jpad ]-IMG_PAD_SIZE_X;
-    srcImgB = p_Vid->imgY_sub_tmp[jpad - 1]-IMG_PAD_SIZE_X;     
-    srcImgC = p_Vid->imgY_sub_tmp[jpad - 2]-IMG_PAD_SIZE_X;
-    srcImgD = p_Vid->imgY_sub_tmp[jpad + 1]-IMG_PAD_SIZE_X;
-    srcImgE = p_Vid->imgY_sub_tmp[jpad + 2]-IMG_PAD_SIZE_X;
-    srcImgF = p_Vid->imgY_sub_tmp[jpad + 3]-IMG_PAD_SIZE_X;
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      is =
-        (tap0 * (*srcImgA++ + *srcImgD++) +
-        tap1 *  (*srcImgB++ + *srcImgE++) +
-        tap2 *  (*srcImgC++ + *srcImgF++));
-
-      wxLineDst[ipad] = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 10 ) );
-    }
-  }
-
-  // bottom
-  for (jpad = ypadded_size - 3-IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
+#if defined(OPENMP)
+#pragma omp parallel for
+#endif
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
   {
-    wxLineDst = dstImg[jpad]-IMG_PAD_SIZE_X;
-    srcImgA = p_Vid->imgY_sub_tmp[jpad ]-IMG_PAD_SIZE_X;
-    srcImgB = p_Vid->imgY_sub_tmp[jpad - 1]-IMG_PAD_SIZE_X;      
-    srcImgC = p_Vid->imgY_sub_tmp[jpad - 2]-IMG_PAD_SIZE_X;
-    srcImgD = p_Vid->imgY_sub_tmp[imin (maxy, jpad + 1)]-IMG_PAD_SIZE_X;
-    srcImgE = p_Vid->imgY_sub_tmp[maxy]-IMG_PAD_SIZE_X;
-    srcImgF = p_Vid->imgY_sub_tmp[maxy]-IMG_PAD_SIZE_X;
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      is =
-        (tap0 * (*srcImgA++ + *srcImgD++) +
-        tap1 *  (*srcImgB++ + *srcImgE++) +
-        tap2 *  (*srcImgC++ + *srcImgF++));
-
-      wxLineDst[ipad] = (imgpel) iClip1 ( p_Vid->max_imgpel_value, rshift_rnd_sf( is, 10 ) );
-    }
+    six_tap_ver_line_tmp(dstImg[jpad]-IMG_PAD_SIZE_X,
+      tmp[jpad                              ]-IMG_PAD_SIZE_X,
+      tmp[imax(jpad - 1, -IMG_PAD_SIZE_Y)   ]-IMG_PAD_SIZE_X,
+      tmp[imax(jpad - 2, -IMG_PAD_SIZE_Y)   ]-IMG_PAD_SIZE_X,
+      tmp[imin(jpad + 1, maxy)              ]-IMG_PAD_SIZE_X,
+      tmp[imin(jpad + 2, maxy)              ]-IMG_PAD_SIZE_X,
+      tmp[imin(jpad + 3, maxy)              ]-IMG_PAD_SIZE_X,
+      xpadded_size, max_imgpel_value);
   }
 }
 
@@ -434,27 +479,18 @@ static void getVerSubImageSixTapTmp( VideoParameters *p_Vid, StorablePicture *s,
  * \param srcImgL
  *    source left image
  * \param srcImgR
- *    source right image 
+ *    source right image
  ************************************************************************
  */
 static void getSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel **srcImgL, imgpel **srcImgR)
 {
-  int jpad, ipad;
+  int jpad;
   int ypadded_size = s->size_y_padded;
   int xpadded_size = s->size_x_padded;
 
-  imgpel *wBufSrcL, *wBufSrcR, *wBufDst;
-
   for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
   {
-    wBufSrcL = srcImgL[jpad]-IMG_PAD_SIZE_X; 
-    wBufSrcR = srcImgR[jpad]-IMG_PAD_SIZE_X; 
-    wBufDst  = dstImg[jpad]-IMG_PAD_SIZE_X;  
-
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      *wBufDst++ = (imgpel) rshift_rnd_sf( *wBufSrcL++ + *wBufSrcR++, 1 );
-    }
+    bilinear_line(dstImg[jpad]-IMG_PAD_SIZE_X, srcImgL[jpad]-IMG_PAD_SIZE_X, srcImgR[jpad]-IMG_PAD_SIZE_X, xpadded_size);
   }
 }
 
@@ -471,12 +507,12 @@ static void getSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel **s
  * \param srcImgL
  *    source left image
  * \param srcImgR
- *    source right image 
+ *    source right image
  ************************************************************************
  */
 static void getHorSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel **srcImgL, imgpel **srcImgR)
 {
-  int jpad, ipad;
+  int jpad;
   int ypadded_size = s->size_y_padded;
   int xpadded_size = s->size_x_padded - 1;
 
@@ -484,17 +520,14 @@ static void getHorSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel
 
   for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
   {
-    wBufSrcL = srcImgL[jpad]-IMG_PAD_SIZE_X; 
-    wBufSrcR = &srcImgR[jpad][1-IMG_PAD_SIZE_X]; 
-    wBufDst  = dstImg[jpad]-IMG_PAD_SIZE_X;     
+    wBufSrcL = srcImgL[jpad]-IMG_PAD_SIZE_X;
+    wBufSrcR = &srcImgR[jpad][1-IMG_PAD_SIZE_X];
+    wBufDst  = dstImg[jpad]-IMG_PAD_SIZE_X;
 
     // left padded area + center
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      *wBufDst++ = (imgpel) rshift_rnd_sf( *wBufSrcL++ + *wBufSrcR++, 1 );
-    }
+    bilinear_line(wBufDst, wBufSrcL, wBufSrcR, xpadded_size);
     // right padded area
-      *wBufDst++ = (imgpel) rshift_rnd_sf( *wBufSrcL++ + wBufSrcR[-1], 1 );
+    wBufDst[xpadded_size] = (imgpel) rshift_rnd_sf( wBufSrcL[xpadded_size] + wBufSrcR[xpadded_size - 1], 1 );
   }
 }
 
@@ -511,38 +544,23 @@ static void getHorSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel
  * \param srcImgT
  *    source top image
  * \param srcImgB
- *    source bottom image 
+ *    source bottom image
  ************************************************************************
  */
 static void getVerSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB)
 {
-  int jpad, ipad;
+  int jpad;
   int ypadded_size = s->size_y_padded - 1;
-  int xpadded_size = s->size_x_padded;  
-
-  imgpel *wBufSrcT, *wBufSrcB, *wBufDst;
+  int xpadded_size = s->size_x_padded;
 
   // top
   for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size-IMG_PAD_SIZE_Y; jpad++)
   {
-    wBufSrcT = srcImgT[jpad]-IMG_PAD_SIZE_X;           
-    wBufDst  = dstImg[jpad]-IMG_PAD_SIZE_X;            
-    wBufSrcB = srcImgB[jpad + 1]-IMG_PAD_SIZE_X;  
-
-    for (ipad = 0; ipad < xpadded_size; ipad++)
-    {
-      *wBufDst++ = (imgpel) rshift_rnd_sf(*wBufSrcT++ + *wBufSrcB++, 1);
-    }
+    bilinear_line(dstImg[jpad]-IMG_PAD_SIZE_X, srcImgT[jpad]-IMG_PAD_SIZE_X, srcImgB[jpad + 1]-IMG_PAD_SIZE_X, xpadded_size);
   }
   // bottom
-  wBufSrcT = srcImgT[ypadded_size-IMG_PAD_SIZE_Y]-IMG_PAD_SIZE_X;           
-  wBufDst  = dstImg[ypadded_size-IMG_PAD_SIZE_Y]-IMG_PAD_SIZE_X;            
-  wBufSrcB = srcImgB[ypadded_size-IMG_PAD_SIZE_Y]-IMG_PAD_SIZE_X;           
-
-  for (ipad = 0; ipad < xpadded_size; ipad++)
-  {
-    *wBufDst++ = (imgpel) rshift_rnd_sf(*wBufSrcT++ + *wBufSrcB++, 1);
-  }
+  jpad = ypadded_size-IMG_PAD_SIZE_Y;
+  bilinear_line(dstImg[jpad]-IMG_PAD_SIZE_X, srcImgT[jpad]-IMG_PAD_SIZE_X, srcImgB[jpad]-IMG_PAD_SIZE_X, xpadded_size);
 }
 
 
@@ -558,42 +576,58 @@ static void getVerSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel
  * \param srcImgT
  *    source top/left image
  * \param srcImgB
- *    source bottom/right image 
+ *    source bottom/right image
  ************************************************************************
  */
 static void getDiagSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB )
 {
-  int jpad, ipad;
-  int maxx = s->size_x_padded - 1-IMG_PAD_SIZE_X;
+  int jpad;
+  int maxx = s->size_x_padded - 1;
   int maxy = s->size_y_padded - 1-IMG_PAD_SIZE_Y;
 
   imgpel *wBufSrcL, *wBufSrcR, *wBufDst;
 
-  for (jpad = -IMG_PAD_SIZE_Y; jpad < maxy; jpad++)
+  for (jpad = -IMG_PAD_SIZE_Y; jpad <= maxy; jpad++)
   {
-    wBufSrcL = srcImgT[jpad + 1]-IMG_PAD_SIZE_X; 
-    wBufSrcR = &srcImgB[jpad][1-IMG_PAD_SIZE_X]; 
-    wBufDst  = dstImg[jpad]-IMG_PAD_SIZE_X;      
-
-    for (ipad = -IMG_PAD_SIZE_X; ipad < maxx; ipad++)
-    {
-      *wBufDst++ = (imgpel) rshift_rnd_sf(*wBufSrcL++ + *wBufSrcR++, 1);
-    }
+    wBufSrcL = srcImgT[imin(jpad + 1, maxy)]-IMG_PAD_SIZE_X;
+    wBufSrcR = &srcImgB[jpad][1-IMG_PAD_SIZE_X];
+    wBufDst  = dstImg[jpad]-IMG_PAD_SIZE_X;
 
-    *wBufDst++ = (imgpel) rshift_rnd_sf(*wBufSrcL++ +  wBufSrcR[-1], 1);
+    bilinear_line(wBufDst, wBufSrcL, wBufSrcR, maxx);
+    wBufDst[maxx] = (imgpel) rshift_rnd_sf(wBufSrcL[maxx] + wBufSrcR[maxx - 1], 1);
   }
+}
 
-  wBufSrcL = srcImgT[maxy]-IMG_PAD_SIZE_X;     
-  wBufSrcR = &srcImgB[maxy][1-IMG_PAD_SIZE_X]; 
-  wBufDst = dstImg[maxy]-IMG_PAD_SIZE_X;       
-
-  for (ipad = -IMG_PAD_SIZE_X; ipad < maxx; ipad++)
-  {
-    *wBufDst++ = (imgpel) rshift_rnd_sf(*wBufSrcL++ + *wBufSrcR++, 1);
-  }
+/*!
+ ************************************************************************
+ * \brief
+ *    One quarter-pel sub-image that is derived by averaging two
+ *    previously computed sub-images
+ ************************************************************************
+ */
+typedef struct bilinear_sub_image
+{
+  void (*filter) (StorablePicture *s, imgpel **dstImg, imgpel **srcImgA, imgpel **srcImgB);
+  int dst_y, dst_x;
+  int a_y, a_x;
+  int b_y, b_x;
+} BiLinearSubImage;
 
-    *wBufDst++ = (imgpel) rshift_rnd_sf(*wBufSrcL++ + wBufSrcR[-1], 1);
-}
+static const BiLinearSubImage bilinear_sub_images[12] =
+{
+  { getSubImageBiLinear    , 0, 1,  0, 0,  0, 2 },  // sub-image 1  [0][1]
+  { getSubImageBiLinear    , 1, 0,  0, 0,  2, 0 },  // sub-image 4  [1][0]
+  { getSubImageBiLinear    , 1, 1,  0, 2,  2, 0 },  // sub-image 5  [1][1]
+  { getSubImageBiLinear    , 1, 2,  0, 2,  2, 2 },  // sub-image 6  [1][2]
+  { getSubImageBiLinear    , 2, 1,  2, 0,  2, 2 },  // sub-image 9  [2][1]
+  { getHorSubImageBiLinear , 0, 3,  0, 2,  0, 0 },  // sub-image 3  [0][3]
+  { getHorSubImageBiLinear , 1, 3,  0, 2,  2, 0 },  // sub-image 7  [1][3]
+  { getHorSubImageBiLinear , 2, 3,  2, 2,  2, 0 },  // sub-image 11 [2][3]
+  { getVerSubImageBiLinear , 3, 0,  2, 0,  0, 0 },  // sub-image 12 [3][0]
+  { getVerSubImageBiLinear , 3, 1,  2, 0,  0, 2 },  // sub-image 13 [3][1]
+  { getVerSubImageBiLinear , 3, 2,  2, 2,  0, 2 },  // sub-image 14 [3][2]
+  { getDiagSubImageBiLinear, 3, 3,  0, 2,  2, 0 },  // sub-image 15 [3][3]
+};
 
 /*!
  ************************************************************************
@@ -648,33 +682,17 @@ void getSubImagesLuma( VideoParameters *p_Vid, StorablePicture *s )
   if( !p_Vid->p_Inp->OnTheFlyFractMCP )
   {
     //// QUARTER-PEL POSITIONS: BI-LINEAR INTERPOLATION ////
-
-    // sub-image 1 [0][1]
-    getSubImageBiLinear    ( s, cImgSub[0][1], cImgSub[0][0], cImgSub[0][2]);
-    // sub-image 4 [1][0]
-    getSubImageBiLinear    ( s, cImgSub[1][0], cImgSub[0][0], cImgSub[2][0]);
-    // sub-image 5 [1][1]
-    getSubImageBiLinear    ( s, cImgSub[1][1], cImgSub[0][2], cImgSub[2][0]);
-    // sub-image 6 [1][2]
-    getSubImageBiLinear    ( s, cImgSub[1][2], cImgSub[0][2], cImgSub[2][2]);
-    // sub-image 9 [2][1]
-    getSubImageBiLinear    ( s, cImgSub[2][1], cImgSub[2][0], cImgSub[2][2]);
-
-    // sub-image 3  [0][3]
-    getHorSubImageBiLinear ( s, cImgSub[0][3], cImgSub[0][2], cImgSub[0][0]);
-    // sub-image 7  [1][3]
-    getHorSubImageBiLinear ( s, cImgSub[1][3], cImgSub[0][2], cImgSub[2][0]);
-    // sub-image 11 [2][3]
-    getHorSubImageBiLinear ( s, cImgSub[2][3], cImgSub[2][2], cImgSub[2][0]);
-
-    // sub-image 12 [3][0]
-    getVerSubImageBiLinear ( s, cImgSub[3][0], cImgSub[2][0], cImgSub[0][0]);
-    // sub-image 13 [3][1]
-    getVerSubImageBiLinear ( s, cImgSub[3][1], cImgSub[2][0], cImgSub[0][2]);
-    // sub-image 14 [3][2]
-    getVerSubImageBiLinear ( s, cImgSub[3][2], cImgSub[2][2], cImgSub[0][2]);
-
-    // sub-image 15 [3][3]
-    getDiagSubImageBiLinear( s, cImgSub[3][3], cImgSub[0][2], cImgSub[2][0]);
+    // all quarter-pel sub-images only depend on the integer and half-pel
+    // ones and can therefore be generated independently
+    int k;
+
+#if defined(OPENMP)
+#pragma omp parallel for
+#endif
+    for (k = 0; k < 12; ++k)
+    {
+      const BiLinearSubImage *sub = &bilinear_sub_images[k];
+      sub->filter(s, cImgSub[sub->dst_y][sub->dst_x], cImgSub[sub->a_y][sub->a_x], cImgSub[sub->b_y][sub->b_x]);
+    }
   }
 }
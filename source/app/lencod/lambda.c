@@ -89,7 +89,7 @@ void get_implicit_lambda_p_slice(Slice *currSlice)
   double lambda_md;
   double lambda_scale = p_Inp->DisableDistanceLambdaScale ? 1.0 : 1.0 - dClip3(0.0,0.5,0.05 * (double) p_Inp->jumpd);
   //limit lambda for mode decison;
-  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (IMGTYPE==0));
+  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (DISTTYPE==0));
   double dMaxLambdaMD =0;
 
   if(bLimitsLambdaMD)
@@ -133,7 +133,7 @@ void get_implicit_lambda_b_slice(Slice *currSlice)
   double lambda_md;
   FrameUnitStruct *p_cur_frm = p_Vid->p_curr_frm_struct;
   //limit lambda for mode decison;
-  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (IMGTYPE==0));
+  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (DISTTYPE==0));
   double dMaxLambdaMD =0;
 
   if(bLimitsLambdaMD)
@@ -186,7 +186,7 @@ void get_implicit_lambda_i_slice(Slice *currSlice)
   double lambda_md;
   double lambda_scale = p_Inp->DisableDistanceLambdaScale ? 1.0 : 1.0 - dClip3(0.0,0.5,0.05 * (double) p_Inp->jumpd);
   //limit lambda for mode decison;
-  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (IMGTYPE==0));
+  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (DISTTYPE==0));
   double dMaxLambdaMD =0;
 
   if(bLimitsLambdaMD)
@@ -232,7 +232,7 @@ void get_implicit_lambda_sp_slice(Slice *currSlice)
   double lambda_md;
   double lambda_scale = p_Inp->DisableDistanceLambdaScale ? 1.0 : 1.0 - dClip3(0.0,0.5,0.05 * (double) p_Inp->jumpd);
   //limit lambda for mode decison;
-  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (IMGTYPE==0));
+  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (DISTTYPE==0));
   double dMaxLambdaMD =0;
 
   int slice_index = currSlice->slice_type;
@@ -280,7 +280,7 @@ void get_explicit_lambda(Slice *currSlice)
   double qp_temp;
   double lambda_scale = p_Inp->DisableDistanceLambdaScale ? 1.0 : 1.0 - dClip3(0.0,0.5,0.05 * (double) p_Inp->jumpd);
   //limit lambda for mode decison;
-  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (IMGTYPE==0));
+  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (DISTTYPE==0));
   double dMaxLambdaMD =0;
 #if (MVC_EXTENSION_ENABLE)
   double tmp_lambda_md = 0.0;
@@ -341,7 +341,7 @@ void get_fixed_lambda(Slice *currSlice)
   InputParameters *p_Inp = currSlice->p_Inp;
   int qp;
   //limit lambda for mode decison;
-  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (IMGTYPE==0));
+  int bLimitsLambdaMD = ((p_Inp->EnableIPCM > 0) && (DISTTYPE==0));
   double dMaxLambdaMD =0;
 
   int j = currSlice->slice_type;
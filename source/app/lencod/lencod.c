@@ -91,6 +91,13 @@
 #include "mc_prediction.h"
 #include "me_distortion.h"
 #include "me_distortion_otf.h"
+#include "otf_cache.h"
+#include "me_cache.h"
+#include "rt_control.h"
+#include "lookahead.h"
+#include "img_dist_async.h"
+#include "async_output.h"
+#include "segment.h"
 #include "md_distortion.h"
 #include "mode_decision.h"
 #include "transform8x8.h"
@@ -105,7 +112,7 @@
 #include "wp.h"
 
 //check the scaling factor to avoid overflow;
-#if !IMGTYPE
+#if !DISTTYPE
 #if JCOST_CALC_SCALEUP && (LAMBDA_ACCURACY_BITS>8) 
 #error "LAMBDA_ACCURACY_BITS is greater than 8. Overflow!"
 #endif
@@ -240,10 +247,75 @@ static void free_encoder (EncoderParams *p_Enc)
   free_pointer( p_Enc );
 }
 
+#if (JM_DUAL_PRECISION)
 /*!
  ***********************************************************************
  * \brief
- *    Main function for encoder.
+ *    Free the Video Parameters structure of an encoder that did not
+ *    code (see alloc_video_params)
+ ***********************************************************************
+ */
+static void free_video_params (VideoParameters *p_Vid)
+{
+  free_pointer (p_Vid->p_SEI);
+  free_pointer (p_Vid->p_QScale);
+  free_pointer (p_Vid->p_Quant);
+  free_pointer (p_Vid->p_Dpb_layer[0]);
+  free_pointer (p_Vid->p_Stats);
+  free_pointer (p_Vid->p_Dist);
+  free_pointer (p_Vid);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Whether the samples of the sequence (source and coded) fit into
+ *    bytes
+ ***********************************************************************
+ */
+static int is_8bit_sequence (InputParameters *p_Inp)
+{
+  int i;
+
+  for (i = 0; i < 3; ++i)
+  {
+    if (p_Inp->source.bit_depth[i] > 8 || p_Inp->output.bit_depth[i] > 8)
+      return 0;
+  }
+  return 1;
+}
+#endif
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Codes the sequence of the configured encoder p_Enc and frees it
+ * \return
+ *    exit code
+ ***********************************************************************
+ */
+static int code_sequence (void)
+{
+  // init encoder
+  init_encoder(p_Enc->p_Vid, p_Enc->p_Inp);
+
+  // encode sequence
+  encode_sequence(p_Enc->p_Vid, p_Enc->p_Inp);
+
+  // terminate sequence
+  free_encoder_memory(p_Enc->p_Vid, p_Enc->p_Inp);
+
+  free_params (p_Enc->p_Inp);  
+  free_encoder(p_Enc);
+
+  return 0;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Runs the encoder on a command line (the encoder processes of the
+ *    library API, see encoder_api.c, enter here as well).
  * \param argc
  *    number of command line arguments
  * \param argv
@@ -252,7 +324,7 @@ static void free_encoder (EncoderParams *p_Enc)
  *    exit code
  ***********************************************************************
  */
-int main(int argc, char **argv)
+int encoder_main(int argc, char **argv)
 {
   init_time();
 #if MEMORY_DEBUG
@@ -263,20 +335,68 @@ int main(int argc, char **argv)
 
   Configure (p_Enc->p_Vid, p_Enc->p_Inp, argc, argv);
 
-  // init encoder
-  init_encoder(p_Enc->p_Vid, p_Enc->p_Inp);
+#if (JM_DUAL_PRECISION)
+  // sequences of at most 8 bits are coded by the encoder built with byte samples, which
+  // takes over the configuration (its allocations and the opened input)
+  if (is_8bit_sequence(p_Enc->p_Inp))
+  {
+    int ret = encoder_main_8bit(p_Enc->p_Inp);
 
-  // encode sequence
-  encode_sequence(p_Enc->p_Vid, p_Enc->p_Inp);
+    free_video_params(p_Enc->p_Vid);
+    free_pointer(p_Enc->p_Inp);
+    free_encoder(p_Enc);
+    return ret;
+  }
+#endif
 
-  // terminate sequence
-  free_encoder_memory(p_Enc->p_Vid, p_Enc->p_Inp);
+  return code_sequence();
+}
 
-  free_params (p_Enc->p_Inp);  
-  free_encoder(p_Enc);
+#if (IMGTYPE == 0)
+/*!
+ ***********************************************************************
+ * \brief
+ *    Entry of the encoder with byte samples that high bit depth builds
+ *    link in (JM_DUAL_PRECISION): codes the sequence that the calling
+ *    encoder has configured.
+ * \param p_Inp
+ *    parameters after Configure(); the allocations and files they
+ *    refer to are taken over
+ * \return
+ *    exit code
+ ***********************************************************************
+ */
+int encoder_main_8bit(InputParameters *p_Inp)
+{
+  init_time();
 
-  return 0;
+  alloc_encoder(&p_Enc);
+
+  *p_Enc->p_Inp = *p_Inp;
+  cfgparams     = *p_Inp;
+
+  return code_sequence();
 }
+#endif
+
+#if !defined(LENCOD_LIBRARY)
+/*!
+ ***********************************************************************
+ * \brief
+ *    Main function for encoder.
+ * \param argc
+ *    number of command line arguments
+ * \param argv
+ *    command line arguments
+ * \return
+ *    exit code
+ ***********************************************************************
+ */
+int main(int argc, char **argv)
+{
+  return encoder_main(argc, argv);
+}
+#endif
 
 
 /*!
@@ -352,6 +472,28 @@ void setup_dpb_layer(DecodedPictureBuffer *p_Dpb, VideoParameters *p_Vid, InputP
     p_Dpb->pf_OneComponentChromaPrediction4x4_regenerate = OneComponentChromaPrediction4x4_regenerate;
     p_Dpb->pf_OneComponentChromaPrediction4x4_retrieve   = OneComponentChromaPrediction4x4_regenerate;
     break;
+  case OTF_L3:
+    p_Dpb->pf_computeSAD = computeSAD_otf;
+    p_Dpb->pf_computeSADWP = computeSADWP_otf;
+    p_Dpb->pf_computeSATD = computeSATD_otf;
+    p_Dpb->pf_computeSATDWP = computeSATDWP_otf;
+    p_Dpb->pf_computeBiPredSAD1 = computeBiPredSAD1_otf;
+    p_Dpb->pf_computeBiPredSAD2 = computeBiPredSAD2_otf;
+    p_Dpb->pf_computeBiPredSATD1 = computeBiPredSATD1_otf;
+    p_Dpb->pf_computeBiPredSATD2 = computeBiPredSATD2_otf;
+    p_Dpb->pf_computeSSE = computeSSE_otf;
+    p_Dpb->pf_computeSSEWP = computeSSEWP_otf;
+    p_Dpb->pf_computeBiPredSSE1 = computeBiPredSSE1_otf;
+    p_Dpb->pf_computeBiPredSSE2 = computeBiPredSSE2_otf;
+    p_Dpb->pf_luma_prediction         = luma_prediction_otf ;
+    p_Dpb->pf_luma_prediction_bi      = luma_prediction_bi_otf ;
+    p_Dpb->pf_chroma_prediction       = chroma_prediction_otf ;
+    p_Dpb->pf_get_block_luma          = get_block_luma_otf_L3 ;
+    // chroma (other than 4:4:4) is cheap to filter and stays on-the-fly
+    p_Dpb->pf_get_block_chroma[OTF_ME] = p_Dpb->pf_get_block_chroma[OTF_MC] = (p_Vid->P444_joined) ? ( get_block_luma_otf_L3 ) : ( get_block_chroma_otf_L2 ) ;
+    p_Dpb->pf_OneComponentChromaPrediction4x4_regenerate = OneComponentChromaPrediction4x4_regenerate;
+    p_Dpb->pf_OneComponentChromaPrediction4x4_retrieve   = OneComponentChromaPrediction4x4_regenerate;
+    break;
   default: //  otf not used
     p_Dpb->pf_computeSAD = computeSAD;
     p_Dpb->pf_computeSADWP = computeSADWP;
@@ -387,6 +529,42 @@ static void set_storage_format(VideoParameters *p_Vid, FrameFormat *p_src, Frame
   p_dst->size        = p_dst->size_cmp[0] + p_dst->size_cmp[1] + p_dst->size_cmp[2];
 }
 
+/*!
+ ***********************************************************************
+ * \brief
+ *    Starts reading a sequential input, or maps a concatenated input
+ *    file (InputMemoryMap). Frames are coded out of order (B frames, IDR
+ *    delay) and the lookahead reads ahead of the coded frame, so a
+ *    window of already read frames is kept buffered (mapped) and the
+ *    frames up to the next anchor picture are prefetched.
+ ***********************************************************************
+ */
+void start_input(InputParameters *p_Inp, VideoDataFile *input_file)
+{
+  int frames_behind = (p_Inp->NumberBFrames + 1 + p_Inp->intra_delay + p_Inp->LookaheadFrames) * (p_Inp->frame_skip + 1) + 1;
+  int frames_ahead  = (p_Inp->NumberBFrames + 1 + p_Inp->LookaheadFrames) * (p_Inp->frame_skip + 1) + 1;
+
+  // with the lookahead the frame structure is populated a buffer length at a time and each population
+  // looks one atom (at most a buffer length) further; the pre-analysis reads the frames it decides on
+  if (p_Inp->LookaheadFrames > 0)
+    frames_behind += 2 * get_frm_struct_length(p_Inp) * (p_Inp->frame_skip + 1);
+
+  if (input_file->stream != NULL)
+  {
+    if (p_Inp->InputStreamBuffer > 0)
+    {
+      if (p_Inp->LookaheadFrames > 0 && p_Inp->InputStreamBuffer < frames_behind)
+        printf("Warning: InputStreamBuffer = %d is shorter than the %d frames the lookahead may read ahead of the coder.\n", p_Inp->InputStreamBuffer, frames_behind);
+      frames_behind = p_Inp->InputStreamBuffer;
+    }
+    StartInputStream(input_file, &p_Inp->source, p_Inp->infile_header, frames_behind, p_Inp->InputStreamReadAhead);
+  }
+  else if (p_Inp->InputMemoryMap)
+  {
+    OpenFrameMap(input_file, &p_Inp->source, p_Inp->infile_header, frames_behind, frames_ahead);
+  }
+}
+
 /*!
  ***********************************************************************
  * \brief
@@ -514,10 +692,12 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   // Open Files
   OpenFiles(&p_Inp->input_file1);
+  start_input(p_Inp, &p_Inp->input_file1);
 #if (MVC_EXTENSION_ENABLE)
   if(p_Vid->num_of_layers==2)
   {
     OpenFiles(&p_Inp->input_file2);
+    start_input(p_Inp, &p_Inp->input_file2);
   }
   p_Vid->prev_view_is_anchor = 0;
   p_Vid->view_id = 0;  // initialise view_id
@@ -606,6 +786,16 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp)
     wpxInitWPXPasses(p_Vid, p_Inp);
 
   init_motion_search_module (p_Vid, p_Inp);
+  if (p_Inp->OnTheFlyFractMCP == OTF_L3)
+    init_otf_cache(p_Vid, p_Inp->OTFTileCacheSize);
+  if (p_Inp->MEResultCache && p_Inp->SearchMode[0] == EPZS && !p_Inp->separate_colour_plane_flag)
+    init_me_cache(p_Vid, p_Inp);
+  if (p_Inp->RTTargetFPS > 0)
+    init_rt_control(p_Vid, p_Inp);
+  if (p_Inp->AsyncMetrics && p_Inp->Verbose != 0)
+    init_metric_engine(p_Vid, p_Inp);
+  if (p_Inp->AsyncOutput)
+    init_async_output(p_Vid);
   information_init(p_Vid, p_Inp, p_Vid->p_Stats);
 
   if(p_Inp->DistortionYUVtoRGB)
@@ -880,10 +1070,11 @@ static void prepare_frame_params(VideoParameters *p_Vid, InputParameters *p_Inp,
 /*!
  ***********************************************************************
  * \brief
- *    Encode a sequence
+ *    Encode the frames with coding order index first to last - 1
+ *    (for MVC the coded pictures of both views)
  ***********************************************************************
  */
-static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
+void encode_frames(VideoParameters *p_Vid, InputParameters *p_Inp, int first, int last)
 {
   int curr_frame_to_code;
   int frames_to_code;
@@ -909,7 +1100,9 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
     frm_struct_buffer = p_Vid->frm_struct_buffer;
   }
   
-  for (curr_frame_to_code = 0; curr_frame_to_code < frames_to_code; curr_frame_to_code++)
+  last = imin(last, frames_to_code);
+
+  for (curr_frame_to_code = first; curr_frame_to_code < last; curr_frame_to_code++)
   {
 #if (MVC_EXTENSION_ENABLE)
     if ( p_Inp->num_of_views == 2 )
@@ -970,6 +1163,11 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
       continue;
     }
 
+    if (p_Vid->p_Lookahead != NULL)
+    {
+      lookahead_analyse(p_Vid->p_Lookahead, p_Vid->p_curr_frm_struct->frame_no + p_Inp->LookaheadFrames);
+    }
+
     // Update frame_num counter
     frame_num_bak = p_Vid->p_EncodePar[p_Vid->dpb_layer_id]->frame_num;
 
@@ -1016,15 +1214,12 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
 
     if (p_Inp->ReportFrameStats)
     {
+      flush_metrics(p_Vid);
       report_frame_statistic(p_Vid, p_Inp);
     }
 
   }
 
-#if EOS_OUTPUT
-  end_of_stream(p_Vid);
-#endif
-
 #if (MVC_EXTENSION_ENABLE)
   if(p_Inp->num_of_views == 2) //? it should use num_of_layers;
   {
@@ -1033,6 +1228,26 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
 #endif
 }
 
+/*!
+ ***********************************************************************
+ * \brief
+ *    Encode a sequence
+ ***********************************************************************
+ */
+static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  if (p_Inp->SegmentParallel)
+    encode_segments(p_Vid, p_Inp);
+  else
+    encode_frames(p_Vid, p_Inp, 0, INT_MAX);
+
+  flush_metrics(p_Vid);
+
+#if EOS_OUTPUT
+  end_of_stream(p_Vid);
+#endif
+}
+
 
 /*!
  ***********************************************************************
@@ -1046,6 +1261,8 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
   terminate_sequence(p_Vid, p_Inp);
   flush_dpb(p_Vid->p_Dpb_layer[0], &p_Inp->output);
   flush_dpb(p_Vid->p_Dpb_layer[1], &p_Inp->output);
+  // the reconstruction files are closed below
+  free_async_output(p_Vid);
   CloseFiles(&p_Inp->input_file1);
   
   if (-1 != p_Vid->p_dec)
@@ -1061,6 +1278,8 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
   if (p_Enc->p_trace)
     fclose(p_Enc->p_trace);
 
+  // the motion search modules are released for the configured search modes
+  rt_control_restore(p_Vid);
   clear_motion_search_module (p_Vid, p_Inp);
 
   RandomIntraUninit(p_Vid);
@@ -1077,6 +1296,11 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   // report everything
   report(p_Vid, p_Inp, p_Vid->p_Stats);
+  free_otf_cache(p_Vid);
+  free_me_cache(p_Vid);
+  free_rt_control(p_Vid);
+  free_metric_engine(p_Vid);
+  free_slice_arenas(p_Vid);
 
 #ifdef _LEAKYBUCKET_
   free_pointer(p_Vid->Bit_Buffer);
@@ -1778,7 +2002,8 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
       smpUMHEX_init(p_Vid);
       memory_size += smpUMHEX_get_mem(p_Vid);
     }
-    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS)
+    // the real-time control may switch to EPZS
+    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS || p_Inp->RTTargetFPS > 0)
     {
       memory_size += EPZSInit(p_Vid);
     }
@@ -1809,10 +2034,10 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
   //if ( p_Inp->ChromaMCBuffer )
     chroma_mc_setup(p_Vid);
 
-  p_Vid->padded_size_x       = (p_Vid->width + 2 * IMG_PAD_SIZE_X);
+  p_Vid->padded_size_x       = get_plane_stride(p_Vid->width, IMG_PAD_SIZE_X);
   p_Vid->padded_size_x_m8x8  = (p_Vid->padded_size_x - BLOCK_SIZE_8x8);
   p_Vid->padded_size_x_m4x4  = (p_Vid->padded_size_x - BLOCK_SIZE);
-  p_Vid->cr_padded_size_x    = (p_Vid->width_cr + 2 * p_Vid->pad_size_uv_x);
+  p_Vid->cr_padded_size_x    = get_plane_stride(p_Vid->width_cr, p_Vid->pad_size_uv_x);
   p_Vid->cr_padded_size_x2   = (p_Vid->cr_padded_size_x << 1);
   p_Vid->cr_padded_size_x4   = (p_Vid->cr_padded_size_x << 2);
   p_Vid->cr_padded_size_x_m8 = (p_Vid->cr_padded_size_x - 8);
@@ -1833,6 +2058,10 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   memory_size += init_process_image( p_Vid, p_Inp );
 
+  // the frame structure of the sequence may already depend on the pre-analysis
+  if (p_Inp->LookaheadFrames > 0)
+    memory_size += init_lookahead(p_Vid, p_Inp);
+
   p_Vid->p_pred = init_seq_structure( p_Vid, p_Inp, &memory_size );
 
   return memory_size;
@@ -2098,7 +2327,7 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
     {
       smpUMHEX_free_mem(p_Vid);
     }
-    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS)
+    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS || p_Inp->RTTargetFPS > 0)
     {
       EPZSDelete(p_Vid);
     }
@@ -2129,6 +2358,7 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   clear_process_image( p_Vid, p_Inp );
   free_seq_structure( p_Vid->p_pred );
+  free_lookahead( p_Vid );
 }
 
 
@@ -2503,10 +2733,10 @@ static void gen_enc_par(VideoParameters *p_Vid, int layer_idx)
   cps->shift_cr_y  = cps->chroma_shift_y - 2;
   cps->shift_cr_x  = cps->chroma_shift_x - 2;
 
-  cps->padded_size_x       = (cps->width + 2 * IMG_PAD_SIZE_X);
+  cps->padded_size_x       = get_plane_stride(cps->width, IMG_PAD_SIZE_X);
   cps->padded_size_x_m8x8  = (cps->padded_size_x - BLOCK_SIZE_8x8);
   cps->padded_size_x_m4x4  = (cps->padded_size_x - BLOCK_SIZE);
-  cps->cr_padded_size_x    = (cps->width_cr + 2 * cps->pad_size_uv_x);
+  cps->cr_padded_size_x    = get_plane_stride(cps->width_cr, cps->pad_size_uv_x);
   cps->cr_padded_size_x2   = (cps->cr_padded_size_x << 1);
   cps->cr_padded_size_x4   = (cps->cr_padded_size_x << 2);
   cps->cr_padded_size_x_m8 = (cps->cr_padded_size_x - 8);
@@ -0,0 +1,74 @@
+/*!
+ ************************************************************************
+ * \file
+ *     lencod_api.h
+ *
+ * \brief
+ *    Encoder library API: frames are passed from memory and the coded
+ *    NAL units are returned through a callback (see encoder_api.c).
+ *    The header does not depend on the other encoder headers.
+ *
+ *    The encoder keeps its state in globals and is not re-entrant, so
+ *    the API is a process pool: each encoder is a separate process fed
+ *    through pipes. lencod_pool_init() starts the server process that
+ *    forks the encoders. It is a fork() of the caller, so it must be
+ *    called while the caller has a single thread, e.g. at the start of
+ *    main(); relative file names of the parameters and options refer to
+ *    the working directory at that time. After that, lencod_open() may be
+ *    called from any thread and the encoders can be driven from different
+ *    threads. The functions of one encoder must not be called concurrently.
+ *
+ *    The encoder writes no report files (stats.dat, log.dat, data.txt,
+ *    leakybucketparam.cfg, stat_frame.dat) unless the options name them,
+ *    e.g. "StatsFile = enc1.dat" or "ReportLog = 1"; encoders sharing a
+ *    working directory must not name the same files. The console output
+ *    and the warnings of the encoder go to log_file.
+ *
+ *    The API is available in POSIX builds only.
+ ************************************************************************
+ */
+
+#ifndef _LENCOD_API_H_
+#define _LENCOD_API_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Receives one coded NAL unit (without start code) of the encoder
+typedef void (*LencodNalCallback) (void *opaque, const unsigned char *nal, int size);
+
+//! Parameters of an encoder
+typedef struct lencod_params
+{
+  const char  *config_file;   //!< configuration file as with -d (NULL: encoder.cfg)
+  const char **options;       //!< "Name = Value" settings as with -p, applied after the configuration file (NULL terminated, may be NULL)
+  int          width;         //!< luma width of the frames
+  int          height;        //!< luma height of the frames
+  int          yuv_format;    //!< 0: 4:0:0, 1: 4:2:0, 2: 4:2:2, 3: 4:4:4
+  int          bit_depth;     //!< sample bit depth; above 8 the samples are 16 bit little endian
+  double       frame_rate;    //!< frames per second
+  int          frames;        //!< frames to be encoded; the sequence ends early if fewer are passed
+  const char  *log_file;      //!< file for the console output and the warnings of the encoder (NULL: discarded)
+  LencodNalCallback nal_out;  //!< called for each NAL unit in bitstream order, from a thread of the encoder
+  void        *opaque;        //!< passed to nal_out
+} LencodParams;
+
+typedef struct lencod_encoder LencodEncoder;
+
+//! Starts the process pool while the caller has a single thread; max_encoders limits the encoders open at once (0: no limit). Returns 0 on success.
+extern int            lencod_pool_init(int max_encoders);
+//! Ends the process pool; encoders that are open keep running until they are closed.
+extern void           lencod_pool_exit(void);
+//! Starts an encoder of the pool; waits while max_encoders are open. Returns NULL if it cannot be started (or without a pool).
+extern LencodEncoder *lencod_open  (const LencodParams *params);
+//! Passes the next frame: plane[c] points to the first sample of component c, stride[c] is its row distance in bytes. Returns 0 on success.
+extern int            lencod_encode(LencodEncoder *enc, const void *const plane[3], const int stride[3]);
+//! Ends the sequence, waits until its last NAL unit has been delivered and releases the encoder. Returns 0 on success, else the exit code of the encoder.
+extern int            lencod_close (LencodEncoder *enc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
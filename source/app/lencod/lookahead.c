@@ -0,0 +1,494 @@
+/*!
+ *************************************************************************************
+ * \file lookahead.c
+ *
+ * \brief
+ *    Lookahead pre-analysis.
+ *
+ *    With LookaheadFrames set, the input frames are read ahead of the encoder and
+ *    reduced with PyrDownG5x5_U8CnR (the filter of the HME image pyramid) to an
+ *    analysis plane of at most LA_MAX_WIDTH samples per line. On that plane every
+ *    8x8 block gets an intra cost estimate (best of DC, vertical and horizontal
+ *    prediction from the source) and an inter cost estimate from a predictive
+ *    small diamond search against the previous frame. The per frame sums drive
+ *
+ *     - IDR placement: a frame whose inter cost comes close to its intra cost
+ *       starts a new scene (LookaheadSceneCut),
+ *     - the B-frame count: prediction structures only bridge runs of frames with
+ *       moderate motion (LookaheadAdaptiveB),
+ *     - rate control: the MAD prediction of the quadratic model is scaled by the
+ *       complexity change and the frame target follows the complexity of the
+ *       next LookaheadFrames frames,
+ *     - RDPictureDecision, whose extra coding passes are skipped for static frames.
+ *
+ *    With the lookahead on, the frame structure is populated FrmStructBufferLength
+ *    frames at a time as the coding proceeds (see init_seq_structure()), and each
+ *    population looks one prediction atom past its last frame. The frames it asks
+ *    for are analysed on demand, so the analysis runs at most FrmStructBufferLength
+ *    frames plus one atom, and never less than LookaheadFrames frames, ahead of
+ *    the frame being coded; scene cuts and B-frame runs are decided in that window.
+ *
+ *************************************************************************************
+ */
+
+#include <math.h>
+
+#include "global.h"
+#include "memalloc.h"
+#include "input.h"
+#include "resize.h"
+#include "lookahead.h"
+
+#define LA_MAX_WIDTH        480   //!< the pyramid is reduced until the analysis plane is at most this wide
+#define LA_BLK                8   //!< block size on the analysis plane
+#define LA_SEARCH_RANGE      16   //!< search range on the analysis plane
+#define LA_B_MOTION_RATIO   0.4   //!< inter/intra cost ratio up to which frames may be bridged by B frames
+#define LA_RC_WEIGHT_MIN    0.5   //!< limits of the rate control target weight
+#define LA_RC_WEIGHT_MAX    2.0
+
+static const MotionVector la_diamond[4] = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
+
+/*!
+ ************************************************************************
+ * \brief
+ *    SAD of an 8x8 block, stops once the current best is exceeded
+ ************************************************************************
+ */
+static int la_block_sad(imgpel **cur, imgpel **ref, int x, int y, int rx, int ry, int min_sad)
+{
+  int i, j, sad = 0;
+
+  for (j = 0; j < LA_BLK && sad < min_sad; ++j)
+  {
+    imgpel *c = &cur[y + j][x];
+    imgpel *r = &ref[ry + j][rx];
+    for (i = 0; i < LA_BLK; ++i)
+      sad += iabs(c[i] - r[i]);
+  }
+  return sad;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Intra cost estimate of an 8x8 block: best of DC, vertical and
+ *    horizontal prediction from the neighbouring source samples
+ ************************************************************************
+ */
+static int la_intra_cost(imgpel **img, int x, int y)
+{
+  int i, j, dc = 0, cost, cost_dc = 0, cost_v = 0, cost_h = 0;
+
+  for (j = 0; j < LA_BLK; ++j)
+    for (i = 0; i < LA_BLK; ++i)
+      dc += img[y + j][x + i];
+  dc = (dc + (LA_BLK * LA_BLK >> 1)) / (LA_BLK * LA_BLK);
+
+  for (j = 0; j < LA_BLK; ++j)
+    for (i = 0; i < LA_BLK; ++i)
+      cost_dc += iabs(img[y + j][x + i] - dc);
+  cost = cost_dc;
+
+  if (y > 0)
+  {
+    for (j = 0; j < LA_BLK; ++j)
+      for (i = 0; i < LA_BLK; ++i)
+        cost_v += iabs(img[y + j][x + i] - img[y - 1][x + i]);
+    cost = imin(cost, cost_v);
+  }
+  if (x > 0)
+  {
+    for (j = 0; j < LA_BLK; ++j)
+      for (i = 0; i < LA_BLK; ++i)
+        cost_h += iabs(img[y + j][x + i] - img[y + j][x - 1]);
+    cost = imin(cost, cost_h);
+  }
+  return cost;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Motion search of one block against the previous frame: the best of
+ *    the spatial and temporal predictors is refined with a small diamond
+ ************************************************************************
+ */
+static int la_motion_search(Lookahead *p_la, int bx, int by)
+{
+  imgpel **cur = p_la->layer[p_la->levels];
+  imgpel **ref = p_la->prev;
+  int idx = by * p_la->blk_x + bx;
+  int x = bx * LA_BLK, y = by * LA_BLK;
+  int min_x = imax(-LA_SEARCH_RANGE, -x), max_x = imin(LA_SEARCH_RANGE, p_la->width  - LA_BLK - x);
+  int min_y = imax(-LA_SEARCH_RANGE, -y), max_y = imin(LA_SEARCH_RANGE, p_la->height - LA_BLK - y);
+  MotionVector cand[5], best_mv = { 0, 0 }, mv;
+  int num_cand = 0, k, sad, min_sad = INT_MAX, iter, improved;
+
+  cand[num_cand++] = best_mv;
+  cand[num_cand++] = p_la->prev_mv[idx];
+  if (bx > 0)
+    cand[num_cand++] = p_la->mv[idx - 1];
+  if (by > 0)
+  {
+    cand[num_cand++] = p_la->mv[idx - p_la->blk_x];
+    if (bx < p_la->blk_x - 1)
+      cand[num_cand++] = p_la->mv[idx - p_la->blk_x + 1];
+  }
+
+  for (k = 0; k < num_cand; ++k)
+  {
+    mv.mv_x = (short) iClip3(min_x, max_x, cand[k].mv_x);
+    mv.mv_y = (short) iClip3(min_y, max_y, cand[k].mv_y);
+    sad = la_block_sad(cur, ref, x, y, x + mv.mv_x, y + mv.mv_y, min_sad);
+    if (sad < min_sad)
+    {
+      min_sad = sad;
+      best_mv = mv;
+    }
+  }
+
+  for (iter = 0; iter < LA_SEARCH_RANGE; ++iter)
+  {
+    MotionVector centre = best_mv;
+
+    improved = FALSE;
+    for (k = 0; k < 4; ++k)
+    {
+      mv.mv_x = (short) (centre.mv_x + la_diamond[k].mv_x);
+      mv.mv_y = (short) (centre.mv_y + la_diamond[k].mv_y);
+      if (mv.mv_x < min_x || mv.mv_x > max_x || mv.mv_y < min_y || mv.mv_y > max_y)
+        continue;
+      sad = la_block_sad(cur, ref, x, y, x + mv.mv_x, y + mv.mv_y, min_sad);
+      if (sad < min_sad)
+      {
+        min_sad = sad;
+        best_mv = mv;
+        improved = TRUE;
+      }
+    }
+    if (!improved)
+      break;
+  }
+
+  p_la->mv[idx] = best_mv;
+  return min_sad;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads, downscales and analyses one frame
+ ************************************************************************
+ */
+static void la_analyse_frame(Lookahead *p_la, int frame_no)
+{
+  VideoParameters *p_Vid = p_la->p_Vid;
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  LookaheadFrame  *p_frm = &p_la->frm[frame_no];
+  int bx, by, l, intra, inter;
+  imgpel **tmp;
+  MotionVector *tmp_mv;
+
+  // a short input is reported by the encoder once it gets there
+  if (!read_one_frame(p_Vid, &p_Inp->input_file1, (1 + p_Inp->frame_skip) * frame_no, p_Inp->infile_header, &p_Inp->source, &p_Inp->output, p_la->frm_data))
+    return;
+  pad_borders(p_Inp->output, p_Vid->width, p_Vid->height, p_Vid->width_cr, p_Vid->height_cr, p_la->frm_data);
+
+  for (l = 1; l <= p_la->levels; ++l)
+  {
+    imgpel **src = p_la->layer[l - 1];
+    imgpel **dst = p_la->layer[l];
+
+    PyrDownG5x5_U8CnR((const imgpel *) *src, (int) ((src[1] - src[0]) * sizeof(imgpel)), p_Vid->width >> (l - 1), p_Vid->height >> (l - 1),
+      *dst, (int) ((dst[1] - dst[0]) * sizeof(imgpel)), 1);
+  }
+
+  for (by = 0; by < p_la->blk_y; ++by)
+  {
+    for (bx = 0; bx < p_la->blk_x; ++bx)
+    {
+      intra = la_intra_cost(p_la->layer[p_la->levels], bx * LA_BLK, by * LA_BLK);
+      inter = frame_no ? la_motion_search(p_la, bx, by) : intra;
+      p_frm->intra_cost += intra;
+      p_frm->inter_cost += imin(intra, inter);
+    }
+  }
+
+  if (frame_no)
+  {
+    p_frm->scene_cut = (byte) (p_la->scene_cut_ratio > 0.0 && (double) p_frm->inter_cost > p_la->scene_cut_ratio * (double) p_frm->intra_cost);
+    p_frm->is_static = (byte) (!p_frm->scene_cut && p_frm->inter_cost <= p_la->static_cost);
+    p_la->scene_cuts    += p_frm->scene_cut;
+    p_la->static_frames += p_frm->is_static;
+  }
+
+  // the current plane and motion become the references of the next frame
+  tmp = p_la->prev;
+  p_la->prev = p_la->layer[p_la->levels];
+  p_la->layer[p_la->levels] = tmp;
+  tmp_mv = p_la->prev_mv;
+  p_la->prev_mv = p_la->mv;
+  p_la->mv = tmp_mv;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate the lookahead pre-analysis
+ ************************************************************************
+ */
+int init_lookahead(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  Lookahead *p_la;
+  int l, memory_size = 0;
+
+  if ((p_la = (Lookahead *) calloc(1, sizeof(Lookahead))) == NULL)
+    no_mem_exit("init_lookahead: p_la");
+
+  p_la->p_Vid           = p_Vid;
+  p_la->num_frames      = p_Inp->no_frames;
+  p_la->depth           = p_Inp->LookaheadFrames;
+  p_la->adaptive_b      = p_Inp->LookaheadAdaptiveB && p_Inp->NumberBFrames > 0;
+  p_la->scene_cut_ratio = p_Inp->LookaheadSceneCut;
+
+  p_la->levels = 1;
+  while (p_la->levels < LA_MAX_LEVELS && (p_Vid->width >> p_la->levels) > LA_MAX_WIDTH)
+    ++p_la->levels;
+  p_la->width  = p_Vid->width  >> p_la->levels;
+  p_la->height = p_Vid->height >> p_la->levels;
+  p_la->blk_x  = p_la->width  / LA_BLK;
+  p_la->blk_y  = p_la->height / LA_BLK;
+
+  // about half a sample of average difference on the analysis plane
+  p_la->static_cost = ((int64) p_la->width * p_la->height << (p_Vid->bitdepth_luma - 8)) >> 1;
+
+  memory_size += get_mem2Dpel(&p_la->frm_data[0], p_Vid->height, p_Vid->width);
+  if (p_Vid->yuv_format != YUV400)
+  {
+    memory_size += get_mem2Dpel(&p_la->frm_data[1], p_Vid->height_cr, p_Vid->width_cr);
+    memory_size += get_mem2Dpel(&p_la->frm_data[2], p_Vid->height_cr, p_Vid->width_cr);
+  }
+
+  p_la->layer[0] = p_la->frm_data[0];
+  for (l = 1; l <= p_la->levels; ++l)
+    memory_size += get_mem2Dpel(&p_la->layer[l], p_Vid->height >> l, p_Vid->width >> l);
+  memory_size += get_mem2Dpel(&p_la->prev, p_la->height, p_la->width);
+
+  if ((p_la->mv = (MotionVector *) calloc(imax(1, p_la->blk_x * p_la->blk_y), sizeof(MotionVector))) == NULL)
+    no_mem_exit("init_lookahead: p_la->mv");
+  if ((p_la->prev_mv = (MotionVector *) calloc(imax(1, p_la->blk_x * p_la->blk_y), sizeof(MotionVector))) == NULL)
+    no_mem_exit("init_lookahead: p_la->prev_mv");
+  if ((p_la->frm = (LookaheadFrame *) calloc(imax(1, p_la->num_frames), sizeof(LookaheadFrame))) == NULL)
+    no_mem_exit("init_lookahead: p_la->frm");
+  memory_size += 2 * p_la->blk_x * p_la->blk_y * sizeof(MotionVector) + p_la->num_frames * sizeof(LookaheadFrame);
+
+  p_Vid->p_Lookahead = p_la;
+
+  return memory_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the lookahead pre-analysis
+ ************************************************************************
+ */
+void free_lookahead(VideoParameters *p_Vid)
+{
+  Lookahead *p_la = p_Vid->p_Lookahead;
+  int l;
+
+  if (p_la == NULL)
+    return;
+
+  for (l = 1; l <= p_la->levels; ++l)
+    free_mem2Dpel(p_la->layer[l]);
+  free_mem2Dpel(p_la->prev);
+  free_mem2Dpel(p_la->frm_data[0]);
+  if (p_la->frm_data[1] != NULL)
+  {
+    free_mem2Dpel(p_la->frm_data[1]);
+    free_mem2Dpel(p_la->frm_data[2]);
+  }
+  free(p_la->mv);
+  free(p_la->prev_mv);
+  free(p_la->frm);
+  free(p_la);
+
+  p_Vid->p_Lookahead = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Analyses the frames up to (and including) frame_no
+ ************************************************************************
+ */
+void lookahead_analyse(Lookahead *p_la, int frame_no)
+{
+  TIME_T start_time, end_time;
+  int last = imin(frame_no, p_la->num_frames - 1);
+
+  if (p_la->analysed > last)
+    return;
+
+  gettime(&start_time);
+  while (p_la->analysed <= last)
+    la_analyse_frame(p_la, p_la->analysed++);
+  gettime(&end_time);
+
+  p_la->time += timenorm(timediff(&start_time, &end_time));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Results of a frame, analysing it first if needed
+ ************************************************************************
+ */
+static LookaheadFrame *la_get_frame(Lookahead *p_la, int frame_no)
+{
+  if (p_la == NULL || frame_no < 0 || frame_no >= p_la->num_frames)
+    return NULL;
+
+  lookahead_analyse(p_la, frame_no);
+  return &p_la->frm[frame_no];
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns 1 if the frame starts a new scene
+ ************************************************************************
+ */
+int lookahead_scene_cut(Lookahead *p_la, int frame_no)
+{
+  LookaheadFrame *p_frm = (p_la != NULL && p_la->scene_cut_ratio > 0.0) ? la_get_frame(p_la, frame_no) : NULL;
+
+  return (p_frm != NULL) ? p_frm->scene_cut : 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns 1 if the frame (almost) repeats the previous one
+ ************************************************************************
+ */
+int lookahead_is_static(Lookahead *p_la, int frame_no)
+{
+  LookaheadFrame *p_frm = la_get_frame(p_la, frame_no);
+
+  return (p_frm != NULL) ? p_frm->is_static : 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Longest prediction structure (in frames) that should start at frame
+ *    frame_no: its B frames have to lie in a run of moderate motion
+ ************************************************************************
+ */
+int lookahead_prd_length(Lookahead *p_la, int frame_no, int max_length)
+{
+  LookaheadFrame *p_frm;
+  int length;
+
+  if (p_la == NULL || !p_la->adaptive_b)
+    return max_length;
+
+  // the run grows by one frame as long as the frame that becomes its anchor moves moderately;
+  // structures running past the end of the sequence are limited by the frame count anyway
+  for (length = 0; length < max_length; ++length)
+  {
+    if ((p_frm = la_get_frame(p_la, frame_no + length)) == NULL)
+      return max_length;
+    if (p_frm->scene_cut || (double) p_frm->inter_cost > LA_B_MOTION_RATIO * (double) p_frm->intra_cost)
+      break;
+  }
+
+  return imax(1, length);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Cost estimate of a frame (inter cost, intra cost for the first frame)
+ ************************************************************************
+ */
+double lookahead_cost(Lookahead *p_la, int frame_no)
+{
+  LookaheadFrame *p_frm = la_get_frame(p_la, frame_no);
+
+  return (p_frm != NULL) ? (double) p_frm->inter_cost : 0.0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Intra cost estimate of a frame
+ ************************************************************************
+ */
+double lookahead_intra_cost(Lookahead *p_la, int frame_no)
+{
+  LookaheadFrame *p_frm = la_get_frame(p_la, frame_no);
+
+  return (p_frm != NULL) ? (double) p_frm->intra_cost : 0.0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Cost estimate of a frame as it is coded: a scene cut starts with an
+ *    IDR picture
+ ************************************************************************
+ */
+static double la_coded_cost(Lookahead *p_la, int frame_no)
+{
+  return lookahead_scene_cut(p_la, frame_no) ? lookahead_intra_cost(p_la, frame_no) : lookahead_cost(p_la, frame_no);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Share of an IDR picture at frame_no in the bits of itself and the
+ *    num_frames frames after it: its intra cost estimate relative to the
+ *    cost estimates of the frames ahead. Frames beyond the lookahead
+ *    window count with the mean of the window.
+ ************************************************************************
+ */
+double lookahead_idr_share(Lookahead *p_la, int frame_no, int num_frames)
+{
+  double cost = lookahead_intra_cost(p_la, frame_no), sum = 0.0;
+  int i, n = 0;
+
+  for (i = frame_no + 1; i <= frame_no + p_la->depth && i < p_la->num_frames && n < num_frames; ++i, ++n)
+    sum += la_coded_cost(p_la, i);
+
+  if (cost <= 0.0 || n == 0)
+    return 1.0;
+
+  return cost / (cost + sum * num_frames / n);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Weight of the rate control target of a frame: complexity relative
+ *    to the mean of the next LookaheadFrames frames. Scene cuts count
+ *    with their intra cost, so the frames before one leave bits for
+ *    its IDR picture.
+ ************************************************************************
+ */
+float lookahead_rc_weight(Lookahead *p_la, int frame_no)
+{
+  double cost = la_coded_cost(p_la, frame_no), sum = 0.0;
+  int i, n = 0;
+
+  for (i = frame_no; i <= frame_no + p_la->depth && i < p_la->num_frames; ++i, ++n)
+    sum += la_coded_cost(p_la, i);
+
+  if (cost <= 0.0 || sum <= 0.0)
+    return 1.0F;
+
+  return (float) dmin(LA_RC_WEIGHT_MAX, dmax(LA_RC_WEIGHT_MIN, sqrt(cost * n / sum)));
+}
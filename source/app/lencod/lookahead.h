@@ -0,0 +1,63 @@
+/*!
+ ************************************************************************
+ * \file
+ *     lookahead.h
+ *
+ * \brief
+ *    Lookahead pre-analysis: complexity, scene cut and intra/inter cost
+ *    estimates of the input frames from a downscaled motion search
+ ************************************************************************
+ */
+
+#ifndef _LOOKAHEAD_H_
+#define _LOOKAHEAD_H_
+
+#include "global.h"
+
+#define LA_MAX_LEVELS 4   //!< maximum number of pyramid levels below the input resolution
+
+//! pre-analysis results of one frame (display order)
+typedef struct lookahead_frame
+{
+  int64 intra_cost;       //!< sum of the block intra cost estimates
+  int64 inter_cost;       //!< sum of the block costs with motion compensation from the previous frame
+  byte  scene_cut;        //!< frame starts a new scene
+  byte  is_static;        //!< frame (almost) repeats the previous one
+} LookaheadFrame;
+
+typedef struct lookahead
+{
+  VideoParameters *p_Vid;
+  int    num_frames;                    //!< frames of the sequence
+  int    depth;                         //!< frames analysed ahead of the frame being coded
+  int    analysed;                      //!< frames analysed so far
+  int    levels;                        //!< pyramid levels between the input and the analysis plane
+  int    width, height;                 //!< size of the analysis plane
+  int    blk_x, blk_y;                  //!< size of the analysis plane in blocks
+  int    adaptive_b;                    //!< B-frame runs follow the motion of the sequence
+  double scene_cut_ratio;               //!< inter/intra cost ratio that marks a scene cut (0: off)
+  int64  static_cost;                   //!< inter cost below which a frame counts as static
+  imgpel **frm_data[3];                 //!< input frame at coding resolution
+  imgpel **layer[LA_MAX_LEVELS + 1];    //!< image pyramid, layer[levels] is the analysis plane
+  imgpel **prev;                        //!< analysis plane of the previous frame
+  MotionVector *mv;                     //!< block motion of the current frame
+  MotionVector *prev_mv;                //!< block motion of the previous frame
+  LookaheadFrame *frm;                  //!< per frame results
+  int    scene_cuts;                    //!< scene cuts detected
+  int    static_frames;                 //!< static frames detected
+  int64  time;                          //!< analysis time (ms)
+} Lookahead;
+
+extern int    init_lookahead      (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void   free_lookahead      (VideoParameters *p_Vid);
+extern void   lookahead_analyse   (Lookahead *p_la, int frame_no);
+extern int    lookahead_scene_cut (Lookahead *p_la, int frame_no);
+extern int    lookahead_is_static (Lookahead *p_la, int frame_no);
+extern int    lookahead_prd_length(Lookahead *p_la, int frame_no, int max_length);
+extern double lookahead_cost      (Lookahead *p_la, int frame_no);
+extern double lookahead_intra_cost(Lookahead *p_la, int frame_no);
+extern double lookahead_idr_share (Lookahead *p_la, int frame_no, int num_frames);
+extern float  lookahead_rc_weight (Lookahead *p_la, int frame_no);
+
+#endif
+
@@ -24,6 +24,7 @@
 #include "image.h"
 #include "mb_access.h"
 #include "loop_filter.h"
+#include "memalloc.h"
 
 extern void set_loop_filter_functions_mbaff (VideoParameters *p_Vid);
 extern void set_loop_filter_functions_normal(VideoParameters *p_Vid);
@@ -113,42 +114,43 @@ void DeblockFrame(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV)
 /*!
  *****************************************************************************************
  * \brief
- *    Deblocking filter for one macroblock.
+ *    Filter decisions and boundary strengths of one macroblock. They only depend on the
+ *    coding parameters of the macroblock and its neighbours, not on the samples.
  *****************************************************************************************
  */
-
-static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, int MbQAddr)
+static void get_mb_deblock_info(VideoParameters *p_Vid, int MbQAddr, MbDeblockInfo *info)
 {
+  Macroblock    *MbQ = &(p_Vid->mb_data[MbQAddr]) ; // current Mb
   int           edge;
-  byte          Strength[16];
-
   short         mb_x, mb_y;
-
-  int           filterNon8x8LumaEdgesFlag[4] = {1,1,1,1};
   int           filterLeftMbEdgeFlag;
   int           filterTopMbEdgeFlag;
-  int           edge_cr;
-  Macroblock    *MbQ = &(p_Vid->mb_data[MbQAddr]) ; // current Mb
   Slice  *currSlice = MbQ->p_Slice;
   int           mvlimit = (p_Vid->structure!=FRAME) || (p_Vid->mb_aff_frame_flag && MbQ->mb_field) ? 2 : 4;
   seq_parameter_set_rbsp_t *active_sps = p_Vid->active_sps;
   p_Vid->mixedModeEdgeFlag = 0;
 
+  info->ver_edges  = 0;
+  info->hor_edges  = 0;
+  info->mixed_edge = 0;
+
   // return, if filter is disabled
   if (MbQ->DFDisableIdc == 1) 
   {
     MbQ->DeblockCall = 0;
+    info->filter = 0;
     return;
   }
 
+  info->filter = 1;
   MbQ->DeblockCall = 1;
   get_mb_pos (p_Vid, MbQAddr, p_Vid->mb_size[IS_LUMA], &mb_x, &mb_y);
 
   if (MbQ->mb_type == I8MB)
     assert(MbQ->luma_transform_size_8x8_flag);
 
-  filterNon8x8LumaEdgesFlag[1] =
-    filterNon8x8LumaEdgesFlag[3] = !(MbQ->luma_transform_size_8x8_flag);
+  info->luma_edge[0] = info->luma_edge[2] = 1;
+  info->luma_edge[1] = info->luma_edge[3] = (byte) !(MbQ->luma_transform_size_8x8_flag);
 
   filterLeftMbEdgeFlag = (mb_x != 0);
   filterTopMbEdgeFlag  = (mb_y != 0);
@@ -166,13 +168,13 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
 
   CheckAvailabilityOfNeighbors(MbQ);
 
-  // Vertical deblocking
+  // Vertical edges
   for (edge = 0; edge < 4 ; ++edge )
   {
     // If cbp == 0 then deblocking for some macroblock types could be skipped                                                                  
     if (MbQ->cbp == 0)
     {
-      if (filterNon8x8LumaEdgesFlag[edge] == 0 && active_sps->chroma_format_idc!=YUV444)
+      if (info->luma_edge[edge] == 0 && active_sps->chroma_format_idc!=YUV444)
         continue;
       else if (edge > 0 && (currSlice->slice_type == P_SLICE || currSlice->slice_type == B_SLICE))
       {
@@ -185,43 +187,26 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
 
     if( edge || filterLeftMbEdgeFlag )
     {
+      byte *Strength = info->StrengthVer[edge];
+
       // Strength for 4 blks in 1 stripe
-      p_Vid->GetStrengthVer(Strength, MbQ, edge << 2, mvlimit); // Strength for 4 blks in 1 stripe
+      p_Vid->GetStrengthVer(Strength, MbQ, edge << 2, mvlimit);
 
       if ( Strength[0] != 0 || Strength[1] != 0 || Strength[2] != 0 || Strength[3] !=0 ||
            Strength[4] != 0 || Strength[5] != 0 || Strength[6] != 0 || Strength[7] !=0 ||
            Strength[8] != 0 || Strength[9] != 0 || Strength[10] != 0 || Strength[11] !=0 ||
            Strength[12] != 0 || Strength[13] != 0 || Strength[14] != 0 || Strength[15] !=0 ) // only if one of the 16 Strength bytes is != 0
-      {
-        if (filterNon8x8LumaEdgesFlag[edge])
-        {
-          p_Vid->EdgeLoopLumaVer( PLANE_Y, imgY, Strength, MbQ, edge << 2) ;
-          if (p_Vid->P444_joined)
-          {
-            p_Vid->EdgeLoopLumaVer(PLANE_U, imgUV[0], Strength, MbQ, edge << 2);
-            p_Vid->EdgeLoopLumaVer(PLANE_V, imgUV[1], Strength, MbQ, edge << 2);
-          }
-        }
-        if(p_Vid->yuv_format==YUV420 || p_Vid->yuv_format==YUV422 )
-        {
-          edge_cr = chroma_edge[0][edge][p_Vid->yuv_format];
-          if( (imgUV != NULL) && (edge_cr >= 0))
-          {
-            p_Vid->EdgeLoopChromaVer( imgUV[0], Strength, MbQ, edge_cr, 0);
-            p_Vid->EdgeLoopChromaVer( imgUV[1], Strength, MbQ, edge_cr, 1);
-          }
-        }
-      }        
+        info->ver_edges |= (byte) (1 << edge);
     }
   }//end edge
 
-  // horizontal deblocking  
+  // Horizontal edges
   for( edge = 0; edge < 4 ; ++edge )
   {
     // If cbp == 0 then deblocking for some macroblock types could be skipped
     if (MbQ->cbp == 0)
     {
-      if (filterNon8x8LumaEdgesFlag[edge] == 0 && active_sps->chroma_format_idc==YUV420)
+      if (info->luma_edge[edge] == 0 && active_sps->chroma_format_idc==YUV420)
         continue;
       else if (edge > 0 && (currSlice->slice_type == P_SLICE || currSlice->slice_type == B_SLICE))
       {
@@ -234,6 +219,8 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
 
     if( edge || filterTopMbEdgeFlag )
     {
+      byte *Strength = info->StrengthHor[edge];
+
       // Strength for 4 blks in 1 stripe
       p_Vid->GetStrengthHor(Strength, MbQ, edge << 2, mvlimit);
 
@@ -241,59 +228,176 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
            Strength[4] != 0 || Strength[5] != 0 || Strength[6] != 0 || Strength[7] !=0 ||
            Strength[8] != 0 || Strength[9] != 0 || Strength[10] != 0 || Strength[11] !=0 ||
            Strength[12] != 0 || Strength[13] != 0 || Strength[14] != 0 || Strength[15] !=0 ) // only if one of the 16 Strength bytes is != 0
+        info->hor_edges |= (byte) (1 << edge);
+
+      if (!edge && !MbQ->mb_field && p_Vid->mixedModeEdgeFlag) 
+      {
+        // this is the extra horizontal edge between a frame macroblock pair and a field above it
+        MbQ->DeblockCall = 2;
+        p_Vid->GetStrengthHor(info->StrengthHor[4], MbQ, MB_BLOCK_SIZE, mvlimit); // Strength for 4 blks in 1 stripe
+        MbQ->DeblockCall = 1;
+        info->mixed_edge = 1;
+      }
+    }
+  }//end edge
+
+  MbQ->DeblockCall = 0;
+}
+
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Filters the edges of one macroblock selected by get_mb_deblock_info(). The
+ *    macroblock data is only read here.
+ *****************************************************************************************
+ */
+static void filter_mb_edges(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, Macroblock *MbQ, MbDeblockInfo *info, int stride_y, int stride_uv)
+{
+  int edge, edge_cr;
+
+  // Vertical deblocking
+  for (edge = 0; edge < 4 ; ++edge )
+  {
+    if ((info->ver_edges >> edge) & 0x01)
+    {
+      byte *Strength = info->StrengthVer[edge];
+
+      if (info->luma_edge[edge])
       {
-        if (filterNon8x8LumaEdgesFlag[edge])
+        p_Vid->EdgeLoopLumaVer( PLANE_Y, imgY, Strength, MbQ, edge << 2, stride_y) ;
+        if (p_Vid->P444_joined)
         {
-          p_Vid->EdgeLoopLumaHor( PLANE_Y, imgY, Strength, MbQ, edge << 2, p_Vid->width_padded) ;
-          if (p_Vid->P444_joined)
-          {
-            p_Vid->EdgeLoopLumaHor(PLANE_U, imgUV[0], Strength, MbQ, edge << 2, p_Vid->width_padded);
-            p_Vid->EdgeLoopLumaHor(PLANE_V, imgUV[1], Strength, MbQ, edge << 2, p_Vid->width_padded);
-          }
+          p_Vid->EdgeLoopLumaVer(PLANE_U, imgUV[0], Strength, MbQ, edge << 2, stride_uv);
+          p_Vid->EdgeLoopLumaVer(PLANE_V, imgUV[1], Strength, MbQ, edge << 2, stride_uv);
         }
-        if(p_Vid->yuv_format==YUV420 || p_Vid->yuv_format==YUV422 )
+      }
+      if(p_Vid->yuv_format==YUV420 || p_Vid->yuv_format==YUV422 )
+      {
+        edge_cr = chroma_edge[0][edge][p_Vid->yuv_format];
+        if( (imgUV != NULL) && (edge_cr >= 0))
         {
-          edge_cr = chroma_edge[1][edge][p_Vid->yuv_format];
-          if( (imgUV != NULL) && (edge_cr >= 0))
-          {
-            p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, edge_cr, p_Vid->width_cr + p_Vid->pad_size_uv_x * 2, 0);
-            p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, edge_cr, p_Vid->width_cr + p_Vid->pad_size_uv_x * 2, 1);
-          }
+          p_Vid->EdgeLoopChromaVer( imgUV[0], Strength, MbQ, edge_cr, stride_uv, 0);
+          p_Vid->EdgeLoopChromaVer( imgUV[1], Strength, MbQ, edge_cr, stride_uv, 1);
         }
       }
+    }
+  }//end edge
 
-      if (!edge && !MbQ->mb_field && p_Vid->mixedModeEdgeFlag) 
+  // horizontal deblocking  
+  for( edge = 0; edge < 4 ; ++edge )
+  {
+    if ((info->hor_edges >> edge) & 0x01)
+    {
+      byte *Strength = info->StrengthHor[edge];
+
+      if (info->luma_edge[edge])
       {
-        // this is the extra horizontal edge between a frame macroblock pair and a field above it
-        MbQ->DeblockCall = 2;
-        p_Vid->GetStrengthHor(Strength, MbQ, MB_BLOCK_SIZE, mvlimit); // Strength for 4 blks in 1 stripe
-        //if( Strength[0] != 0 || Strength[1] != 0 || Strength[2] != 0 || Strength[3] != 0  )                      // only if one of the 4 Strength bytes is != 0
+        p_Vid->EdgeLoopLumaHor( PLANE_Y, imgY, Strength, MbQ, edge << 2, stride_y) ;
+        if (p_Vid->P444_joined)
         {
-          if (filterNon8x8LumaEdgesFlag[edge])
-          {
-            p_Vid->EdgeLoopLumaHor( PLANE_Y, imgY, Strength, MbQ, MB_BLOCK_SIZE, p_Vid->width_padded) ;
-            if (p_Vid->P444_joined)
-            {
-              p_Vid->EdgeLoopLumaHor(PLANE_U, imgUV[0], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->width_padded) ;
-              p_Vid->EdgeLoopLumaHor(PLANE_V, imgUV[1], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->width_padded) ;
-            }
-          }
-          if( p_Vid->yuv_format == YUV420 || p_Vid->yuv_format==YUV422 )
-          {
-            edge_cr = chroma_edge[1][edge][p_Vid->yuv_format];
-            if( (imgUV != NULL) && (edge_cr >= 0))
-            {
-              p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->width_cr+p_Vid->pad_size_uv_x*2, 0) ;
-              p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->width_cr+p_Vid->pad_size_uv_x*2, 1) ;
-            }
-          }
+          p_Vid->EdgeLoopLumaHor(PLANE_U, imgUV[0], Strength, MbQ, edge << 2, stride_uv);
+          p_Vid->EdgeLoopLumaHor(PLANE_V, imgUV[1], Strength, MbQ, edge << 2, stride_uv);
+        }
+      }
+      if(p_Vid->yuv_format==YUV420 || p_Vid->yuv_format==YUV422 )
+      {
+        edge_cr = chroma_edge[1][edge][p_Vid->yuv_format];
+        if( (imgUV != NULL) && (edge_cr >= 0))
+        {
+          p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, edge_cr, stride_uv, 0);
+          p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, edge_cr, stride_uv, 1);
         }
-        MbQ->DeblockCall = 1;
       }
     }
+
+    if (!edge && info->mixed_edge)
+    {
+      // this is the extra horizontal edge between a frame macroblock pair and a field above it
+      byte *Strength = info->StrengthHor[4];
+
+      MbQ->DeblockCall = 2;
+      p_Vid->EdgeLoopLumaHor( PLANE_Y, imgY, Strength, MbQ, MB_BLOCK_SIZE, stride_y) ;
+      if (p_Vid->P444_joined)
+      {
+        p_Vid->EdgeLoopLumaHor(PLANE_U, imgUV[0], Strength, MbQ, MB_BLOCK_SIZE, stride_uv) ;
+        p_Vid->EdgeLoopLumaHor(PLANE_V, imgUV[1], Strength, MbQ, MB_BLOCK_SIZE, stride_uv) ;
+      }
+      if( p_Vid->yuv_format == YUV420 || p_Vid->yuv_format==YUV422 )
+      {
+        edge_cr = chroma_edge[1][edge][p_Vid->yuv_format];
+        if( (imgUV != NULL) && (edge_cr >= 0))
+        {
+          p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, MB_BLOCK_SIZE, stride_uv, 0) ;
+          p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, MB_BLOCK_SIZE, stride_uv, 1) ;
+        }
+      }
+      MbQ->DeblockCall = 1;
+    }
   }//end edge
+}
 
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Deblocking filter for one macroblock.
+ *****************************************************************************************
+ */
+static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, int MbQAddr)
+{
+  Macroblock    *MbQ = &(p_Vid->mb_data[MbQAddr]) ; // current Mb
+  MbDeblockInfo info;
+  PelPlane      plane_y, plane_uv;
+
+  get_mb_deblock_info(p_Vid, MbQAddr, &info);
+  if (!info.filter)
+    return;
+
+  // strides of the planes being filtered (padded reference planes or the unpadded planes of the simulated decoders)
+  get_pel_plane(&plane_y, imgY, p_Vid->width, p_Vid->height);
+  if (imgUV != NULL)
+    get_pel_plane(&plane_uv, imgUV[0], p_Vid->width_cr, p_Vid->height_cr);
+  else
+    plane_uv = plane_y;
+
+  MbQ->DeblockCall = 1;
+  filter_mb_edges(p_Vid, imgY, imgUV, MbQ, &info, plane_y.stride, plane_uv.stride);
   MbQ->DeblockCall = 0;
 }
 
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Filter decisions of all macroblocks of the current picture, for filtering several
+ *    planes of the same picture with DeblockFramePlane()
+ *****************************************************************************************
+ */
+void GetDeblockInfo(VideoParameters *p_Vid, MbDeblockInfo *info)
+{
+  unsigned int i;
+
+  init_Deblock(p_Vid);
+  for (i = 0; i < p_Vid->PicSizeInMbs; i++)
+    get_mb_deblock_info(p_Vid, i, &info[i]);
+}
+
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Filter a luma plane of the current picture with the decisions of GetDeblockInfo().
+ *    Apart from the planes nothing is written, so several planes can be filtered at the
+ *    same time. Not for MBAFF frames, whose neighbour derivation depends on DeblockCall.
+ *****************************************************************************************
+ */
+void DeblockFramePlane(VideoParameters *p_Vid, imgpel **imgY, MbDeblockInfo *info)
+{
+  unsigned int i;
+  PelPlane plane_y;
+
+  get_pel_plane(&plane_y, imgY, p_Vid->width, p_Vid->height);
+  for (i = 0; i < p_Vid->PicSizeInMbs; i++)
+  {
+    if (info[i].filter)
+      filter_mb_edges(p_Vid, imgY, NULL, &p_Vid->mb_data[i], &info[i], plane_y.stride, plane_y.stride);
+  }
+}
 
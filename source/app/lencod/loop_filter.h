@@ -22,6 +22,21 @@
 
 #define GROUP_SIZE  1
 
+//! Filter decisions of one macroblock, they do not depend on the samples being filtered
+typedef struct mb_deblock_info
+{
+  byte filter;                                  //!< macroblock is filtered (DFDisableIdc != 1)
+  byte luma_edge[4];                            //!< luma edge is filtered (no inner 4x4 edges for the 8x8 transform)
+  byte ver_edges;                               //!< vertical edges with a non zero strength (bit mask)
+  byte hor_edges;                               //!< horizontal edges with a non zero strength (bit mask)
+  byte mixed_edge;                              //!< extra edge between a frame macroblock and a field pair above it (MBAFF)
+  byte StrengthVer[4][MB_BLOCK_SIZE];           //!< boundary strengths of the vertical edges
+  byte StrengthHor[5][MB_BLOCK_SIZE];           //!< boundary strengths of the horizontal edges, [4]: mixed edge
+} MbDeblockInfo;
+
+extern void GetDeblockInfo   (VideoParameters *p_Vid, MbDeblockInfo *info);
+extern void DeblockFramePlane(VideoParameters *p_Vid, imgpel **imgY, MbDeblockInfo *info);
+
 /*********************************************************************************************************/
 
 // NOTE: In principle, the alpha and beta tables are calculated with the formulas below
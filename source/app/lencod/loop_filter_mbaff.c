@@ -29,9 +29,9 @@
 
 static void get_strength_ver_MBAff     (byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int mvlimit);
 static void get_strength_hor_MBAff     (byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int mvlimit);
-static void edge_loop_luma_ver_MBAff   (ColorPlane pl, imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge);
+static void edge_loop_luma_ver_MBAff   (ColorPlane pl, imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width);
 static void edge_loop_luma_hor_MBAff   (ColorPlane pl, imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width);
-static void edge_loop_chroma_ver_MBAff (imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int uv);
+static void edge_loop_chroma_ver_MBAff (imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width, int uv);
 static void edge_loop_chroma_hor_MBAff (imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width, int uv);
 
 
@@ -285,7 +285,7 @@ static void get_strength_hor_MBAff(byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ
  *    Filters 16 pel block edge of Super MB Frame coded MBs
  *****************************************************************************************
  */
-static void edge_loop_luma_ver_MBAff(ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge)
+static void edge_loop_luma_ver_MBAff(ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width)
 {
   int      pel, ap = 0, aq = 0, Strng ;
   int      C0, tc0, dif;
@@ -541,7 +541,7 @@ static void edge_loop_luma_hor_MBAff(ColorPlane pl, imgpel** Img, byte Strength[
 *    Filters chroma block edge for MBAFF types
 *****************************************************************************************
  */
-static void edge_loop_chroma_ver_MBAff(imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int uv)
+static void edge_loop_chroma_ver_MBAff(imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width, int uv)
 {
   int      pel, Strng ;
   int      C0, tc0, dif;
@@ -27,9 +27,9 @@
 
 static void GetStrengthVer      (byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int mvlimit);
 static void GetStrengthHor      (byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int mvlimit);
-static void EdgeLoopLumaVer     (ColorPlane pl, imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge);
+static void EdgeLoopLumaVer     (ColorPlane pl, imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width);
 static void EdgeLoopLumaHor     (ColorPlane pl, imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width);
-static void EdgeLoopChromaVer   (imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int uv);
+static void EdgeLoopChromaVer   (imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width, int uv);
 static void EdgeLoopChromaHor   (imgpel** Img, byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int edge, int width, int uv);
 
 
@@ -295,10 +295,11 @@ static void GetStrengthHor(byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ, int ed
 /*!
  *****************************************************************************************
  * \brief
- *    Filters 16 pel block edge of Frame or Field coded MBs 
+ *    Filters 16 pel block edge of Frame or Field coded MBs. The rows
+ *    are addressed through the plane stride (width).
  *****************************************************************************************
  */
-static void EdgeLoopLumaVer(ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge)
+static void EdgeLoopLumaVer(ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width)
 {
   VideoParameters *p_Vid = MbQ->p_Vid;
 
@@ -325,8 +326,7 @@ static void EdgeLoopLumaVer(ColorPlane pl, imgpel** Img, byte Strength[16], Macr
       const byte *ClipTab = CLIP_TAB[indexA];
       int max_imgpel_value = p_Vid->max_pel_value_comp[pl];      
 
-      int pos_x1 = pixMB1.pos_x;
-      imgpel **cur_img = &Img[pixMB1.pos_y];
+      imgpel *cur_line = &Img[pixMB1.pos_y][pixMB1.pos_x];
       int pel;
 
       for( pel = 0 ; pel < MB_BLOCK_SIZE ; pel += 4 )
@@ -336,9 +336,10 @@ static void EdgeLoopLumaVer(ColorPlane pl, imgpel** Img, byte Strength[16], Macr
           int i;
           for( i = 0 ; i < BLOCK_SIZE ; ++i )
           {
-            imgpel *SrcPtrP = *(cur_img++) + pos_x1;
+            imgpel *SrcPtrP = cur_line;
             imgpel *SrcPtrQ = SrcPtrP + 1;
             imgpel  L0 = *SrcPtrP;
+            cur_line += width;
             imgpel  R0 = *SrcPtrQ;
 
             if( iabs( R0 - L0 ) < Alpha )
@@ -389,8 +390,9 @@ static void EdgeLoopLumaVer(ColorPlane pl, imgpel** Img, byte Strength[16], Macr
           int edge_diff;
           for( i = 0 ; i < BLOCK_SIZE ; ++i )
           {             
-            SrcPtrP = *(cur_img++) + pos_x1;
+            SrcPtrP = cur_line;
             SrcPtrQ = SrcPtrP + 1;
+            cur_line += width;
             edge_diff = *SrcPtrQ - *SrcPtrP;
 
             if( iabs( edge_diff ) < Alpha )
@@ -426,7 +428,7 @@ static void EdgeLoopLumaVer(ColorPlane pl, imgpel** Img, byte Strength[16], Macr
         }
         else
         {
-          cur_img += 4;
+          cur_line += 4 * width;
         }
         Strength += 4;
       }
@@ -584,10 +586,11 @@ static void EdgeLoopLumaHor(ColorPlane pl, imgpel** Img, byte Strength[16], Macr
 /*!
  *****************************************************************************************
  * \brief
- *    Filters chroma block edge for Frame or Field coded pictures
+ *    Filters chroma block edge for Frame or Field coded pictures. The
+ *    rows are addressed through the plane stride (width).
  *****************************************************************************************
  */
-static void EdgeLoopChromaVer(imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int uv)
+static void EdgeLoopChromaVer(imgpel** Img, byte Strength[16], Macroblock *MbQ, int edge, int width, int uv)
 {
   VideoParameters *p_Vid = MbQ->p_Vid;  
 
@@ -620,8 +623,7 @@ static void EdgeLoopChromaVer(imgpel** Img, byte Strength[16], Macroblock *MbQ,
       const     byte *ClipTab = CLIP_TAB[indexA];
 
       int pel;
-      int pos_x1 = pixMB1.pos_x;
-      imgpel **cur_img = &Img[pixMB1.pos_y];
+      imgpel *cur_line = &Img[pixMB1.pos_y][pixMB1.pos_x];
 
       for( pel = 0 ; pel < PelNum ; ++pel )
       {
@@ -629,7 +631,7 @@ static void EdgeLoopChromaVer(imgpel** Img, byte Strength[16], Macroblock *MbQ,
 
         if( Strng != 0)
         {
-          imgpel *SrcPtrP = *cur_img + pos_x1;
+          imgpel *SrcPtrP = cur_line;
           imgpel *SrcPtrQ = SrcPtrP + 1;
           int edge_diff = *SrcPtrQ - *SrcPtrP;
 
@@ -661,7 +663,7 @@ static void EdgeLoopChromaVer(imgpel** Img, byte Strength[16], Macroblock *MbQ,
             }
           }
         }
-        cur_img++;
+        cur_line += width;
       }     
     }
   }
@@ -1975,12 +1975,21 @@ static int writeIPCMData(Macroblock *currMB, DataPartition*  dataPart)
   {
     int len;
     EncodingEnvironmentPtr eep = &dataPart->ee_cabac;
-    len = arienco_bits_written(eep);
-    arienco_done_encoding(currMB, eep); // This pads to byte
-    len = arienco_bits_written(eep) - len;
-    no_bits += len;
-    // Now restart the encoder
-    arienco_start_encoding(eep, dataPart->bitstream->streamBuffer, &(dataPart->bitstream->byte_pos));
+    if (eep->Eepoch)
+    {
+      // rate estimation: count about one byte for termination and alignment, the coder is restarted in the real pass only
+      eep->Eest_bits += (8 << EST_BITS_SHIFT);
+      no_bits += 8;
+    }
+    else
+    {
+      len = arienco_bits_written(eep);
+      arienco_done_encoding(currMB, eep); // This pads to byte
+      len = arienco_bits_written(eep) - len;
+      no_bits += len;
+      // Now restart the encoder
+      arienco_start_encoding(eep, dataPart->bitstream->streamBuffer, &(dataPart->bitstream->byte_pos));
+    }
   }
 
   writeIPCMByteAlign(dataPart->bitstream, &se, &(currMB->bits.mb_y_coeff));
@@ -2851,6 +2860,12 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
 
   }
 #endif
+  //--- the chosen mode is coded for real, drop the coding states (and rate estimation) of the mode decision ---
+  if (currSlice->symbol_mode == CABAC && p_Inp->rdopt)
+  {
+    clear_coding_state_journal(currSlice);
+  }
+
   //--- write non-slice termination symbol if the macroblock is not the first one in its slice ---
   if (currSlice->symbol_mode==CABAC && currMB->mbAddrX != currSlice->start_mb_nr && eos_bit)
   {
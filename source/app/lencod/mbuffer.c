@@ -3173,8 +3173,8 @@ static void process_picture_in_dpb_s(VideoParameters *p_Vid, StorablePicture *p_
   imgpel***  d_img;
   int i;
 
-  img_in.frm_stride[0] = p_pic->size_x_padded;
-  img_in.frm_stride[1] = img_in.frm_stride[2] = p_pic->size_x_cr + (p_pic->pad_size_uv_x << 1);
+  img_in.frm_stride[0] = get_plane_stride(p_pic->size_x, IMG_PAD_SIZE_X);
+  img_in.frm_stride[1] = img_in.frm_stride[2] = get_plane_stride(p_pic->size_x_cr, p_pic->pad_size_uv_x);
 
   if (p_pic->structure == FRAME)
   {
@@ -50,6 +50,15 @@ typedef struct pic_motion_params
   byte                     field_frame; //!< indicates if co_located is field or frame. Will be removed at some point
 } PicMotionParams;
 
+//! sample sum of a picture plane, kept for the weighted prediction estimation
+typedef struct wp_plane_sum
+{
+  imgpel **img;          //!< plane the sum was computed for (NULL: not computed yet)
+  int      height;       //!< rows included in the sum
+  int      width;        //!< columns included in the sum
+  int64    sum;
+} WPPlaneSum;
+
 
 //! definition a picture (field or frame)
 typedef struct storable_picture
@@ -137,6 +146,8 @@ typedef struct storable_picture
   int  bInterpolated;
   int  ref_pic_na[6];
   int  otf_flag;
+  int  otf_cache_id;           //!< identifies the interpolated content in the OTF_L3 tile cache
+  WPPlaneSum wp_sum[MAX_PLANE]; //!< sample sums of p_curr_img, imgUV[0] and imgUV[1] (see ComputeRefImgSum)
   //int  separate_colour_plane_flag;
 } StorablePicture;
 
@@ -108,6 +108,23 @@ static inline void mc_prediction(imgpel** mb_pred, imgpel* lpred, int block_size
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Copy a block between two strided planes
+ ************************************************************************
+ */
+void mc_copy_block(imgpel *dst, int dst_stride, const imgpel *src, int src_stride, int block_size_x, int block_size_y)
+{
+  int j;
+  for (j = 0; j < block_size_y; j++)
+  {
+    memcpy(dst, src, block_size_x * sizeof(imgpel));
+    dst += dst_stride;
+    src += src_stride;
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -123,15 +140,7 @@ static inline void OneComponentLumaPrediction ( VideoParameters *p_Vid, //!< vid
                                                StorablePicture *list //!< reference picture list
                                                )
 {
-  int     j;
-  imgpel *ref_line = UMVLine4X (list, pic_pix_y, pic_pix_x);
-
-  for (j = 0; j < block_size_y; j++) 
-  {
-    memcpy(mpred, ref_line, block_size_x * sizeof(imgpel));
-    ref_line += p_Vid->padded_size_x;
-    mpred += block_size_x;
-  }  
+  mc_copy_block(mpred, block_size_x, UMVLine4X (list, pic_pix_y, pic_pix_x), p_Vid->padded_size_x, block_size_x, block_size_y);
 }
 
 
@@ -428,15 +437,7 @@ void OneComponentChromaPrediction (VideoParameters *p_Vid, //!< video encoding p
                                    StorablePicture *list, //!< reference picture list
                                    int    uv)         //!< chroma component
 {
-  int     j;
-  imgpel *ref_line = UMVLine4Xcr (list, uv + 1, pic_pix_y, pic_pix_x);
-
-  for (j = 0; j < block_size_y; j++) 
-  {
-    memcpy(mpred, ref_line, block_size_x * sizeof(imgpel));
-    ref_line += p_Vid->cr_padded_size_x;
-    mpred += block_size_x;
-  }
+  mc_copy_block(mpred, block_size_x, UMVLine4Xcr (list, uv + 1, pic_pix_y, pic_pix_x), p_Vid->cr_padded_size_x, block_size_x, block_size_y);
 }
 
 /*!
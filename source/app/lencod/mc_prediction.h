@@ -19,6 +19,7 @@
 #define _MC_PREDICTION_H_
 #include "mbuffer.h"
 
+extern void mc_copy_block         ( imgpel *dst, int dst_stride, const imgpel *src, int src_stride, int block_size_x, int block_size_y );
 extern void luma_prediction       ( Macroblock* currMB, int, int, int, int, int, int[2], char *, short );
 extern void luma_prediction_bi    ( Macroblock* currMB, int, int, int, int, int, int, short, short, int );
 extern void chroma_prediction     ( Macroblock* currMB, int, int, int, int, int, int, int, int, short, short, short );
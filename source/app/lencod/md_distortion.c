@@ -27,6 +27,7 @@
 #include "macroblock.h"
 #include "mv_search.h"
 #include "md_distortion.h"
+#include "simd.h"
 
 void setupDistortion(Slice *currSlice)
 {
@@ -36,15 +37,40 @@ void setupDistortion(Slice *currSlice)
 /*!
  ***********************************************************************
  * \brief
- *    compute generic SSE
+ *    Sum of squared differences of a block. The vector path squares
+ *    and pairwise adds 8 differences at a time and accumulates in 64
+ *    bits, so it is exact for all supported bit depths.
  ***********************************************************************
  */
-int64 compute_SSE(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, int ySize, int xSize)
+static inline int64 sse_block(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, int ySize, int xSize)
 {
   int i, j;
   imgpel *lineRef, *lineSrc;
   int64 distortion = 0;
 
+#if defined(JM_SIMD)
+  if ((xSize & 0x07) == 0)
+  {
+    __m128i acc = _mm_setzero_si128();
+
+    for (j = 0; j < ySize; j++)
+    {
+      lineRef = &imgRef[j][xRef];
+      lineSrc = &imgSrc[j][xSrc];
+
+      for (i = 0; i < xSize; i += 8)
+      {
+        __m128i d  = _mm_sub_epi16(simd_load_pel8(lineRef + i), simd_load_pel8(lineSrc + i));
+        __m128i sq = _mm_madd_epi16(d, d);
+
+        acc = _mm_add_epi64(acc, _mm_cvtepu32_epi64(sq));
+        acc = _mm_add_epi64(acc, _mm_cvtepu32_epi64(_mm_srli_si128(sq, 8)));
+      }
+    }
+    return _mm_cvtsi128_si64(acc) + _mm_extract_epi64(acc, 1);
+  }
+#endif
+
   for (j = 0; j < ySize; j++)
   {
     lineRef = &imgRef[j][xRef];    
@@ -56,22 +82,20 @@ int64 compute_SSE(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, int ySiz
   return distortion;
 }
 
-distblk compute_SSE_cr(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, int ySize, int xSize)
+/*!
+ ***********************************************************************
+ * \brief
+ *    compute generic SSE
+ ***********************************************************************
+ */
+int64 compute_SSE(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, int ySize, int xSize)
 {
-  int i, j;
-  imgpel *lineRef, *lineSrc;
-  distblk distortion = 0;
-
-  for (j = 0; j < ySize; j++)
-  {
-    lineRef = &imgRef[j][xRef];    
-    lineSrc = &imgSrc[j][xSrc];
-
-    for (i = 0; i < xSize; i++)
-      distortion += iabs2( *lineRef++ - *lineSrc++ );
-  }
+  return sse_block(imgRef, imgSrc, xRef, xSrc, ySize, xSize);
+}
 
-  return dist_scale(distortion);
+distblk compute_SSE_cr(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, int ySize, int xSize)
+{
+  return dist_scale((distblk) sse_block(imgRef, imgSrc, xRef, xSrc, ySize, xSize));
 }
 
 /*!
@@ -82,20 +106,7 @@ distblk compute_SSE_cr(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, int
  */
 distblk compute_SSE16x16(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc)
 {
-  int i, j;
-  imgpel *lineRef, *lineSrc;
-  distblk distortion = 0;
-
-  for (j = 0; j < MB_BLOCK_SIZE; j++)
-  {
-    lineRef = &imgRef[j][xRef];    
-    lineSrc = &imgSrc[j][xSrc];
-
-    for (i = 0; i < MB_BLOCK_SIZE; i++)
-      distortion += iabs2( *lineRef++ - *lineSrc++ );
-  }
-
-  return dist_scale(distortion);
+  return dist_scale((distblk) sse_block(imgRef, imgSrc, xRef, xSrc, MB_BLOCK_SIZE, MB_BLOCK_SIZE));
 }
 
 distblk compute_SSE16x16_thres(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc, distblk min_cost)
@@ -126,20 +137,7 @@ distblk compute_SSE16x16_thres(imgpel **imgRef, imgpel **imgSrc, int xRef, int x
  */
 distblk compute_SSE8x8(imgpel **imgRef, imgpel **imgSrc, int xRef, int xSrc)
 {
-  int i, j;
-  imgpel *lineRef, *lineSrc;
-  distblk distortion = 0;
-
-  for (j = 0; j < BLOCK_SIZE_8x8; j++)
-  {
-    lineRef = &imgRef[j][xRef];    
-    lineSrc = &imgSrc[j][xSrc];
-
-    for (i = 0; i < BLOCK_SIZE_8x8; i++)
-      distortion += iabs2( *lineRef++ - *lineSrc++ );
-  }
-
-  return dist_scale(distortion);
+  return dist_scale((distblk) sse_block(imgRef, imgSrc, xRef, xSrc, BLOCK_SIZE_8x8, BLOCK_SIZE_8x8));
 }
 
 
@@ -0,0 +1,240 @@
+/*!
+ *************************************************************************************
+ * \file me_cache.c
+ *
+ * \brief
+ *    Motion estimation result cache.
+ *
+ *    RDPictureDecision, WPMCPrecision and the frame/field picture decision code the
+ *    same picture several times. The results of the single list block searches of
+ *    a pass are kept per structure, list, reference and partition so that later
+ *    passes of the same picture can either take them over unchanged (same
+ *    predictor, lambdas and weights) or only refine them (same reference but a
+ *    different QP, predictor or WP weights). The cost of the cached integer
+ *    vector is evaluated again with the current lambda, predictor and weights.
+ *    With the same weights only a quarter-pel refinement around the cached
+ *    vector follows, else the sub-pel search starts from the integer vector.
+ *
+ *    Each partition keeps ME_CACHE_WAYS results, so that e.g. the passes with
+ *    and without weighted prediction do not evict each other.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "me_cache.h"
+
+//! first cache slot of each block type inside a macroblock
+static const int me_cache_block_offset[8] = { 0, 0, 1, 3, 5, 9, 17, 25 };
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate the motion estimation result cache
+ ************************************************************************
+ */
+void init_me_cache(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  MECache *p_cache;
+
+  if ((p_cache = (MECache *) calloc(1, sizeof(MECache))) == NULL)
+    no_mem_exit("init_me_cache: p_cache");
+
+  p_cache->num_lists   = 6;
+  p_cache->num_refs    = imax(1, p_Vid->max_num_references);
+  p_cache->num_entries = p_Vid->FrameSizeInMbs * ME_CACHE_BLOCKS * ME_CACHE_WAYS;
+  p_cache->stamp       = 0;
+
+  if ((p_cache->entries = (MECacheEntry **) calloc(3 * p_cache->num_lists * p_cache->num_refs, sizeof(MECacheEntry *))) == NULL)
+    no_mem_exit("init_me_cache: entries");
+
+  p_Vid->p_MECache = p_cache;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the motion estimation result cache
+ ************************************************************************
+ */
+void free_me_cache(VideoParameters *p_Vid)
+{
+  MECache *p_cache = p_Vid->p_MECache;
+
+  if (p_cache != NULL)
+  {
+    int i;
+    for (i = 0; i < 3 * p_cache->num_lists * p_cache->num_refs; ++i)
+      free(p_cache->entries[i]);
+
+    free(p_cache->entries);
+    free(p_cache);
+    p_Vid->p_MECache = NULL;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Start a new source picture. Entries of older pictures are never
+ *    matched again, so nothing has to be cleared.
+ ************************************************************************
+ */
+void me_cache_new_picture(VideoParameters *p_Vid)
+{
+  if (p_Vid->p_MECache != NULL)
+    ++p_Vid->p_MECache->stamp;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns the cache set (ME_CACHE_WAYS entries) of the partition
+ *    searched by mv_block, or NULL if the search is not cached
+ ************************************************************************
+ */
+MECacheEntry *get_me_cache_entry(Macroblock *currMB, MEBlock *mv_block, int block_x, int block_y)
+{
+  MECache *p_cache = currMB->p_Vid->p_MECache;
+  int list = mv_block->list + currMB->list_offset;
+  int ref  = mv_block->ref_idx;
+  int bw   = mv_block->blocksize_x >> 2;
+  int bh   = mv_block->blocksize_y >> 2;
+  MECacheEntry **p_entries;
+
+  if (p_cache == NULL || ref >= p_cache->num_refs || list >= p_cache->num_lists)
+    return NULL;
+
+  p_entries = &p_cache->entries[(currMB->p_Slice->structure * p_cache->num_lists + list) * p_cache->num_refs + ref];
+  if (*p_entries == NULL)
+  {
+    if ((*p_entries = (MECacheEntry *) calloc(p_cache->num_entries, sizeof(MECacheEntry))) == NULL)
+      no_mem_exit("get_me_cache_entry: entries");
+  }
+
+  return *p_entries + ME_CACHE_WAYS * (currMB->mbAddrX * ME_CACHE_BLOCKS + me_cache_block_offset[mv_block->blocktype]
+    + (block_y / bh) * (4 / bw) + block_x / bw);
+}
+
+static inline int me_cache_same_weights(MECacheEntry *entry, MEBlock *mv_block)
+{
+  if (entry->apply_weights != mv_block->apply_weights)
+    return FALSE;
+
+  return (!mv_block->apply_weights || (entry->weight == mv_block->weight_luma && entry->offset == mv_block->offset_luma));
+}
+
+//! marks entry as the most recently used way of its set
+static inline void me_cache_touch(MECacheEntry *set, MECacheEntry *entry)
+{
+  int i, used = 0;
+
+  for (i = 0; i < ME_CACHE_WAYS; ++i)
+    used = imax(used, set[i].used);
+  entry->used = used + 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Checks whether a cached search result can be used for the current
+ *    search and how (see MECacheResult). The entry to use is returned in
+ *    hit. A refinement prefers a result searched with the same weights.
+ *    The counters are shared by the concurrent reference searches of
+ *    ParallelRefME.
+ ************************************************************************
+ */
+int me_cache_lookup(MECache *p_cache, MECacheEntry *set, MEBlock *mv_block, StorablePicture *ref_pic, MotionVector *pred, int *lambda_factor, MECacheEntry **hit)
+{
+  MECacheEntry *refine = NULL;
+  int i;
+
+#if defined(OPENMP)
+#pragma omp atomic
+#endif
+  ++p_cache->lookups;
+
+  for (i = 0; i < ME_CACHE_WAYS; ++i)
+  {
+    MECacheEntry *entry = &set[i];
+
+    if (entry->stamp != p_cache->stamp || entry->ref_pic != ref_pic)
+      continue;
+
+    if (me_cache_same_weights(entry, mv_block) && entry->pred.mv_x == pred->mv_x && entry->pred.mv_y == pred->mv_y
+      && entry->lambda[F_PEL] == lambda_factor[F_PEL] && entry->lambda[H_PEL] == lambda_factor[H_PEL] && entry->lambda[Q_PEL] == lambda_factor[Q_PEL])
+    {
+      me_cache_touch(set, entry);
+      *hit = entry;
+#if defined(OPENMP)
+#pragma omp atomic
+#endif
+      ++p_cache->reused;
+      return ME_CACHE_REUSE;
+    }
+
+    if (refine == NULL || me_cache_same_weights(entry, mv_block))
+      refine = entry;
+  }
+
+  *hit = refine;
+  if (refine == NULL)
+    return ME_CACHE_MISS;
+
+  me_cache_touch(set, refine);
+#if defined(OPENMP)
+#pragma omp atomic
+#endif
+  ++p_cache->refined;
+  return me_cache_same_weights(refine, mv_block) ? ME_CACHE_REFINE_QPEL : ME_CACHE_REFINE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stores the result of a block search. It replaces the result of the
+ *    same reference and weights, else a result of another picture or
+ *    reference, else the least recently used one.
+ ************************************************************************
+ */
+void me_cache_store(MECache *p_cache, MECacheEntry *set, MEBlock *mv_block, StorablePicture *ref_pic, MotionVector *pred, int *lambda_factor, MotionVector *int_mv, distblk int_cost, distblk cost)
+{
+  MECacheEntry *entry = NULL;
+  int i;
+
+  for (i = 0; i < ME_CACHE_WAYS && entry == NULL; ++i)
+  {
+    if (set[i].stamp == p_cache->stamp && set[i].ref_pic == ref_pic && me_cache_same_weights(&set[i], mv_block))
+      entry = &set[i];
+  }
+  for (i = 0; i < ME_CACHE_WAYS && entry == NULL; ++i)
+  {
+    if (set[i].stamp != p_cache->stamp || set[i].ref_pic != ref_pic)
+      entry = &set[i];
+  }
+  if (entry == NULL)
+  {
+    entry = &set[0];
+    for (i = 1; i < ME_CACHE_WAYS; ++i)
+    {
+      if (set[i].used < entry->used)
+        entry = &set[i];
+    }
+  }
+
+  me_cache_touch(set, entry);
+  entry->ref_pic = ref_pic;
+  entry->stamp   = p_cache->stamp;
+  entry->lambda[F_PEL] = lambda_factor[F_PEL];
+  entry->lambda[H_PEL] = lambda_factor[H_PEL];
+  entry->lambda[Q_PEL] = lambda_factor[Q_PEL];
+  entry->apply_weights = (short) mv_block->apply_weights;
+  entry->weight  = mv_block->weight_luma;
+  entry->offset  = mv_block->offset_luma;
+  entry->pred    = *pred;
+  entry->int_mv  = *int_mv;
+  entry->mv      = mv_block->mv[(int) mv_block->list];
+  entry->int_cost = int_cost;
+  entry->cost    = cost;
+}
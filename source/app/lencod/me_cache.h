@@ -0,0 +1,63 @@
+/*!
+ ************************************************************************
+ * \file
+ *     me_cache.h
+ *
+ * \brief
+ *    Motion estimation result cache shared by the coding passes of a picture
+ ************************************************************************
+ */
+
+#ifndef _ME_CACHE_H_
+#define _ME_CACHE_H_
+
+#include "global.h"
+
+#define ME_CACHE_BLOCKS 41  //!< partitions of all block types (1+2+2+4+8+8+16) in a macroblock
+#define ME_CACHE_WAYS    2  //!< results kept per partition, e.g. of a pass without and one with WP
+
+typedef enum
+{
+  ME_CACHE_MISS        = 0, //!< no usable result, perform a full search
+  ME_CACHE_REFINE      = 1, //!< same reference, other weights: sub-pel search from the cached integer vector
+  ME_CACHE_REFINE_QPEL = 2, //!< same reference and weights: quarter-pel refinement around the cached vector
+  ME_CACHE_REUSE       = 3  //!< identical search conditions, reuse the cached result
+} MECacheResult;
+
+typedef struct me_cache_entry
+{
+  StorablePicture *ref_pic;   //!< reference searched
+  int          stamp;         //!< picture the entry belongs to
+  int          used;          //!< order of the last use within the set of ways
+  int          lambda[3];     //!< F_PEL, H_PEL and Q_PEL lambda factors of the search
+  short        apply_weights; //!< weighted prediction used in the search
+  short        weight;        //!< luma WP weight
+  short        offset;        //!< luma WP offset
+  MotionVector pred;          //!< motion vector predictor
+  MotionVector int_mv;        //!< best motion vector of the integer search
+  MotionVector mv;            //!< best motion vector
+  distblk      int_cost;      //!< best cost after the integer search
+  distblk      cost;          //!< best cost after the sub-pel search
+} MECacheEntry;
+
+typedef struct me_cache
+{
+  MECacheEntry **entries;     //!< [(structure * num_lists + list) * num_refs + ref], ME_CACHE_WAYS per partition, allocated on first use
+  int   num_lists;
+  int   num_refs;
+  int   num_entries;
+  int   stamp;
+  int64 lookups;
+  int64 reused;
+  int64 refined;
+} MECache;
+
+extern void          init_me_cache      (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void          free_me_cache      (VideoParameters *p_Vid);
+extern void          me_cache_new_picture(VideoParameters *p_Vid);
+extern MECacheEntry *get_me_cache_entry (Macroblock *currMB, MEBlock *mv_block, int block_x, int block_y);
+extern int           me_cache_lookup    (MECache *p_cache, MECacheEntry *set, MEBlock *mv_block, StorablePicture *ref_pic, MotionVector *pred, int *lambda_factor, MECacheEntry **hit);
+extern void          me_cache_store     (MECache *p_cache, MECacheEntry *set, MEBlock *mv_block, StorablePicture *ref_pic, MotionVector *pred, int *lambda_factor, MotionVector *int_mv, distblk int_cost, distblk cost);
+
+#endif
+
@@ -24,6 +24,7 @@
 #include "refbuf.h"
 #include "mv_search.h"
 #include "me_distortion.h"
+#include "simd.h"
 
 
 //#define CHECKOVERFLOW(mcost) assert(mcost>=0)
@@ -174,6 +175,19 @@ void select_distortion(VideoParameters *p_Vid, InputParameters *p_Inp)
 */
 int HadamardSAD4x4 (short* diff)
 {
+#if defined(JM_SIMD)
+  __m128i v[4];
+  int k;
+
+  for (k = 0; k < 4; ++k)
+    v[k] = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *) &diff[4 * k]));
+
+  simd_hadamard4_pass(v, 1);
+  simd_transpose4x4_epi32(&v[0], &v[1], &v[2], &v[3]);
+  simd_hadamard4_pass(v, 1);
+
+  return ((simd_sum_abs_epi32(v, 4) + 1) >> 1);
+#else
   int k, satd = 0;
   int m[16], d[16];
 
@@ -255,6 +269,7 @@ int HadamardSAD4x4 (short* diff)
 
 
   return ((satd+1)>>1);
+#endif
 }
 
 /*!
@@ -265,6 +280,21 @@ int HadamardSAD4x4 (short* diff)
 */
 int HadamardSAD8x8 (short* diff)
 {
+#if defined(JM_SIMD)
+  __m128i v[16];
+  int k;
+
+  for (k = 0; k < 16; ++k)
+    v[k] = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *) &diff[4 * k]));
+
+  simd_hadamard8_pass(v, 2);
+  simd_hadamard8_pass(v + 1, 2);
+  simd_transpose8x8_epi32(v);
+  simd_hadamard8_pass(v, 2);
+  simd_hadamard8_pass(v + 1, 2);
+
+  return ((simd_sum_abs_epi32(v, 16) + 2) >> 2);
+#else
   int i, j, jj, sad=0;
 
   // Hadamard related arrays
@@ -338,6 +368,104 @@ int HadamardSAD8x8 (short* diff)
       sad += iabs (m2[j][i]);
 
   return ((sad+2)>>2);
+#endif
+}
+
+/*!
+************************************************************************
+* \brief
+*    SAD of a block between two strided planes. Returns as soon as the
+*    SAD of the rows processed so far exceeds max_sad, in which case the
+*    partial SAD is returned.
+************************************************************************
+*/
+int sad_block(const imgpel *src, int src_stride, const imgpel *ref, int ref_stride, int blocksize_x, int blocksize_y, int max_sad)
+{
+  int sad = 0;
+  int x, y;
+
+#if defined(JM_SIMD) && (IMGTYPE == 0)
+  // byte samples: psadbw sums the absolute differences of 8 samples per 64 bit lane
+  if ((blocksize_x & 0x0F) == 0)
+  {
+    __m128i acc = _mm_setzero_si128();
+
+    for (y = 0; y < blocksize_y; y++)
+    {
+      for (x = 0; x < blocksize_x; x += 16)
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *) (src + x)), _mm_loadu_si128((const __m128i *) (ref + x))));
+      sad = _mm_cvtsi128_si32(_mm_add_epi64(acc, _mm_unpackhi_epi64(acc, acc)));
+      if (sad > max_sad)
+        return sad;
+      src += src_stride;
+      ref += ref_stride;
+    }
+    return sad;
+  }
+  if (blocksize_x == 8)
+  {
+    __m128i acc = _mm_setzero_si128();
+
+    for (y = 0; y < blocksize_y; y++)
+    {
+      acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadl_epi64((const __m128i *) src), _mm_loadl_epi64((const __m128i *) ref)));
+      sad = _mm_cvtsi128_si32(acc);
+      if (sad > max_sad)
+        return sad;
+      src += src_stride;
+      ref += ref_stride;
+    }
+    return sad;
+  }
+#endif
+#if defined(JM_SIMD)
+  if ((blocksize_x & 0x07) == 0)
+  {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+
+    for (y = 0; y < blocksize_y; y++)
+    {
+      for (x = 0; x < blocksize_x; x += 8)
+      {
+        __m128i d = _mm_abs_epi16(_mm_sub_epi16(simd_load_pel8(src + x), simd_load_pel8(ref + x)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(d, ones));
+      }
+      sad = simd_hsum_epi32(acc);
+      if (sad > max_sad)
+        return sad;
+      src += src_stride;
+      ref += ref_stride;
+    }
+    return sad;
+  }
+  if (blocksize_x == 4)
+  {
+    __m128i acc = _mm_setzero_si128();
+
+    for (y = 0; y < blocksize_y; y++)
+    {
+      acc = _mm_add_epi32(acc, _mm_abs_epi32(_mm_sub_epi32(simd_load_pel4(src), simd_load_pel4(ref))));
+      sad = simd_hsum_epi32(acc);
+      if (sad > max_sad)
+        return sad;
+      src += src_stride;
+      ref += ref_stride;
+    }
+    return sad;
+  }
+#endif
+
+  for (y = 0; y < blocksize_y; y++)
+  {
+    for (x = 0; x < blocksize_x; x++)
+      sad += iabs(src[x] - ref[x]);
+    if (sad > max_sad)
+      return sad;
+    src += src_stride;
+    ref += ref_stride;
+  }
+  return sad;
 }
 
 /*!
@@ -351,69 +479,30 @@ distblk computeSAD(StorablePicture *ref1,
                distblk min_mcost,
                MotionVector *cand)
 {
-  int mcost = 0;
+  int mcost;
   int imin_cost = dist_down(min_mcost);
-  int y,x;
   short blocksize_x = mv_block->blocksize_x;
   short blocksize_y = mv_block->blocksize_y;
   VideoParameters *p_Vid = mv_block->p_Vid;
-  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
-#if (JM_MEM_DISTORTION)
-  int *imgpel_abs = p_Vid->imgpel_abs;
-#endif
 
-  imgpel *src_line, *ref_line;
-  src_line = mv_block->orig_pic[0];
-  ref_line = UMVLine4X (ref1, cand->mv_y, cand->mv_x);
-  for (y=0; y<blocksize_y; y++)
-  {
-    for (x = 0; x < blocksize_x; x+=4)
-    {
-#if (JM_MEM_DISTORTION)
-      mcost += imgpel_abs[ *src_line++ - *ref_line++ ];
-      mcost += imgpel_abs[ *src_line++ - *ref_line++ ];
-      mcost += imgpel_abs[ *src_line++ - *ref_line++ ];
-      mcost += imgpel_abs[ *src_line++ - *ref_line++ ];
-#else
-      mcost += iabs( *src_line++ - *ref_line++ );
-      mcost += iabs( *src_line++ - *ref_line++ );
-      mcost += iabs( *src_line++ - *ref_line++ );
-      mcost += iabs( *src_line++ - *ref_line++ );
-#endif
-    }
-    if(mcost > imin_cost) 
-      return (dist_scale_f((distblk)mcost));
-    ref_line += pad_size_x;
-  }
+  // the original block is stored contiguously, the reference with the plane stride
+  mcost = sad_block(mv_block->orig_pic[0], blocksize_x, UMVLine4X (ref1, cand->mv_y, cand->mv_x), p_Vid->padded_size_x,
+    blocksize_x, blocksize_y, imin_cost);
+  if(mcost > imin_cost) 
+    return (dist_scale_f((distblk)mcost));
+
   if ( mv_block->ChromaMEEnable ) 
   {
     // calculate chroma conribution to motion compensation error
     int blocksize_x_cr = mv_block->blocksize_cr_x;
     int blocksize_y_cr = mv_block->blocksize_cr_y;
-    int cr_pad_size_x = p_Vid->cr_padded_size_x - blocksize_x_cr;
     int k;
     int mcr_cost = 0; // chroma me cost
 
     for (k=0; k < 2; k++)
     {
-      src_line = mv_block->orig_pic[k+1];
-      ref_line = UMVLine8X_chroma ( ref1, k+1, cand->mv_y, cand->mv_x);
-      mcr_cost = 0;
-
-      for (y = 0; y < blocksize_y_cr; y++)
-      {
-        for (x = 0; x < blocksize_x_cr; x += 2)
-        {
-#if (JM_MEM_DISTORTION)
-          mcr_cost += imgpel_abs[ *src_line++ - *ref_line++ ];
-          mcr_cost += imgpel_abs[ *src_line++ - *ref_line++ ];
-#else
-          mcr_cost += iabs( *src_line++ - *ref_line++ );
-          mcr_cost += iabs( *src_line++ - *ref_line++ );
-#endif
-        }
-        ref_line += cr_pad_size_x;
-      }
+      mcr_cost = sad_block(mv_block->orig_pic[k+1], blocksize_x_cr, UMVLine8X_chroma ( ref1, k+1, cand->mv_y, cand->mv_x), p_Vid->cr_padded_size_x,
+        blocksize_x_cr, blocksize_y_cr, INT_MAX);
       mcost += mv_block->ChromaMEWeight * mcr_cost;
 
       if(mcost >imin_cost)
@@ -28,6 +28,7 @@ extern distblk distortion8x8SATD(short* diff, distblk min_cost);
 extern int HadamardSAD4x4(short* diff);
 extern int HadamardSAD8x8(short* diff);
 // SAD functions
+extern int     sad_block          (const imgpel *src, int src_stride, const imgpel *ref, int ref_stride, int blocksize_x, int blocksize_y, int max_sad);
 extern distblk computeSAD         (StorablePicture *ref1, MEBlock*, distblk, MotionVector *);
 extern distblk computeSAD16x16    (StorablePicture *ref1, MEBlock*, distblk, MotionVector *);
 extern distblk computeSAD16x8     (StorablePicture *ref1, MEBlock*, distblk, MotionVector *);
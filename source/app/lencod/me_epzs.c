@@ -61,7 +61,7 @@ EPZS_motion_estimation (Macroblock * currMB,     // <--  current Macroblock
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -429,7 +429,7 @@ EPZS_subMB_motion_estimation  (Macroblock * currMB,     // <--  current Macroblo
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -774,7 +774,7 @@ EPZS_bipred_motion_estimation (Macroblock * currMB,     // <--  Current Macroblo
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
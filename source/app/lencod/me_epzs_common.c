@@ -438,6 +438,7 @@ EPZSStructInit (Slice * currSlice)
     1) << 2 : (2 * p_Inp->search_range[p_Vid->view_id] + 1) << 2;
   p_EPZS->p_Vid = p_Vid;
   p_EPZS->BlkCount = 1;
+  p_EPZS->searcharray = searcharray;
 
   //! In this implementation we keep threshold limits fixed.
   //! However one could adapt these limits based on lagrangian
@@ -1235,7 +1236,7 @@ EPZSBlockTypePredictorsMB (Slice * currSlice, MEBlock * mv_block, SPoint * point
   int block_y   = mv_block->block_y;
   int list      = mv_block->list;
   int ref       = mv_block->ref_idx;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   MotionVector ****all_mv = currSlice->all_mv[list];
   MotionVector *cur_mv = &point[*prednum].motion;
 
@@ -1244,30 +1245,34 @@ EPZSBlockTypePredictorsMB (Slice * currSlice, MEBlock * mv_block, SPoint * point
     *cur_mv = all_mv[ref][BLOCK_PARENT[blocktype]][block_y][block_x];
 
     //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
 
     if(BLOCK_PARENT[blocktype] !=1)
     {
       cur_mv  = &point[*prednum].motion;
       *cur_mv = all_mv[ref][1][block_y][block_x];
       //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-      *prednum += (*((int *) cur_mv) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
     }
   }
 
   if (ref > 0)
   {
-    cur_mv = &point[*prednum].motion;
-    scale_mv (cur_mv, p_EPZS->mv_scale[list][ref][ref - 1], &all_mv[ref - 1][blocktype][block_y][block_x], 8);
-    //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-    *prednum += (*((int *) cur_mv) != 0);
+    // ref - 1 may still be searched by another thread
+    if (ref == 1 || !p_EPZS->concurrent_refs)
+    {
+      cur_mv = &point[*prednum].motion;
+      scale_mv (cur_mv, p_EPZS->mv_scale[list][ref][ref - 1], &all_mv[ref - 1][blocktype][block_y][block_x], 8);
+      //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
+    }
 
     if (ref > 1)
     {
       cur_mv = &point[*prednum].motion;
       scale_mv (cur_mv, p_EPZS->mv_scale[list][ref][0], &all_mv[0][blocktype][block_y][block_x], 8);
       //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-      *prednum += (*((int *) cur_mv) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
     }
   }
 }
@@ -1625,22 +1630,22 @@ EPZSBlockTypePredictors (Slice * currSlice, MEBlock *mv_block, SPoint * point, i
   *cur_mv = all_mv[ref][BLOCK_PARENT[blocktype]][block_y][block_x];
   
   //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-  *prednum += (*((int *) cur_mv) != 0);
+  *prednum += is_nonzero_mv(cur_mv);
 
   if ((ref > 0) && (currSlice->structure != FRAME))
   {
-    EPZSParameters *p_EPZS = currSlice->p_EPZS;
+    EPZSParameters *p_EPZS = mv_block->p_EPZS;
     cur_mv = &point[*prednum].motion;
     scale_mv (cur_mv, p_EPZS->mv_scale[list][ref][ref - 1], &all_mv[ref - 1][blocktype][block_y][block_x], 8);
 
     //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
     if (ref > 1)
     {
       cur_mv = &point[*prednum].motion;
       scale_mv (cur_mv, p_EPZS->mv_scale[list][ref][0], &all_mv[0][blocktype][block_y][block_x], 8);
       //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-      *prednum += (*((int *) cur_mv) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
     }
   }
 
@@ -1648,7 +1653,7 @@ EPZSBlockTypePredictors (Slice * currSlice, MEBlock *mv_block, SPoint * point, i
   *cur_mv = all_mv[ref][1][block_y][block_x];
 
   //*prednum += ((cur_mv->mv_x | cur_mv->mv_y) != 0);
-  *prednum += (*((int *) cur_mv) != 0);
+  *prednum += is_nonzero_mv(cur_mv);
 }
 
 /*!
@@ -1706,7 +1711,7 @@ EPZS_spatial_memory_predictors (EPZSParameters * p_EPZS,  //!< EPZS Parameters
   if (pic_x > 0)
   {
     *cur_mv = prd_mv[by][pic_x - bs_x];
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
     cur_mv = &point[*prednum].motion;
   }
 
@@ -1714,14 +1719,14 @@ EPZS_spatial_memory_predictors (EPZSParameters * p_EPZS,  //!< EPZS Parameters
 
   // Up predictor
   *cur_mv = prd_mv[by][pic_x];
-  *prednum += (*((int *) cur_mv) != 0);
+  *prednum += is_nonzero_mv(cur_mv);
 
   // Up-Right predictor
   if (pic_x + bs_x < img_width)
   {
     cur_mv = &point[*prednum].motion;
     *cur_mv = prd_mv[by][pic_x + bs_x];
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
   }
 #else
   int mot_scale = p_EPZS->mv_scale[list][ref][0];
@@ -1801,7 +1806,7 @@ EPZS_hierarchical_predictors (EPZSParameters * p_EPZS,  //!< EPZS Parameters
   //printf("reference poc %d %lld\n", ref_picture->poc, pHMEInfo->poc[0][list][ref]);
   // co-located
   *cur_mv = hme_mv[by][bx];
-  *prednum += (*((int *) cur_mv) != 0);
+  *prednum += is_nonzero_mv(cur_mv);
   cur_mv = &point[*prednum].motion;
 
   // All left predictors
@@ -1809,20 +1814,20 @@ EPZS_hierarchical_predictors (EPZSParameters * p_EPZS,  //!< EPZS Parameters
   {
     // left predictor
     *cur_mv = hme_mv[by][bx - 1];
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
     cur_mv = &point[*prednum].motion;
     // left above
     if (by > 0)
     {
       *cur_mv = hme_mv[by - 1][bx - 1];
-      *prednum += (*((int *) cur_mv) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
       cur_mv = &point[*prednum].motion;
     }
     // left below
     if (by + 1 < (ref_picture->size_y >> pHMEInfo->HMEBlockSizeIdx))
     {
       *cur_mv = hme_mv[by + 1][bx - 1];
-      *prednum += (*((int *) cur_mv) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
       cur_mv = &point[*prednum].motion;
     }
   }
@@ -1831,20 +1836,20 @@ EPZS_hierarchical_predictors (EPZSParameters * p_EPZS,  //!< EPZS Parameters
   {
     // right predictor
     *cur_mv = hme_mv[by][bx + 1];
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
     cur_mv = &point[*prednum].motion;
     // right above
     if (by > 0)
     {
       *cur_mv = hme_mv[by - 1][bx + 1];
-      *prednum += (*((int *) cur_mv) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
       cur_mv = &point[*prednum].motion;
     }
     // right below
     if (by + 1 < (ref_picture->size_y >> pHMEInfo->HMEBlockSizeIdx))
     {
       *cur_mv = hme_mv[by + 1][bx + 1];
-      *prednum += (*((int *) cur_mv) != 0);
+      *prednum += is_nonzero_mv(cur_mv);
       cur_mv = &point[*prednum].motion;
     }
   }
@@ -1852,14 +1857,14 @@ EPZS_hierarchical_predictors (EPZSParameters * p_EPZS,  //!< EPZS Parameters
   if (by > 0)
   {
     *cur_mv = hme_mv[by - 1][bx];
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
     cur_mv = &point[*prednum].motion;
   }
   // below
   if (by + 1 < (ref_picture->size_y >> pHMEInfo->HMEBlockSizeIdx))
   {
     *cur_mv = hme_mv[by + 1][bx];
-    *prednum += (*((int *) cur_mv) != 0);
+    *prednum += is_nonzero_mv(cur_mv);
     cur_mv = &point[*prednum].motion;
   }
 }
@@ -65,6 +65,7 @@ typedef struct epzs_params {
   VideoParameters *p_Vid;
   uint16 BlkCount;
   int   searcharray;
+  Boolean concurrent_refs;  //!< references are searched concurrently: only ref 0 results are available to the other references
 
   distblk medthres[8];
   distblk maxthres[8];
@@ -113,6 +114,19 @@ extern int   EPZSInit                  (VideoParameters *p_Vid);
 extern int   EPZSStructInit            (Slice *currSlice);
 extern void  EPZSOutputStats           (InputParameters *p_Inp, FILE * stat, short stats_file);
 extern void  EPZS_setup_engine         (Macroblock *, InputParameters *);
+/*!
+***********************************************************************
+* \brief
+*    Returns if a predictor is not the zero vector. The components are
+*    compared since an int load of the just written vector may be
+*    reordered before the store (strict aliasing).
+***********************************************************************
+*/
+static inline int is_nonzero_mv(const MotionVector *mv)
+{
+  return (mv->mv_x != 0 || mv->mv_y != 0);
+}
+
 /*!
 ***********************************************************************
 * \brief
@@ -127,7 +141,7 @@ static inline int add_predictor(MotionVector *cur_mv, MotionVector prd_mv, int m
   *cur_mv = prd_mv;
   cur_mv->mv_x = (short) rshift_rnd_sf((mvScale * cur_mv->mv_x), shift_mv);
   cur_mv->mv_y = (short) rshift_rnd_sf((mvScale * cur_mv->mv_y), shift_mv);
-  return (*((int*) cur_mv) != 0);
+  return is_nonzero_mv(cur_mv);
 }
 
 static inline void scale_mv(MotionVector *out_mv, int scale, const MotionVector *mv, int shift_mv)
@@ -49,7 +49,7 @@ EPZS_integer_motion_estimation (Macroblock * currMB,     // <--  current Macrobl
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -444,7 +444,7 @@ EPZS_integer_subMB_motion_estimation (Macroblock * currMB,    // <--  current Ma
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -802,7 +802,7 @@ EPZS_integer_bipred_motion_estimation (Macroblock * currMB,      // <--  Current
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -36,7 +36,7 @@ EPZS_sub_pel_motion_estimation ( Macroblock *currMB,      // <--  current Macrob
 {
   VideoParameters *p_Vid = currMB->p_Vid;
   Slice *currSlice = currMB->p_Slice;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
   int   pos, best_pos = 0, second_pos = 0;
   distblk mcost;
   distblk second_mcost = DISTBLK_MAX;
@@ -233,7 +233,7 @@ EPZS_sub_pel_bipred_motion_estimation (Macroblock *currMB,      // <--  current
 {
   VideoParameters *p_Vid = currMB->p_Vid;
   Slice *currSlice = currMB->p_Slice;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  EPZSParameters *p_EPZS = mv_block->p_EPZS;
 
   int   list_offset   = p_Vid->mb_data[currMB->mbAddrX].list_offset;
 
@@ -37,11 +37,21 @@
 #include "list_reorder.h"
 
 
+//! Per thread scratch of the parallel HME search
+typedef struct hme_thread_ctx
+{
+  MEBlock        mv_block;   //!< private copy of the block template (own orig_pic)
+  EPZSParameters epzs;       //!< shares the read-only EPZS tables, owns EPZSMap and predictor
+  EPZSStructure  predictor;
+  int            map_size;
+  int64          distortion; //!< distortion accumulated by this thread (wavefront mode)
+} HMEThreadCtx;
+
 // private
 static void SetMVFromUpperLevel (Slice *currSlice, int pyr_level);
 static void HMEPicMotionSearch  (Slice *currSlice, MEBlock *mv_block, int *lambda_factor);
-static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, int *lambda_factor);
-static distblk HME_EPZSIntPelBlockMotionSearch_Enh (MotionVector *pred_mv, MEBlock *mv_block, MotionVector **pic_mv, distblk **pic_mcost, int lambda_factor);
+static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, EPZSParameters *p_EPZS, int *lambda_factor);
+static distblk HME_EPZSIntPelBlockMotionSearch_Enh (MotionVector *pred_mv, MEBlock *mv_block, EPZSParameters *p_EPZS, MotionVector **pic_mv, distblk **pic_mcost, int lambda_factor);
 
 static void prepare_enc_frame_picture_hme (VideoParameters *p_Vid)
 {
@@ -93,6 +103,8 @@ void invoke_HME(VideoParameters *p_Vid, int pic_idx)
   {
     HMEResizeSearchRange(p_Vid, pHMEInfo);
   }
+  // the search windows must match the map, the search range may change between frames (RTTargetFPS)
+  CalcSearchRange(p_Vid, p_Inp, pHMEInfo->iMaxRefNum);
 
   p_Vid->ThisPOC = pHMEInfo->pTmpSlice->framepoc;
   //do HME;
@@ -497,6 +509,7 @@ void hme_init_mv_block(VideoParameters *p_Vid, MEBlock *mv_block, short blocktyp
   // Init WP parameters
   mv_block->p_Vid             = p_Vid;
   mv_block->p_Slice           = currSlice;
+  mv_block->p_EPZS            = currSlice->p_EPZS;
   mv_block->cost              = INT_MAX;
   mv_block->search_pos2       = 9;
   mv_block->search_pos4       = 9;
@@ -512,6 +525,63 @@ void hme_init_mv_block(VideoParameters *p_Vid, MEBlock *mv_block, short blocktyp
   mv_block->computeBiPredFPel = NULL;
 }
 
+#if defined(OPENMP)
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate one search context per thread. The visited point map and
+ *    the predictor list are the only EPZS data written by the HME block
+ *    search, so each thread gets its own copy of these.
+ ************************************************************************
+ */
+static void hme_alloc_thread_ctx(Slice *currSlice, MEBlock *mv_block)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  HMEInfo_t *pHMEInfo = p_Vid->pHMEInfo;
+  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  int map_size = (2 * p_Vid->p_Inp->search_range[0] + 1) << 2;
+  int i;
+
+  pHMEInfo->num_thread_ctx = omp_get_max_threads();
+  if ((pHMEInfo->p_thread_ctx = (HMEThreadCtx *) calloc(pHMEInfo->num_thread_ctx, sizeof(HMEThreadCtx))) == NULL)
+    no_mem_exit("hme_alloc_thread_ctx: p_thread_ctx");
+
+  for (i = 0; i < pHMEInfo->num_thread_ctx; ++i)
+  {
+    HMEThreadCtx *ctx = &pHMEInfo->p_thread_ctx[i];
+
+    ctx->mv_block = *mv_block;
+    get_mem2Dpel(&ctx->mv_block.orig_pic, 1, mv_block->blocksize_x * mv_block->blocksize_y);
+
+    ctx->epzs = *p_EPZS;
+    ctx->epzs.BlkCount = 0;
+    ctx->map_size = map_size;
+    get_mem2Dshort((short ***) &ctx->epzs.EPZSMap, map_size, map_size);
+
+    ctx->predictor = *p_EPZS->predictor;
+    if ((ctx->predictor.point = (SPoint *) calloc(p_EPZS->predictor->searchPoints, sizeof(SPoint))) == NULL)
+      no_mem_exit("hme_alloc_thread_ctx: predictor");
+    ctx->epzs.predictor = &ctx->predictor;
+  }
+}
+
+static void hme_free_thread_ctx(HMEInfo_t *pHMEInfo)
+{
+  int i;
+
+  for (i = 0; i < pHMEInfo->num_thread_ctx; ++i)
+  {
+    HMEThreadCtx *ctx = &pHMEInfo->p_thread_ctx[i];
+    free_mv_block(&ctx->mv_block);
+    free_mem2Dshort((short **) ctx->epzs.EPZSMap);
+    free(ctx->predictor.point);
+  }
+  free(pHMEInfo->p_thread_ctx);
+  pHMEInfo->p_thread_ctx = NULL;
+  pHMEInfo->num_thread_ctx = 0;
+}
+#endif
+
 //do HME over all levels;
 void HMESearch(Slice *currSlice)
 {
@@ -535,10 +605,16 @@ void HMESearch(Slice *currSlice)
   SetMELambda(p_Vid, lambda_factor);  
 
   hme_init_mv_block(p_Vid, &mv_block, (short) blocktype);
+#if defined(OPENMP)
+  hme_alloc_thread_ctx(currSlice, &mv_block);
+#endif
 
   // Motion estimation for current picture 
   HMEPicMotionSearch (currSlice, &mv_block, lambda_factor);
 
+#if defined(OPENMP)
+  hme_free_thread_ctx(pHMEInfo);
+#endif
   free_mv_block(&mv_block);
 
 #if GET_METIME
@@ -838,15 +914,67 @@ void hme_SetSearchRange(MEBlock *mv_block, MotionVector *mv)
     }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Search one 8x8 block of the current pyramid level
+ ************************************************************************
+ */
+static distblk hme_block_search(Slice *currSlice, MEBlock *mv_block, EPZSParameters *p_EPZS, int *lambda_factor, int list, int ref, int bx, int by)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  HMEInfo_t *pHMEInfo = p_Vid->pHMEInfo;
+  int pyr_level = mv_block->hme_level;
+  int pic_size_x = pHMEInfo->iImageWidth  >> pyr_level;
+
+  mv_block->list = (char) list;
+  mv_block->ref_idx = (char) ref;
+
+  //set position;
+  mv_block->pos_x2 = (short) bx;
+  mv_block->pos_y2 = (short) by;
+  mv_block->pos_x = (short) (bx << 3);
+  mv_block->pos_y = (short) (by << 3);
+  mv_block->pos_x_padded = (short) (mv_block->pos_x << 2); // + IMG_PAD_SIZE_X_TIMES4;
+  mv_block->pos_y_padded = (short) (mv_block->pos_y << 2); // + IMG_PAD_SIZE_Y_TIMES4;
+  hme_get_neighbors(mv_block->block, bx, by, (pic_size_x>>3));
+
+  hme_get_original_block(pHMEInfo, pyr_level, mv_block);
+
+  PrepareMEParams(p_Vid->currentSlice, mv_block, FALSE, list, ref);
+
+  HMESetSearchRange(pHMEInfo->p_HMESW + ref, pyr_level, &(mv_block->searchRange), pHMEInfo->p_HMESWMin + ref);
+
+  return HMEBlockMotionSearch(pHMEInfo->p_hme_mv[pyr_level][list][ref], pHMEInfo->p_hme_mcost[pyr_level][list][ref], 
+    pHMEInfo->p_hme_mdist[pyr_level][list][ref], mv_block, p_EPZS, lambda_factor);
+}
+
+#if defined(OPENMP)
+/*!
+ ************************************************************************
+ * \brief
+ *    Fetch the search context of the calling thread. The visited point
+ *    map is cleared before its stamp wraps around, so that results do
+ *    not depend on how blocks were distributed among threads.
+ ************************************************************************
+ */
+static inline HMEThreadCtx *hme_thread_ctx(HMEInfo_t *pHMEInfo)
+{
+  HMEThreadCtx *ctx = &pHMEInfo->p_thread_ctx[omp_get_thread_num()];
+
+  if (ctx->epzs.BlkCount == 0xFFFF)
+  {
+    memset(ctx->epzs.EPZSMap[0], 0, ctx->map_size * ctx->map_size * sizeof(uint16));
+    ctx->epzs.BlkCount = 0;
+  }
+  return ctx;
+}
+#endif
+
 void HMELevelMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_factor)
 {
   VideoParameters *p_Vid = currSlice->p_Vid;
   HMEInfo_t *pHMEInfo = p_Vid->pHMEInfo;
-  distblk **p_pic_mcost; 
-  MotionVector **p_pic_mv;
-  distblk **p_pic_mdist; 
-  SearchWindow *currPicSW = pHMEInfo->p_HMESW;
-  SearchWindow *currPicSWMin = pHMEInfo->p_HMESWMin;
 
   int pyr_level = mv_block->hme_level;
 
@@ -866,52 +994,99 @@ void HMELevelMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_facto
 
   pic_size_x = pHMEInfo->iImageWidth  >> pyr_level;
   pic_size_y = pHMEInfo->iImageHeight >> pyr_level;
-  
+
+#if defined(OPENMP)
+  {
+    int blk_x = pic_size_x >> 3;
+    int blk_y = pic_size_y >> 3;
+    int num_tasks = currSlice->listXsize[0] + ((numlists > 1) ? currSlice->listXsize[1] : 0);
+    int task, i;
+
+    // copy the level geometry to the thread contexts
+    for (i = 0; i < pHMEInfo->num_thread_ctx; ++i)
+    {
+      MEBlock *ctx_block = &pHMEInfo->p_thread_ctx[i].mv_block;
+      ctx_block->hme_level          = mv_block->hme_level;
+      ctx_block->hme_ref_size_x_pad = mv_block->hme_ref_size_x_pad;
+      ctx_block->hme_ref_size_y_pad = mv_block->hme_ref_size_y_pad;
+      ctx_block->hme_ref_size_x_max = mv_block->hme_ref_size_x_max;
+      ctx_block->hme_ref_size_y_max = mv_block->hme_ref_size_y_max;
+    }
+
+    if (num_tasks >= pHMEInfo->num_thread_ctx)
+    {
+      // enough references to keep all threads busy: one reference per thread, raster order
+#pragma omp parallel for schedule(dynamic, 1) private(list, ref, bx, by)
+      for (task = 0; task < num_tasks; ++task)
+      {
+        HMEThreadCtx *ctx;
+        int64 distortion = 0;
+
+        list = (task < currSlice->listXsize[0]) ? 0 : 1;
+        ref  = task - list * currSlice->listXsize[0];
+        for(by = 0; by < blk_y; by++)
+        {
+          for(bx = 0; bx < blk_x; bx++)
+          {
+            ctx = hme_thread_ctx(pHMEInfo);
+            distortion += hme_block_search(currSlice, &ctx->mv_block, &ctx->epzs, lambda_factor, list, ref, bx, by);
+          }
+        }
+        pHMEInfo->hme_distortion[pyr_level][list][ref] = distortion;
+      }
+    }
+    else
+    {
+      // few references: rows of each reference in wavefront order. A block
+      // depends on its left, top-left, top and top-right neighbours, so all
+      // blocks on the diagonal bx + 2 * by = d can be searched concurrently.
+      int diag, num_diag = blk_x + 2 * (blk_y - 1);
+
+      for (task = 0; task < num_tasks; ++task)
+      {
+        list = (task < currSlice->listXsize[0]) ? 0 : 1;
+        ref  = task - list * currSlice->listXsize[0];
+
+        for (i = 0; i < pHMEInfo->num_thread_ctx; ++i)
+          pHMEInfo->p_thread_ctx[i].distortion = 0;
+
+        for (diag = 0; diag < num_diag; diag++)
+        {
+          int row_last  = imin(blk_y, (diag >> 1) + 1);
+          int row_start = (diag < blk_x) ? 0 : ((diag - blk_x) >> 1) + 1;
+          int row;
+
+#pragma omp parallel for
+          for (row = row_start; row < row_last; row++)
+          {
+            HMEThreadCtx *ctx = hme_thread_ctx(pHMEInfo);
+            ctx->distortion += hme_block_search(currSlice, &ctx->mv_block, &ctx->epzs, lambda_factor, list, ref, diag - 2 * row, row);
+          }
+        }
+
+        for (i = 0; i < pHMEInfo->num_thread_ctx; ++i)
+          pHMEInfo->hme_distortion[pyr_level][list][ref] += pHMEInfo->p_thread_ctx[i].distortion;
+      }
+    }
+  }
+#else
   for (list = 0; list < numlists; list++)
   {
-    //----- set arrays -----
-    mv_block->list = (char) list;
     // changed order since ideally we could use other reference
     // results to optimize other references.
     // Otherwise, some operations could be avoided as was in the original code.
     for (ref=0; ref < currSlice->listXsize[list+0]; ref++) 
     {
-       mv_block->ref_idx = (char) ref;
        for(by=0; by<(pic_size_y>>3); by++)
        {
          for(bx=0; bx<(pic_size_x>>3); bx++)
          {
-          //set position;
-          mv_block->pos_x2 = (short) bx;
-          mv_block->pos_y2 = (short) by;
-          mv_block->pos_x = (short) (bx << 3);
-          mv_block->pos_y = (short) (by << 3);
-          mv_block->pos_x_padded = (short) (mv_block->pos_x << 2); // + IMG_PAD_SIZE_X_TIMES4;
-          mv_block->pos_y_padded = (short) (mv_block->pos_y << 2); // + IMG_PAD_SIZE_Y_TIMES4;
-          hme_get_neighbors(mv_block->block, bx, by, (pic_size_x>>3));
-
-          hme_get_original_block(pHMEInfo, pyr_level, mv_block);
-
-
-          PrepareMEParams(p_Vid->currentSlice, mv_block, FALSE, list, ref);
-
-          p_pic_mv    = pHMEInfo->p_hme_mv[pyr_level][list][ref];
-          p_pic_mcost = pHMEInfo->p_hme_mcost[pyr_level][list][ref];
-          p_pic_mdist = pHMEInfo->p_hme_mdist[pyr_level][list][ref];
-
-
-          HMESetSearchRange(currPicSW+ref, pyr_level, &(mv_block->searchRange), currPicSWMin+ref);
-
-          pHMEInfo->hme_distortion[pyr_level][list][ref] += HMEBlockMotionSearch(p_pic_mv, p_pic_mcost, p_pic_mdist, mv_block, lambda_factor);
+          pHMEInfo->hme_distortion[pyr_level][list][ref] += hme_block_search(currSlice, mv_block, currSlice->p_EPZS, lambda_factor, list, ref, bx, by);
         }
       }
     }
   }
-  
-//for (list = 0; list < numlists; list++)
-  //   for (ref=0; ref < currSlice->listXsize[list+0]; ref++) 
-    //    printf(" level %d list %d ref %d distortion %lld\n", pyr_level, list, ref, pHMEInfo->hme_distortion[pyr_level][list][ref]);
-
+#endif
 }
 
 /*******************************************************************
@@ -941,7 +1116,7 @@ static void HMEPicMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_
      SetMVFromUpperLevel(currSlice, pyr_level);
      
      mv_block->hme_level = (short) pyr_level;
-     mv_block->hme_ref_size_x_pad = pic_size_x+IMG_PAD_SIZE_X*2;
+     mv_block->hme_ref_size_x_pad = get_plane_stride(pic_size_x, IMG_PAD_SIZE_X);
      mv_block->hme_ref_size_y_pad = pic_size_y+IMG_PAD_SIZE_Y*2;
      mv_block->hme_ref_size_x_max = pic_size_x+IMG_PAD_SIZE_X-mv_block->blocksize_x;
      mv_block->hme_ref_size_y_max = pic_size_y+IMG_PAD_SIZE_Y-mv_block->blocksize_y;
@@ -951,7 +1126,7 @@ static void HMEPicMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_
   }
 }
 
-static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, int *lambda_factor)
+static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, EPZSParameters *p_EPZS, int *lambda_factor)
 {
   VideoParameters *p_Vid = mv_block->p_Vid;
   int list = mv_block->list;
@@ -969,7 +1144,7 @@ static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mco
   mv->mv_y = ((pred.mv_y+1)>>2)<<2;
 
   //do integer search;
-  min_mcost = HME_EPZSIntPelBlockMotionSearch_Enh(&pred, mv_block, p_pic_mv, p_pic_mcost, lambda_factor[F_PEL] / 2);
+  min_mcost = HME_EPZSIntPelBlockMotionSearch_Enh(&pred, mv_block, p_EPZS, p_pic_mv, p_pic_mcost, lambda_factor[F_PEL] / 2);
 
   //set the cost and mv;
   p_pic_mv[by][bx] = *mv;
@@ -1126,6 +1301,7 @@ static distblk                             //  ==> minimum motion cost after sea
 HME_EPZSIntPelBlockMotionSearch_Enh (
                                      MotionVector * pred_mv,  // <--  motion vector predictor in sub-pel units
                                      MEBlock * mv_block,      // <--  motion vector information
+                                     EPZSParameters *p_EPZS,  // <--  EPZS state (visited map and predictor list are written)
                                      MotionVector **pic_mv,
                                      distblk **pic_mcost,
                                      int lambda_factor        // <--  lagrangian parameter for determining motion cost
@@ -1134,7 +1310,6 @@ HME_EPZSIntPelBlockMotionSearch_Enh (
   VideoParameters *p_Vid = mv_block->p_Vid;
   Slice *currSlice = p_Vid->currentSlice;
   InputParameters *p_Inp = p_Vid->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
 
   int blocktype = mv_block->blocktype;
 
@@ -105,6 +105,10 @@ typedef struct hme_info
   int hme_ref_pic_removal_flag[2][MAX_REFERENCE_PICTURES];
   int hme_ref_pic_removal_cnt[2];
 
+  // parallel search (OPENMP builds)
+  struct hme_thread_ctx *p_thread_ctx; //!< one search context per thread
+  int num_thread_ctx;
+
   //function;
   distblk (*pf_computeSAD8x8_hme)(StorablePicture *ref1,
                                   MEBlock *mv_block,
@@ -149,6 +153,7 @@ extern void FreeHMEInfo   (VideoParameters *p_Vid);
 extern void SetMELambda(VideoParameters *p_Vid, int *lambda_mf);
 extern void HMEInitFrame  (VideoParameters *p_Vid, HMEInfo_t *pHMEInfo);
 extern void HMEResizeSearchRange(VideoParameters *p_Vid, HMEInfo_t *pHMEInfo);
+extern void CalcSearchRange(VideoParameters *p_Vid, InputParameters *p_Inp, int iMaxRefNum);
 extern void HMEStoreInfo  (VideoParameters *p_Vid, HMEInfo_t *pHMEInfo);
 extern void HMERestoreInfo(VideoParameters *p_Vid, HMEInfo_t *pHMEInfo);
 extern void HMESearch     (Slice *currSlice);
@@ -51,6 +51,7 @@
 #include "me_fullsearch.h"
 #include "me_umhex.h"
 #include "me_umhexsmp.h"
+#include "me_cache.h"
 #include "rdoq.h"
 
 
@@ -716,6 +717,7 @@ void init_mv_block(Macroblock *currMB, MEBlock *mv_block, short blocktype, int l
   // Init WP parameters
   mv_block->p_Vid             = p_Vid;
   mv_block->p_Slice           = currSlice;
+  mv_block->p_EPZS            = currSlice->p_EPZS;
   mv_block->cost              = INT_MAX;
   mv_block->search_pos2       = 9;
   mv_block->search_pos4       = 9;
@@ -885,7 +887,13 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
 
   MotionVector **all_mv = &currSlice->all_mv[list][ref][blocktype][block_y];
 
-  distblk *prevSad = (p_Inp->SearchMode[p_Vid->view_id] == EPZS)? currSlice->p_EPZS->distortion[list + currMB->list_offset][blocktype - 1]: NULL;
+  distblk *prevSad = (p_Inp->SearchMode[p_Vid->view_id] == EPZS)? mv_block->p_EPZS->distortion[list + currMB->list_offset][blocktype - 1]: NULL;
+
+  StorablePicture *ref_picture = currSlice->listX[list + currMB->list_offset][ref];
+  MECacheEntry *cache_set = NULL, *cache_entry = NULL;
+  int cache_result = ME_CACHE_MISS;
+  MotionVector int_mv;
+  distblk int_mcost;
 
   get_neighbors(currMB, mv_block->block, mb_x, mb_y, bsx);
 
@@ -956,23 +964,79 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   // valid search range limits could be precomputed once during the initialization process
   clip_mv_range(p_Vid, 0, mv, Q_PEL);
 
-  //--- perform motion search ---
-  min_mcost = currMB->IntPelME (currMB, &pred, mv_block, min_mcost, lambda_factor[F_PEL]);
+  //--- look for the result of an earlier coding pass of this picture ---
+  if (p_Vid->p_MECache != NULL && prevSad != NULL && (cache_set = get_me_cache_entry(currMB, mv_block, block_x, block_y)) != NULL)
+    cache_result = me_cache_lookup(p_Vid->p_MECache, cache_set, mv_block, ref_picture, &pred, lambda_factor, &cache_entry);
+
+  if (cache_result == ME_CACHE_REUSE)
+  {
+    min_mcost = cache_entry->int_cost;
+    *mv = cache_entry->int_mv;
+  }
+  else if (cache_result != ME_CACHE_MISS)
+  {
+    // same reference: cost of the cached integer vector with the current lambda, predictor and weights
+    MotionVector cand, pred_pad = pad_MVs (pred, mv_block);
+
+    *mv = cache_entry->int_mv;
+    clip_mv_range(p_Vid, 0, mv, Q_PEL);
+    cand = pad_MVs (*mv, mv_block);
+    min_mcost = mv_cost (p_Vid, lambda_factor[F_PEL], &cand, &pred_pad);
+    min_mcost += mv_block->computePredFPel (ref_picture, mv_block, DISTBLK_MAX - min_mcost, &cand);
+  }
+  else
+  {
+    //--- perform motion search ---
+    min_mcost = currMB->IntPelME (currMB, &pred, mv_block, min_mcost, lambda_factor[F_PEL]);
+  }
+
+  if (cache_result != ME_CACHE_MISS && (ref == 0 || prevSad[pic_pix_x >> 2] > min_mcost))
+    prevSad[pic_pix_x >> 2] = min_mcost;
+  int_mv    = *mv;
+  int_mcost = min_mcost;
 
   //==============================
   //=====   SUB-PEL SEARCH   =====
   //============================== 
   mv_block->ChromaMEEnable = (p_Inp->ChromaMEEnable == ME_YUV_FP_SP ) ? TRUE : FALSE; // set it externally
 
-  if (!p_Inp->DisableSubpelME[p_Vid->view_id])
+  if (cache_result == ME_CACHE_REUSE)
+  {
+    *mv = cache_entry->mv;
+    min_mcost = cache_entry->cost;
+  }
+  else if (!p_Inp->DisableSubpelME[p_Vid->view_id])
   {
     if (p_Inp->SearchMode[p_Vid->view_id] != EPZS || (ref == 0 || currSlice->structure != FRAME || (ref > 0 && min_mcost < 3.5 * prevSad[pic_pix_x >> 2])))
     {
-      if ( !p_Vid->start_me_refinement_hp )
+      if (cache_result == ME_CACHE_REFINE_QPEL)
       {
-        min_mcost = max_value;
+        // same weights: the cached vector only moves by a quarter pel for the new lambda or predictor
+        int search_pos2 = mv_block->search_pos2;
+
+        *mv = cache_entry->mv;
+        if ( !p_Vid->start_me_refinement_hp )
+        {
+          min_mcost = max_value;
+        }
+        else
+        {
+          MotionVector cand = pad_MVs (*mv, mv_block), pred_pad = pad_MVs (pred, mv_block);
+          min_mcost = mv_cost (p_Vid, lambda_factor[H_PEL], &cand, &pred_pad);
+          min_mcost += mv_block->computePredHPel (ref_picture, mv_block, DISTBLK_MAX - min_mcost, &cand);
+        }
+        mv_block->search_pos2 = 1;
+        min_mcost =  currMB->SubPelME (currMB, &pred, mv_block, min_mcost, lambda_factor);
+        mv_block->search_pos2 = search_pos2;
+      }
+      else
+      {
+        if ( !p_Vid->start_me_refinement_hp )
+        {
+          min_mcost = max_value;
+        }
+        min_mcost =  currMB->SubPelME (currMB, &pred, mv_block, min_mcost, lambda_factor);
       }
-      min_mcost =  currMB->SubPelME (currMB, &pred, mv_block, min_mcost, lambda_factor);
     }
   }
 
@@ -980,6 +1044,9 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   // better solution is to modify search window appropriately
   clip_mv_range(p_Vid, 0, mv, Q_PEL);
 
+  if (cache_set != NULL && cache_result != ME_CACHE_REUSE)
+    me_cache_store(p_Vid->p_MECache, cache_set, mv_block, ref_picture, &pred, lambda_factor, &int_mv, int_mcost, min_mcost);
+
   if (!p_Inp->rdopt)
   {
     // Get the skip mode cost
@@ -1555,6 +1622,185 @@ distblk GetDirectCostMB (Macroblock *currMB)
   return cost;
 }
 
+#if defined(OPENMP)
+//! Per thread scratch of the concurrent reference search (ParallelRefME)
+typedef struct ref_me_thread_ctx
+{
+  EPZSParameters epzs;       //!< shares the read-only EPZS tables, owns EPZSMap, predictor and distortion
+  EPZSStructure  predictor;
+  int            row_size;   //!< entries of a distortion row
+} RefMEThreadCtx;
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate one EPZS search context per thread for the concurrent
+ *    reference search. Besides the visited point map and the predictor
+ *    list, the distortion rows are private: a reference only sees the
+ *    distortion of reference 0, whatever thread searches it.
+ ************************************************************************
+ */
+void init_ref_me_threads(Slice *currSlice)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  int max_list_number = p_Vid->mb_aff_frame_flag ? 6 : 2;
+  int i;
+
+  if (p_EPZS == NULL)
+    return;
+
+  currSlice->num_RefMECtx = omp_get_max_threads();
+  if ((currSlice->p_RefMECtx = (RefMEThreadCtx *) calloc(currSlice->num_RefMECtx, sizeof(RefMEThreadCtx))) == NULL)
+    no_mem_exit("init_ref_me_threads: p_RefMECtx");
+
+  for (i = 0; i < currSlice->num_RefMECtx; ++i)
+  {
+    RefMEThreadCtx *ctx = &currSlice->p_RefMECtx[i];
+
+    ctx->epzs = *p_EPZS;
+    ctx->epzs.BlkCount = 0;
+    ctx->epzs.concurrent_refs = TRUE;
+    get_mem2Dshort((short ***) &ctx->epzs.EPZSMap, p_EPZS->searcharray, p_EPZS->searcharray);
+
+    ctx->row_size = (p_Vid->width + MB_BLOCK_SIZE) / BLOCK_SIZE;
+    get_mem3Ddistblk(&ctx->epzs.distortion, max_list_number, 7, ctx->row_size);
+
+    ctx->predictor = *p_EPZS->predictor;
+    if ((ctx->predictor.point = (SPoint *) calloc(p_EPZS->predictor->searchPoints, sizeof(SPoint))) == NULL)
+      no_mem_exit("init_ref_me_threads: predictor");
+    ctx->epzs.predictor = &ctx->predictor;
+  }
+}
+
+void free_ref_me_threads(Slice *currSlice)
+{
+  int i;
+
+  for (i = 0; i < currSlice->num_RefMECtx; ++i)
+  {
+    RefMEThreadCtx *ctx = &currSlice->p_RefMECtx[i];
+    free_mem2Dshort((short **) ctx->epzs.EPZSMap);
+    free_mem3Ddistblk(ctx->epzs.distortion);
+    free(ctx->predictor.point);
+  }
+  free(currSlice->p_RefMECtx);
+  currSlice->p_RefMECtx = NULL;
+  currSlice->num_RefMECtx = 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Fetch the search context of the calling thread. The visited point
+ *    map is cleared before its stamp wraps around, so that results do
+ *    not depend on how references were distributed among threads.
+ ************************************************************************
+ */
+static inline RefMEThreadCtx *ref_me_thread_ctx(Slice *currSlice)
+{
+  RefMEThreadCtx *ctx = &currSlice->p_RefMECtx[omp_get_thread_num()];
+
+  if (ctx->epzs.BlkCount == 0xFFFF)
+  {
+    memset(ctx->epzs.EPZSMap[0], 0, ctx->epzs.searcharray * ctx->epzs.searcharray * sizeof(uint16));
+    ctx->epzs.BlkCount = 0;
+  }
+  return ctx;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Motion search of a partition with concurrent references
+ *    (ParallelRefME). Reference 0 of each list is searched first, as it
+ *    seeds the bi-predictive search and the early termination of the
+ *    other references. The other references of both lists are then
+ *    searched by the worker threads. They see the state left by
+ *    reference 0 only, and their distortions are merged in reference
+ *    order, so the result does not depend on the number of threads.
+ ************************************************************************
+ */
+static void PartitionMotionSearchRefs (Macroblock *currMB, MEBlock *mv_block, int blocktype, int block8x8, int *lambda_factor)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  InputParameters *p_Inp = currMB->p_Inp;
+  Slice *currSlice = currMB->p_Slice;
+  EPZSParameters *p_EPZS = (p_Inp->SearchMode[p_Vid->view_id] == EPZS) ? currSlice->p_EPZS : NULL;
+  PicMotionParams **motion = p_Vid->enc_picture->mv_info;
+  short by = by0[blocktype][block8x8];
+  short bx = bx0[blocktype][block8x8];
+  short step_h = (part_size[blocktype][0]);
+  short step_v = (part_size[blocktype][1]);
+  short pic_block_y = currMB->block_y + by;
+  short pic_block_x = currMB->block_x + bx;
+  int   list_offset = currMB->list_offset;
+  int   numlists    = (currSlice->slice_type == B_SLICE) ? 2 : 1;
+  int   num_tasks[2] = { 0, 0 };
+  distblk ref_sad[2][MAX_REFERENCE_PICTURES];
+  int   list, ref, task;
+
+  //===== REFERENCE 0 OF EACH LIST =====
+  for (list = 0; list < numlists; list++)
+  {
+    if (currSlice->listXsize[list + list_offset] == 0)
+      continue;
+
+    mv_block->list    = (char) list;
+    mv_block->ref_idx = 0;
+    get_search_range(mv_block, p_Inp, 0, blocktype);
+    p_Vid->motion_cost[blocktype][list][0][block8x8] = BlockMotionSearch (currMB, mv_block, bx<<2, by<<2, lambda_factor);
+    set_me_parameters(motion, &currSlice->all_mv[list][0][blocktype][by][bx], list, 0, step_h, step_v, pic_block_y, pic_block_x);
+
+    num_tasks[list] = currSlice->listXsize[list + list_offset] - 1;
+  }
+
+  //===== OTHER REFERENCES OF BOTH LISTS =====
+#pragma omp parallel for schedule(dynamic, 1) private(list, ref)
+  for (task = 0; task < num_tasks[0] + num_tasks[1]; ++task)
+  {
+    MEBlock ref_block = *mv_block;
+
+    list = (task < num_tasks[0]) ? 0 : 1;
+    ref  = task - list * num_tasks[0] + 1;
+
+    ref_block.list    = (char) list;
+    ref_block.ref_idx = (char) ref;
+    if (p_EPZS != NULL)
+    {
+      RefMEThreadCtx *ctx = ref_me_thread_ctx(currSlice);
+      distblk *sad_row = ctx->epzs.distortion[list + list_offset][blocktype - 1];
+
+      memcpy(sad_row, p_EPZS->distortion[list + list_offset][blocktype - 1], ctx->row_size * sizeof(distblk));
+      ref_block.p_EPZS = &ctx->epzs;
+      get_search_range(&ref_block, p_Inp, (short) ref, blocktype);
+      p_Vid->motion_cost[blocktype][list][ref][block8x8] = BlockMotionSearch (currMB, &ref_block, bx<<2, by<<2, lambda_factor);
+      ref_sad[list][ref] = sad_row[ref_block.pos_x2];
+    }
+    else
+    {
+      get_search_range(&ref_block, p_Inp, (short) ref, blocktype);
+      p_Vid->motion_cost[blocktype][list][ref][block8x8] = BlockMotionSearch (currMB, &ref_block, bx<<2, by<<2, lambda_factor);
+    }
+  }
+
+  //--- set motion vectors, reference frames and the smallest distortion in reference order ---
+  for (list = 0; list < numlists; list++)
+  {
+    for (ref = 1; ref <= num_tasks[list]; ref++)
+    {
+      if (p_EPZS != NULL)
+      {
+        distblk *prevSad = &p_EPZS->distortion[list + list_offset][blocktype - 1][mv_block->pos_x2];
+        if (*prevSad > ref_sad[list][ref])
+          *prevSad = ref_sad[list][ref];
+      }
+      set_me_parameters(motion, &currSlice->all_mv[list][ref][blocktype][by][bx], list, (char) ref, step_h, step_v, pic_block_y, pic_block_x);
+    }
+  }
+}
+#endif
+
 /*!
  ************************************************************************
  * \brief
@@ -1641,6 +1887,13 @@ void PartitionMotionSearch (Macroblock *currMB,
 
     get_original_block(p_Vid, &mv_block);
 
+#if defined(OPENMP)
+    if (p_Inp->ParallelRefME && (p_Inp->SearchMode[p_Vid->view_id] == EPZS || p_Inp->SearchMode[p_Vid->view_id] == FULL_SEARCH))
+    {
+      PartitionMotionSearchRefs (currMB, &mv_block, blocktype, block8x8, lambda_factor);
+    }
+    else
+#endif
     //--- motion search for block ---   
     {
       //===== LOOP OVER REFERENCE FRAMES =====
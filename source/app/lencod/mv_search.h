@@ -33,6 +33,10 @@ extern void init_motion_search_module  (VideoParameters *p_Vid, InputParameters
 extern void clear_motion_search_module (VideoParameters *p_Vid, InputParameters *p_Inp);
 
 extern void  PartitionMotionSearch    (Macroblock *currMB, int, int, int*);
+#if defined(OPENMP)
+extern void  init_ref_me_threads      (Slice *currSlice);
+extern void  free_ref_me_threads      (Slice *currSlice);
+#endif
 extern void  SubPartitionMotionSearch (Macroblock *currMB, int, int, int*);
 
 extern void  Get_Direct_MV_Spatial_MBAFF  (Macroblock *currMB);
@@ -0,0 +1,211 @@
+/*!
+ *************************************************************************************
+ * \file otf_cache.c
+ *
+ * \brief
+ *    LRU cache of interpolated reference tiles (OTF_L3).
+ *
+ *    Only the full pel reference planes are stored. Sub-pel samples are
+ *    interpolated on demand in OTF_TILE_SIZE x OTF_TILE_SIZE tiles, one tile per
+ *    sub-pel phase, and kept in a fixed size pool that recycles the least
+ *    recently used tile. Motion search revisits the same neighbourhood many
+ *    times, so most block requests are served by a copy from the pool.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "otf_cache.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hash of a tile key
+ ************************************************************************
+ */
+static inline int otf_tile_hash(OTFTileCache *p_cache, imgpel **plane, int pic_id, int phase, int tile_x, int tile_y)
+{
+  unsigned int h = (unsigned int) (((size_t) plane) >> 4);
+
+  h = (h ^ (unsigned int) pic_id) * 0x9E3779B1u;
+  h = (h ^ (unsigned int) ((phase << 24) ^ (tile_y << 12) ^ tile_x)) * 0x85EBCA6Bu;
+  h ^= h >> 15;
+
+  return (int) (h & (unsigned int) p_cache->hash_mask);
+}
+
+static inline void lru_unlink(OTFTileCache *p_cache, int idx)
+{
+  OTFTile *tile = &p_cache->tiles[idx];
+
+  if (tile->lru_prev >= 0)
+    p_cache->tiles[tile->lru_prev].lru_next = tile->lru_next;
+  else
+    p_cache->lru_head = tile->lru_next;
+
+  if (tile->lru_next >= 0)
+    p_cache->tiles[tile->lru_next].lru_prev = tile->lru_prev;
+  else
+    p_cache->lru_tail = tile->lru_prev;
+}
+
+static inline void lru_push_front(OTFTileCache *p_cache, int idx)
+{
+  OTFTile *tile = &p_cache->tiles[idx];
+
+  tile->lru_prev = -1;
+  tile->lru_next = p_cache->lru_head;
+  if (p_cache->lru_head >= 0)
+    p_cache->tiles[p_cache->lru_head].lru_prev = idx;
+  else
+    p_cache->lru_tail = idx;
+  p_cache->lru_head = idx;
+}
+
+static void hash_remove(OTFTileCache *p_cache, int idx)
+{
+  OTFTile *tile = &p_cache->tiles[idx];
+  int *link = &p_cache->hash_head[otf_tile_hash(p_cache, tile->plane, tile->pic_id, tile->phase, tile->tile_x, tile->tile_y)];
+
+  while (*link >= 0)
+  {
+    if (*link == idx)
+    {
+      *link = tile->hash_next;
+      return;
+    }
+    link = &p_cache->tiles[*link].hash_next;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate the tile cache
+ ************************************************************************
+ */
+void init_otf_cache(VideoParameters *p_Vid, int num_tiles)
+{
+  OTFTileCache *p_cache;
+  int i, num_buckets = 1;
+
+  if ((p_cache = (OTFTileCache *) calloc(1, sizeof(OTFTileCache))) == NULL)
+    no_mem_exit("init_otf_cache: p_cache");
+
+  num_tiles = imax(num_tiles, 4);
+  while (num_buckets < 2 * num_tiles)
+    num_buckets <<= 1;
+
+  p_cache->num_tiles = num_tiles;
+  p_cache->hash_mask = num_buckets - 1;
+
+  if ((p_cache->tiles = (OTFTile *) calloc(num_tiles, sizeof(OTFTile))) == NULL)
+    no_mem_exit("init_otf_cache: tiles");
+  if ((p_cache->hash_head = (int *) malloc(num_buckets * sizeof(int))) == NULL)
+    no_mem_exit("init_otf_cache: hash_head");
+  if ((p_cache->tile_mem = (imgpel *) malloc((size_t) num_tiles * OTF_TILE_SIZE * OTF_TILE_SIZE * sizeof(imgpel))) == NULL)
+    no_mem_exit("init_otf_cache: tile_mem");
+  if ((p_cache->tmp_res = (int *) malloc((OTF_TILE_SIZE + 5) * (OTF_TILE_SIZE + 5) * sizeof(int))) == NULL)
+    no_mem_exit("init_otf_cache: tmp_res");
+
+  for (i = 0; i < num_buckets; ++i)
+    p_cache->hash_head[i] = -1;
+
+  p_cache->lru_head = p_cache->lru_tail = -1;
+  for (i = 0; i < num_tiles; ++i)
+  {
+    p_cache->tiles[i].pic_id = -1;
+    p_cache->tiles[i].hash_next = -1;
+    p_cache->tiles[i].data = p_cache->tile_mem + (size_t) i * OTF_TILE_SIZE * OTF_TILE_SIZE;
+    lru_push_front(p_cache, i);
+  }
+
+  p_Vid->p_OtfCache = p_cache;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the tile cache
+ ************************************************************************
+ */
+void free_otf_cache(VideoParameters *p_Vid)
+{
+  OTFTileCache *p_cache = p_Vid->p_OtfCache;
+
+  if (p_cache != NULL)
+  {
+    free(p_cache->tmp_res);
+    free(p_cache->tile_mem);
+    free(p_cache->hash_head);
+    free(p_cache->tiles);
+    free(p_cache);
+    p_Vid->p_OtfCache = NULL;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns a fresh identifier for a newly interpolated picture. Tiles
+ *    keyed with an older identifier are never hit again and age out.
+ ************************************************************************
+ */
+int get_otf_cache_id(VideoParameters *p_Vid)
+{
+  return (p_Vid->p_OtfCache != NULL) ? ++p_Vid->p_OtfCache->pic_count : 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Look up a tile. On a miss the least recently used tile is recycled,
+ *    keyed with the request and returned with *hit = 0; the caller
+ *    then has to fill its samples, width and height.
+ ************************************************************************
+ */
+OTFTile *get_otf_cache_tile(OTFTileCache *p_cache, imgpel **plane, int pic_id, int phase, int tile_x, int tile_y, int *hit)
+{
+  int bucket = otf_tile_hash(p_cache, plane, pic_id, phase, tile_x, tile_y);
+  int idx = p_cache->hash_head[bucket];
+  OTFTile *tile;
+
+  while (idx >= 0)
+  {
+    tile = &p_cache->tiles[idx];
+    if (tile->pic_id == pic_id && tile->plane == plane && tile->phase == phase && tile->tile_x == tile_x && tile->tile_y == tile_y)
+    {
+      if (idx != p_cache->lru_head)
+      {
+        lru_unlink(p_cache, idx);
+        lru_push_front(p_cache, idx);
+      }
+      ++p_cache->hits;
+      *hit = 1;
+      return tile;
+    }
+    idx = tile->hash_next;
+  }
+
+  // recycle the least recently used tile
+  idx  = p_cache->lru_tail;
+  tile = &p_cache->tiles[idx];
+  if (tile->pic_id >= 0)
+    hash_remove(p_cache, idx);
+
+  tile->plane  = plane;
+  tile->pic_id = pic_id;
+  tile->phase  = phase;
+  tile->tile_x = tile_x;
+  tile->tile_y = tile_y;
+  tile->hash_next = p_cache->hash_head[bucket];
+  p_cache->hash_head[bucket] = idx;
+
+  lru_unlink(p_cache, idx);
+  lru_push_front(p_cache, idx);
+
+  ++p_cache->misses;
+  *hit = 0;
+  return tile;
+}
@@ -0,0 +1,55 @@
+/*!
+ ************************************************************************
+ * \file
+ *     otf_cache.h
+ *
+ * \brief
+ *    LRU cache of interpolated reference tiles used by the OTF_L3
+ *    on-the-fly interpolation mode
+ ************************************************************************
+ */
+
+#ifndef _OTF_CACHE_H_
+#define _OTF_CACHE_H_
+
+#include "global.h"
+
+#define OTF_TILE_SIZE   64  //!< Width and height of a cached sub-pel tile
+
+typedef struct otf_tile
+{
+  imgpel **plane;     //!< full pel plane the tile was interpolated from
+  int      pic_id;    //!< otf_cache_id of the owning picture (-1: slot unused)
+  int      phase;     //!< sub-pel phase (dy << 2) + dx
+  int      tile_x;
+  int      tile_y;
+  int      width;     //!< valid width  (tiles at the right  border may be narrower)
+  int      height;    //!< valid height (tiles at the bottom border may be shorter)
+  int      hash_next; //!< next tile in the same hash bucket
+  int      lru_prev;
+  int      lru_next;
+  imgpel  *data;      //!< width x height samples, row by row
+} OTFTile;
+
+typedef struct otf_tile_cache
+{
+  int      num_tiles;
+  int      hash_mask;
+  int     *hash_head;
+  OTFTile *tiles;
+  imgpel  *tile_mem;
+  int     *tmp_res;   //!< scratch for the 2D half-pel filters of a full tile
+  int      lru_head;  //!< most recently used
+  int      lru_tail;  //!< least recently used, recycled first
+  int      pic_count;
+  int64    hits;
+  int64    misses;
+} OTFTileCache;
+
+extern void     init_otf_cache     (VideoParameters *p_Vid, int num_tiles);
+extern void     free_otf_cache     (VideoParameters *p_Vid);
+extern int      get_otf_cache_id   (VideoParameters *p_Vid);
+extern OTFTile *get_otf_cache_tile (OTFTileCache *p_cache, imgpel **plane, int pic_id, int phase, int tile_x, int tile_y, int *hit);
+
+#endif
+
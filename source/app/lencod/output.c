@@ -17,6 +17,8 @@
 #include "image.h"
 #include "input.h"
 #include "output.h"
+#include "async_output.h"
+#include "pel_convert.h"
 
 /*!
  ************************************************************************
@@ -135,9 +137,21 @@ void img2buf (imgpel** imgX, unsigned char* buf, int size_x, int size_y, int sym
       for(i=crop_top;i<size_y-crop_bottom;i++)
       {
         int i_pos = (i-crop_top)*(twidth) - crop_left;
-        for(j=crop_left;j<size_x-crop_right;j++)
+        if (symbol_size_in_bytes == 1)
         {
-          memcpy(buf+((j + i_pos)*symbol_size_in_bytes),&(imgX[i][j]), size);
+          get_pel_convert()->narrow_row(buf + i_pos + crop_left, &imgX[i][crop_left], twidth);
+        }
+        else if (size == symbol_size_in_bytes)
+        {
+          // imgpel == pixel in file
+          memcpy(buf + (i_pos + crop_left) * symbol_size_in_bytes, &imgX[i][crop_left], twidth * symbol_size_in_bytes);
+        }
+        else
+        {
+          for(j=crop_left;j<size_x-crop_right;j++)
+          {
+            memcpy(buf+((j + i_pos)*symbol_size_in_bytes),&(imgX[i][j]), size);
+          }
         }
       }
     }
@@ -148,6 +162,8 @@ void img2buf (imgpel** imgX, unsigned char* buf, int size_x, int size_y, int sym
  ************************************************************************
  * \brief
  *    Writes out a storable picture without doing any output modifications
+ * \param p_Vid
+ *    VideoParameters structure
  * \param p
  *    Picture to be written
  * \param output
@@ -156,15 +172,19 @@ void img2buf (imgpel** imgX, unsigned char* buf, int size_x, int size_y, int sym
  *    Output file
  ************************************************************************
  */
-void write_picture(StorablePicture *p, FrameFormat *output, int p_out)
+void write_picture(VideoParameters *p_Vid, StorablePicture *p, FrameFormat *output, int p_out)
 {
-  write_out_picture(p, output, p_out);
+  write_out_picture(p_Vid, p, output, p_out);
 }
 
 /*!
  ************************************************************************
  * \brief
- *    Writes out a storable picture
+ *    Writes out a storable picture. The planes are converted into one
+ *    buffer, which is written at once or, with AsyncOutput, taken from
+ *    and queued to the output writer.
+ * \param p_Vid
+ *    VideoParameters structure
  * \param p
  *    Picture to be written
  * \param output
@@ -173,17 +193,18 @@ void write_picture(StorablePicture *p, FrameFormat *output, int p_out)
  *    Output file
  ************************************************************************
  */
-void write_out_picture(StorablePicture *p, FrameFormat *output, int p_out)
+void write_out_picture(VideoParameters *p_Vid, StorablePicture *p, FrameFormat *output, int p_out)
 {
   int SubWidthC  [4]= { 1, 2, 2, 1};
   int SubHeightC [4]= { 1, 2, 1, 1};
 
-  size_t ret;
-
   int crop_left, crop_right, crop_top, crop_bottom;
+  int crop_left_cr, crop_right_cr, crop_top_cr, crop_bottom_cr;
   int symbol_size_in_bytes = output->pic_unit_size_shift3;
   Boolean rgb_output = (Boolean) (output->color_model != CM_YUV && output->yuv_format == YUV444);
-  unsigned char *buf;
+  size_t luma_size, chroma_size, size;
+  unsigned char *buf, *pos;
+  OutputJob *job = NULL;
 
   if (p->non_existing)
     return;
@@ -203,72 +224,58 @@ void write_out_picture(StorablePicture *p, FrameFormat *output, int p_out)
     crop_left = crop_right = crop_top = crop_bottom = 0;
   }
 
+  crop_left_cr   = p->frame_crop_left_offset;
+  crop_right_cr  = p->frame_crop_right_offset;
+  crop_top_cr    = ( 2 - p->frame_mbs_only_flag ) * p->frame_crop_top_offset;
+  crop_bottom_cr = ( 2 - p->frame_mbs_only_flag ) * p->frame_crop_bottom_offset;
+
   //printf ("write frame size: %dx%d\n", p->size_x-crop_left-crop_right,p->size_y-crop_top-crop_bottom );
 
-  // KS: this buffer should actually be allocated only once, but this is still much faster than the previous version
-  buf = malloc (p->size_x * p->size_y * symbol_size_in_bytes);
-  if (NULL==buf)
+  luma_size = (size_t) (p->size_y-crop_bottom-crop_top)*(p->size_x-crop_right-crop_left)*symbol_size_in_bytes;
+  chroma_size = (p->chroma_format_idc != YUV400)
+    ? (size_t) (p->size_y_cr-crop_bottom_cr-crop_top_cr)*(p->size_x_cr-crop_right_cr-crop_left_cr)*symbol_size_in_bytes : 0;
+  size = luma_size + 2 * chroma_size;
+
+  if (p_Vid->p_Output != NULL)
+  {
+    job = get_output_job(p_Vid, size);
+    job->fd = p_out;
+    buf = job->buf;
+  }
+  else if ((buf = malloc (size)) == NULL)
   {
     no_mem_exit("write_out_picture: buf");
   }
 
+  pos = buf;
   if(rgb_output)
   {
-    crop_left   = p->frame_crop_left_offset;
-    crop_right  = p->frame_crop_right_offset;
-    crop_top    = ( 2 - p->frame_mbs_only_flag ) * p->frame_crop_top_offset;
-    crop_bottom = ( 2 - p->frame_mbs_only_flag ) * p->frame_crop_bottom_offset;
-
-    img2buf (p->imgUV[1], buf, p->size_x_cr, p->size_y_cr, symbol_size_in_bytes, crop_left, crop_right, crop_top, crop_bottom);
-    ret = write(p_out, buf, (p->size_y_cr-crop_bottom-crop_top)*(p->size_x_cr-crop_right-crop_left)*symbol_size_in_bytes);
-    if (ret != ((p->size_y_cr-crop_bottom-crop_top)*(p->size_x_cr-crop_right-crop_left)*symbol_size_in_bytes))
-    {
-      error ("write_out_picture: error writing to RGB output file.", 500);
-    }
-
-    if (p->frame_cropping_flag)
-    {
-      crop_left   = SubWidthC[p->chroma_format_idc] * p->frame_crop_left_offset;
-      crop_right  = SubWidthC[p->chroma_format_idc] * p->frame_crop_right_offset;
-      crop_top    = SubHeightC[p->chroma_format_idc]*( 2 - p->frame_mbs_only_flag ) * p->frame_crop_top_offset;
-      crop_bottom = SubHeightC[p->chroma_format_idc]*( 2 - p->frame_mbs_only_flag ) * p->frame_crop_bottom_offset;
-    }
-    else
-    {
-      crop_left = crop_right = crop_top = crop_bottom = 0;
-    }
+    img2buf (p->imgUV[1], pos, p->size_x_cr, p->size_y_cr, symbol_size_in_bytes, crop_left_cr, crop_right_cr, crop_top_cr, crop_bottom_cr);
+    pos += chroma_size;
   }
 
-  img2buf (p->imgY, buf, p->size_x, p->size_y, symbol_size_in_bytes, crop_left, crop_right, crop_top, crop_bottom);
-  ret = write(p_out, buf, (p->size_y-crop_bottom-crop_top)*(p->size_x-crop_right-crop_left)*symbol_size_in_bytes);
-  if (ret != ((p->size_y-crop_bottom-crop_top)*(p->size_x-crop_right-crop_left)*symbol_size_in_bytes))
-  {
-    error ("write_out_picture: error writing to YUV output file.", 500);
-  }
+  img2buf (p->imgY, pos, p->size_x, p->size_y, symbol_size_in_bytes, crop_left, crop_right, crop_top, crop_bottom);
+  pos += luma_size;
 
   if (p->chroma_format_idc != YUV400)
   {
-    crop_left   = p->frame_crop_left_offset;
-    crop_right  = p->frame_crop_right_offset;
-    crop_top    = ( 2 - p->frame_mbs_only_flag ) * p->frame_crop_top_offset;
-    crop_bottom = ( 2 - p->frame_mbs_only_flag ) * p->frame_crop_bottom_offset;
-
-    img2buf (p->imgUV[0], buf, p->size_x_cr, p->size_y_cr, symbol_size_in_bytes, crop_left, crop_right, crop_top, crop_bottom);
-    ret = write(p_out, buf, (p->size_y_cr-crop_bottom-crop_top)*(p->size_x_cr-crop_right-crop_left)* symbol_size_in_bytes);
-    if (ret != ((p->size_y_cr-crop_bottom-crop_top)*(p->size_x_cr-crop_right-crop_left)* symbol_size_in_bytes))
-    {
-      error ("write_out_picture: error writing to YUV output file.", 500);
-    }
+    img2buf (p->imgUV[0], pos, p->size_x_cr, p->size_y_cr, symbol_size_in_bytes, crop_left_cr, crop_right_cr, crop_top_cr, crop_bottom_cr);
+    pos += chroma_size;
 
     if (!rgb_output)
-    {
-      img2buf (p->imgUV[1], buf, p->size_x_cr, p->size_y_cr, symbol_size_in_bytes, crop_left, crop_right, crop_top, crop_bottom);
-      ret = write(p_out, buf, (p->size_y_cr-crop_bottom-crop_top)*(p->size_x_cr-crop_right-crop_left)*symbol_size_in_bytes);
-      if (ret != ((p->size_y_cr-crop_bottom-crop_top)*(p->size_x_cr-crop_right-crop_left)*symbol_size_in_bytes))
-      {
-        error ("write_out_picture: error writing to YUV output file.", 500);
-      }
-    }
+      img2buf (p->imgUV[1], pos, p->size_x_cr, p->size_y_cr, symbol_size_in_bytes, crop_left_cr, crop_right_cr, crop_top_cr, crop_bottom_cr);
+  }
+
+  if (job != NULL)
+  {
+    job->size = size;
+    queue_output_job(p_Vid, job);
+    return;
+  }
+
+  if ((size_t) write(p_out, buf, (unsigned int) size) != size)
+  {
+    error ("write_out_picture: error writing to YUV output file.", 500);
   }
 
   free(buf);
@@ -376,7 +383,7 @@ void write_unpaired_field(VideoParameters *p_Vid, FrameStore* fs, FrameFormat *o
 
     clear_picture(p_Vid, fs->bottom_field);
     dpb_combine_field_yuv(p_Vid, fs);
-    write_picture (fs->frame, output, p_out);
+    write_picture (p_Vid, fs->frame, output, p_out);
   }
 
   if(fs->is_used &2)
@@ -402,7 +409,7 @@ void write_unpaired_field(VideoParameters *p_Vid, FrameStore* fs, FrameFormat *o
       fs ->top_field->frame_crop_right_offset = fs->bottom_field->frame_crop_right_offset;
     }
     dpb_combine_field_yuv(p_Vid, fs);
-    write_picture (fs->frame, output, p_out);
+    write_picture (p_Vid, fs->frame, output, p_out);
   }
 
   fs->is_used=3;
@@ -459,7 +466,7 @@ void write_stored_frame( VideoParameters *p_Vid, FrameStore *fs, FrameFormat *ou
   }
   else
   {
-    write_picture(fs->frame, output, p_out);
+    write_picture (p_Vid, fs->frame, output, p_out);
   }
 
   fs->is_output = 1;
@@ -489,7 +496,7 @@ void direct_output(VideoParameters *p_Vid, StorablePicture *p, FrameFormat *outp
     // we have a frame (or complementary field pair)
     // so output it directly
     flush_direct_output(p_Vid, output, p_out);
-    write_picture (p, output, p_out);
+    write_picture (p_Vid, p, output, p_out);
     free_storable_picture(p_Vid, p);
     return;
     break;
@@ -514,7 +521,7 @@ void direct_output(VideoParameters *p_Vid, StorablePicture *p, FrameFormat *outp
   {
     // we have both fields, so output them
     dpb_combine_field_yuv(p_Vid, p_Vid->out_buffer);
-    write_picture (p_Vid->out_buffer->frame, output, p_out);
+    write_picture (p_Vid, p_Vid->out_buffer->frame, output, p_out);
     free_storable_picture(p_Vid, p_Vid->out_buffer->frame);
     p_Vid->out_buffer->frame = NULL;
     free_storable_picture(p_Vid, p_Vid->out_buffer->top_field);
@@ -15,7 +15,7 @@
 #define _OUTPUT_H_
 
 extern void flush_direct_output(VideoParameters *p_Vid, FrameFormat *output, int p_out);
-extern void write_out_picture  ( StorablePicture *p, FrameFormat *output, int p_out);
+extern void write_out_picture  (VideoParameters *p_Vid, StorablePicture *p, FrameFormat *output, int p_out);
 extern void write_stored_frame (VideoParameters *p_Vid, FrameStore *fs, FrameFormat *output, int p_out);
 extern void direct_output      (VideoParameters *p_Vid, StorablePicture *p, FrameFormat *output, int p_out);
 extern void direct_output_paff (VideoParameters *p_Vid, StorablePicture *p, FrameFormat *output, int p_out);
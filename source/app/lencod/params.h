@@ -65,6 +65,9 @@ struct inp_par_enc
   int UseConstrainedIntraPred;          //!< 0: Inter MB pixels are allowed for intra prediction 1: Not allowed
   int  SetFirstAsLongTerm;              //!< Support for temporal considerations for CB plus encoding
   int  infile_header;                   //!< If input file has a header set this to the length of the header
+  int  InputStreamBuffer;               //!< sequential input: frames kept behind the furthest frame read (0: derived)
+  int  InputStreamReadAhead;            //!< sequential input: frames read ahead by the reader thread
+  int  InputMemoryMap;                  //!< map concatenated input files into memory instead of reading them
   int  MultiSourceData;
   VideoDataFile   input_file2;          //!< Input video file2
   VideoDataFile   input_file3;          //!< Input video file3
@@ -89,6 +92,8 @@ struct inp_par_enc
   char ReconFile2    [FILE_NAME_SIZE];  //!< Reconstructed Pictures (view 1)
   char TraceFile     [FILE_NAME_SIZE];  //!< Trace Outputs
   char StatsFile     [FILE_NAME_SIZE];  //!< Stats File
+  int  AsyncOutput;                     //!< write the bitstream and reconstruction from a background thread
+  int  SegmentParallel;                 //!< code the IDR periods as segments in up to this many concurrent processes (0: off)
   char QmatrixFile   [FILE_NAME_SIZE];  //!< Q matrix cfg file
   int  ProcessInput;                    //!< Filter Input Sequence
   int  EnableOpenGOP;                   //!< support for open gops.
@@ -150,6 +155,7 @@ struct inp_par_enc
   int ChromaWeightSupport;           //!< Weighted prediction support for chroma (0: disabled, 1: enabled)
   int UseWeightedReferenceME;        //!< Use Weighted Reference for ME.
   int RDPictureDecision;             //!< Perform RD optimal decision between various coded versions of same picture
+  int MEResultCache;                 //!< Reuse block motion search results across coding passes of the same picture
   int RDPSliceBTest;                 //!< Tests B slice replacement for P.
   int RDPSliceITest;                 //!< Tests I slice replacement for P.
   int RDPictureMaxPassISlice;        //!< Max # of coding passes for I-slice
@@ -161,6 +167,11 @@ struct inp_par_enc
   int RDPictureFrameQPBSlice;        //!< Whether to check additional frame level QP values for B slices
 
   int SkipIntraInInterSlices;        //!< Skip intra type checking in inter slices if best_mode is skip/direct
+  double RTTargetFPS;                //!< Target encoding speed of the real-time complexity control (0: off)
+  int RTMaxLevel;                    //!< Highest complexity reduction level the real-time control may use
+  int LookaheadFrames;               //!< Frames analysed ahead of the frame being coded by the lookahead pre-analysis (0: off)
+  double LookaheadSceneCut;          //!< Pre-analysis inter/intra cost ratio that places an IDR picture at a scene cut (0: off)
+  int LookaheadAdaptiveB;            //!< Shorten B-frame runs over high motion found by the pre-analysis
   int PSliceSkipDecisionMethod;             //!< Use of a NaturalSkip method for deciding skip modes in P slices
   int BRefPictures;                  //!< B coded reference pictures replace P pictures (0: not used, 1: used)
   int HierarchicalCoding;
@@ -220,12 +231,15 @@ struct inp_par_enc
   double VisualResWavPSNR;
   int SSIMOverlapSize;
   int DistortionYUVtoRGB;
+  int AsyncMetrics;           //!< compute the quality metrics in a background thread
   int CtxAdptLagrangeMult;    //!< context adaptive lagrangian multiplier
   int FastCrIntraDecision;
+  int IntraRDOCandidates;           //!< 4x4/8x8 intra modes kept for full RDO after SATD ranking (0: all)
   int disthres;
   int nobskip;
   int BiasSkipRDO;
   int ForceTrueRateRDO;
+  int CABACRateEstimation;          //!< estimate CABAC rates in RD mode decision from state tables instead of coding the bins
 
 #ifdef _LEAKYBUCKET_
   int  NumberLeakyBuckets;
@@ -234,6 +248,7 @@ struct inp_par_enc
 #endif
 
   int PicInterlace;           //!< picture adaptive frame/field
+  int ConcurrentFieldDecision;//!< code the field pair candidate of PicInterlace=2 concurrently with the frame
   int MbInterlace;            //!< macroblock adaptive frame/field
   int IntraBottom;            //!< Force Intra Bottom at GOP periods.
 
@@ -250,6 +265,7 @@ struct inp_par_enc
   int RandomIntraMBRefresh;     //!< Number of pseudo-random intra-MBs per picture
 
   int OnTheFlyFractMCP;         //!< On the fly interpolation mode
+  int OTFTileCacheSize;         //!< Number of interpolated tiles kept by OTF_L3
 
   // Chroma interpolation and buffering
   int ChromaMCBuffer;
@@ -291,6 +307,7 @@ struct inp_par_enc
   int model_number;
   int Transform8x8Mode;
   int ReportFrameStats;
+  int ReportLog;                     //!< append the sequence statistics to log.dat and data.txt
   int DisplayEncParams;
   int Verbose;
 
@@ -355,6 +372,7 @@ struct inp_par_enc
   int HMEEnable;
   int HMEDisableMMCO;
   int PyramidLevels;
+  int ParallelRefME;                    //!< search the references of a macroblock partition concurrently (OPENMP builds)
   
   
   // IDR min distance
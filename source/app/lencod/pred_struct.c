@@ -16,6 +16,7 @@
 
 #include "pred_struct.h"
 #include "explicit_seq.h"
+#include "lookahead.h"
 
 #define DEBUG_PRED_STRUCT 0
 
@@ -36,6 +37,7 @@ static int  establish_random_access( InputParameters *p_Inp, SeqStructure *p_seq
 static int  establish_intra( InputParameters *p_Inp, SeqStructure *p_seq_struct, int curr_frame, int avail_frames, int sim );
 static int  establish_sp( InputParameters *p_Inp, SeqStructure *p_seq_struct, int curr_frame, int avail_frames, int sim );
 static int  get_fixed_frame( InputParameters *p_Inp, SeqStructure *p_seq_struct, int curr_frame, int avail_frames );
+static int  get_avail_frames( InputParameters *p_Inp, SeqStructure *p_seq_struct, int curr_frame, int proc_frames );
 static int  get_prd_index( InputParameters *p_Inp, SeqStructure *p_seq_struct, int num_frames );
 static int  get_idr_index( InputParameters *p_Inp, SeqStructure *p_seq_struct, int num_frames );
 static int  get_intra_index( InputParameters *p_Inp, SeqStructure *p_seq_struct, int num_frames );
@@ -421,6 +423,23 @@ static void free_frame_buffer( FrameUnitStruct *p_frm_struct, int num_frames )
   }
 }
 
+/*!
+ ***********************************************************************
+ * \brief
+ *    Length of the frame structure unit buffer, i.e. the number of frames
+ *    populated at a time
+ * \param p_Inp
+ *    pointer to the InputParameters structure
+ * \return
+ *    FrmStructBufferLength, extended to hold an IDR or intra period
+ ***********************************************************************
+ */
+
+int get_frm_struct_length( InputParameters *p_Inp )
+{
+  return imax( p_Inp->FrmStructBufferLength, imax( p_Inp->idr_period, p_Inp->intra_period ) + p_Inp->NumberBFrames + p_Inp->intra_delay + 2 );
+}
+
 /*!
  ***********************************************************************
  * \brief
@@ -451,12 +470,16 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
   }
 
   // set length of frame buffer
-  p_Inp->FrmStructBufferLength = imax( p_Inp->FrmStructBufferLength, imax( p_Inp->idr_period, p_Inp->intra_period ) + p_Inp->NumberBFrames + p_Inp->intra_delay + 2 );
+  p_Inp->FrmStructBufferLength = get_frm_struct_length( p_Inp );
   p_Vid->frm_struct_buffer = p_Inp->FrmStructBufferLength;
   p_Vid->frm_struct_buffer = imin( p_Vid->frm_struct_buffer, p_Inp->no_frames );
   p_Inp->FrmStructBufferLength = imin( p_Inp->FrmStructBufferLength, p_Inp->no_frames ); 
 
-  p_Inp->FrmStructBufferLength = p_Inp->no_frames;
+  // with the lookahead the structure is populated FrmStructBufferLength frames at a time as the coding proceeds, so
+  // only the frames it decides on are analysed ahead of the coder; the buffer still holds the sequence, since
+  // prediction atoms may run past the populated count
+  if ( p_Vid->p_Lookahead == NULL )
+    p_Inp->FrmStructBufferLength = p_Inp->no_frames;
   p_Vid->frm_struct_buffer = p_Inp->no_frames;
 
   *memory_size += sizeof( SeqStructure );
@@ -477,6 +500,7 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
   p_seq_struct->last_sp_frame            = 0;
   p_seq_struct->last_sp_disp             = 0;
   p_seq_struct->pop_flag                 = 0;
+  p_seq_struct->p_lookahead              = p_Vid->p_Lookahead;
 
 #if (MVC_EXTENSION_ENABLE)
   p_seq_struct->num_frames_mvc           = p_seq_struct->num_frames * p_Inp->num_of_views; // two views hence twice the buffer size
@@ -488,7 +512,7 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
   init_gop_struct ( p_Inp, p_seq_struct, 1, memory_size ); // IDR GOPs
   init_gop_struct ( p_Inp, p_seq_struct, 0, memory_size ); // Intra GOPs
 
-  frames_to_pop = p_Vid->frm_struct_buffer;
+  frames_to_pop = p_Inp->FrmStructBufferLength;
 
   // populate frames
 #if (MVC_EXTENSION_ENABLE)
@@ -687,7 +711,14 @@ static int establish_random_access( InputParameters *p_Inp, SeqStructure *p_seq_
       }
     }
   }
-  // additional case can be added to insert IDR based on *pre-analysis* and other "pre-scient" tools
+  // scene cuts found by the lookahead pre-analysis start with an IDR picture (shortest random access structure)
+  if ( !is_random_access && curr_frame && lookahead_scene_cut( p_seq_struct->p_lookahead, curr_frame ) )
+  {
+    if ( sim || p_seq_struct->p_gop[0].length <= avail_frames )
+    {
+      is_random_access = 1;
+    }
+  }
 
   return is_random_access;
 }
@@ -903,6 +934,41 @@ static int establish_sp( InputParameters *p_Inp, SeqStructure *p_seq_struct, int
   return is_sp;
 }
 
+/*!
+ ***********************************************************************
+ * \brief
+ *    Number of frames the structure decisions may look at
+ * \param p_Inp
+ *    pointer to the InputParameters structure
+ * \param p_seq_struct
+ *    pointer to the sequence structure
+ * \param curr_frame
+ *    coding order of the current frame
+ * \param proc_frames
+ *    frames already populated in this call
+ * \return
+ *    the frames left to populate, extended by the longest atom when the
+ *    population stops short of the sequence end
+ ***********************************************************************
+ */
+
+static int get_avail_frames( InputParameters *p_Inp, SeqStructure *p_seq_struct, int curr_frame, int proc_frames )
+{
+  int idx;
+  int max_length = 0;
+
+  // a partial population also sees the atom that straddles its last frame, so the IDR and intra frames are placed
+  // as they would be with the whole sequence populated
+  for ( idx = 0; idx < p_seq_struct->num_prds; idx++ )
+    max_length = imax( max_length, p_seq_struct->p_prd[idx].length );
+  for ( idx = 0; idx < p_seq_struct->num_gops; idx++ )
+    max_length = imax( max_length, p_seq_struct->p_gop[idx].length );
+  for ( idx = 0; idx < p_seq_struct->num_intra_gops; idx++ )
+    max_length = imax( max_length, p_seq_struct->p_intra_gop[idx].length );
+
+  return imin( p_Inp->no_frames - curr_frame, p_seq_struct->curr_num_to_populate - proc_frames + max_length );
+}
+
 /*!
  ***********************************************************************
  * \brief
@@ -1785,7 +1851,7 @@ void populate_frm_struct( VideoParameters *p_Vid, InputParameters *p_Inp, SeqStr
     // we have to check here for inserted frames (e.g. due to pre-analysis) and assign them to the structure (future work)
 
     // establish if it is an IDR frame
-    is_idr = establish_random_access( p_Inp, p_seq_struct, curr_frame, p_seq_struct->curr_num_to_populate - proc_frames, 0 );
+    is_idr = establish_random_access( p_Inp, p_seq_struct, curr_frame, get_avail_frames( p_Inp, p_seq_struct, curr_frame, proc_frames ), 0 );
     if ( is_idr && p_seq_struct->pop_flag != POP_INTRA && p_seq_struct->pop_flag != POP_SP )
     {
       // random access structure
@@ -1801,7 +1867,7 @@ void populate_frm_struct( VideoParameters *p_Vid, InputParameters *p_Inp, SeqStr
     }
     else // INTRA frames check (non-IDR)
     {
-      is_intra = establish_intra( p_Inp, p_seq_struct, curr_frame, p_seq_struct->curr_num_to_populate - proc_frames, 0 );
+      is_intra = establish_intra( p_Inp, p_seq_struct, curr_frame, get_avail_frames( p_Inp, p_seq_struct, curr_frame, proc_frames ), 0 );
       if ( is_intra && p_seq_struct->pop_flag != POP_SP )
       {
         // intra structure (not random access)
@@ -1817,7 +1883,7 @@ void populate_frm_struct( VideoParameters *p_Vid, InputParameters *p_Inp, SeqStr
       }
       else // SP frames check
       {
-        is_sp = establish_sp( p_Inp, p_seq_struct, curr_frame, p_seq_struct->curr_num_to_populate - proc_frames, 0 );
+        is_sp = establish_sp( p_Inp, p_seq_struct, curr_frame, get_avail_frames( p_Inp, p_seq_struct, curr_frame, proc_frames ), 0 );
         if ( is_sp )
         {
           // intra structure (not random access)
@@ -2155,6 +2221,7 @@ static int populate_reg_pred_struct_atom( VideoParameters *p_Vid, InputParameter
   int avail_frames;
   int pred_frame = 0;
   int pred_idx;
+  int la_length;
 
   FrameUnitStruct *p_frm_struct;
   PredStructAtom *p_cur_prd;
@@ -2164,16 +2231,16 @@ static int populate_reg_pred_struct_atom( VideoParameters *p_Vid, InputParameter
   // this finds the next place for a fixed (IDR/intra/SP/SI) frame *after* current_frame (hence counts from current_frame + 1 on)
   if ( !(p_Inp->intra_delay) )
   {
-    fixed_idx = get_fixed_frame_for_prd( p_Inp, p_seq_struct, curr_frame, p_seq_struct->curr_num_to_populate - proc_frames );
+    fixed_idx = get_fixed_frame_for_prd( p_Inp, p_seq_struct, curr_frame, get_avail_frames( p_Inp, p_seq_struct, curr_frame, proc_frames ) );
   }
   else
   {
     // IntraDelay currently does not support the improved prediction structure allocation (get_fixed_frame_for_prd)
-    fixed_idx = get_fixed_frame( p_Inp, p_seq_struct, curr_frame, p_seq_struct->curr_num_to_populate - proc_frames );
+    fixed_idx = get_fixed_frame( p_Inp, p_seq_struct, curr_frame, get_avail_frames( p_Inp, p_seq_struct, curr_frame, proc_frames ) );
   }
   if ( fixed_idx == -1 )
   {
-    avail_frames = p_seq_struct->curr_num_to_populate - proc_frames;
+    avail_frames = get_avail_frames( p_Inp, p_seq_struct, curr_frame, proc_frames );
   }
   else
   {
@@ -2188,12 +2255,14 @@ static int populate_reg_pred_struct_atom( VideoParameters *p_Vid, InputParameter
   // loop through these frames and apply the appropriate prediction structure (p_prd)
   while ( pred_frame < avail_frames )
   {
-    pred_idx = get_prd_index( p_Inp, p_seq_struct, avail_frames - pred_frame );
+    // the lookahead pre-analysis may shorten the structure over high motion
+    la_length = lookahead_prd_length( p_seq_struct->p_lookahead, curr_frame + pred_frame, p_seq_struct->p_prd[p_seq_struct->num_prds - 1].length );
+    pred_idx = get_prd_index( p_Inp, p_seq_struct, imin( la_length, avail_frames - pred_frame ) );
     // check here whether the prediction structure does not fit even if there is no fixed frame detected;
     // if we proceed we will allocate an inefficient pred structure; better to terminate the frame population here
     if ( fixed_idx == -1 && (curr_frame + avail_frames) < p_Inp->no_frames )
     {
-      if ( (p_seq_struct->num_prds - 1) != pred_idx )
+      if ( get_prd_index( p_Inp, p_seq_struct, la_length ) != pred_idx )
       {
         *terminate_pop = 1;
         break; // the pred_frame loop
@@ -2278,10 +2347,10 @@ static int populate_rnd_acc_pred_struct_atom( VideoParameters *p_Vid, InputParam
   // regular prediction structure (*in-between* idr and intra frames though)
   // first determine how many frames are available to be used to place our prediction structures
   // this finds the next place for a fixed (IDR/intra/SP/SI) frame *after* current_frame (hence counts from current_frame + 1 on)
-  fixed_idx = get_fixed_frame( p_Inp, p_seq_struct, curr_frame + 1, p_seq_struct->curr_num_to_populate - proc_frames - 1 );
+  fixed_idx = get_fixed_frame( p_Inp, p_seq_struct, curr_frame + 1, get_avail_frames( p_Inp, p_seq_struct, curr_frame + 1, proc_frames + 1 ) );
   if ( fixed_idx == -1 )
   {
-    avail_frames = p_seq_struct->curr_num_to_populate - proc_frames;
+    avail_frames = get_avail_frames( p_Inp, p_seq_struct, curr_frame, proc_frames );
   }
   else
   {
@@ -2302,8 +2371,9 @@ static int populate_rnd_acc_pred_struct_atom( VideoParameters *p_Vid, InputParam
   {
     if ( !(p_Inp->PreferDispOrder) ) // coding order
     {
-      // bias in favor of longest *available* and *possible* structure
-      gop_idx = get_rand_acc_index( p_Inp, p_seq_struct, avail_frames );
+      // bias in favor of longest *available* and *possible* structure; at a scene cut the IDR picture may not be preceded
+      // in display order by frames of the previous scene
+      gop_idx = ( !no_rnd_acc && lookahead_scene_cut( p_seq_struct->p_lookahead, curr_frame ) ) ? 0 : get_rand_acc_index( p_Inp, p_seq_struct, avail_frames );
     }
     else // display order
     {
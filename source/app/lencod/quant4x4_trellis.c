@@ -165,12 +165,17 @@ void rdoq_4x4_CABAC(Macroblock *currMB, int **tblock, struct quant_methods *q_me
 
   levelDataStruct levelData[16];
   int kStart=0, kStop=0, noCoeff = 0, estBits;
+  RDOQCacheEntry *p_entry;
 
   double lambda_md = p_Vid->lambda_rdoq[p_Vid->type][p_Vid->masterQP]; 
 
-  noCoeff = init_trellis_data_4x4_CABAC(currMB, tblock, q_method, p_scan, &levelData[0], &kStart, &kStop, LUMA_4x4);
   estBits = est_write_and_store_CBP_block_bit(currMB, LUMA_4x4);
+  if (rdoq_cache_lookup(currMB->p_Slice, &p_entry, tblock, q_method->block_x, p_scan, 16, LUMA_4x4, q_method->qp, q_method->q_params, lambda_md, estBits, levelTrellis))
+    return;
+
+  noCoeff = init_trellis_data_4x4_CABAC(currMB, tblock, q_method, p_scan, &levelData[0], &kStart, &kStop, LUMA_4x4);
   est_writeRunLevel_CABAC(currMB, levelData, levelTrellis, LUMA_4x4, lambda_md, kStart, kStop, noCoeff, estBits);
+  rdoq_cache_store(p_entry, levelTrellis);
 }
 
 /*!
@@ -312,10 +317,15 @@ void rdoq_ac4x4_CABAC(Macroblock *currMB, int **tblock, struct quant_methods *q_
   levelDataStruct levelData[16];
   double  lambda_md = p_Vid->lambda_rdoq[p_Vid->type][p_Vid->masterQP]; 
   int kStart = 0, kStop = 0, noCoeff = 0, estBits;
+  RDOQCacheEntry *p_entry;
 
-  noCoeff = init_trellis_data_4x4_CABAC(currMB, tblock, q_method, p_scan, &levelData[0], &kStart, &kStop, type);
   estBits = est_write_and_store_CBP_block_bit(currMB, type);
+  if (rdoq_cache_lookup(currMB->p_Slice, &p_entry, tblock, q_method->block_x, p_scan, 15, type, q_method->qp, q_method->q_params, lambda_md, estBits, levelTrellis))
+    return;
+
+  noCoeff = init_trellis_data_4x4_CABAC(currMB, tblock, q_method, p_scan, &levelData[0], &kStart, &kStop, type);
   est_writeRunLevel_CABAC(currMB, levelData, levelTrellis, type, lambda_md, kStart, kStop, noCoeff, estBits);
+  rdoq_cache_store(p_entry, levelTrellis);
 }
 
 /*!
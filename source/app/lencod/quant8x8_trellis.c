@@ -42,11 +42,16 @@ static void rdoq_8x8_CABAC(Macroblock *currMB, int **tblock, int block_x,int qp_
   levelDataStruct levelData[64];
   double  lambda_md = 0.0;
   int kStart = 0, kStop = 0, noCoeff = 0;
+  RDOQCacheEntry *p_entry;
 
   lambda_md = p_Vid->lambda_rdoq[p_Vid->type][p_Vid->masterQP]; 
 
+  if (rdoq_cache_lookup(currMB->p_Slice, &p_entry, tblock, block_x, p_scan, 64, LUMA_8x8, qp_per * 6 + qp_rem, q_params_8x8, lambda_md, 0, levelTrellis))
+    return;
+
   noCoeff = init_trellis_data_8x8_CABAC(currMB, tblock, block_x, qp_per, qp_rem, q_params_8x8, p_scan, &levelData[0], &kStart, &kStop);
   est_writeRunLevel_CABAC(currMB, levelData, levelTrellis, LUMA_8x8, lambda_md, kStart, kStop, noCoeff, 0);
+  rdoq_cache_store(p_entry, levelTrellis);
 }
 
 /*!
@@ -21,6 +21,7 @@
 
 #include "global.h"
 #include "ratectl.h"
+#include "lookahead.h"
 
 
 /*!
@@ -226,6 +227,21 @@ void rc_free_generic(RCGeneric **p_quad)
   }
 }
 
+/*!
+ *************************************************************************************
+ * \brief
+ *    Returns 1 for an IDR picture the lookahead pre-analysis inserted at a
+ *    scene cut, i.e. off the IDRPeriod grid the GOP budget is based on
+ *
+ *************************************************************************************
+ */
+int rc_scene_cut_idr(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  return p_Vid->p_Lookahead != NULL && p_Vid->number != 0 && p_Vid->p_curr_frm_struct->idr_flag
+    && (p_Inp->idr_period == 0 || (p_Vid->curr_frm_idx % p_Inp->idr_period) != 0)
+    && lookahead_scene_cut(p_Vid->p_Lookahead, p_Vid->frame_no);
+}
+
 /*!
  *************************************************************************************
  * \brief
@@ -266,7 +282,8 @@ void rc_init_gop_params(VideoParameters *p_Vid, InputParameters *p_Inp)
         rc_init_GOP(p_Vid, p_Inp, p_quad, p_gen, np, nb);
       }
     }
-    else if ( p_Vid->p_curr_frm_struct->idr_flag )  
+    // an IDR picture inserted at a scene cut is coded from the budget of the current GOP
+    else if ( p_Vid->p_curr_frm_struct->idr_flag && !rc_scene_cut_idr(p_Vid, p_Inp) )
     {
       int M = p_Inp->NumberBFrames + 1;
       int n = p_Inp->idr_period;
@@ -314,7 +331,9 @@ void rc_init_frame(VideoParameters *p_Vid, InputParameters *p_Inp)
       rc_copy_quadratic( p_Vid, p_Inp, p_Vid->p_rc_quad_init, p_Vid->p_rc_quad ); // store rate allocation quadratic...    
       rc_copy_generic( p_Vid, p_Vid->p_rc_gen_init, p_Vid->p_rc_gen ); // ...and generic model
     }
-    p_Vid->rc_init_pict_ptr(p_Vid, p_Inp, p_Vid->p_rc_quad, p_Vid->p_rc_gen, 1,0,1, 1.0F);
+    // the frame target follows the complexity of the frames ahead if these are known
+    p_Vid->rc_init_pict_ptr(p_Vid, p_Inp, p_Vid->p_rc_quad, p_Vid->p_rc_gen, 1,0,1,
+      (p_Vid->p_Lookahead != NULL) ? lookahead_rc_weight(p_Vid->p_Lookahead, p_Vid->frame_no) : 1.0F);
 
     if( p_Vid->active_sps->frame_mbs_only_flag)
       p_Vid->p_rc_gen->TopFieldFlag=0;
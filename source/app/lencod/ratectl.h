@@ -36,6 +36,7 @@ extern void  rc_alloc_generic           ( VideoParameters *p_Vid, RCGeneric **p_
 extern void  rc_free_generic            ( RCGeneric **p_quad );
 extern void  rc_copy_generic            ( VideoParameters *p_Vid, RCGeneric *dst, RCGeneric *src );
 extern void  rc_init_gop_params         ( VideoParameters *p_Vid, InputParameters *p_Inp );
+extern int   rc_scene_cut_idr           ( VideoParameters *p_Vid, InputParameters *p_Inp );
 extern void  rc_init_frame              ( VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void  rc_init_sequence           ( VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void  rc_store_slice_header_bits ( VideoParameters *p_Vid, InputParameters *p_Inp, int len);
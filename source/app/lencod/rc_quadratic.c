@@ -22,6 +22,7 @@
 
 #include "global.h"
 #include "ratectl.h"
+#include "lookahead.h"
 
 
 static const float THETA = 1.3636F;
@@ -65,6 +66,13 @@ void rc_alloc_quadratic( VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadr
   lprc->PAverageQp    = lprc->PAveFrameQP;
   lprc->MyInitialQp   = lprc->PAveFrameQP;
   lprc->AveWb         = 0.0;
+  lprc->LACost        = 0.0;
+  lprc->PLACost       = 0.0;
+  lprc->LAMADRatio    = 1.0;
+  lprc->IPicBits      = 0;
+  lprc->IPicQP        = lprc->PAveFrameQP;
+  lprc->IPicLACost    = 0.0;
+  lprc->SceneCutQP    = 0;
 
   lprc->BUPFMAD = (double*) calloc ((rcBufSize), sizeof (double));
   if (NULL==lprc->BUPFMAD)
@@ -515,6 +523,13 @@ void rc_init_pict(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p
 
   p_Vid->NumberofCodedMacroBlocks = 0;
 
+  /* scale the MAD prediction with the complexity change seen by the lookahead pre-analysis */
+  if(p_Vid->p_Lookahead != NULL && (fieldpic || topfield))
+  {
+    p_quad->LACost     = lookahead_cost(p_Vid->p_Lookahead, p_Vid->frame_no);
+    p_quad->LAMADRatio = (p_quad->LACost > 0.0 && p_quad->PLACost > 0.0) ? dmin(4.0, dmax(0.25, p_quad->LACost / p_quad->PLACost)) : 1.0;
+  }
+
   /* Normally, the bandwidth for the VBR case is estimated by
      a congestion control algorithm. A bandwidth curve can be predefined if we only want to
      test the proposed algorithm */
@@ -859,6 +874,14 @@ void rc_update_pict_frame(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuad
   /* update the complexity weight of I, P, B frame */  
   int complexity = 0;
 
+  /* the last I picture is the reference for the QP of IDR pictures inserted at scene cuts */
+  if ( p_Vid->type == I_SLICE && p_Vid->p_Lookahead != NULL )
+  {
+    p_quad->IPicBits   = nbits;
+    p_quad->IPicQP     = p_quad->m_Qc;
+    p_quad->IPicLACost = lookahead_intra_cost(p_Vid->p_Lookahead, p_Vid->frame_no);
+  }
+
   switch( p_Inp->RCUpdateMode )
   {
   case RC_MODE_0:
@@ -1041,7 +1064,10 @@ void updateRCModel (VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic
     if( MADModelFlag )
       updateMADModel(p_Vid, p_Inp, p_quad, p_gen);
     else if( p_Vid->type == P_SLICE || (p_Inp->RCUpdateMode == RC_MODE_1 && (p_Vid->number != 0)) )
+    {
       p_quad->PPictureMAD[0] = p_quad->CurrentFrameMAD;
+      p_quad->PLACost = p_quad->LACost;
+    }
   }
 }
 
@@ -1151,6 +1177,7 @@ void updateMADModel (VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic
     }
     p_quad->PPictureMAD[0] = p_quad->CurrentFrameMAD;
     p_quad->PictureMAD[0]  = p_quad->PPictureMAD[0];
+    p_quad->PLACost        = p_quad->LACost;
 
     if(p_Vid->BasicUnit == p_Vid->FrameSizeInMbs)
       p_quad->ReferenceMAD[0]=p_quad->PictureMAD[1];
@@ -1308,7 +1335,7 @@ int updateQPRC0(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
     {
       if (p_Vid->type==I_SLICE)
       {
-        p_quad->m_Qc = p_quad->MyInitialQp;
+        p_quad->m_Qc = rc_scene_cut_idr(p_Vid, p_Inp) ? updateSceneCutQP(p_Vid, p_quad, p_gen) : p_quad->MyInitialQp;
         return p_quad->m_Qc;
       }
       else if(p_Vid->type == B_SLICE)
@@ -1364,6 +1391,16 @@ int updateQPRC0(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
           updateQPNonPicAFF( p_Vid->active_sps, p_quad );
         return p_quad->m_Qc;
       }
+      else if( p_Vid->type == P_SLICE && p_quad->SceneCutQP != 0 )
+      {
+        /* the model is fitted to the previous scene, the first P picture of the new one starts from the QP of its IDR picture */
+        p_quad->m_Qc = p_quad->SceneCutQP;
+        p_quad->SceneCutQP = 0;
+
+        if(p_gen->FieldControl==0)
+          updateQPNonPicAFF( p_Vid->active_sps, p_quad );
+        return p_quad->m_Qc;
+      }
       else
       {
         /*adaptive field/frame coding*/
@@ -1381,7 +1418,7 @@ int updateQPRC0(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
         m_Hp = p_quad->PPreHeader;
 
         /* predict the MAD of current picture*/
-        p_quad->CurrentFrameMAD = p_quad->MADPictureC1*p_quad->PreviousPictureMAD + p_quad->MADPictureC2;
+        p_quad->CurrentFrameMAD = p_quad->MADPictureC1*p_quad->PreviousPictureMAD*p_quad->LAMADRatio + p_quad->MADPictureC2;
 
         /*compute the number of bits for the texture*/
         if(p_quad->Target < 0)
@@ -1420,7 +1457,7 @@ int updateQPRC0(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
     /*top field of I frame*/
     if (p_Vid->type == I_SLICE)
     {
-      p_quad->m_Qc = p_quad->MyInitialQp;
+      p_quad->m_Qc = rc_scene_cut_idr(p_Vid, p_Inp) ? updateSceneCutQP(p_Vid, p_quad, p_gen) : p_quad->MyInitialQp;
       return p_quad->m_Qc;
     }
     else if( p_Vid->type == B_SLICE )
@@ -1585,7 +1622,7 @@ int updateQPRC1(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
         m_Hp = p_quad->PPreHeader;
 
         /* predict the MAD of current picture*/
-        p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->PreviousPictureMAD + p_quad->MADPictureC2;
+        p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->PreviousPictureMAD*p_quad->LAMADRatio + p_quad->MADPictureC2;
 
         /*compute the number of bits for the texture*/
         if(p_quad->Target < 0)
@@ -1714,7 +1751,9 @@ int updateQPRC2(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
         if((p_Inp->PicInterlace==ADAPTIVE_CODING)||(p_Inp->MbInterlace))
           updateQPInterlace( p_quad, p_gen );
 
-        if ( p_Vid->p_curr_frm_struct->idr_flag )
+        if ( rc_scene_cut_idr(p_Vid, p_Inp) )
+          p_quad->m_Qc = updateSceneCutQP(p_Vid, p_quad, p_gen);
+        else if ( p_Vid->p_curr_frm_struct->idr_flag )
           p_quad->m_Qc = p_quad->MyInitialQp;
         else
           p_quad->m_Qc = p_quad->CurrLastQP; // Set QP to average qp of last P frame
@@ -1747,6 +1786,16 @@ int updateQPRC2(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
           updateQPNonPicAFF( p_Vid->active_sps, p_quad );
         return p_quad->m_Qc;
       }
+      else if( p_Vid->type == P_SLICE && p_quad->SceneCutQP != 0 )
+      {
+        /* the model is fitted to the previous scene, the first P picture of the new one starts from the QP of its IDR picture */
+        p_quad->m_Qc = p_quad->SceneCutQP;
+        p_quad->SceneCutQP = 0;
+
+        if(p_gen->FieldControl==0)
+          updateQPNonPicAFF( p_Vid->active_sps, p_quad );
+        return p_quad->m_Qc;
+      }
       else
       {
         /*adaptive field/frame coding*/
@@ -1764,7 +1813,7 @@ int updateQPRC2(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
         m_Hp = p_quad->PPreHeader;
 
         /* predict the MAD of current picture*/
-        p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->PreviousPictureMAD + p_quad->MADPictureC2;
+        p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->PreviousPictureMAD*p_quad->LAMADRatio + p_quad->MADPictureC2;
 
         /*compute the number of bits for the texture*/
         if(p_quad->Target < 0)
@@ -1812,7 +1861,10 @@ int updateQPRC2(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
       if((p_Inp->PicInterlace==ADAPTIVE_CODING)||(p_Inp->MbInterlace))
         updateQPInterlace( p_quad, p_gen );
 
-      p_quad->m_Qc = p_quad->PrevLastQP; // Set QP to average qp of last P frame
+      if ( rc_scene_cut_idr(p_Vid, p_Inp) )
+        p_quad->m_Qc = updateSceneCutQP(p_Vid, p_quad, p_gen);
+      else
+        p_quad->m_Qc = p_quad->PrevLastQP; // Set QP to average qp of last P frame
       p_quad->PrevLastQP = p_quad->CurrLastQP;
       p_quad->CurrLastQP = p_quad->PrevLastQP;
       p_quad->PAveFrameQP = p_quad->CurrLastQP;
@@ -1958,7 +2010,7 @@ int updateQPRC3(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_q
           m_Hp = 0; // it is usually a very small portion of the total I_SLICE bit budget
 
         /* predict the MAD of current picture*/
-        p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->PreviousPictureMAD + p_quad->MADPictureC2;
+        p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->PreviousPictureMAD*p_quad->LAMADRatio + p_quad->MADPictureC2;
 
         /*compute the number of bits for the texture*/
         if(p_quad->Target < 0)
@@ -2192,6 +2244,38 @@ int updateFirstP( VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p
   return p_quad->m_Qc;
 }
 
+/*!
+ *************************************************************************************
+ * \brief
+ *    QP of an IDR picture inserted at a scene cut: the bits of the last I
+ *    picture, scaled by the pre-analysis intra cost change, against the
+ *    share of the remaining bits the lookahead expects the IDR to take
+ *************************************************************************************
+*/
+int updateSceneCutQP( VideoParameters *p_Vid, RCQuadratic *p_quad, RCGeneric *p_gen )
+{
+  Lookahead *p_la = p_Vid->p_Lookahead;
+  double cost = lookahead_intra_cost(p_la, p_Vid->frame_no);
+  double target = dmax(p_quad->bit_rate / p_quad->frame_rate,
+    lookahead_idr_share(p_la, p_Vid->frame_no, p_quad->Np + p_quad->Nb) * (double) p_gen->RemainingBits);
+  int m_Qp = p_quad->CurrLastQP;
+
+  if (p_quad->IPicBits > 0 && p_quad->IPicLACost > 0.0 && cost > 0.0)
+  {
+    // intra bits halve for every 6 QP steps
+    m_Qp = p_quad->IPicQP + (int) floor(6.0 * log(p_quad->IPicBits * (cost / p_quad->IPicLACost) / target) / log(2.0) + 0.5);
+    m_Qp = iClip3(p_quad->CurrLastQP - 2, p_quad->CurrLastQP + 4, m_Qp);
+  }
+
+  m_Qp = iClip3(p_Vid->RCMinQP + p_quad->bitdepth_qp_scale, p_Vid->RCMaxQP + p_quad->bitdepth_qp_scale, m_Qp);
+
+  // frame layer rate control: the first P picture of the new scene starts from this QP
+  if (p_Vid->BasicUnit == p_Vid->FrameSizeInMbs)
+    p_quad->SceneCutQP = m_Qp;
+
+  return m_Qp;
+}
+
 /*!
  *************************************************************************************
  * \brief
@@ -2377,21 +2461,21 @@ void predictCurrPicMAD( InputParameters *p_Inp, RCQuadratic *p_quad, RCGeneric *
   int i;
   if(((p_Inp->PicInterlace==ADAPTIVE_CODING)||(p_Inp->MbInterlace))&&(p_gen->FieldControl==1))
   {
-    p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->FCBUPFMAD[p_quad->TotalNumberofBasicUnit-p_quad->NumberofBasicUnit]+p_quad->MADPictureC2;
+    p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->FCBUPFMAD[p_quad->TotalNumberofBasicUnit-p_quad->NumberofBasicUnit]*p_quad->LAMADRatio+p_quad->MADPictureC2;
     p_quad->TotalBUMAD=0;
     for(i=p_quad->TotalNumberofBasicUnit-1; i>=(p_quad->TotalNumberofBasicUnit-p_quad->NumberofBasicUnit);i--)
     {
-      p_quad->CurrentBUMAD=p_quad->MADPictureC1*p_quad->FCBUPFMAD[i]+p_quad->MADPictureC2;
+      p_quad->CurrentBUMAD=p_quad->MADPictureC1*p_quad->FCBUPFMAD[i]*p_quad->LAMADRatio+p_quad->MADPictureC2;
       p_quad->TotalBUMAD +=p_quad->CurrentBUMAD*p_quad->CurrentBUMAD;
     }
   }
   else
   {
-    p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->BUPFMAD[p_quad->TotalNumberofBasicUnit-p_quad->NumberofBasicUnit]+p_quad->MADPictureC2;
+    p_quad->CurrentFrameMAD=p_quad->MADPictureC1*p_quad->BUPFMAD[p_quad->TotalNumberofBasicUnit-p_quad->NumberofBasicUnit]*p_quad->LAMADRatio+p_quad->MADPictureC2;
     p_quad->TotalBUMAD=0;
     for(i=p_quad->TotalNumberofBasicUnit-1; i>=(p_quad->TotalNumberofBasicUnit-p_quad->NumberofBasicUnit);i--)
     {
-      p_quad->CurrentBUMAD=p_quad->MADPictureC1*p_quad->BUPFMAD[i]+p_quad->MADPictureC2;
+      p_quad->CurrentBUMAD=p_quad->MADPictureC1*p_quad->BUPFMAD[i]*p_quad->LAMADRatio+p_quad->MADPictureC2;
       p_quad->TotalBUMAD +=p_quad->CurrentBUMAD*p_quad->CurrentBUMAD;
     }
   }
@@ -47,6 +47,7 @@ extern void updateQPNonPicAFF   ( seq_parameter_set_rbsp_t *active_sps, RCQuadra
 extern void updateBottomField   ( InputParameters *p_Inp, RCQuadratic *p_quad );
 extern int  updateFirstP        ( VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_quad, RCGeneric *p_gen, int topfield );
 extern int  updateNegativeTarget( VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_quad, RCGeneric *p_gen, int topfield, int m_Qp );
+extern int  updateSceneCutQP    ( VideoParameters *p_Vid, RCQuadratic *p_quad, RCGeneric *p_gen );
 extern int  updateFirstBU       ( VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_quad, RCGeneric *p_gen, int topfield );
 extern void updateLastBU        ( VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_quad, RCGeneric *p_gen, int topfield );
 extern void predictCurrPicMAD   ( InputParameters *p_Inp, RCQuadratic *p_quad, RCGeneric *p_gen );
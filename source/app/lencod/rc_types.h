@@ -147,6 +147,15 @@ typedef struct rc_quadratic
 
   int    bitdepth_qp_scale; // support negative QPs (bitdepth > 8-bits per component)
 
+  // lookahead pre-analysis
+  double LACost;      // pre-analysis cost estimate of the current picture
+  double PLACost;     // pre-analysis cost estimate of the picture of PPictureMAD[0]
+  double LAMADRatio;  // complexity change between the two, scales the MAD prediction
+  int    IPicBits;    // bits of the last I picture
+  int    IPicQP;      // QP of the last I picture
+  double IPicLACost;  // pre-analysis intra cost estimate of the last I picture
+  int    SceneCutQP;  // QP of an IDR picture inserted at a scene cut, the next P picture starts from it (0: none)
+
   // simple encoder buffer simulation
   int    enc_buf_curr;
 
@@ -40,6 +40,50 @@
 
 extern int MBType2Value (Macroblock* currMB);
 
+/*!
+ *************************************************************************************
+ * \brief
+ *    Select the intra modes that get a full RD evaluation: the IntraRDOCandidates
+ *    modes with the lowest SATD + mode bits cost and the most probable mode.
+ *    Unavailable modes have a cost of DISTBLK_MAX.
+ *************************************************************************************
+ */
+static void preselect_intra_modes(VideoParameters *p_Vid, int num_candidates, distblk *satd_cost, int mostProbableMode, byte *selected)
+{
+  int ipmode, k, best;
+  int available = 0, checked = 0;
+
+  for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+  {
+    selected[ipmode] = 0;
+    if (satd_cost[ipmode] != DISTBLK_MAX)
+      ++available;
+  }
+
+  for (k = 0; k < num_candidates; k++)
+  {
+    best = -1;
+    for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+    {
+      if (!selected[ipmode] && satd_cost[ipmode] != DISTBLK_MAX && (best < 0 || satd_cost[ipmode] < satd_cost[best]))
+        best = ipmode;
+    }
+    if (best < 0)
+      break;
+    selected[best] = 1;
+  }
+
+  if (satd_cost[mostProbableMode] != DISTBLK_MAX)
+    selected[mostProbableMode] = 1;
+
+  for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+    checked += selected[ipmode];
+
+  p_Vid->intra_presel_blocks++;
+  p_Vid->intra_presel_modes += available;
+  p_Vid->intra_presel_checked += checked;
+}
+
 /*!
  *************************************************************************************
  * \brief
@@ -81,6 +125,8 @@ int mode_decision_for_I4x4_blocks_JM_High (Macroblock *currMB, int  b8,  int  b4
   int best_nz_coeff = 0;
   int block_x4 = block_x>>2;
   int block_y4 = block_y>>2;
+  int presel = (p_Inp->IntraRDOCandidates > 0);
+  byte selected[NO_INTRA_PMODE];
 
 #ifdef BEST_NZ_COEFF
   int best_coded_block_flag = 0;
@@ -113,6 +159,29 @@ int mode_decision_for_I4x4_blocks_JM_High (Macroblock *currMB, int  b8,  int  b4
   // set intra prediction values for 4x4 intra prediction
   currSlice->set_intrapred_4x4(currMB, PLANE_Y, pic_pix_x, pic_pix_y, &left_available, &up_available, &all_available);  
 
+  //===== RANK THE MODES BY SATD COST =====
+  if (presel)
+  {
+    distblk satd_cost[NO_INTRA_PMODE];
+    int lambda_mf = p_Vid->lambda_mf[currSlice->slice_type][p_Vid->masterQP][Q_PEL];
+
+    for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+    {
+      available_mode =  (all_available) || (ipmode==DC_PRED) ||
+        (up_available && (ipmode==VERT_PRED||ipmode==VERT_LEFT_PRED||ipmode==DIAG_DOWN_LEFT_PRED)) ||
+        (left_available && (ipmode==HOR_PRED||ipmode==HOR_UP_PRED));
+
+      satd_cost[ipmode] = DISTBLK_MAX;
+      if (available_mode && valid_intra_mode(currSlice, ipmode) != 0)
+      {
+        get_intrapred_4x4(currMB, PLANE_Y, ipmode, block_x, block_y, left_available, up_available);
+        satd_cost[ipmode] = weighted_cost(lambda_mf, (ipmode == mostProbableMode) ? 1 : 4)
+          + compute_satd4x4_cost(p_Vid, &p_Vid->pCurImg[pic_opix_y], currSlice->mpr_4x4[0][ipmode], pic_opix_x, DISTBLK_MAX);
+      }
+    }
+    preselect_intra_modes(p_Vid, p_Inp->IntraRDOCandidates, satd_cost, mostProbableMode, selected);
+  }
+
   //===== LOOP OVER ALL 4x4 INTRA PREDICTION MODES =====
   for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
   {
@@ -123,10 +192,14 @@ int mode_decision_for_I4x4_blocks_JM_High (Macroblock *currMB, int  b8,  int  b4
     if (valid_intra_mode(currSlice, ipmode) == 0)
       continue;
 
+    if (presel && !selected[ipmode])
+      continue;
+
     if( available_mode)
     {
-      // generate intra 4x4 prediction block given availability
-      get_intrapred_4x4(currMB, PLANE_Y, ipmode, block_x, block_y, left_available, up_available);
+      // generate intra 4x4 prediction block given availability (already done when ranking)
+      if (!presel)
+        get_intrapred_4x4(currMB, PLANE_Y, ipmode, block_x, block_y, left_available, up_available);
 
       // get prediction and prediction error
       generate_pred_error_4x4(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_4x4[0][ipmode], &currSlice->mb_pred[0][block_y], &currSlice->mb_ores[0][block_y], pic_opix_x, block_x);     
@@ -252,6 +325,8 @@ int mode_decision_for_I8x8_blocks_JM_High (Macroblock *currMB, int b8, int lambd
   PixelPos left_block, top_block;
 
   int *mb_size = p_Vid->mb_size[IS_LUMA];
+  int presel = (p_Inp->IntraRDOCandidates > 0);
+  byte selected[NO_INTRA_PMODE];
 
   get4x4Neighbour(currMB, block_x - 1, block_y    , mb_size, &left_block);
   get4x4Neighbour(currMB, block_x,     block_y - 1, mb_size, &top_block );
@@ -280,15 +355,41 @@ int mode_decision_for_I8x8_blocks_JM_High (Macroblock *currMB, int b8, int lambd
   //===== INTRA PREDICTION FOR 8x8 BLOCK =====
   currSlice->set_intrapred_8x8(currMB, PLANE_Y, pic_pix_x, pic_pix_y, &left_available, &up_available, &all_available);
 
+  //===== RANK THE MODES BY SATD COST =====
+  if (presel)
+  {
+    distblk satd_cost[NO_INTRA_PMODE];
+    int lambda_mf = p_Vid->lambda_mf[currSlice->slice_type][p_Vid->masterQP][Q_PEL];
+
+    for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+    {
+      satd_cost[ipmode] = DISTBLK_MAX;
+      if( (ipmode==DC_PRED) ||
+        ((ipmode==VERT_PRED||ipmode==VERT_LEFT_PRED||ipmode==DIAG_DOWN_LEFT_PRED) && up_available ) ||
+        ((ipmode==HOR_PRED||ipmode==HOR_UP_PRED) && left_available ) ||
+        (all_available) )
+      {
+        get_intrapred_8x8(currMB, PLANE_Y, ipmode, left_available, up_available);
+        satd_cost[ipmode] = weighted_cost(lambda_mf, (ipmode == mostProbableMode) ? 1 : 4)
+          + compute_satd8x8_cost(p_Vid, &p_Vid->pCurImg[pic_opix_y], currSlice->mpr_8x8[0][ipmode], pic_opix_x, DISTBLK_MAX);
+      }
+    }
+    preselect_intra_modes(p_Vid, p_Inp->IntraRDOCandidates, satd_cost, mostProbableMode, selected);
+  }
+
   //===== LOOP OVER ALL 8x8 INTRA PREDICTION MODES =====
   for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
   {
+    if (presel && !selected[ipmode])
+      continue;
+
     if( (ipmode==DC_PRED) ||
       ((ipmode==VERT_PRED||ipmode==VERT_LEFT_PRED||ipmode==DIAG_DOWN_LEFT_PRED) && up_available ) ||
       ((ipmode==HOR_PRED||ipmode==HOR_UP_PRED) && left_available ) ||
       (all_available) )
     {
-      get_intrapred_8x8(currMB, PLANE_Y, ipmode, left_available, up_available);
+      if (!presel)
+        get_intrapred_8x8(currMB, PLANE_Y, ipmode, left_available, up_available);
       // get prediction and prediction error
       generate_pred_error_8x8(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_8x8[0][ipmode], &mb_pred[block_y], &mb_ores[block_y], pic_opix_x, block_x);     
 
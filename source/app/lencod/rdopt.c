@@ -56,7 +56,6 @@ static void set_ref_and_motion_vectors_B_slice    (Macroblock *currMB, PicMotion
 
 static distblk compute_sad4x4_cost (VideoParameters *p_Vid, imgpel **cur_img, imgpel **prd_img, int pic_opix_x, distblk min_cost);
 static distblk compute_sse4x4_cost (VideoParameters *p_Vid, imgpel **cur_img, imgpel **prd_img, int pic_opix_x, distblk min_cost);
-static distblk compute_satd4x4_cost(VideoParameters *p_Vid, imgpel **cur_img, imgpel **prd_img, int pic_opix_x, distblk min_cost);
 static distblk compute_comp4x4_cost(VideoParameters *p_Vid, imgpel **cur_img, imgpel **prd_img, int pic_opix_x, distblk min_cost);
 
 static distblk rdcost_for_4x4_intra_blocks     (Macroblock *currMB, int* nonzero, int b8, int b4, int ipmode, int lambda, int mostProbableMode, distblk min_rdcost);
@@ -152,6 +151,7 @@ void clear_rdopt (Slice *currSlice)
   delete_coding_state (p_RDO->cs_b8);
   delete_coding_state (p_RDO->cs_cm);
   delete_coding_state (p_RDO->cs_tmp);
+  delete_ctx_undo_log (p_RDO->ctx_log);
 }
 
 void setupDistCost(Slice *currSlice, InputParameters *p_Inp)
@@ -274,6 +274,7 @@ void init_rdopt (Slice *currSlice)
   p_RDO->cs_b8  = create_coding_state (p_Inp);
   p_RDO->cs_cm  = create_coding_state (p_Inp);
   p_RDO->cs_tmp = create_coding_state (p_Inp);
+  p_RDO->ctx_log = (p_Inp->symbol_mode == CABAC) ? create_ctx_undo_log () : NULL;
   if (p_Inp->CtxAdptLagrangeMult == 1)
   {
     p_Vid->mb16x16_cost = CALM_MF_FACTOR_THRESHOLD;
@@ -1801,6 +1802,22 @@ void prepare_ipcm_mode(Macroblock *currMB)
       p_Vid->nz_coeff[currMB->mbAddrX][j][i] = 16;
 }
 
+/*!
+ *************************************************************************************
+ * \brief
+ *    Keeps the cost of a mode at the master QP for the mode short list of the
+ *    other QPs (RDOQ_CP_Mode = 2). A mode rejected on its distortion alone
+ *    keeps that distortion, a lower bound of its cost.
+ *************************************************************************************
+ */
+static inline void store_rdoq_mode_cost(Macroblock *currMB, short mode, distblk cost)
+{
+  Slice *currSlice = currMB->p_Slice;
+
+  if (currMB->p_Inp->RDOQ_CP_Mode == 2 && currSlice->UseRDOQuant && currMB->p_Vid->qp == currMB->p_Vid->masterQP)
+    currSlice->rdoq_mode_cost[mode] = distblkmin(currSlice->rdoq_mode_cost[mode], cost);
+}
+
 /*!
  *************************************************************************************
  * \brief
@@ -1921,7 +1938,10 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
     distortion = currSlice->getDistortion(currMB);
   }
   if (distortion > currMB->min_rdcost)
+  {
+    store_rdoq_mode_cost(currMB, mode, distortion);
     return 0;
+  }
   //printf("passed distortion %.2f %.2f\n", (double)distortion, currMB->min_rdcost);
 
   if (currMB->qp_scaled[0] == 0 && p_Vid->active_sps->lossless_qpprime_flag == 1 && distortion != 0)
@@ -1980,6 +2000,8 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
   }
 #endif //end;
 
+  store_rdoq_mode_cost(currMB, mode, rdcost);
+
   // 
   if ((currSlice->slice_type != I_SLICE) && (p_Inp->BiasSkipRDO == 1) && (mode == 1) && (currMB->best_mode == 0) && (currMB->min_dcost > 4 * distortion) && (currMB->min_dcost > ((64 * (256 + 2 * p_Vid->mb_cr_size_y * p_Vid->mb_cr_size_x)) << LAMBDA_ACCURACY_BITS)))
   {
@@ -68,6 +68,7 @@ struct rdo_structure
   CSobj *cs_b8;
   CSobj *cs_cm;
   CSobj *cs_tmp;
+  CtxUndoLog *ctx_log;  //!< context changes since the first coding state of the macroblock (CABAC)
 
   BestMode mode_best;
 
@@ -78,6 +79,7 @@ struct rdo_structure
 
 extern byte    field_flag_inference (Macroblock  *currMB);
 extern int valid_intra_mode(Slice *currSlice, int ipmode);
+extern distblk compute_satd4x4_cost(VideoParameters *p_Vid, imgpel **cur_img, imgpel **prd_img, int pic_opix_x, distblk min_cost);
 
 extern void init_md_best(BestMode  *best);
 
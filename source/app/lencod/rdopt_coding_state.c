@@ -17,7 +17,9 @@
 #include "global.h"
 
 #include "rdopt_coding_state.h"
+#include "rdopt.h"
 #include "cabac.h"
+#include "biariencode.h"
 #include "memalloc.h"
 
 /*!
@@ -36,16 +38,12 @@ void delete_coding_state (CSobj *cs)
       free (cs->encenv);
       cs->encenv = NULL;
     }
-    if (cs->bitstream != NULL)
+    if (cs->bs_mark != NULL)
     {
-      free (cs->bitstream);
-      cs->bitstream = NULL;
+      free (cs->bs_mark);
+      cs->bs_mark = NULL;
     }
 
-    //=== contexts for binary arithmetic coding ===
-    delete_contexts_MotionInfo  (cs->mot_ctx);
-    delete_contexts_TextureInfo (cs->tex_ctx);
-
     if (cs->cbp_bits_8x8 != NULL)
     {
       free (cs->cbp_bits_8x8);
@@ -79,23 +77,14 @@ CSobj *create_coding_state (InputParameters *p_Inp)
   {
     if ((cs->encenv = (EncodingEnvironment*) calloc (cs->no_part, sizeof(EncodingEnvironment))) == NULL)
       no_mem_exit("init_coding_state: cs->encenv");
-
-    if ((cs->bitstream = (Bitstream*) calloc (cs->no_part, sizeof(Bitstream))) == NULL)
-      no_mem_exit("init_coding_state: cs->bitstream");
-    //=== context for binary arithmetic coding ===
-    cs->mot_ctx = create_contexts_MotionInfo ();
-    cs->tex_ctx = create_contexts_TextureInfo();
-
   }
   else
   {
     cs->encenv = NULL;
-    if ((cs->bitstream = (Bitstream*) calloc (cs->no_part, sizeof(Bitstream))) == NULL)
-      no_mem_exit("init_coding_state: cs->bitstream");
-
-    cs->mot_ctx = NULL;
-    cs->tex_ctx = NULL;
   }
+
+  if ((cs->bs_mark = (BitstreamMark*) calloc (cs->no_part, sizeof(BitstreamMark))) == NULL)
+    no_mem_exit("init_coding_state: cs->bs_mark");
   
   if (p_Inp->ProfileIDC == FREXT_Hi444)
   {
@@ -108,6 +97,232 @@ CSobj *create_coding_state (InputParameters *p_Inp)
   return cs;
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    create the journal of context changes shared by the coding
+ *    states of a slice
+ ************************************************************************
+ */
+CtxUndoLog *create_ctx_undo_log (void)
+{
+  CtxUndoLog *p_log;
+
+  if ((p_log = (CtxUndoLog *) calloc (1, sizeof(CtxUndoLog))) == NULL)
+    no_mem_exit("create_ctx_undo_log: p_log");
+
+  p_log->max_size = 1024;
+  if ((p_log->entries = (CtxUndoEntry *) malloc (p_log->max_size * sizeof(CtxUndoEntry))) == NULL)
+    no_mem_exit("create_ctx_undo_log: p_log->entries");
+
+  p_log->max_values = 1024;
+  if ((p_log->values = (CtxUndoEntry *) malloc (p_log->max_values * sizeof(CtxUndoEntry))) == NULL)
+    no_mem_exit("create_ctx_undo_log: p_log->values");
+
+  p_log->max_checkpoints = 64;
+  if ((p_log->checkpoints = (CtxCheckpoint *) malloc (p_log->max_checkpoints * sizeof(CtxCheckpoint))) == NULL)
+    no_mem_exit("create_ctx_undo_log: p_log->checkpoints");
+
+  return p_log;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    delete the journal of context changes
+ ************************************************************************
+ */
+void delete_ctx_undo_log (CtxUndoLog *p_log)
+{
+  if (p_log != NULL)
+  {
+    free (p_log->entries);
+    free (p_log->values);
+    free (p_log->checkpoints);
+    free (p_log);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Ends the journaling of the current macroblock before its chosen
+ *    mode is coded. Coding states stored so far can not be restored
+ *    afterwards.
+ ************************************************************************
+ */
+void clear_coding_state_journal (Slice *currSlice)
+{
+  int i;
+
+  for (i = 0; i < currSlice->max_part_nr; i++)
+  {
+    currSlice->partArr[i].ee_cabac.Elog = NULL;
+    arienco_stop_estimation(&currSlice->partArr[i].ee_cabac);
+  }
+
+  if (currSlice->p_RDO->ctx_log != NULL)
+  {
+    CtxUndoLog *p_log = currSlice->p_RDO->ctx_log;
+    p_log->size            = 0;
+    p_log->low_size        = 0;
+    p_log->num_values      = 0;
+    p_log->num_checkpoints = 0;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    store/restore the position of a bitstream
+ ************************************************************************
+ */
+static inline void mark_bitstream (BitstreamMark *mark, Bitstream *bitstream)
+{
+  mark->byte_pos   = bitstream->byte_pos;
+  mark->bits_to_go = bitstream->bits_to_go;
+  mark->write_flag = bitstream->write_flag;
+  mark->byte_buf   = bitstream->byte_buf;
+}
+
+static inline void rewind_bitstream (Bitstream *bitstream, BitstreamMark *mark)
+{
+  bitstream->byte_pos   = mark->byte_pos;
+  bitstream->bits_to_go = mark->bits_to_go;
+  bitstream->write_flag = mark->write_flag;
+  bitstream->byte_buf   = mark->byte_buf;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    appends a context and its current value to the checkpoint values
+ ************************************************************************
+ */
+static inline void add_ctx_value (CtxUndoLog *p_log, BiContextTypePtr ctx)
+{
+  if (p_log->num_values == p_log->max_values)
+  {
+    p_log->max_values <<= 1;
+    if ((p_log->values = (CtxUndoEntry *) realloc (p_log->values, p_log->max_values * sizeof(CtxUndoEntry))) == NULL)
+      no_mem_exit("add_ctx_value: p_log->values");
+  }
+  p_log->values[p_log->num_values].ctx   = ctx;
+  p_log->values[p_log->num_values].saved = *ctx;
+  p_log->num_values++;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    undo the journaled context changes down to the given log size
+ *
+ *    Contexts of entries that were already logged at the last
+ *    checkpoint are noted, the next checkpoint saves their values.
+ ************************************************************************
+ */
+static inline void undo_ctx_log (CtxUndoLog *p_log, int size)
+{
+  CtxUndoEntry *entry = p_log->entries + p_log->size;
+
+  while (p_log->size > size)
+  {
+    --entry;
+    *entry->ctx = entry->saved;
+    if (--p_log->size < p_log->low_size)
+      add_ctx_value (p_log, entry->ctx);
+  }
+
+  if (p_log->low_size > size)
+    p_log->low_size = size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    takes a checkpoint of the context undo log and returns its index
+ *
+ *    The checkpoint saves the current values of the contexts changed
+ *    since the previous checkpoint: those logged since and those whose
+ *    log entries were undone since. The cost is proportional to the
+ *    bins coded since the previous checkpoint.
+ ************************************************************************
+ */
+static int checkpoint_ctx_log (CtxUndoLog *p_log)
+{
+  CtxCheckpoint *cp;
+  int i;
+  int first = 0;
+
+  if (p_log->num_checkpoints > 0)
+  {
+    cp = &p_log->checkpoints[p_log->num_checkpoints - 1];
+    first = cp->first + cp->num_values;
+  }
+
+  if (p_log->num_checkpoints == p_log->max_checkpoints)
+  {
+    p_log->max_checkpoints <<= 1;
+    if ((p_log->checkpoints = (CtxCheckpoint *) realloc (p_log->checkpoints, p_log->max_checkpoints * sizeof(CtxCheckpoint))) == NULL)
+      no_mem_exit("checkpoint_ctx_log: p_log->checkpoints");
+  }
+
+  // contexts undone since the previous checkpoint: take their values now
+  for (i = first; i < p_log->num_values; i++)
+    p_log->values[i].saved = *p_log->values[i].ctx;
+
+  for (i = p_log->low_size; i < p_log->size; i++)
+    add_ctx_value (p_log, p_log->entries[i].ctx);
+
+  cp = &p_log->checkpoints[p_log->num_checkpoints];
+  cp->first      = first;
+  cp->num_values = p_log->num_values - first;
+  cp->mark       = p_log->size;
+  cp->id         = (p_log->size > 0) ? p_log->entries[p_log->size - 1].id : 0;
+
+  p_log->low_size = p_log->size;
+
+  return p_log->num_checkpoints++;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    restores the contexts of a checkpoint
+ *
+ *    If the log entries up to the checkpoint are still in the log, it
+ *    is enough to undo the later ones. Otherwise the log is undone to
+ *    the last checkpoint before it that is still valid and the values
+ *    of the following checkpoints are applied again.
+ ************************************************************************
+ */
+static void restore_ctx_checkpoint (CtxUndoLog *p_log, int idx)
+{
+  CtxCheckpoint *cp = &p_log->checkpoints[idx];
+  int i, j;
+
+  // the first checkpoint of the macroblock (mark 0) is always valid
+  while (p_log->size < cp->mark || (cp->mark > 0 && p_log->entries[cp->mark - 1].id != cp->id))
+    --cp;
+
+  undo_ctx_log (p_log, cp->mark);
+
+  for (j = (int) (cp - p_log->checkpoints) + 1; j <= idx; j++)
+  {
+    cp = &p_log->checkpoints[j];
+    for (i = cp->first; i < cp->first + cp->num_values; i++)
+    {
+      log_context (p_log, p_log->values[i].ctx);
+      *p_log->values[i].ctx = p_log->values[i].saved;
+    }
+    if (j == idx)
+    {
+      cp->mark = p_log->size;
+      cp->id   = (p_log->size > 0) ? p_log->entries[p_log->size - 1].id : 0;
+    }
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -134,7 +349,7 @@ void store_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
   //=== important variables of data partition array ===
   for (i = 0; i < i_last; i++)
   {
-    cs->bitstream[i] = *currSlice->partArr[i].bitstream;
+    mark_bitstream (&cs->bs_mark[i], currSlice->partArr[i].bitstream);
   }
 
   //=== syntax element number and bitcounters ===
@@ -153,6 +368,12 @@ void store_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
  ************************************************************************
  * \brief
  *    store cabac coding state (for rd-optimized mode decision)
+ *
+ *    Instead of copying the context models, the first coding state
+ *    of a macroblock starts a journal of all context changes (see
+ *    biari_encode_symbol) and each coding state only takes a
+ *    checkpoint of the journal. With CABACRateEstimation the bins
+ *    are only estimated from then on.
  ************************************************************************
  */
 static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
@@ -161,18 +382,31 @@ static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   Slice *currSlice = currMB->p_Slice;
   int  i_last = currSlice->idr_flag? 1:cs->no_part;  
   DataPartition *partArr = &currSlice->partArr[0];
+  CtxUndoLog *p_log = currSlice->p_RDO->ctx_log;
+
+  if (partArr->ee_cabac.Elog == NULL)
+  {
+    if (currSlice->p_Inp->CABACRateEstimation && ++currSlice->cabac_est_epoch == 0)
+      currSlice->cabac_est_epoch = 1;
+
+    for (i = 0; i < i_last; i++)
+    {
+      partArr[i].ee_cabac.Elog = p_log;
+      if (currSlice->p_Inp->CABACRateEstimation)
+        arienco_start_estimation(&partArr[i].ee_cabac, currSlice->cabac_est_epoch);
+    }
+  }
 
   //=== important variables of data partition array ===
   //only one partition for an IDR picture
   for (i = 0; i < i_last; i++)
   {
-    cs->bitstream[i] = *partArr->bitstream;
-    cs->encenv[i]    = (partArr++)->ee_cabac;    
+    mark_bitstream (&cs->bs_mark[i], partArr->bitstream);
+    cs->encenv[i] = (partArr++)->ee_cabac;    
   }
 
   //=== contexts for binary arithmetic coding ===
-  *cs->mot_ctx = *currSlice->mot_ctx;
-  *cs->tex_ctx = *currSlice->tex_ctx;
+  cs->ctx_checkpoint = checkpoint_ctx_log (p_log);
 
   //=== syntax element number and bitcounters ===
   cs->bits = currMB->bits;
@@ -213,7 +447,7 @@ void reset_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
   for (i = 0; i < i_last; i++)
   {
     //--- parameters of encoding environments ---
-    *currSlice->partArr[i].bitstream = cs->bitstream[i];
+    rewind_bitstream (currSlice->partArr[i].bitstream, &cs->bs_mark[i]);
   }
 
   //=== syntax element number and bit counters ===
@@ -232,6 +466,10 @@ void reset_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
  ************************************************************************
  * \brief
  *    restore coding state (for rd-optimized mode decision)
+ *
+ *    The context changes journaled after the state was stored are
+ *    undone in reverse order, so the cost is proportional to the
+ *    number of bins coded since.
  ************************************************************************
  */
 static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
@@ -240,19 +478,19 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   Slice *currSlice = currMB->p_Slice;
   int  i_last = currSlice->idr_flag? 1:cs->no_part;   
   DataPartition *partArr = &currSlice->partArr[0];
+  CtxUndoLog *p_log = currSlice->p_RDO->ctx_log;
 
   //=== important variables of data partition array ===
   //only one partition for an IDR picture
   for (i = 0; i < i_last; i++)
   {
     //--- parameters of encoding environments ---
-    *partArr->bitstream   = cs->bitstream[i];
+    rewind_bitstream (partArr->bitstream, &cs->bs_mark[i]);
     (partArr++)->ee_cabac = cs->encenv[i];
   }
 
   //=== contexts for binary arithmetic coding ===
-  *currSlice->mot_ctx = *cs->mot_ctx;
-  *currSlice->tex_ctx = *cs->tex_ctx;
+  restore_ctx_checkpoint (p_log, cs->ctx_checkpoint);
 
   //=== syntax element number and bit counters ===
   currMB->bits = cs->bits;
@@ -267,9 +505,6 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
     memcpy (currMB->cbp_bits_8x8, cs->cbp_bits_8x8, 3 * sizeof(int64));
 }
 
-
-
-
 /*!
  ************************************************************************
  * \brief
@@ -19,16 +19,24 @@
 #ifndef _RD_OPT_CS_H_
 #define _RD_OPT_CS_H_
 
+//! position of a bitstream, the written data after it is simply overwritten
+typedef struct bitstream_mark
+{
+  int                  byte_pos;
+  int                  bits_to_go;
+  int                  write_flag;
+  byte                 byte_buf;
+} BitstreamMark;
+
 struct coding_state {
 
   // important variables of data partition array
   int                  no_part;
-  Bitstream            *bitstream;
+  BitstreamMark        *bs_mark;
   EncodingEnvironment  *encenv;
 
   // contexts for binary arithmetic coding
-  MotionInfoContexts   *mot_ctx;
-  TextureInfoContexts  *tex_ctx;
+  int                   ctx_checkpoint;  //!< checkpoint of the context undo log taken when the state was stored
 
   // bit counter
   BitCounter            bits;
@@ -43,6 +51,9 @@ typedef struct coding_state CSobj;
 
 extern void  delete_coding_state  (CSobj *);  //!< delete structure
 extern CSobj *create_coding_state  (InputParameters *p_Inp);       //!< create structure
+extern CtxUndoLog *create_ctx_undo_log (void);
+extern void  delete_ctx_undo_log  (CtxUndoLog *p_log);
+extern void  clear_coding_state_journal (Slice *currSlice);
 
 extern void init_coding_state_methods(Slice *currSlice);  //!< Init methods given entropy coding
 
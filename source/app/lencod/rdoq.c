@@ -22,6 +22,7 @@
 #include "mv_search.h"
 
 #define RDOQ_BASE 0
+#define RDOQ_CP_MODE_SHIFT 3   //!< RDOQ_CP_Mode = 2 keeps the modes within 1/8 of the best cost at the master QP
 
 
 /*!
@@ -34,9 +35,94 @@ void init_rdoq_slice(Slice *currSlice)
 {
   //currSlice->norm_factor_4x4 = (double) ((int64) 1 << (2 * DQ_BITS + 19)); // norm factor 4x4 is basically (1<<31)
   //currSlice->norm_factor_8x8 = (double) ((int64) 1 << (2 * Q_BITS_8 + 9)); // norm factor 8x8 is basically (1<<41)
+  int qp_rem, j, i;
+
   currSlice->norm_factor_4x4 = pow(2, (2 * DQ_BITS + 19));
   currSlice->norm_factor_8x8 = pow(2, (2 * Q_BITS_8 + 9));
+
+  for (qp_rem = 0; qp_rem < 6; ++qp_rem)
+  {
+    for (j = 0; j < 4; ++j)
+      for (i = 0; i < 4; ++i)
+        currSlice->est_err_4x4[qp_rem][j][i] = ((double) estErr4x4[qp_rem][j][i]) / currSlice->norm_factor_4x4;
+    for (j = 0; j < 8; ++j)
+      for (i = 0; i < 8; ++i)
+        currSlice->est_err_8x8[qp_rem][j][i] = (double) estErr8x8[qp_rem][j][i] / currSlice->norm_factor_8x8;
+  }
+}
+
+/*!
+****************************************************************************
+* \brief
+*    Look up the CABAC trellis result of a block.
+*
+*    The motion and intra mode decisions of a macroblock quantize the same
+*    residual many times with identical rate estimates, since the CABAC
+*    estimates are only updated once per macroblock (and per QP for
+*    RDOQ_QP_Num > 1). Results are kept for the current macroblock only.
+*
+* \return
+*    TRUE if a result was found and copied to levelTrellis; otherwise
+*    *entry is the slot to pass to rdoq_cache_store() once the trellis
+*    has been run (NULL if no cache is in use).
+****************************************************************************
+*/
+int rdoq_cache_lookup(Slice *currSlice, RDOQCacheEntry **entry, int **tblock, int block_x, const byte *p_scan, int num_coeff, 
+                      int type, int qp, LevelQuantParams **q_params, double lambda, int est_cbp, int levelTrellis[])
+{
+  RDOQCache *p_cache = currSlice->p_RDOQCache;
+  RDOQCacheEntry *p_entry;
+  int coeff[64];
+  unsigned int hash = (unsigned int) ((type * 64 + qp) * 31 + est_cbp);
+  int k;
+
+  *entry = NULL;
+  if (p_cache == NULL)
+    return FALSE;
+
+  for (k = 0; k < num_coeff; ++k)
+  {
+    coeff[k] = tblock[p_scan[1]][block_x + p_scan[0]];
+    hash = (hash ^ (unsigned int) coeff[k]) * 0x01000193;
+    p_scan += 2;
+  }
+  p_scan -= 2 * num_coeff;
+
+  p_entry = &p_cache->entries[(hash ^ (hash >> 15)) & (RDOQ_CACHE_SIZE - 1)];
+  if (p_entry->stamp == p_cache->stamp && p_entry->type == type && p_entry->qp == qp && p_entry->est_cbp == est_cbp
+    && p_entry->num_coeff == num_coeff && p_entry->lambda == lambda && p_entry->q_params == q_params && p_entry->p_scan == p_scan
+    && memcmp(p_entry->coeff, coeff, num_coeff * sizeof(int)) == 0)
+  {
+    memcpy(levelTrellis, p_entry->level, num_coeff * sizeof(int));
+    return TRUE;
+  }
+
+  p_entry->stamp     = p_cache->stamp;
+  p_entry->type      = type;
+  p_entry->qp        = qp;
+  p_entry->est_cbp   = est_cbp;
+  p_entry->num_coeff = num_coeff;
+  p_entry->lambda    = lambda;
+  p_entry->q_params  = q_params;
+  p_entry->p_scan    = p_scan;
+  memcpy(p_entry->coeff, coeff, num_coeff * sizeof(int));
+
+  *entry = p_entry;
+  return FALSE;
 }
+
+/*!
+****************************************************************************
+* \brief
+*    Store the trellis result of the block passed to rdoq_cache_lookup()
+****************************************************************************
+*/
+void rdoq_cache_store(RDOQCacheEntry *entry, int levelTrellis[])
+{
+  if (entry != NULL)
+    memcpy(entry->level, levelTrellis, entry->num_coeff * sizeof(int));
+}
+
 /*!
 ****************************************************************************
 * \brief
@@ -248,8 +334,16 @@ void trellis_mp(Macroblock *currMB)
 
   currSlice->rddata_trellis_best.min_rdcost = 1e30;
 
+  if (p_Inp->RDOQ_CP_Mode == 2)
+  {
+    int mode;
+    for (mode = 0; mode < MAXMODE; mode++)
+      currSlice->rdoq_mode_cost[mode] = DISTBLK_MAX;
+  }
+
   if (p_Inp->symbol_mode == CABAC)
   {
+    ++currSlice->p_RDOQCache->stamp;
     estRunLevel_CABAC(currMB, LUMA_4x4); 
     estRunLevel_CABAC(currMB, LUMA_16AC);
     estRunLevel_CABAC(currMB, LUMA_16DC);
@@ -344,6 +438,7 @@ void trellis_sp(Macroblock *currMB)
 
   if (currSlice->symbol_mode == CABAC)
   {
+    ++currSlice->p_RDOQCache->stamp;
     estRunLevel_CABAC(currMB, LUMA_4x4); 
     estRunLevel_CABAC(currMB, LUMA_16AC);
 
@@ -391,6 +486,27 @@ void RDOQ_update_mode(Slice *currSlice, RD_PARAMS *enc_mb)
 
   int mb_type = currSlice->rddata_trellis_best.mb_type;
   int i;
+
+  // keep the modes whose cost at the master QP came close to the best one
+  if (p_Inp->RDOQ_CP_Mode == 2)
+  {
+    distblk threshold = DISTBLK_MAX;
+
+    for(i=0; i<MAXMODE; i++)
+      threshold = distblkmin(threshold, currSlice->rdoq_mode_cost[i]);
+    if (threshold == DISTBLK_MAX)
+      return;
+    threshold += (threshold >> RDOQ_CP_MODE_SHIFT);
+
+    for(i=0; i<MAXMODE; i++)
+    {
+      // the sub-macroblock partitions (4..7) follow P8x8
+      if ((i < 4 || i > 7) && currSlice->rdoq_mode_cost[i] > threshold)
+        enc_mb->valid[i] = 0;
+    }
+    return;
+  }
+
   for(i=0; i<MAXMODE; i++)
     enc_mb->valid[i] = 0;
 
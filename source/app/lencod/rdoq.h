@@ -147,8 +147,34 @@ typedef struct level_data_struct
   int sign;
 } levelDataStruct;
 
+#define RDOQ_CACHE_SIZE 512   //!< number of cached CABAC trellis results per slice (power of two)
+
+//! result of one CABAC trellis search, keyed by everything the search depends on
+typedef struct rdoq_cache_entry
+{
+  int    stamp;               //!< macroblock the entry belongs to
+  int    type;                //!< block type
+  int    qp;                  //!< quantization parameter (qp_per * 6 + qp_rem)
+  int    est_cbp;             //!< estimated coded block flag bits
+  int    num_coeff;           //!< number of coefficients in the scan
+  double lambda;              //!< lagrangian multiplier
+  LevelQuantParams **q_params;//!< quantization matrix
+  const byte *p_scan;         //!< scan order
+  int    coeff[64];           //!< transform coefficients in scan order
+  int    level[64];           //!< levels selected by the trellis
+} RDOQCacheEntry;
+
+typedef struct rdoq_cache
+{
+  RDOQCacheEntry entries[RDOQ_CACHE_SIZE];
+  int stamp;
+} RDOQCache;
+
 
 extern void init_rdoq_slice(Slice *currSlice);
+extern int  rdoq_cache_lookup(Slice *currSlice, RDOQCacheEntry **entry, int **tblock, int block_x, const byte *p_scan, int num_coeff, 
+                              int type, int qp, LevelQuantParams **q_params, double lambda, int est_cbp, int levelTrellis[]);
+extern void rdoq_cache_store (RDOQCacheEntry *entry, int levelTrellis[]);
 
 /*----------CAVLC related functions----------*/
 extern void est_RunLevel_CAVLC(Macroblock *currMB, levelDataStruct *levelData, int *levelTrellis, int block_type, 
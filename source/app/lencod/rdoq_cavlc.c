@@ -496,7 +496,7 @@ void init_trellis_data_4x4_CAVLC(Macroblock *currMB, int **tblock, int block_x,
     }
     else
     {
-      estErr = ((double) estErr4x4[qp_rem][j][i]) / currSlice->norm_factor_4x4;
+      estErr = currSlice->est_err_4x4[qp_rem][j][i];
 
       scaled_coeff = iabs(*m7) * q_params[j][i].ScaleComp;
       dataLevel->levelDouble = scaled_coeff;
@@ -663,7 +663,7 @@ void init_trellis_data_8x8_CAVLC(Macroblock *currMB, int **tblock, int block_x,
       }
       else
       {
-        estErr = (double) estErr8x8[qp_rem][j][i] / currSlice->norm_factor_8x8;
+        estErr = currSlice->est_err_8x8[qp_rem][j][i];
 
         scaled_coeff = iabs(*m7) * q_params[j][i].ScaleComp;
         dataLevel->levelDouble = scaled_coeff;
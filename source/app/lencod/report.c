@@ -29,6 +29,10 @@
 #include "parset.h"
 #include "report.h"
 #include "img_process_types.h"
+#include "otf_cache.h"
+#include "me_cache.h"
+#include "rt_control.h"
+#include "lookahead.h"
 
 
 static const char DistortionType[3][20] = {"SAD", "SSE", "Hadamard SAD"};
@@ -801,6 +805,45 @@ void report( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_S
 
     fprintf(stdout,  " Total encoding time for the seq.  : %7.3f sec (%3.2f fps)\n", (float) p_Vid->tot_time * 0.001, 1000.0 * (float) (p_Stats->frame_counter) / (float)p_Vid->tot_time);
     fprintf(stdout,  " Total ME time for sequence        : %7.3f sec \n\n", (float)p_Vid->me_tot_time * 0.001);
+    if (p_Vid->p_OtfCache != NULL)
+    {
+      OTFTileCache *p_cache = p_Vid->p_OtfCache;
+      int64 lookups = p_cache->hits + p_cache->misses;
+      fprintf(stdout,  " OTF tile cache hit rate           : %6.2f%% (%" FORMAT_OFF_T " lookups)\n\n",
+        lookups ? (100.0 * (double) p_cache->hits / (double) lookups) : 0.0, lookups);
+    }
+    if (p_Vid->p_MECache != NULL)
+    {
+      MECache *p_cache = p_Vid->p_MECache;
+      double lookups = p_cache->lookups ? (double) p_cache->lookups : 1.0;
+      fprintf(stdout,  " ME result cache reused/refined    : %6.2f%% / %6.2f%% (%" FORMAT_OFF_T " lookups)\n\n",
+        100.0 * (double) p_cache->reused / lookups, 100.0 * (double) p_cache->refined / lookups, p_cache->lookups);
+    }
+    if (p_Vid->p_RTCtrl != NULL && p_Vid->p_RTCtrl->frames)
+    {
+      RTControl *p_rt = p_Vid->p_RTCtrl;
+      fprintf(stdout,  " Real-time control (target/actual) : %6.2f / %6.2f fps, mean level %4.2f, %" FORMAT_OFF_T " frames late\n\n",
+        p_Inp->RTTargetFPS, p_rt->total_time ? 1000.0 * (double) p_rt->frames / (double) p_rt->total_time : 0.0,
+        (double) p_rt->level_sum / (double) p_rt->frames, p_rt->late_frames);
+    }
+    if (p_Vid->p_Lookahead != NULL)
+    {
+      Lookahead *p_la = p_Vid->p_Lookahead;
+      fprintf(stdout,  " Lookahead pre-analysis            : %d frames in %7.3f sec, %d scene cuts, %d static frames\n\n",
+        p_la->analysed, (float) p_la->time * 0.001, p_la->scene_cuts, p_la->static_frames);
+    }
+    if (p_Vid->num_segments > 1)
+    {
+      fprintf(stdout,  " Segment-parallel encoding         : %d segments in up to %d processes\n\n",
+        p_Vid->num_segments, p_Inp->SegmentParallel);
+    }
+    if (p_Inp->IntraRDOCandidates && p_Vid->intra_presel_blocks)
+    {
+      fprintf(stdout,  " Intra RDO modes checked per block : %6.2f of %4.2f (%5.2f%% pruned)\n\n",
+        (double) p_Vid->intra_presel_checked / (double) p_Vid->intra_presel_blocks,
+        (double) p_Vid->intra_presel_modes / (double) p_Vid->intra_presel_blocks,
+        100.0 * (double) (p_Vid->intra_presel_modes - p_Vid->intra_presel_checked) / (double) p_Vid->intra_presel_modes);
+    }
 
     fprintf(stdout," Y { PSNR (dB), cSNR (dB), MSE }   : { %7.3f, %7.3f, %9.5f }\n", 
       snr->average[0], csnr_y, sse->average[0]/(float)impix);
@@ -1004,7 +1047,8 @@ void report( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_S
   report_stats(p_Vid, p_Inp, p_Stats, bit_use);
 
   // write to log file
-  report_log(p_Vid, p_Inp, p_Stats);
+  if (p_Inp->ReportLog)
+    report_log(p_Vid, p_Inp, p_Stats);
 
   if (p_Inp->ReportFrameStats)
   {
@@ -1053,6 +1097,10 @@ void information_init ( VideoParameters *p_Vid, InputParameters *p_Inp, StatPara
   }
 
   fprintf(stdout,  " Input YUV file                    : %s \n", p_Inp->input_file1.fname);
+  if (p_Inp->input_file1.stream != NULL)
+    fprintf(stdout,  " Input read                        : Sequential%s, %d frames ahead\n", p_Inp->input_file1.vdtype == VIDEO_Y4M ? " (YUV4MPEG2)" : "", p_Inp->InputStreamReadAhead);
+  else if (p_Inp->input_file1.map != NULL)
+    fprintf(stdout,  " Input read                        : Memory mapped\n");
 #if (MVC_EXTENSION_ENABLE)
   if(p_Inp->num_of_views==2)
     fprintf(stdout,  " Input YUV file 2                  : %s \n", p_Inp->input_file2.fname);
@@ -1074,6 +1122,14 @@ void information_init ( VideoParameters *p_Vid, InputParameters *p_Inp, StatPara
   {
     fprintf(stdout,  " Freq. for encoded bitstream       : %3.2f\n", p_Inp->output.frame_rate);
     fprintf(stdout,  " PicInterlace / MbInterlace        : %d/%d\n", p_Inp->PicInterlace, p_Inp->MbInterlace);
+    if (p_Inp->ConcurrentFieldDecision)
+      fprintf(stdout," Concurrent frame/field decision   : Enabled\n");
+    if (p_Vid->p_Metrics != NULL)
+      fprintf(stdout," Quality metrics                   : Background thread\n");
+    if (p_Vid->p_Output != NULL)
+      fprintf(stdout," Bitstream/reconstruction output   : Background thread\n");
+    if (p_Inp->SegmentParallel)
+      fprintf(stdout," Segment-parallel encoding         : %d processes\n", p_Inp->SegmentParallel);
     fprintf(stdout,  " Transform8x8Mode                  : %d\n", p_Inp->Transform8x8Mode);
 
     for (i=0; i<3; i++)
@@ -1085,7 +1141,13 @@ void information_init ( VideoParameters *p_Vid, InputParameters *p_Inp, StatPara
     if( p_Inp->OnTheFlyFractMCP )
     {
       fprintf(stdout," On-the-fly interpolation mode     : OTF_L%d\n", p_Inp->OnTheFlyFractMCP );
+      if (p_Inp->OnTheFlyFractMCP == OTF_L3)
+        fprintf(stdout," OTF tile cache size               : %d tiles\n", p_Inp->OTFTileCacheSize );
     }
+    if (p_Vid->p_MECache != NULL)
+      fprintf(stdout," ME result cache                   : Enabled\n");
+    if (p_Inp->ParallelRefME)
+      fprintf(stdout," Reference-parallel ME             : Enabled\n");
 
     switch ( p_Inp->ChromaMEEnable )
     {
@@ -1167,6 +1229,8 @@ void information_init ( VideoParameters *p_Vid, InputParameters *p_Inp, StatPara
       fprintf(stdout," Entropy coding method             : CAVLC\n");
     else
       fprintf(stdout," Entropy coding method             : CABAC\n");
+    if (p_Inp->CABACRateEstimation)
+      fprintf(stdout," CABAC rate estimation in RDO      : Enabled\n");
 
     fprintf(stdout,  " Profile/Level IDC                 : (%d,%d)\n", p_Inp->ProfileIDC, p_Inp->LevelIDC);
 
@@ -0,0 +1,221 @@
+/*!
+ *************************************************************************************
+ * \file rt_control.c
+ *
+ * \brief
+ *    Real-time complexity control.
+ *
+ *    With RTTargetFPS set, the encoding time of every frame is fed to a PI
+ *    controller that moves the encoder along a complexity ladder (see RTLevel):
+ *    each level switches off or shrinks one more tool (RDOQ, intra checks in
+ *    inter slices, the mode decision, partitions, search pattern, range and
+ *    references, sub-pel ME). The controller raises the level while frames take
+ *    longer than the budget and lowers it again once there is headroom, so the
+ *    quality drops only as far as needed to keep up with the target rate.
+ *
+ *    Levels change between frames only, so all slices of a picture see the same
+ *    settings. The configured parameters are restored at the end of the sequence.
+ *
+ *************************************************************************************
+ */
+
+#include <math.h>
+
+#include "global.h"
+#include "rt_control.h"
+
+#define RT_SMOOTHING      0.3   //!< weight of the latest frame in the smoothed frame time
+#define RT_GAIN_P         1.0   //!< proportional gain (levels per relative error change)
+#define RT_GAIN_I         0.5   //!< integral gain (levels per relative error and frame)
+#define RT_DEAD_ZONE      0.05  //!< relative error treated as on target
+#define RT_DEADLINE_SKIP  1.5   //!< frames beyond this multiple of the budget raise the level at once
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets the encoder parameters of a complexity level. Every parameter
+ *    touched by the ladder is derived from the configured value, so the
+ *    levels can be applied in any order.
+ ************************************************************************
+ */
+static void rt_apply_level(RTControl *p_rt, InputParameters *p_Inp, int level)
+{
+  InputParameters *cfg = &p_rt->cfg;
+  int view, b, k;
+
+  // RDO quantization (the RDOQ_CP and multiple QP options depend on it)
+  if (level >= RT_LEVEL_NO_RDOQ)
+  {
+    p_Inp->UseRDOQuant  = 0;
+    p_Inp->RDOQ_QP_Num  = 1;
+    p_Inp->RDOQ_CP_MV   = 0;
+    p_Inp->RDOQ_CP_Mode = 0;
+  }
+  else
+  {
+    p_Inp->UseRDOQuant  = cfg->UseRDOQuant;
+    p_Inp->RDOQ_QP_Num  = cfg->RDOQ_QP_Num;
+    p_Inp->RDOQ_CP_MV   = cfg->RDOQ_CP_MV;
+    p_Inp->RDOQ_CP_Mode = cfg->RDOQ_CP_Mode;
+  }
+
+  p_Inp->SkipIntraInInterSlices = (level >= RT_LEVEL_SKIP_INTRA) ? 1 : cfg->SkipIntraInInterSlices;
+
+  // mode decision
+  if (level >= RT_LEVEL_LOW_MD && p_rt->low_md_allowed)
+    p_Inp->rdopt = 0;
+  else if (level >= RT_LEVEL_FAST_MD && p_rt->fast_md_allowed)
+    p_Inp->rdopt = 2;
+  else
+    p_Inp->rdopt = cfg->rdopt;
+
+  for (view = 0; view < 2; ++view)
+  {
+    // partitions; skip/direct and 16x16 are always checked
+    for (b = 0; b < 2; ++b)
+    {
+      for (k = 0; k < 8; ++k)
+        p_Inp->InterSearch[view][b][k] = cfg->InterSearch[view][b][k];
+      if (level >= RT_LEVEL_NO_SUB8x8)
+        p_Inp->InterSearch[view][b][5] = p_Inp->InterSearch[view][b][6] = p_Inp->InterSearch[view][b][7] = 0;
+      if (level >= RT_LEVEL_NO_8x8)
+        p_Inp->InterSearch[view][b][4] = 0;
+    }
+
+    // search method and range
+    p_Inp->SearchMode[view]   = (level >= RT_LEVEL_FAST_SEARCH) ? EPZS : cfg->SearchMode[view];
+    p_Inp->search_range[view] = (level >= RT_LEVEL_HALF_RANGE) ? imax(4, cfg->search_range[view] >> 1) : cfg->search_range[view];
+
+    // references
+    if (level >= RT_LEVEL_ONE_REF)
+    {
+      p_Inp->P_List0_refs[view] = 1;
+#if HM50_LIKE_MMCO
+      // the HM-5.0 like marking is bound to the configured B list sizes
+      if (!cfg->HM50RefStructure)
+#endif
+      {
+        p_Inp->B_List0_refs[view] = 1;
+        p_Inp->B_List1_refs[view] = 1;
+      }
+    }
+    else
+    {
+      p_Inp->P_List0_refs[view] = cfg->P_List0_refs[view];
+      p_Inp->B_List0_refs[view] = cfg->B_List0_refs[view];
+      p_Inp->B_List1_refs[view] = cfg->B_List1_refs[view];
+    }
+
+    p_Inp->DisableSubpelME[view] = (level >= RT_LEVEL_NO_SUBPEL) ? 1 : cfg->DisableSubpelME[view];
+  }
+
+  if (level >= RT_LEVEL_FAST_SEARCH)
+  {
+    p_Inp->EPZSPattern = 0;
+    p_Inp->EPZSDual    = 0;
+  }
+  else
+  {
+    p_Inp->EPZSPattern = cfg->EPZSPattern;
+    p_Inp->EPZSDual    = cfg->EPZSDual;
+  }
+
+  p_rt->level = level;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate the real-time controller
+ ************************************************************************
+ */
+void init_rt_control(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  RTControl *p_rt;
+
+  if ((p_rt = (RTControl *) calloc(1, sizeof(RTControl))) == NULL)
+    no_mem_exit("init_rt_control: p_rt");
+
+  p_rt->cfg       = *p_Inp;
+  p_rt->budget    = 1000.0 / p_Inp->RTTargetFPS;
+  p_rt->avg_time  = p_rt->budget;
+  p_rt->max_level = imin(p_Inp->RTMaxLevel, RT_LEVELS - 1);
+
+  // md_highfast does not support the FRExt tools; md_low excludes the RD only options
+  p_rt->fast_md_allowed = (p_Inp->rdopt == 1 || p_Inp->rdopt == 4) && !is_FREXT_profile(p_Inp->ProfileIDC);
+  p_rt->low_md_allowed  = (p_Inp->rdopt == 1 || p_Inp->rdopt == 2 || p_Inp->rdopt == 4)
+    && p_Inp->MbInterlace != ADAPTIVE_CODING && !p_Inp->CABACRateEstimation && !p_Inp->IntraRDOCandidates
+    && p_Inp->MEErrorMetric[F_PEL] == p_Inp->ModeDecisionMetric;
+
+  p_Vid->p_RTCtrl = p_rt;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Restore the configured parameters, e.g. before the modules that
+ *    were set up for them are released
+ ************************************************************************
+ */
+void rt_control_restore(VideoParameters *p_Vid)
+{
+  if (p_Vid->p_RTCtrl != NULL)
+    rt_apply_level(p_Vid->p_RTCtrl, p_Vid->p_Inp, RT_LEVEL_CONFIG);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the real-time controller
+ ************************************************************************
+ */
+void free_rt_control(VideoParameters *p_Vid)
+{
+  if (p_Vid->p_RTCtrl != NULL)
+  {
+    rt_control_restore(p_Vid);
+    free(p_Vid->p_RTCtrl);
+    p_Vid->p_RTCtrl = NULL;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Feeds the encoding time of a frame (ms) to the controller and
+ *    selects the complexity level of the next frame
+ ************************************************************************
+ */
+void rt_control_update(VideoParameters *p_Vid, int64 frame_time)
+{
+  RTControl *p_rt = p_Vid->p_RTCtrl;
+  double t = (double) frame_time;
+  double err;
+  int level;
+
+  ++p_rt->frames;
+  p_rt->level_sum  += p_rt->level;
+  p_rt->total_time += frame_time;
+  if (t > p_rt->budget)
+    ++p_rt->late_frames;
+
+  // velocity form PI controller on the relative error of the smoothed frame time
+  p_rt->avg_time = RT_SMOOTHING * t + (1.0 - RT_SMOOTHING) * p_rt->avg_time;
+  err = (p_rt->avg_time - p_rt->budget) / p_rt->budget;
+  if (fabs(err) < RT_DEAD_ZONE)
+    err = 0.0;
+
+  p_rt->control += RT_GAIN_P * (err - p_rt->last_err) + RT_GAIN_I * err;
+  p_rt->last_err = err;
+
+  // a single frame far beyond its deadline is not left to the smoothing
+  if (t > RT_DEADLINE_SKIP * p_rt->budget && p_rt->control < p_rt->level + 1)
+    p_rt->control = p_rt->level + 1;
+
+  p_rt->control = dmax(0.0, dmin((double) p_rt->max_level, p_rt->control));
+  level = (int) (p_rt->control + 0.5);
+
+  if (level != p_rt->level)
+    rt_apply_level(p_rt, p_Vid->p_Inp, level);
+}
+
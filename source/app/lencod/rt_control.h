@@ -0,0 +1,57 @@
+/*!
+ ************************************************************************
+ * \file
+ *     rt_control.h
+ *
+ * \brief
+ *    Real-time complexity control: steers the encoder settings towards a
+ *    target encoding speed
+ ************************************************************************
+ */
+
+#ifndef _RT_CONTROL_H_
+#define _RT_CONTROL_H_
+
+#include "global.h"
+
+//! Complexity ladder, each level also applies the reductions of the levels below it
+typedef enum
+{
+  RT_LEVEL_CONFIG = 0,   //!< settings of the configuration file
+  RT_LEVEL_NO_RDOQ,      //!< RDO quantization off
+  RT_LEVEL_SKIP_INTRA,   //!< SkipIntraInInterSlices
+  RT_LEVEL_FAST_MD,      //!< md_highfast instead of md_high / md_high_updated
+  RT_LEVEL_NO_SUB8x8,    //!< no 8x4, 4x8 and 4x4 partitions
+  RT_LEVEL_FAST_SEARCH,  //!< EPZS with small diamond patterns
+  RT_LEVEL_HALF_RANGE,   //!< half the search range
+  RT_LEVEL_ONE_REF,      //!< a single reference per list
+  RT_LEVEL_NO_8x8,       //!< 16x16, 16x8 and 8x16 partitions only
+  RT_LEVEL_LOW_MD,       //!< md_low (non RD optimized mode decision)
+  RT_LEVEL_NO_SUBPEL,    //!< integer pel motion estimation
+  RT_LEVELS
+} RTLevel;
+
+typedef struct rt_control
+{
+  InputParameters cfg;      //!< configured parameters the ladder starts from
+  double budget;            //!< time budget per frame (ms)
+  double avg_time;          //!< smoothed frame encoding time (ms)
+  double control;           //!< controller output, the complexity level as a real number
+  double last_err;          //!< relative timing error of the previous frame
+  int    level;             //!< complexity level in use
+  int    max_level;         //!< highest level the controller may select
+  int    low_md_allowed;    //!< md_low can replace the configured mode decision
+  int    fast_md_allowed;   //!< md_highfast can replace the configured mode decision
+  int64  frames;            //!< frames coded under control
+  int64  late_frames;       //!< frames that exceeded the budget
+  int64  level_sum;         //!< sum of the levels the frames were coded with
+  int64  total_time;        //!< encoding time of these frames (ms)
+} RTControl;
+
+extern void init_rt_control   (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void free_rt_control   (VideoParameters *p_Vid);
+extern void rt_control_update (VideoParameters *p_Vid, int64 frame_time);
+extern void rt_control_restore(VideoParameters *p_Vid);
+
+#endif
+
@@ -20,6 +20,7 @@
 #include "global.h"
 #include "rtp.h"
 #include "sei.h"
+#include "async_output.h"
 
 // A little trick to avoid those horrible #if TRACE all over the source code
 #if TRACE
@@ -116,6 +117,8 @@ int ComposeRTPPacket (RTPpacket_t *p)
  *    0 in case of access
  *    <0 in case of write failure (typically fatal)
  *
+ * \param p_Vid
+ *    VideoParameters structure
  * \param p
  *    the RTP packet to be written (after ComposeRTPPacket() )
  * \param f
@@ -128,7 +131,7 @@ int ComposeRTPPacket (RTPpacket_t *p)
  *    Stephan Wenger   stewe@cs.tu-berlin.de
  *****************************************************************************/
 
-int WriteRTPPacket (RTPpacket_t *p, FILE *f)
+int WriteRTPPacket (VideoParameters *p_Vid, RTPpacket_t *p, FILE *f)
 
 {
   int intime = -1;
@@ -137,11 +140,11 @@ int WriteRTPPacket (RTPpacket_t *p, FILE *f)
   assert (p != NULL);
 
 
-  if (1 != fwrite (&p->packlen, 4, 1, f))
+  if (4 != write_stream_data (p_Vid, &p->packlen, 4, f))
     return -1;
-  if (1 != fwrite (&intime, 4, 1, f))
+  if (4 != write_stream_data (p_Vid, &intime, 4, f))
     return -1;
-  if (1 != fwrite (p->packet, p->packlen, 1, f))
+  if (p->packlen != write_stream_data (p_Vid, p->packet, p->packlen, f))
     return -1;
   return 0;
 }
@@ -218,11 +221,12 @@ int WriteRTPNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_rtp)
     printf ("Cannot compose RTP packet, exit\n");
     exit (-1);
   }
-  if (WriteRTPPacket (p, *f_rtp) < 0)
+  if (WriteRTPPacket (p_Vid, p, *f_rtp) < 0)
   {
     printf ("Cannot write %d bytes of RTP packet to outfile, exit\n", p->packlen);
     exit (-1);
   }
+  queue_stream_data (p_Vid);
   free (p->packet);
   free (p->payload);
   free (p);
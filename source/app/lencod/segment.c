@@ -0,0 +1,557 @@
+/*!
+ *************************************************************************************
+ * \file segment.c
+ *
+ * \brief
+ *    Segment-parallel encoding.
+ *
+ *    With SegmentParallel=N and an IDRPeriod, the sequence is cut in coding order
+ *    at its IDR pictures. Nothing after an IDR picture references a picture coded
+ *    before it, so every segment can be coded on its own. The parent sets up the
+ *    encoder (parameter sets, frame structure) and then fork()s up to N processes,
+ *    one per segment. Each works on a private copy of the encoder state, codes the
+ *    frames of its segment with the usual encoding loop and writes the bitstream,
+ *    reconstruction and console output to files of its own (<name>.seg<k>). The
+ *    parent appends them in segment order as soon as the segments before have been
+ *    appended. The statistics the processes leave in shared memory are merged
+ *    when all segments are coded.
+ *
+ *    The segments keep the coding order indices and the frame structure of the
+ *    whole sequence, so the parameter sets, POC, frame_num and idr_pic_id come out
+ *    as in sequential coding. With ResendSPS=2 every segment also carries the
+ *    parameter sets. Encoder state that normally carries over an IDR picture (rate
+ *    control, adaptive rounding) starts from the configured values in every segment.
+ *    With rate control, each segment gets a bit rate in proportion to its complexity
+ *    relative to the sequence, estimated by the lookahead pre-analysis.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "segment.h"
+#include "annexb.h"
+#include "configfile.h"
+#include "filehandle.h"
+#include "img_io.h"
+#include "mbuffer.h"
+#include "ratectl.h"
+#include "lookahead.h"
+#include "otf_cache.h"
+#include "me_cache.h"
+#include "img_dist_async.h"
+#include "async_output.h"
+
+#if !(defined(WIN32) || defined(WIN64))
+#define SEGMENT_PROCESSES
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+#define SEG_NAME_SIZE  (FILE_NAME_SIZE + 16)
+
+typedef struct segment_plan
+{
+  int    num;                 //!< number of segments
+  int   *start;               //!< coding order index of the first frame of each segment (start[num]: end)
+  int   *bit_rate;            //!< rate control bit rate of each segment, or NULL
+  int   *pid;                 //!< process coding the segment
+  byte  *done;                //!< segment process has finished
+  SegmentResult *result;      //!< statistics of each segment (shared)
+  long  *bits;                //!< coded frame sizes in coding order (shared)
+  size_t shared_size;
+} SegmentPlan;
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Name of a file of segment k
+ ************************************************************************
+ */
+static void segment_file_name(char *name, const char *base, int k, const char *ext)
+{
+  if (snprintf(name, SEG_NAME_SIZE, "%s.seg%d%s", base, k, ext) >= SEG_NAME_SIZE)
+    error("segment_file_name: file name too long", 500);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Cuts the sequence at its IDR pictures. Returns the number of
+ *    segments.
+ ************************************************************************
+ */
+static int plan_segments(VideoParameters *p_Vid, InputParameters *p_Inp, SegmentPlan *plan)
+{
+  FrameUnitStruct *p_frm = p_Vid->p_pred->p_frm;
+  int i;
+
+  memset(plan, 0, sizeof(SegmentPlan));
+  if ((plan->start = (int *) calloc(p_Inp->no_frames + 1, sizeof(int))) == NULL)
+    no_mem_exit("plan_segments: plan->start");
+
+  for (i = 0; i < p_Inp->no_frames; ++i)
+  {
+    if (i == 0 || (p_frm[i].idr_flag && p_frm[i].frame_no < p_Inp->no_frames))
+      plan->start[plan->num++] = i;
+  }
+  plan->start[plan->num] = p_Inp->no_frames;
+
+  return plan->num;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Rate control budget: the bit rate of a segment follows its cost
+ *    per frame (intra cost of the IDR picture, inter cost of the other
+ *    frames) relative to the whole sequence. The ratios are limited and
+ *    scaled so that the segments add up to the configured rate.
+ ************************************************************************
+ */
+static void segment_bit_budgets(VideoParameters *p_Vid, InputParameters *p_Inp, SegmentPlan *plan)
+{
+  FrameUnitStruct *p_frm = p_Vid->p_pred->p_frm;
+  Lookahead *p_la = p_Vid->p_Lookahead;
+  int own_la = (p_la == NULL);
+  double *ratio, total_cost = 0.0, scale = 0.0;
+  int *frames, total_frames = 0;
+  int i, k;
+
+  if ((plan->bit_rate = (int *) calloc(plan->num, sizeof(int))) == NULL)
+    no_mem_exit("segment_bit_budgets: plan->bit_rate");
+  if ((ratio = (double *) calloc(plan->num, sizeof(double))) == NULL)
+    no_mem_exit("segment_bit_budgets: ratio");
+  if ((frames = (int *) calloc(plan->num, sizeof(int))) == NULL)
+    no_mem_exit("segment_bit_budgets: frames");
+
+  // without a lookahead a temporary one does the pre-pass
+  if (own_la)
+  {
+    init_lookahead(p_Vid, p_Inp);
+    p_la = p_Vid->p_Lookahead;
+  }
+  lookahead_analyse(p_la, p_Inp->no_frames - 1);
+
+  for (k = 0; k < plan->num; ++k)
+  {
+    for (i = plan->start[k]; i < plan->start[k + 1]; ++i)
+    {
+      int frame_no = p_frm[i].frame_no;
+
+      if (frame_no >= p_Inp->no_frames)
+        continue;
+      ratio[k] += (double) (i == plan->start[k] ? p_la->frm[frame_no].intra_cost : p_la->frm[frame_no].inter_cost);
+      ++frames[k];
+    }
+    total_cost   += ratio[k];
+    total_frames += frames[k];
+  }
+
+  for (k = 0; k < plan->num; ++k)
+  {
+    if (frames[k] > 0 && total_cost > 0.0)
+      ratio[k] = dmin(SEG_RC_RATIO_MAX, dmax(SEG_RC_RATIO_MIN, (ratio[k] / frames[k]) / (total_cost / total_frames)));
+    else
+      ratio[k] = 1.0;
+    scale += ratio[k] * frames[k];
+  }
+  scale = (scale > 0.0) ? total_frames / scale : 1.0;
+
+  for (k = 0; k < plan->num; ++k)
+    plan->bit_rate[k] = (int) (p_Inp->bit_rate * ratio[k] * scale + 0.5);
+
+  if (own_la)
+    free_lookahead(p_Vid);
+  free(frames);
+  free(ratio);
+}
+
+#if defined(SEGMENT_PROCESSES)
+/*!
+ ************************************************************************
+ * \brief
+ *    Codes segment k in a child process and leaves the statistics in
+ *    the shared memory of the plan. Does not return.
+ ************************************************************************
+ */
+static void code_segment(VideoParameters *p_Vid, InputParameters *p_Inp, SegmentPlan *plan, int k)
+{
+  SegmentResult *res = &plan->result[k];
+  char name[SEG_NAME_SIZE];
+  int fd;
+
+  // the frame lines go to the console output of the segment
+  segment_file_name(name, p_Inp->outfile, k, ".log");
+  if ((fd = open(name, OPENFLAGS_WRITE, OPEN_PERMISSIONS)) != -1)
+  {
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+  }
+
+  // file offsets are shared with the parent, so the input is opened again
+  CloseFiles(&p_Inp->input_file1);
+  OpenFiles(&p_Inp->input_file1);
+  start_input(p_Inp, &p_Inp->input_file1);
+
+  // the writer and metric threads only exist in the parent
+  p_Vid->p_Metrics = NULL;
+  p_Vid->p_Output  = NULL;
+  if (p_Inp->AsyncMetrics && p_Inp->Verbose != 0)
+    init_metric_engine(p_Vid, p_Inp);
+  if (p_Inp->AsyncOutput)
+    init_async_output(p_Vid);
+
+  // the buffers of the parent's streams are empty (flushed before the fork) and are left alone
+  segment_file_name(name, p_Inp->outfile, k, "");
+  OpenAnnexbFile(name, p_Vid->f_out);
+  if (p_Vid->p_dec != -1)
+  {
+    close(p_Vid->p_dec);
+    segment_file_name(name, p_Inp->ReconFile, k, "");
+    if ((p_Vid->p_dec = open(name, OPENFLAGS_WRITE, OPEN_PERMISSIONS)) == -1)
+    {
+      snprintf(errortext, ET_SIZE, "Error open file %s", name);
+      error(errortext, 500);
+    }
+  }
+
+  // the parameter sets at the start of the bitstream belong to the first segment
+  if (k > 0)
+    p_Vid->p_Stats->bit_ctr_parametersets_n = 0;
+
+  if (plan->bit_rate != NULL)
+  {
+    // the initial QP follows the bit rate of the segment unless it is configured
+    p_Inp->bit_rate    = plan->bit_rate[k];
+    p_Inp->SeinitialQP = cfgparams.SeinitialQP;
+    rc_init_sequence(p_Vid, p_Inp);
+    // a leading B picture is coded before any P picture of the segment has set the QP it starts from
+    p_Vid->p_rc_quad->PrevLastQP = p_Inp->SeinitialQP + p_Vid->p_rc_quad->bitdepth_qp_scale;
+  }
+
+  encode_frames(p_Vid, p_Inp, plan->start[k], plan->start[k + 1]);
+
+  flush_metrics(p_Vid);
+  terminate_sequence(p_Vid, p_Inp);
+  flush_dpb(p_Vid->p_Dpb_layer[0], &p_Inp->output);
+  free_async_output(p_Vid);
+  free_metric_engine(p_Vid);
+  if (p_Vid->p_dec != -1)
+    close(p_Vid->p_dec);
+
+  res->stats       = *p_Vid->p_Stats;
+  res->dist        = *p_Vid->p_Dist;
+  res->tot_time    = p_Vid->tot_time;
+  res->me_tot_time = p_Vid->me_tot_time;
+  res->intra_presel_blocks  = p_Vid->intra_presel_blocks;
+  res->intra_presel_modes   = p_Vid->intra_presel_modes;
+  res->intra_presel_checked = p_Vid->intra_presel_checked;
+  if (p_Vid->p_OtfCache != NULL)
+  {
+    res->otf_hits   = p_Vid->p_OtfCache->hits;
+    res->otf_misses = p_Vid->p_OtfCache->misses;
+  }
+  if (p_Vid->p_MECache != NULL)
+  {
+    res->me_lookups = p_Vid->p_MECache->lookups;
+    res->me_reused  = p_Vid->p_MECache->reused;
+    res->me_refined = p_Vid->p_MECache->refined;
+  }
+#ifdef _LEAKYBUCKET_
+  res->coded_frames = imin(p_Vid->total_frame_buffer, plan->start[k + 1] - plan->start[k]);
+  memcpy(plan->bits + plan->start[k], p_Vid->Bit_Buffer, res->coded_frames * sizeof(long));
+#endif
+
+  fflush(stdout);
+  _exit(0);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Appends a segment file to the output and removes it
+ ************************************************************************
+ */
+static void append_file(const char *name, FILE *f_out, int fd_out)
+{
+  byte buf[65536];
+  ssize_t size;
+  int fd;
+
+  if ((fd = open(name, OPENFLAGS_READ)) == -1)
+  {
+    snprintf(errortext, ET_SIZE, "Error open segment file %s", name);
+    error(errortext, 500);
+  }
+
+  while ((size = read(fd, buf, sizeof(buf))) > 0)
+  {
+    if ((f_out != NULL) ? fwrite(buf, 1, size, f_out) != (size_t) size : write(fd_out, buf, size) != size)
+    {
+      snprintf(errortext, ET_SIZE, "Error appending segment file %s", name);
+      error(errortext, 500);
+    }
+  }
+
+  close(fd);
+  remove(name);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Removes the files of segment k
+ ************************************************************************
+ */
+static void remove_segment_files(InputParameters *p_Inp, int k)
+{
+  char name[SEG_NAME_SIZE];
+
+  segment_file_name(name, p_Inp->outfile, k, "");
+  remove(name);
+  segment_file_name(name, p_Inp->outfile, k, ".log");
+  remove(name);
+  if (strlen(p_Inp->ReconFile) > 0)
+  {
+    segment_file_name(name, p_Inp->ReconFile, k, "");
+    remove(name);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stops the segment processes still running and reports an error
+ ************************************************************************
+ */
+static void abort_segments(InputParameters *p_Inp, SegmentPlan *plan, int first, int started, char *text)
+{
+  int k;
+
+  for (k = first; k < started; ++k)
+  {
+    if (!plan->done[k])
+    {
+      kill(plan->pid[k], SIGTERM);
+      waitpid(plan->pid[k], NULL, 0);
+    }
+    remove_segment_files(p_Inp, k);
+  }
+
+  error(text, 500);
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Running average of two parts of a sequence
+ ************************************************************************
+ */
+static void merge_average(float *dst, float src, int dst_frames, int src_frames)
+{
+  if (src_frames > 0)
+    *dst = (float) (((double) *dst * dst_frames + (double) src * src_frames) / (dst_frames + src_frames));
+}
+
+static void add_int64(int64 *dst, const int64 *src, const int64 *base, size_t n)
+{
+  size_t i;
+
+  for (i = 0; i < n; ++i)
+    dst[i] += src[i] - base[i];
+}
+
+static void add_int(int *dst, const int *src, const int *base, size_t n)
+{
+  size_t i;
+
+  for (i = 0; i < n; ++i)
+    dst[i] += src[i] - base[i];
+}
+
+#define ADD_INT64(f) add_int64((int64 *) &dst->f, (const int64 *) &src->f, (const int64 *) &base->f, sizeof(dst->f) / sizeof(int64))
+#define ADD_INT(f)   add_int  ((int *)   &dst->f, (const int *)   &src->f, (const int *)   &base->f, sizeof(dst->f) / sizeof(int))
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Adds what a segment coded (its statistics minus the state it
+ *    started from) to the sequence statistics
+ ************************************************************************
+ */
+static void merge_segment(VideoParameters *p_Vid, SegmentResult *res, StatParameters *base, long *bits)
+{
+  StatParameters *dst = p_Vid->p_Stats;
+  StatParameters *src = &res->stats;
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+  int k, c, t;
+
+  // the averages are weighted with the frame counts before these are added
+  for (k = 0; k < TOTAL_DIST_TYPES; ++k)
+  {
+    DistMetric *d = &p_Dist->metric[k], *s = &res->dist.metric[k];
+
+    for (c = 0; c < 3; ++c)
+    {
+      merge_average(&d->average[c], s->average[c], p_Dist->frame_ctr, res->dist.frame_ctr);
+      for (t = 0; t < NUM_SLICE_TYPES; ++t)
+        merge_average(&d->avslice[t][c], s->avslice[t][c], dst->frame_ctr[t] - base->frame_ctr[t], src->frame_ctr[t] - base->frame_ctr[t]);
+      if (res->dist.frame_ctr > 0)
+        d->value[c] = s->value[c];
+    }
+  }
+  p_Dist->frame_ctr += res->dist.frame_ctr;
+
+  ADD_INT64(bit_ctr);
+  ADD_INT64(bit_ctr_emulation_prevention);
+  ADD_INT  (b8_mode_0_use);
+  ADD_INT64(mode_use_transform);
+  ADD_INT64(intra_chroma_mode);
+  ADD_INT  (frame_counter);
+  ADD_INT64(quant);
+  ADD_INT64(num_macroblocks);
+  ADD_INT  (frame_ctr);
+  ADD_INT64(bit_counter);
+  ADD_INT64(mode_use);
+  ADD_INT64(bit_use_mode);
+  ADD_INT64(bit_use_mb_type);
+  ADD_INT64(bit_use_header);
+  ADD_INT64(tmp_bit_use_cbp);
+  ADD_INT64(bit_use_coeffC);
+  ADD_INT64(bit_use_coeff);
+  ADD_INT64(bit_use_delta_quant);
+  ADD_INT64(bit_use_stuffing_bits);
+  ADD_INT  (bit_ctr_parametersets);
+  ADD_INT64(bit_ctr_filler_data);
+
+  p_Vid->me_tot_time          += res->me_tot_time;
+  p_Vid->intra_presel_blocks  += res->intra_presel_blocks;
+  p_Vid->intra_presel_modes   += res->intra_presel_modes;
+  p_Vid->intra_presel_checked += res->intra_presel_checked;
+  if (p_Vid->p_OtfCache != NULL)
+  {
+    p_Vid->p_OtfCache->hits   += res->otf_hits;
+    p_Vid->p_OtfCache->misses += res->otf_misses;
+  }
+  if (p_Vid->p_MECache != NULL)
+  {
+    p_Vid->p_MECache->lookups += res->me_lookups;
+    p_Vid->p_MECache->reused  += res->me_reused;
+    p_Vid->p_MECache->refined += res->me_refined;
+  }
+
+#ifdef _LEAKYBUCKET_
+  memcpy(p_Vid->Bit_Buffer + p_Vid->total_frame_buffer, bits, res->coded_frames * sizeof(long));
+  p_Vid->total_frame_buffer += res->coded_frames;
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Codes the IDR periods of the sequence in concurrent processes and
+ *    concatenates their output (SegmentParallel)
+ ************************************************************************
+ */
+void encode_segments(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+#if defined(SEGMENT_PROCESSES)
+  SegmentPlan plan;
+  StatParameters base;
+  TIME_T start_time, end_time;
+  char name[SEG_NAME_SIZE];
+  void *shared;
+  int started = 0, appended = 0, running = 0;
+  int status, pid, k;
+
+  gettime(&start_time);
+
+  if (plan_segments(p_Vid, p_Inp, &plan) < 2)
+  {
+    free(plan.start);
+    encode_frames(p_Vid, p_Inp, 0, INT_MAX);
+    return;
+  }
+
+  if (p_Inp->RCEnable)
+    segment_bit_budgets(p_Vid, p_Inp, &plan);
+
+  plan.shared_size = plan.num * sizeof(SegmentResult) + p_Inp->no_frames * sizeof(long);
+  if ((shared = mmap(NULL, plan.shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+    no_mem_exit("encode_segments: shared");
+  plan.result = (SegmentResult *) shared;
+  plan.bits   = (long *) (plan.result + plan.num);
+  if ((plan.pid = (int *) calloc(plan.num, sizeof(int))) == NULL)
+    no_mem_exit("encode_segments: plan.pid");
+  if ((plan.done = (byte *) calloc(plan.num, sizeof(byte))) == NULL)
+    no_mem_exit("encode_segments: plan.done");
+
+  // nothing the parent has written may still be buffered when the processes start
+  flush_async_output(p_Vid);
+  fflush(*p_Vid->f_out);
+  base = *p_Vid->p_Stats;
+
+  while (appended < plan.num)
+  {
+    while (running < p_Inp->SegmentParallel && started < plan.num)
+    {
+      fflush(stdout);
+      if ((pid = fork()) == 0)
+        code_segment(p_Vid, p_Inp, &plan, started);
+      if (pid < 0)
+        abort_segments(p_Inp, &plan, appended, started, "encode_segments: fork failed");
+      plan.pid[started++] = pid;
+      ++running;
+    }
+
+    if ((pid = waitpid(-1, &status, 0)) < 0)
+      abort_segments(p_Inp, &plan, appended, started, "encode_segments: waitpid failed");
+    for (k = appended; k < started && plan.pid[k] != pid; ++k)
+      ;
+    if (k == started)
+      continue;
+
+    plan.done[k] = 1;
+    --running;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      snprintf(errortext, ET_SIZE, "Coding of segment %d (coded frames %d to %d) failed", k, plan.start[k], plan.start[k + 1] - 1);
+      abort_segments(p_Inp, &plan, appended, started, errortext);
+    }
+
+    // segments are appended in order, each as soon as the ones before it are
+    while (appended < started && plan.done[appended])
+    {
+      segment_file_name(name, p_Inp->outfile, appended, ".log");
+      append_file(name, stdout, -1);
+      segment_file_name(name, p_Inp->outfile, appended, "");
+      append_file(name, *p_Vid->f_out, -1);
+      if (p_Vid->p_dec != -1)
+      {
+        segment_file_name(name, p_Inp->ReconFile, appended, "");
+        append_file(name, NULL, p_Vid->p_dec);
+      }
+      ++appended;
+    }
+  }
+  fflush(stdout);
+
+  // processes still to be started must see the state the first one saw, so the statistics are merged at the end
+  for (k = 0; k < plan.num; ++k)
+    merge_segment(p_Vid, &plan.result[k], &base, plan.bits + plan.start[k]);
+
+  gettime(&end_time);
+  p_Vid->tot_time = timediff(&start_time, &end_time);
+  p_Vid->num_segments = plan.num;
+
+  munmap(shared, plan.shared_size);
+  free(plan.done);
+  free(plan.pid);
+  free(plan.bit_rate);
+  free(plan.start);
+#else
+  encode_frames(p_Vid, p_Inp, 0, INT_MAX);
+#endif
+}
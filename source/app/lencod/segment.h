@@ -0,0 +1,38 @@
+/*!
+ ************************************************************************
+ * \file
+ *     segment.h
+ *
+ * \brief
+ *    Segment-parallel encoding: the IDR periods of the sequence are coded
+ *    by concurrent encoder processes and concatenated
+ ************************************************************************
+ */
+
+#ifndef _SEGMENT_H_
+#define _SEGMENT_H_
+
+#include "global.h"
+#include "enc_statistics.h"
+
+#define SEG_RC_RATIO_MIN  0.25  //!< smallest segment bit rate relative to the configured one
+#define SEG_RC_RATIO_MAX  4.0   //!< largest segment bit rate relative to the configured one
+
+//! Statistics a segment process hands back to the parent
+typedef struct segment_result
+{
+  StatParameters   stats;           //!< bit and mode statistics at the end of the segment
+  DistortionParams dist;            //!< distortion averages of the segment
+  int64  tot_time;                  //!< encoding time of the segment
+  int64  me_tot_time;               //!< motion estimation time of the segment
+  int64  intra_presel_blocks;
+  int64  intra_presel_modes;
+  int64  intra_presel_checked;
+  int64  otf_hits, otf_misses;      //!< OTF tile cache (OTF_L3)
+  int64  me_lookups, me_reused, me_refined;  //!< ME result cache
+  long   coded_frames;              //!< frames stored in the leaky bucket buffer
+} SegmentResult;
+
+extern void encode_segments(VideoParameters *p_Vid, InputParameters *p_Inp);
+
+#endif
@@ -62,10 +62,57 @@
 #include "rd_intra_jm.h"
 #include "rd_intra_jm444.h"
 
+#define SLICE_ARENA_BLOCK_SIZE  (256 * 1024)
+
 // Local declarations
 static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp);
 static Slice *malloc_slice_lite(VideoParameters *p_Vid, InputParameters *p_Inp);
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Get an arena for a new slice. Arenas of freed slices are reset and
+ *    kept in a pool, so that after the first pictures the slice buffers
+ *    are served from memory that is already mapped and no longer
+ *    malloc'ed and freed piece by piece for every picture.
+ ************************************************************************
+ */
+static MemArena *get_slice_arena(VideoParameters *p_Vid)
+{
+  MemArena *arena = p_Vid->p_SliceArenas;
+
+  if (arena != NULL)
+    p_Vid->p_SliceArenas = arena->next;
+  else
+    arena = arena_create(SLICE_ARENA_BLOCK_SIZE);
+
+  arena->next = NULL;
+  return arena;
+}
+
+static void release_slice_arena(VideoParameters *p_Vid, MemArena *arena)
+{
+  arena_reset(arena);
+  arena->next = p_Vid->p_SliceArenas;
+  p_Vid->p_SliceArenas = arena;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the pool of slice arenas
+ ************************************************************************
+ */
+void free_slice_arenas(VideoParameters *p_Vid)
+{
+  while (p_Vid->p_SliceArenas != NULL)
+  {
+    MemArena *next = p_Vid->p_SliceArenas->next;
+    arena_destroy(p_Vid->p_SliceArenas);
+    p_Vid->p_SliceArenas = next;
+  }
+}
+
 int allocate_block_mem(Slice *currSlice)
 {
   int alloc_size = 0;
@@ -106,6 +153,7 @@ static void CAVLC_init(Slice *currSlice)
 
 static int alloc_rddata(Slice *currSlice, RD_DATA *rd_data)
 {
+  MemArena *prev_arena = arena_select(currSlice->p_Arena);
   int alloc_size = 0;
 
   alloc_size += get_mem3Dpel(&(rd_data->rec_mb), 3, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
@@ -122,6 +170,7 @@ static int alloc_rddata(Slice *currSlice, RD_DATA *rd_data)
   alloc_size += get_mem2D((byte***)&(rd_data->ipredmode), currSlice->height_blk, currSlice->width_blk);
   alloc_size += get_mem3D((byte****)&(rd_data->refar), 2, 4, 4);
 
+  arena_select(prev_arena);
   return alloc_size;
 }
 
@@ -1319,6 +1368,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
   Bitstream *currStream;
   int active_ref_lists = (p_Vid->mb_aff_frame_flag) ? 6 : 2;
   DecodedPictureBuffer *p_Dpb = p_Vid->p_Dpb_layer[layer_id];
+  MemArena *prev_arena;
   int alloc_size = 0;
 
 #if (MVC_EXTENSION_ENABLE)
@@ -1444,8 +1494,10 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
       }
 #endif
     }
+    prev_arena = arena_select((*currSlice)->p_Arena);
     get_mem3D((byte ****)(void*)&(*currSlice)->direct_ref_idx, (*currSlice)->height_blk, (*currSlice)->width_blk, 2);
     get_mem2D((byte ***) (void*)&(*currSlice)->direct_pdir,    (*currSlice)->height_blk, (*currSlice)->width_blk);
+    arena_select(prev_arena);
   }
 
   setup_slice(*currSlice);
@@ -1610,6 +1662,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
 
   (*currSlice)->max_num_references = (short) p_Vid->max_num_references;
 
+  prev_arena = arena_select((*currSlice)->p_Arena);
   if (((*currSlice)->slice_type != I_SLICE) && (*currSlice)->slice_type != SI_SLICE)
   {
     alloc_size += get_mem5Dmv (&((*currSlice)->all_mv), 2, (*currSlice)->max_num_references, 9, 4, 4);
@@ -1630,6 +1683,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
       }
     }
   }
+  arena_select(prev_arena);
 
   if (p_Vid->mb_aff_frame_flag)
     init_mbaff_lists(*currSlice);
@@ -1666,6 +1720,10 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
         no_mem_exit("init_slice: p_EPZS");
       EPZSStructInit (*currSlice);
       EPZSSliceInit  (*currSlice);
+#if defined(OPENMP)
+      if (p_Inp->ParallelRefME)
+        init_ref_me_threads(*currSlice);
+#endif
     }
   }
 
@@ -1698,6 +1756,12 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
     if (((*currSlice)->estBitsCabac = (estBitsCabacStruct*) calloc(NUM_BLOCK_TYPES, sizeof(estBitsCabacStruct)))==NULL) 
       no_mem_exit("init_slice: (*currSlice)->estBitsCabac"); 
 
+    if (p_Inp->symbol_mode == CABAC)
+    {
+      if (((*currSlice)->p_RDOQCache = (RDOQCache *) calloc(1, sizeof(RDOQCache)))==NULL) 
+        no_mem_exit("init_slice: (*currSlice)->p_RDOQCache"); 
+    }
+
     init_rdoq_slice(*currSlice);
 
     alloc_rddata(*currSlice, &(*currSlice)->rddata_trellis_curr);
@@ -1731,6 +1795,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
     (*currSlice)->set_motion_vectors_mb = SetMotionVectorsMBISlice;
   }
 
+  prev_arena = arena_select((*currSlice)->p_Arena);
   get_mem3Dpel(&((*currSlice)->mb_pred),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
   get_mem3Dint(&((*currSlice)->mb_rres),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
   get_mem3Dint(&((*currSlice)->mb_ores),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
@@ -1740,6 +1805,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
 
   get_mem_ACcoeff (p_Vid, &((*currSlice)->cofAC));
   get_mem_DCcoeff (&((*currSlice)->cofDC));
+  arena_select(prev_arena);
 
   allocate_block_mem(*currSlice);
   init_coding_state_methods(*currSlice);
@@ -1884,6 +1950,7 @@ void init_slice_lite (VideoParameters *p_Vid, Slice **currSlice, int start_mb_ad
   }
 
   (*currSlice)->estBitsCabac = NULL;
+  (*currSlice)->p_RDOQCache = NULL;
   nullify_rddata(&((*currSlice)->rddata_trellis_curr));
   nullify_rddata(&((*currSlice)->rddata_trellis_best));
 
@@ -1940,6 +2007,7 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
   int i;
   DataPartition *dataPart;
   Slice *currSlice;
+  MemArena *arena;
   int cr_size = (p_Inp->separate_colour_plane_flag != 0) ? 0 : 512;
 
   int buffer_size;
@@ -1959,10 +2027,12 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
   }
 
   // KS: this is approx. max. allowed code picture size
-  if ((currSlice = (Slice *) calloc(1, sizeof(Slice))) == NULL) no_mem_exit ("malloc_slice: currSlice structure");
+  arena = get_slice_arena(p_Vid);
+  currSlice = (Slice *) arena_calloc(arena, 1, sizeof(Slice));
 
   currSlice->p_Vid             = p_Vid;
   currSlice->p_Inp             = p_Inp;
+  currSlice->p_Arena           = arena;
 
   if (((currSlice->p_RDO)  = (RDOPTStructure *) calloc(1, sizeof(RDOPTStructure)))==NULL) 
     no_mem_exit("malloc_slice: p_RDO");
@@ -2012,9 +2082,11 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
   if (p_Inp->WeightedPrediction || p_Inp->WeightedBiprediction || p_Inp->GenerateMultiplePPS)
   {
     // Currently only use up to 32 references. Need to use different indicator such as maximum num of references in list
+    MemArena *prev_arena = arena_select(arena);
     get_mem3Dshort(&currSlice->wp_weight , 6, MAX_REFERENCE_PICTURES, 3);
     get_mem3Dshort(&currSlice->wp_offset , 6, MAX_REFERENCE_PICTURES, 3);
     get_mem4Dshort(&currSlice->wbp_weight, 6, MAX_REFERENCE_PICTURES, MAX_REFERENCE_PICTURES, 3);
+    arena_select(prev_arena);
   }
 
   return currSlice;
@@ -2132,6 +2204,8 @@ void free_slice(Slice *currSlice)
   {
     VideoParameters *p_Vid = currSlice->p_Vid;
     InputParameters *p_Inp = currSlice->p_Inp;
+    // buffers taken from the slice arena are released with the arena itself
+    MemArena *prev_arena = arena_select(currSlice->p_Arena);
 
     int i;
     DataPartition *dataPart;
@@ -2220,6 +2294,7 @@ void free_slice(Slice *currSlice)
     if (currSlice->UseRDOQuant)
     {
       free(currSlice->estBitsCabac);
+      free(currSlice->p_RDOQCache);
 
       free_rddata(currSlice, &currSlice->rddata_trellis_curr);
       if(currSlice->RDOQ_QP_Num > 1)
@@ -2277,12 +2352,20 @@ void free_slice(Slice *currSlice)
     {
       if (p_Inp->SearchMode[p_Vid->view_id] == EPZS)
       {
+#if defined(OPENMP)
+        if (currSlice->p_RefMECtx)
+          free_ref_me_threads(currSlice);
+#endif
         if(currSlice->p_EPZS)
           EPZSStructDelete (currSlice);    
       }
     }
 
-    free(currSlice);
+    arena_select(prev_arena);
+    if (currSlice->p_Arena != NULL)
+      release_slice_arena(p_Vid, currSlice->p_Arena);
+    else
+      free(currSlice);
   }
 }
 
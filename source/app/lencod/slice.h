@@ -43,6 +43,7 @@ extern void free_slice_list        ( Picture *currPic );
 extern void SetLagrangianMultipliersOn (Slice *currSlice);
 extern void SetLagrangianMultipliersOff(Slice *currSlice);
 extern void  free_slice                (Slice *currSlice);
+extern void  free_slice_arenas         (VideoParameters *p_Vid);
 
 
 #endif
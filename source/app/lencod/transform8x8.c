@@ -38,6 +38,7 @@
 #include "rdopt.h"
 #include "md_common.h"
 #include "intra8x8.h"
+#include "fused_tq.h"
 #include "rdopt_coding_state.h"
 
 //! single scan pattern
@@ -558,6 +559,10 @@ int residual_transform_quant_luma_8x8(Macroblock *currMB, ColorPlane pl, int b8,
     quant_methods.pos_scan   = currMB->is_field_mode ? FIELD_SCAN8x8 : SNGL_SCAN8x8;    
     quant_methods.c_cost     = COEFF_COST8x8[currSlice->disthres];
 
+    // The normal and adaptive rounding quantizers have a fused transform / quantization / reconstruction path
+    if (currSlice->quant_8x8 == quant_8x8_normal || currSlice->quant_8x8 == quant_8x8_around)
+      return fused_tq_luma_8x8(currMB, pl, &quant_methods, NULL);
+
     // Forward 8x8 transform
     forward8x8(mb_ores, mb_rres, block_y, block_x);
 
@@ -636,6 +641,9 @@ int residual_transform_quant_luma_8x8_cavlc(Macroblock *currMB, ColorPlane pl, i
     quant_methods.pos_scan   = currMB->is_field_mode ? FIELD_SCAN8x8_CAVLC : SNGL_SCAN8x8_CAVLC;    
     quant_methods.c_cost     = COEFF_COST8x8[currSlice->disthres];
 
+    if (currSlice->quant_8x8cavlc == quant_8x8cavlc_normal || currSlice->quant_8x8cavlc == quant_8x8cavlc_around)
+      return fused_tq_luma_8x8(currMB, pl, &quant_methods, currSlice->cofAC[pl_off]);
+
     // Forward 8x8 transform
     forward8x8(mb_ores, mb_rres, block_y, block_x);
 
@@ -17,6 +17,7 @@
 #include "global.h"
 #include "image.h"
 #include "wp.h"
+#include "simd.h"
 
 /*!
 ************************************************************************
@@ -141,6 +142,35 @@ void ComputeImplicitWeights(Slice *currSlice,
 }
 
 
+/*!
+************************************************************************
+* \brief
+*    Sum of n consecutive samples. The vector path adds the samples as
+*    signed 16 bit values, which holds for all bit depths up to 14.
+************************************************************************
+*/
+static inline int ComputeRowSum(const imgpel *p_img, int n)
+{
+  int x = 0;
+  int sum = 0;
+
+#if defined(JM_SIMD)
+  if (n >= 8)
+  {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+
+    for (; x <= n - 8; x += 8)
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(simd_load_pel8(&p_img[x]), ones));
+    sum = simd_hsum_epi32(acc);
+  }
+#endif
+  for (; x < n; x++)
+    sum += p_img[x];
+
+  return sum;
+}
+
 /*!
 ************************************************************************
 * \brief
@@ -149,39 +179,120 @@ void ComputeImplicitWeights(Slice *currSlice,
 */
 double ComputeImgSum(imgpel **CurrentImage, int height, int width)
 {
-  int i, j;
-  double sum_value = 0.0;
-  imgpel *p_tmp;
+  int i;
+  int64 sum_value = 0;
 
+  // integer sums are exact, so this matches the former sample by sample double accumulation
   for (i = 0; i < height; i++)
   {
-    p_tmp = CurrentImage[i];
-    for (j = 0; j < width; j++)
+    sum_value += ComputeRowSum(CurrentImage[i], width);
+  }
+  return (double) sum_value;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Sum of the samples of plane pl (0: p_curr_img, 1 and 2: imgUV) of a
+*    reference picture. The sum is kept with the picture, so the WP test
+*    and estimation functions, both lists and the WPMCPrecision passes
+*    compute it once. Reference pictures are not modified after they have
+*    been stored, so a sum stays valid as long as the plane and the area
+*    do not change.
+************************************************************************
+*/
+double ComputeRefImgSum(StorablePicture *ref, int pl, int height, int width)
+{
+  imgpel **img = (pl == 0) ? ref->p_curr_img : ref->imgUV[pl - 1];
+  WPPlaneSum *p_sum = &ref->wp_sum[pl];
+
+  if (p_sum->img != img || p_sum->height != height || p_sum->width != width)
+  {
+    p_sum->sum    = (int64) ComputeImgSum(img, height, width);
+    p_sum->img    = img;
+    p_sum->height = height;
+    p_sum->width  = width;
+  }
+  return (double) p_sum->sum;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Collects the distinct pictures of the first num_lists reference
+*    lists. If idx is not NULL, idx[clist][n] receives the position of
+*    listX[clist][n] in pics (only lists 0 and 1 are mapped).
+*
+* \return
+*    number of distinct pictures
+************************************************************************
+*/
+int GetDistinctRefPictures(Slice *currSlice, int num_lists, StorablePicture **pics, int idx[2][MAX_REFERENCE_PICTURES])
+{
+  int num_pics = 0;
+  int clist, n, i;
+
+  for (clist = 0; clist < num_lists; clist++)
+  {
+    for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
-      sum_value += (double) *(p_tmp++);
+      StorablePicture *ref = currSlice->listX[clist][n];
+
+      for (i = 0; i < num_pics && pics[i] != ref; i++)
+        ;
+      if (i == num_pics)
+        pics[num_pics++] = ref;
+      if (idx != NULL && clist < 2)
+        idx[clist][n] = i;
     }
   }
-  return sum_value;
+  return num_pics;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Computes the plane sums of all pictures in the first num_lists
+*    reference lists in parallel, for planes first_pl to last_pl, so the
+*    per reference loops of the WP functions only look them up.
+************************************************************************
+*/
+void ComputeRefImgSums(Slice *currSlice, int num_lists, int first_pl, int last_pl)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  StorablePicture *pics[6 * MAX_REFERENCE_PICTURES];
+  int num_planes = last_pl - first_pl + 1;
+  int num_pics = GetDistinctRefPictures(currSlice, num_lists, pics, NULL);
+  int task;
+
+  // each task owns one plane of one picture, so the sums can be stored without locking
+#if defined(OPENMP)
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (task = 0; task < num_pics * num_planes; task++)
+  {
+    int pl = first_pl + task % num_planes;
+
+    if (pl == 0)
+      ComputeRefImgSum(pics[task / num_planes], 0, p_Vid->height, p_Vid->width);
+    else
+      ComputeRefImgSum(pics[task / num_planes], pl, p_Vid->height_cr, p_Vid->width_cr);
+  }
 }
 
 static int ComputeBlockSum(imgpel **CurrentImage, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x, int cur_blk)
 {
-  int x, y;
+  int y;
   int sum = 0; 
 
   int blkx = cur_blk % width_in_blk;
   int blky = cur_blk / width_in_blk;
   int blk_start_x = blkx*blk_size_x;
   int blk_start_y = blky*blk_size_y;
-  imgpel *img_ptr;
 
   for(y = 0; y < blk_size_y; y++)
   {
-    img_ptr = &CurrentImage[blk_start_y + y][blk_start_x];
-    for(x = 0; x < blk_size_x; x++)
-    {
-      sum += img_ptr[x];
-    }
+    sum += ComputeRowSum(&CurrentImage[blk_start_y + y][blk_start_x], blk_size_x);
   }
 
   return sum; 
@@ -243,8 +354,6 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
   short offset[2][MAX_REFERENCE_PICTURES][3];
   int clist;
 
-  imgpel **tmpPtr;
-
   currSlice->luma_log_weight_denom   = 5;
   currSlice->chroma_log_weight_denom = 5;
 
@@ -263,6 +372,8 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
     } 
   }
 
+  ComputeRefImgSums(currSlice, 2 + list_offset, 0, p_Inp->ChromaWeightSupport == 1 ? 2 : 0);
+
   for (clist = 0; clist < 2 + list_offset; clist++)
   {
     for (n = 0; n < currSlice->listXsize[clist]; n++)
@@ -279,16 +390,14 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
         }
 
         // Y
-        tmpPtr = currSlice->listX[clist][n]->p_curr_img;      
-        dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[n] = ComputeRefImgSum(currSlice->listX[clist][n], 0, p_Vid->height, p_Vid->width);
 
         if (p_Inp->ChromaWeightSupport == 1)
         {
           for (k = 0; k < 2; k++)
           {
             // UV
-            tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
           }        
         }
 
@@ -387,7 +496,6 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
   short im_weight[6][MAX_REFERENCE_PICTURES][MAX_REFERENCE_PICTURES][3];
   int clist;
   short wf_weight, wf_offset;
-  imgpel **tmpPtr;
 
   if (p_Vid->active_pps->weighted_bipred_idc == 2) //! implicit mode. Values are fixed and it is important to show it here
   {
@@ -448,6 +556,8 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
       } 
     }
 
+    ComputeRefImgSums(currSlice, 2 + list_offset, 0, p_Inp->ChromaWeightSupport == 1 ? 2 : 0);
+
     for (clist=0; clist<2 + list_offset; clist++)
     {
       for (n = 0; n < currSlice->listXsize[clist]; n++)
@@ -465,8 +575,7 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
           // To simplify these computations we may wish to perform these after a reference is 
           // stored in the reference buffer and attach them to the storedimage structure!!!
           // Y
-          tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-          dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+          dc_ref[clist][n] = ComputeRefImgSum(currSlice->listX[clist][n], 0, p_Vid->height, p_Vid->width);
 
           if (dc_ref[clist][n] != 0.0)
             wf_weight = (short) (default_weight[0] * dc_org / dc_ref[clist][n] + 0.5);
@@ -485,8 +594,7 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
           {          
             for (k = 0; k < 2; k++)
             {        	
-              tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-              dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+              dc_ref_UV[clist][n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
 
               if (dc_ref_UV[clist][n][k] != 0.0)
                 wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -581,7 +689,6 @@ int TestWPPSliceAlg0(Slice *currSlice, int select_offset)
   //short wp_offset[6][MAX_REFERENCE_PICTURES][3];
   int clist;
   int perform_wp = 0;
-  imgpel **tmpPtr;
 
   short luma_log_weight_denom = 5;
   short chroma_log_weight_denom = 5;
@@ -614,19 +721,19 @@ int TestWPPSliceAlg0(Slice *currSlice, int select_offset)
     } 
   }
 
+  ComputeRefImgSums(currSlice, 2 + list_offset, 0, p_Inp->ChromaWeightSupport == 1 ? 2 : 0);
+
   for (clist = 0; clist < 2 + list_offset; clist++)
   {
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
-      tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-      dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+      dc_ref[n] = ComputeRefImgSum(currSlice->listX[clist][n], 0, p_Vid->height, p_Vid->width);
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
-          tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-          dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+          dc_ref_UV[n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
         }        
       }
 
@@ -743,7 +850,6 @@ int TestWPBSliceAlg0(Slice *currSlice, int select_method)
   int clist;
   short wf_weight, wf_offset;
   int perform_wp = 1;
-  imgpel **tmpPtr;
 
   short luma_log_weight_denom = 5;
   short chroma_log_weight_denom = 5;
@@ -797,6 +903,8 @@ int TestWPBSliceAlg0(Slice *currSlice, int select_method)
       } 
     }
 
+    ComputeRefImgSums(currSlice, 2 + list_offset, 0, p_Inp->ChromaWeightSupport == 1 ? 2 : 0);
+
     for (clist=0; clist<2 + list_offset; clist++)
     {
       for (n = 0; n < currSlice->listXsize[clist]; n++)
@@ -804,8 +912,7 @@ int TestWPBSliceAlg0(Slice *currSlice, int select_method)
         // To simplify these computations we may wish to perform these after a reference is 
         // stored in the reference buffer and attach them to the storedimage structure!!!
         // Y
-        tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-        dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[clist][n] = ComputeRefImgSum(currSlice->listX[clist][n], 0, p_Vid->height, p_Vid->width);
 
         if (dc_ref[clist][n] != 0.0)
           wf_weight = (short) (default_weight[0] * dc_org / dc_ref[clist][n] + 0.5);
@@ -822,8 +929,7 @@ int TestWPBSliceAlg0(Slice *currSlice, int select_method)
         {          
           for (k = 0; k < 2; k++)
           {
-            tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[clist][n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
 
             if (dc_ref_UV[clist][n][k] != 0.0)
               wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -33,6 +33,9 @@ extern void   EstimateWPPSliceAlg0   (Slice *currSlice, int offset);
 extern int    TestWPPSliceAlg0       (Slice *currSlice, int offset);
 extern int    TestWPBSliceAlg0       (Slice *currSlice, int method);
 extern double ComputeImgSum          (imgpel **CurrentImage, int height, int width);
+extern double ComputeRefImgSum       (StorablePicture *ref, int pl, int height, int width);
+extern void   ComputeRefImgSums      (Slice *currSlice, int num_lists, int first_pl, int last_pl);
+extern int    GetDistinctRefPictures (Slice *currSlice, int num_lists, StorablePicture **pics, int idx[2][MAX_REFERENCE_PICTURES]);
 extern void   ComputeImgSumBlockBased(imgpel **CurrentImage, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk, double *dc);
 extern int64  ComputeSumBlockBased   (imgpel **CurrentImage, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk);
 
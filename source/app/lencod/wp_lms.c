@@ -19,50 +19,164 @@
 #include "image.h"
 #include "wp_lms.h"
 #include "wp.h"
+#include "simd.h"
 
+//! Statistics of a reference picture over the macroblocks of a slice
+typedef struct wp_ref_stats
+{
+  double dc[3];   //!< sample sums of the planes
+  double norm;    //!< sum of the absolute luma differences to the luma mean
+} WPRefStats;
 
-static double ComputeBlockNormMean(imgpel **CurrentImage, 
-                                   int height_in_blk, int width_in_blk, 
-                                   int blk_size_y, int blk_size_x, 
-                                   int cur_blk, double dc_mean)
+/*!
+************************************************************************
+* \brief
+*    Sum of a row of n samples, and sum and number of its samples above
+*    threshold
+************************************************************************
+*/
+static inline void ComputeRowSumAbove(const imgpel *p_img, int n, int threshold, int *sum_all, int *sum, int *count)
 {
-  int blkx, blky; 
-  int x, y;
-  double sum = 0.; 
-  imgpel *img_ptr; 
+  int x = 0;
+  int a = 0, s = 0, c = 0;
+
+#if defined(JM_SIMD)
+  if (n >= 8)
+  {
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i thr  = _mm_set1_epi16((short) threshold);
+    __m128i acc_a = _mm_setzero_si128();
+    __m128i acc_s = _mm_setzero_si128();
+    __m128i acc_c = _mm_setzero_si128();
 
-  blkx = cur_blk % width_in_blk;
-  blky = cur_blk / width_in_blk;
+    for (; x <= n - 8; x += 8)
+    {
+      __m128i v  = simd_load_pel8(&p_img[x]);
+      __m128i gt = _mm_cmpgt_epi16(v, thr);
 
-  for(y = 0; y < blk_size_y; y++)
+      acc_a = _mm_add_epi32(acc_a, _mm_madd_epi16(v, ones));
+      acc_s = _mm_add_epi32(acc_s, _mm_madd_epi16(_mm_and_si128(v, gt), ones));
+      acc_c = _mm_sub_epi32(acc_c, _mm_madd_epi16(gt, ones));
+    }
+    a = simd_hsum_epi32(acc_a);
+    s = simd_hsum_epi32(acc_s);
+    c = simd_hsum_epi32(acc_c);
+  }
+#endif
+  for (; x < n; x++)
   {
-    img_ptr = &CurrentImage[blky*blk_size_y+y][blkx*blk_size_x];
-    for(x = 0; x < blk_size_x; x++)
+    a += p_img[x];
+    if (p_img[x] > threshold)
     {
-      sum += dabs((double)img_ptr[x]-dc_mean);
+      s += p_img[x];
+      c++;
     }
   }
-
-  return sum; 
+  *sum_all += a;
+  *sum     += s;
+  *count   += c;
 }
 
+/*!
+************************************************************************
+* \brief
+*    Sum of the absolute differences between the samples of blocks
+*    start_blk to end_blk - 1 and dc_mean. With S and N the sum and the
+*    number of all samples and S_hi and N_hi those above the mean, it is
+*    (2 S_hi - S) - (2 N_hi - N) * dc_mean, so only integer reductions
+*    are needed.
+************************************************************************
+*/
 static void ComputeNormMeanBlockBased(imgpel **CurrentImage, int height_in_blk, int width_in_blk, 
                                       int blk_size_y, int blk_size_x, 
                                       int start_blk, int end_blk, 
                                       double dc_mean, double *norm_slice)
 {
-  int cur_blk;
-  double block_norm; 
-  double norm;
-  
+  // integer samples are above the mean exactly when they are above its integer part
+  int threshold = (int) dc_mean;
+  int64 sum_all = 0, sum_above = 0, count_above = 0;
+  int64 count_all = (int64) (end_blk - start_blk) * blk_size_y * blk_size_x;
+  int cur_blk, y;
+
+  for(cur_blk = start_blk; cur_blk < end_blk; cur_blk++)
   {
-    norm = 0.;
-    for(cur_blk = start_blk; cur_blk < end_blk; cur_blk++)
+    int blkx = cur_blk % width_in_blk;
+    int blky = cur_blk / width_in_blk;
+    int block_all = 0, block_sum = 0, block_count = 0;
+
+    for(y = 0; y < blk_size_y; y++)
     {
-      block_norm = ComputeBlockNormMean(CurrentImage, height_in_blk, width_in_blk, blk_size_y, blk_size_x, cur_blk, dc_mean);
-      norm += block_norm; 
+      ComputeRowSumAbove(&CurrentImage[blky*blk_size_y+y][blkx*blk_size_x], blk_size_x, threshold, &block_all, &block_sum, &block_count);
     }
-    (*norm_slice) = (double) norm;
+    sum_all     += block_all;
+    sum_above   += block_sum;
+    count_above += block_count;
+  }
+  (*norm_slice) = (double) (2 * sum_above - sum_all) - (double) (2 * count_above - count_all) * dc_mean;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Sample sums of the planes of a reference picture over macroblocks
+*    start_mb to end_mb - 1 and, if with_norm is set, the luma norm
+*    around their mean. Sums over the whole picture come from the
+*    picture's cached sums.
+************************************************************************
+*/
+static void ComputeRefStatsLMS(VideoParameters *p_Vid, StorablePicture *ref, int start_mb, int end_mb, int with_norm, WPRefStats *stats)
+{
+  int whole_pic = (start_mb == 0 && end_mb == p_Vid->FrameHeightInMbs * p_Vid->PicWidthInMbs);
+  int slice_size = (end_mb-start_mb)*MB_BLOCK_SIZE*MB_BLOCK_SIZE;
+  int k;
+
+  if (whole_pic)
+    stats->dc[0] = ComputeRefImgSum(ref, 0, p_Vid->FrameHeightInMbs * MB_BLOCK_SIZE, p_Vid->PicWidthInMbs * MB_BLOCK_SIZE);
+  else
+    ComputeImgSumBlockBased(ref->p_curr_img, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 
+      start_mb, end_mb, &stats->dc[0]);
+
+  stats->dc[1] = stats->dc[2] = 0.0;
+  stats->norm = 0.0;
+  if (with_norm)
+  {
+    ComputeNormMeanBlockBased(ref->p_curr_img, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 
+      start_mb, end_mb, stats->dc[0] / ((double) slice_size), &stats->norm);
+  }
+
+  if (p_Vid->p_Inp->ChromaWeightSupport == 1)
+  {
+    for (k = 0; k < 2; k++)
+    {
+      if (whole_pic)
+        stats->dc[k + 1] = ComputeRefImgSum(ref, k + 1, p_Vid->FrameHeightInMbs * p_Vid->mb_cr_size_y, p_Vid->PicWidthInMbs * p_Vid->mb_cr_size_x);
+      else
+        ComputeImgSumBlockBased(ref->imgUV[k], p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 
+          start_mb, end_mb, &stats->dc[k + 1]);
+    }
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Computes the statistics of all distinct pictures in lists 0 and 1 in
+*    parallel. idx[clist][n] receives the entry of listX[clist][n].
+************************************************************************
+*/
+static void ComputeRefStatsListsLMS(Slice *currSlice, int start_mb, int end_mb, int with_norm, WPRefStats *stats, int idx[2][MAX_REFERENCE_PICTURES])
+{
+  StorablePicture *pics[2 * MAX_REFERENCE_PICTURES];
+  int num_pics = GetDistinctRefPictures(currSlice, 2, pics, idx);
+  int i;
+
+  // one task per picture, so the cached sums of a picture are only written by one thread
+#if defined(OPENMP)
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (i = 0; i < num_pics; i++)
+  {
+    ComputeRefStatsLMS(currSlice->p_Vid, pics[i], start_mb, end_mb, with_norm, &stats[i]);
   }
 }
 
@@ -88,7 +202,8 @@ void ComputeExplicitWPParamsLMS(Slice *currSlice,
   short  cur_weight, cur_offset;
   int   bit_depth = (p_Vid->bitdepth_luma - 8);
 
-  imgpel **cur_ref; 
+  WPRefStats ref_stats[2 * MAX_REFERENCE_PICTURES];
+  int ref_idx[2][MAX_REFERENCE_PICTURES];
 
   for (clist=0; clist< 2; clist++)
   {
@@ -121,26 +236,18 @@ void ComputeExplicitWPParamsLMS(Slice *currSlice,
     } 
   }
 
+  ComputeRefStatsListsLMS(currSlice, start_mb, end_mb, 1, ref_stats, ref_idx);
+
   for (clist = 0; clist < 2; clist++)
   {
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
-      cur_ref = currSlice->listX[clist][n]->p_curr_img;
-      ComputeImgSumBlockBased(cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 
-        start_mb, end_mb, &dc_ref[0]);  
-      norm_ref[0] = dc_ref[0] / ((double) slice_size);
-      ComputeNormMeanBlockBased(cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 
-        start_mb, end_mb, norm_ref[0], &denom[0]);  
+      WPRefStats *stats = &ref_stats[ref_idx[clist][n]];
 
-      if (p_Inp->ChromaWeightSupport == 1)
-      {
-        for (k = 0; k < 2; k++)
-        {
-          cur_ref = currSlice->listX[clist][n]->imgUV[k];
-          ComputeImgSumBlockBased(cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 
-            start_mb, end_mb, &dc_ref[k+1]);  
-        }        
-      }
+      for (k = 0; k < 3; k++)
+        dc_ref[k] = stats->dc[k];
+      norm_ref[0] = dc_ref[0] / ((double) slice_size);
+      denom[0] = stats->norm;
 
       if (select_offset == 0)
       {
@@ -221,7 +328,8 @@ void ComputeExplicitWPParamsJNT(Slice *currSlice,
   int64 dc_cur_ref[2][MAX_REFERENCE_PICTURES][3];
   short w0 = default_weight[0], w1 = default_weight[0];
 
-  imgpel **cur_ref; 
+  WPRefStats ref_stats[2 * MAX_REFERENCE_PICTURES];
+  int ref_idx[2][MAX_REFERENCE_PICTURES];
 
   for (clist=0; clist< 2; clist++)
   {
@@ -247,21 +355,15 @@ void ComputeExplicitWPParamsJNT(Slice *currSlice,
     } 
   }
 
+  ComputeRefStatsListsLMS(currSlice, start_mb, end_mb, 0, ref_stats, ref_idx);
+
   for (clist = 0; clist < 2; clist++)
   {
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
-      cur_ref = currSlice->listX[clist][n]->p_curr_img;
-      dc_cur_ref[clist][n][0] = ComputeSumBlockBased (cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, start_mb, end_mb);  
-
-      if (p_Inp->ChromaWeightSupport == 1)
-      {
-        for (k = 0; k < 2; k++)
-        {
-          cur_ref = currSlice->listX[clist][n]->imgUV[k];
-          dc_cur_ref[clist][n][k+1] = ComputeSumBlockBased (cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, start_mb, end_mb);  
-        }        
-      }
+      // the sums are integers, so the conversion is exact
+      for (k = 0; k < 3; k++)
+        dc_cur_ref[clist][n][k] = (int64) ref_stats[ref_idx[clist][n]].dc[k];
     }
   }
 
@@ -41,8 +41,6 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
   short offset[2][MAX_REFERENCE_PICTURES][3];
   int clist;
 
-  imgpel **tmpPtr;
-
   currSlice->luma_log_weight_denom   = 5;
   currSlice->chroma_log_weight_denom = 5;
 
@@ -61,6 +59,8 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
     } 
   }
 
+  ComputeRefImgSums(currSlice, 2 + list_offset, 0, p_Inp->ChromaWeightSupport == 1 ? 2 : 0);
+
   for (clist = 0; clist < 2 + list_offset; clist++)
   {
     for (n = 0; n < currSlice->listXsize[clist]; n++)
@@ -77,16 +77,14 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
         }
 
         // Y
-        tmpPtr = currSlice->listX[clist][n]->p_curr_img;      
-        dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[n] = ComputeRefImgSum(currSlice->listX[clist][n], 0, p_Vid->height, p_Vid->width);
 
         if (p_Inp->ChromaWeightSupport == 1)
         {
           for (k = 0; k < 2; k++)
           {
             // UV
-            tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
           }        
         }
 
@@ -179,7 +177,6 @@ void EstimateWPBSliceAlg2(Slice *currSlice)
   short im_weight[6][MAX_REFERENCE_PICTURES][MAX_REFERENCE_PICTURES][3];
   int clist;
   short wf_weight, wf_offset;
-  imgpel **tmpPtr;
 
   if (p_Vid->active_pps->weighted_bipred_idc == 2) //! implicit mode. Values are fixed and it is important to show it here
   {
@@ -268,6 +265,7 @@ void EstimateWPBSliceAlg2(Slice *currSlice)
       {
         dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
       } 
+      ComputeRefImgSums(currSlice, 2 + list_offset, 1, 2);
     }
 
     for (clist=0; clist<2 + list_offset; clist++)
@@ -294,8 +292,7 @@ void EstimateWPBSliceAlg2(Slice *currSlice)
           {          
             for (k = 0; k < 2; k++)
             {
-              tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-              dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+              dc_ref_UV[clist][n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
 
               if (dc_ref_UV[clist][n][k] != 0.0)
                 wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -391,7 +388,6 @@ int TestWPPSliceAlg2(Slice *currSlice, int select_offset)
   // short wp_offset[6][MAX_REFERENCE_PICTURES][3];
   int clist;
   int perform_wp = 0;
-  imgpel **tmpPtr;
 
   short luma_log_weight_denom   = 5;
   short chroma_log_weight_denom = 5;
@@ -424,19 +420,19 @@ int TestWPPSliceAlg2(Slice *currSlice, int select_offset)
     } 
   }
 
+  ComputeRefImgSums(currSlice, 2 + list_offset, 0, p_Inp->ChromaWeightSupport == 1 ? 2 : 0);
+
   for (clist = 0; clist < 2 + list_offset; clist++)
   {
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
-      tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-      dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+      dc_ref[n] = ComputeRefImgSum(currSlice->listX[clist][n], 0, p_Vid->height, p_Vid->width);
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
-          tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-          dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+          dc_ref_UV[n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
         }        
       }
 
@@ -555,7 +551,6 @@ int TestWPBSliceAlg2(Slice *currSlice, int select_method)
   int clist;
   short wf_weight, wf_offset;
   int perform_wp = 0;
-  imgpel **tmpPtr;
 
   short luma_log_weight_denom   = 5;
   short chroma_log_weight_denom = 5;
@@ -649,6 +644,9 @@ int TestWPBSliceAlg2(Slice *currSlice, int select_method)
     }
     */
 
+    if (p_Inp->ChromaWeightSupport == 1)
+      ComputeRefImgSums(currSlice, 2 + list_offset, 1, 2);
+
     for (clist=0; clist<2 + list_offset; clist++)
     {
       for (n = 0; n < currSlice->listXsize[clist]; n++)
@@ -661,8 +659,7 @@ int TestWPBSliceAlg2(Slice *currSlice, int select_method)
         {          
           for (k = 0; k < 2; k++)
           {
-            tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[clist][n][k] = ComputeRefImgSum(currSlice->listX[clist][n], k + 1, p_Vid->height_cr, p_Vid->width_cr);
 
             if (dc_ref_UV[clist][n][k] != 0.0)
               wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -755,12 +752,19 @@ int TestWPBSliceAlg2(Slice *currSlice, int select_method)
   return perform_wp;
 }
 
-void compute_offset(Slice *currSlice)
+/*!
+************************************************************************
+* \brief
+*    Accumulates the differences between the original samples of one
+*    macroblock row and their motion compensated predictions
+************************************************************************
+*/
+static void compute_offset_mb_row(Slice *currSlice, int i, int offset_total[2][MAX_REFERENCE_PICTURES], int offset_count[2][MAX_REFERENCE_PICTURES])
 {
   VideoParameters *p_Vid = currSlice->p_Vid;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
   Macroblock *currMB;
-  int i, j, x, y, xj, yi, temp, valOrg;
+  int j, x, y, xj, yi, temp, valOrg;
   int mvx=0,  mvy=0;
   int ref_frame=0;
   int subblock=0;
@@ -769,10 +773,83 @@ void compute_offset(Slice *currSlice)
   int out4Y_width  = (p_Vid->width  + IMG_PAD_SIZE_X) * 4 - 1;  
   int out4Y_height = (p_Vid->height + IMG_PAD_SIZE_Y) * 4 - 1;
 
+  for(j=0; j<p_Vid->width >> 4; j++)  //x
+  {
+    currMB = &p_Vid->mb_data[((i*p_Vid->width) >> 4)+j];
+    if(is_intra(currMB)) //intra macroblocks are not used for calculation of the filter coeffs.
+      continue;
+
+    x_orig = MB_BLOCK_SIZE*j;
+    y_orig = MB_BLOCK_SIZE*i;
+
+    for(subblock = 0; subblock < 16; subblock++)
+    {
+      //List 0
+      x = x_orig+4*(subblock & 0x03);
+      y = y_orig+4*(subblock >> 2);
+      mvx = motion[y >> 2][x >> 2].mv[LIST_0].mv_x;
+      mvy = motion[y >> 2][x >> 2].mv[LIST_0].mv_y;
+      ref_frame = motion[y >> 2][x >> 2].ref_idx[LIST_0];
+
+      if(ref_frame != -1)
+      {
+        for(yi = 0; yi < 4; yi++)
+        {    //y
+          for(xj = 0; xj < 4; xj++)
+          {  //x
+            valOrg   = p_Vid->pCurImg[y+yi][x+xj];
+
+            y_pos = imax(-4*IMG_PAD_SIZE_Y, imin(out4Y_height, 4*(y+yi)+mvy));
+            x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj)+mvx));
+
+            temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
+            offset_total[LIST_0][ref_frame]+=(valOrg-temp);
+            offset_count[LIST_0][ref_frame]++;          
+          }
+        }
+      } 
+
+      //List 1
+      mvx = motion[y >> 2][x >> 2].mv[LIST_1].mv_x;
+      mvy = motion[y >> 2][x >> 2].mv[LIST_1].mv_y;
+      ref_frame = motion[y >> 2][x >> 2].ref_idx[LIST_1];
+      if(ref_frame != -1)
+      {
+        for(yi = 0; yi < 4; yi++)
+        {    //y
+          for(xj = 0; xj < 4; xj++)
+          {  //x
+            valOrg   = p_Vid->pCurImg[y+yi][x+xj];
+
+            y_pos = imax(-4*IMG_PAD_SIZE_Y, imin(out4Y_height, 4*(y+yi) + mvy));
+            x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj) + mvx));
+
+            temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
+            offset_total[LIST_1][ref_frame]+=(valOrg-temp);
+            offset_count[LIST_1][ref_frame]++;          
+          }
+        }
+      }
+    }//  for(subblock = 0; subblock < 16; subblock++)
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Computes the average difference between the original picture and its
+*    motion compensated prediction for each reference. The macroblock rows
+*    are processed in parallel; the integer sums do not depend on the order.
+************************************************************************
+*/
+void compute_offset(Slice *currSlice)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  int i;
   int frame, list, offset; 
   double dtemp;
   int numlists  = (p_Vid->type == B_SLICE) ? 2 : 1;
-
+  int mb_rows = p_Vid->height >> 4;
 
   for(list = 0; list < 2; list++)
   {
@@ -783,99 +860,56 @@ void compute_offset(Slice *currSlice)
     }
   }
 
-
-  for(i=0; i<p_Vid->height >> 4; i++) //y
+#if defined(OPENMP)
+#pragma omp parallel private(list, frame)
+#endif
   {
-    for(j=0; j<p_Vid->width >> 4; j++)  //x
-    {
-      { 
-        currMB = &p_Vid->mb_data[((i*p_Vid->width) >> 4)+j];
-        if(is_intra(currMB)) //intra macroblocks are not used for calculation of the filter coeffs.
-          continue;
+    int offset_total[2][MAX_REFERENCE_PICTURES];
+    int offset_count[2][MAX_REFERENCE_PICTURES];
 
-        x_orig = MB_BLOCK_SIZE*j;
-        y_orig = MB_BLOCK_SIZE*i;
-
-        for(subblock = 0; subblock < 16; subblock++)
-        {
-          //List 0
-          x = x_orig+4*(subblock & 0x03);
-          y = y_orig+4*(subblock >> 2);
-          mvx = motion[y >> 2][x >> 2].mv[LIST_0].mv_x;
-          mvy = motion[y >> 2][x >> 2].mv[LIST_0].mv_y;
-          ref_frame = motion[y >> 2][x >> 2].ref_idx[LIST_0];
-
-          if(ref_frame != -1)
-          {
-            for(yi = 0; yi < 4; yi++)
-            {    //y
-              for(xj = 0; xj < 4; xj++)
-              {  //x
-                valOrg   = p_Vid->pCurImg[y+yi][x+xj];
-
-                //y_pos = imax(0,imin(out4Y_height,4*(y+yi)+4*IMG_PAD_SIZE+mvy));
-                y_pos = imax(-4*IMG_PAD_SIZE_Y, imin(out4Y_height, 4*(y+yi)+mvy));
-                //x_pos = imax(0,imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
-                x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj)+mvx));
-
-                temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
-                p_Vid->frameOffsetTotal[LIST_0][ref_frame]+=(valOrg-temp);
-                p_Vid->frameOffsetCount[LIST_0][ref_frame]++;          
-              }
-            }
-          } 
+    memset(offset_total, 0, sizeof(offset_total));
+    memset(offset_count, 0, sizeof(offset_count));
 
+#if defined(OPENMP)
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for(i = 0; i < mb_rows; i++) //y
+    {
+      compute_offset_mb_row(currSlice, i, offset_total, offset_count);
+    }
 
-          //List 1
-          mvx = motion[y >> 2][x >> 2].mv[LIST_1].mv_x;
-          mvy = motion[y >> 2][x >> 2].mv[LIST_1].mv_y;
-          ref_frame = motion[y >> 2][x >> 2].ref_idx[LIST_1];
-          if(ref_frame != -1)
-          {
-            for(yi = 0; yi < 4; yi++)
-            {    //y
-              for(xj = 0; xj < 4; xj++)
-              {  //x
-                valOrg   = p_Vid->pCurImg[y+yi][x+xj];
-
-                //y_pos = imax(0,imin(out4Y_height,4*(y+yi)+4*IMG_PAD_SIZE+mvy));
-                y_pos = imax(-4*IMG_PAD_SIZE_Y, imin(out4Y_height, 4*(y+yi) + mvy));
-                //x_pos = imax(0, imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
-                x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj) + mvx));
-
-                temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
-                p_Vid->frameOffsetTotal[LIST_1][ref_frame]+=(valOrg-temp);
-                p_Vid->frameOffsetCount[LIST_1][ref_frame]++;          
-              }
-            }
-          }
-        }//  for(subblock = 0; subblock < 16; subblock++)
+#if defined(OPENMP)
+#pragma omp critical (compute_offset)
+#endif
+    {
+      for(list = 0; list < 2; list++)
+      {
+        for(frame = 0; frame < MAX_REFERENCE_PICTURES; frame++)
+        {
+          p_Vid->frameOffsetTotal[list][frame] += offset_total[list][frame];
+          p_Vid->frameOffsetCount[list][frame] += offset_count[list][frame];
+        }
       }
     }
+  }
 
-    for(list = 0; list < numlists; list++)
+  for(list = 0; list < numlists; list++)
+  {
+    for(frame = 0; frame < currSlice->listXsize[list]; frame++)
     {
-      for(frame = 0; frame < currSlice->listXsize[list]; frame++)
-      {
-        dtemp=(double)p_Vid->frameOffsetTotal[list][frame];
+      dtemp=(double)p_Vid->frameOffsetTotal[list][frame];
 
-        if (p_Vid->frameOffsetCount[list][frame]>0)
+      if (p_Vid->frameOffsetCount[list][frame]>0)
+      {
+        offset=(int)(fabs(dtemp)/(double)p_Vid->frameOffsetCount[list][frame]+0.5);
+        if (p_Vid->frameOffsetTotal[list][frame]>=0)
         {
-          offset=(int)(fabs(dtemp)/(double)p_Vid->frameOffsetCount[list][frame]+0.5);
-          if (p_Vid->frameOffsetTotal[list][frame]>=0)
-          {
-            p_Vid->frameOffset[list][frame] = (short) offset;
-          }
-          else
-          {
-            p_Vid->frameOffset[list][frame] = (short) -offset;
-          }
-          //printf("list %d frame %d offset %d frameOffsetCount %d, frameOffsetTotal %d\n", list, frame, p_Vid->frameOffset[list][frame], p_Vid->frameOffsetCount[list][frame], p_Vid->frameOffsetTotal[list][frame]);
+          p_Vid->frameOffset[list][frame] = (short) offset;
+        }
+        else
+        {
+          p_Vid->frameOffset[list][frame] = (short) -offset;
         }
-        //else
-        //{
-        //printf("list %d frame %d, frameOffsetCount=0\n", list, frame);
-        //}
       }
     }
   }
@@ -0,0 +1,262 @@
+/*!
+ *************************************************************************************
+ * \file pel_convert_bench.c
+ *
+ * \brief
+ *    Micro-benchmark of the sample format conversions (lcommon/pel_convert.c).
+ *
+ *    Every kernel of the table picked by get_pel_convert() is run on random
+ *    data of the size of one picture and compared with the plain C kernels;
+ *    the time per picture of both is printed. The exit code is 1 if any
+ *    kernel differs from the C version.
+ *
+ *    Usage: pel_convert_bench [width height [iterations]]
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "pel_convert.h"
+
+#define BENCH_ALIGN   64    //!< slack so that odd row lengths can start at any offset
+#define CHECK_UNITS   200   //!< longest row checked for bit exactness
+#define CHECK_BYTES   8192  //!< output bytes compared per plane (covers CHECK_UNITS of every case)
+
+typedef struct bench_buffers
+{
+  int   width;
+  int   height;
+  int   iterations;
+  byte *src;              //!< random file samples (16 bit samples are little endian)
+  byte *dst_c[3];         //!< output of the C kernels
+  byte *dst_simd[3];      //!< output of the selected kernels
+  int   size;             //!< bytes of src and of each dst plane
+} BenchBuffers;
+
+typedef struct bench_case
+{
+  const char *name;
+  int kernel;             //!< 0: widen, 1: shift, 2: narrow, 3: deinterleave, 4: v210
+  int symbol_size;        //!< bytes per file sample
+  int bitshift;           //!< shift_row only
+  const PackedLayout *layout;
+} BenchCase;
+
+static const BenchCase bench_cases[] =
+{
+  { "widen 8 bit",             0, 1,  0, NULL           },
+  { "10 -> 8 bit rescale",     1, 2,  2, NULL           },
+  { "8 -> 10 bit rescale",     1, 1, -2, NULL           },
+  { "16 bit copy",             1, 2,  0, NULL           },
+  { "narrow to 8 bit",         2, 1,  0, NULL           },
+  { "4:2:0 interleaved",       3, 1,  0, &layout_yuv420 },
+  { "4:4:4 interleaved",       3, 1,  0, &layout_yuv444 },
+  { "4:4:4 interleaved 16 bit",3, 2,  0, &layout_yuv444 },
+  { "yuyv 8 bit",              3, 1,  0, &layout_yuyv   },
+  { "yuyv 16 bit",             3, 2,  0, &layout_yuyv   },
+  { "yvyu 8 bit",              3, 1,  0, &layout_yvyu   },
+  { "uyvy 8 bit",              3, 1,  0, &layout_uyvy   },
+  { "v210",                    4, 4,  0, NULL           }
+};
+
+static byte *bench_alloc(int size)
+{
+  byte *p = (byte *) calloc(size + BENCH_ALIGN, 1);
+
+  if (p == NULL)
+  {
+    fprintf(stderr, "pel_convert_bench: not enough memory\n");
+    exit(1);
+  }
+  return p;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Runs one kernel on n samples (or groups/blocks) of the picture
+ ************************************************************************
+ */
+static void run_kernel(const PelConvert *conv, const BenchCase *bc, byte *dst[3], const byte *src, int n)
+{
+  switch (bc->kernel)
+  {
+  case 0:
+    conv->widen_row((imgpel *) dst[0], src, n);
+    break;
+  case 1:
+    conv->shift_row((imgpel *) dst[0], src, n, bc->symbol_size, bc->bitshift);
+    break;
+  case 2:
+    conv->narrow_row(dst[0], (const imgpel *) src, n);
+    break;
+  case 3:
+    conv->deinterleave(dst, src, bc->layout, bc->symbol_size, n);
+    break;
+  default:
+    conv->unpack_v210((uint16 **) dst, src, n);
+    break;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Kernel units (samples, groups or V210 blocks) of one picture row
+ ************************************************************************
+ */
+static int row_units(const BenchCase *bc, int width)
+{
+  switch (bc->kernel)
+  {
+  case 3:
+    // 4:2:0 (period 6) carries 1.5, 4:2:2 (period 4) 2 and 4:4:4 (period 3) 3 samples per pixel
+    return width * (bc->layout->period == 6 ? 3 : (bc->layout->period == 4 ? 4 : 6)) / (2 * bc->layout->period);
+  case 4:
+    return width / 6;
+  default:
+    return width * 3 / 2;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Source bytes of n kernel units
+ ************************************************************************
+ */
+static int unit_bytes(const BenchCase *bc, int n)
+{
+  switch (bc->kernel)
+  {
+  case 2:
+    return n * (int) sizeof(imgpel);
+  case 3:
+    return n * bc->layout->period * bc->symbol_size;
+  case 4:
+    return n * 16;
+  default:
+    return n * bc->symbol_size;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Bit exactness of the selected kernels against the C ones, over
+ *    row lengths that exercise the vector tails and unaligned starts
+ ************************************************************************
+ */
+static int check_case(const PelConvert *conv, const BenchCase *bc, BenchBuffers *b)
+{
+  const PelConvert *ref = get_pel_convert_c();
+  int n, offset, k;
+
+  for (n = 1; n <= CHECK_UNITS; ++n)
+  {
+    for (offset = 0; offset < 4; ++offset)
+    {
+      const byte *src = b->src + offset * (bc->kernel == 2 ? (int) sizeof(imgpel) : bc->symbol_size);
+
+      for (k = 0; k < 3; ++k)
+      {
+        memset(b->dst_c[k], 0xA5, CHECK_BYTES);
+        memset(b->dst_simd[k], 0xA5, CHECK_BYTES);
+      }
+      run_kernel(ref,  bc, b->dst_c, src, n);
+      run_kernel(conv, bc, b->dst_simd, src, n);
+      for (k = 0; k < 3; ++k)
+      {
+        if (memcmp(b->dst_c[k], b->dst_simd[k], CHECK_BYTES))
+        {
+          printf("%-26s MISMATCH (length %d, offset %d, plane %d)\n", bc->name, n, offset, k);
+          return 1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Time of one picture of the case with the given kernels, in ms
+ ************************************************************************
+ */
+static double time_case(const PelConvert *conv, const BenchCase *bc, BenchBuffers *b)
+{
+  TIME_T start_time, end_time;
+  int units = row_units(bc, b->width);
+  int stride = unit_bytes(bc, units);
+  int i, y;
+
+  gettime(&start_time);
+  for (i = 0; i < b->iterations; ++i)
+  {
+    for (y = 0; y < b->height; ++y)
+    {
+      const byte *src = b->src + (y * stride) % (b->size - stride);
+
+      run_kernel(conv, bc, b->dst_simd, src, units);
+    }
+  }
+  gettime(&end_time);
+
+  // timenorm() scales to ms; scaling the difference first keeps us
+  return (double) timenorm(timediff(&start_time, &end_time) * 1000) / (double) b->iterations / 1000.0;
+}
+
+int main(int argc, char **argv)
+{
+  const PelConvert *conv = get_pel_convert();
+  BenchBuffers b;
+  int mismatch = 0;
+  int i, k;
+
+  b.width      = (argc > 2) ? atoi(argv[1]) : 1920;
+  b.height     = (argc > 2) ? atoi(argv[2]) : 1080;
+  b.iterations = (argc > 3) ? atoi(argv[3]) : 20;
+  if (b.width < 6 || b.height < 1 || b.iterations < 1)
+  {
+    fprintf(stderr, "Usage: %s [width height [iterations]]\n", argv[0]);
+    return 1;
+  }
+
+  // a few rows of the widest case (4:4:4 16 bit), at least the checked rows
+  b.size = imax(b.width * 3 * 2 * 4, CHECK_BYTES) + BENCH_ALIGN;
+  b.src = bench_alloc(b.size);
+  for (k = 0; k < 3; ++k)
+  {
+    b.dst_c[k]    = bench_alloc(b.size);
+    b.dst_simd[k] = bench_alloc(b.size);
+  }
+
+  srand(1);
+  for (i = 0; i < b.size; ++i)
+    b.src[i] = (byte) (rand() >> 7);
+
+  init_time();
+  printf("Sample conversion kernels: %s, ms per %dx%d picture (%d iterations)\n", conv->name, b.width, b.height, b.iterations);
+  printf("%-26s %10s %10s\n", "", "C", conv->name);
+
+  for (i = 0; i < (int) (sizeof(bench_cases) / sizeof(bench_cases[0])); ++i)
+  {
+    const BenchCase *bc = &bench_cases[i];
+
+    if (check_case(conv, bc, &b))
+    {
+      mismatch = 1;
+      continue;
+    }
+    printf("%-26s %10.3f %10.3f\n", bc->name, time_case(get_pel_convert_c(), bc, &b), time_case(conv, bc, &b));
+  }
+
+  free(b.src);
+  for (k = 0; k < 3; ++k)
+  {
+    free(b.dst_c[k]);
+    free(b.dst_simd[k]);
+  }
+  return mismatch;
+}
@@ -26,6 +26,7 @@
 #include "mc_prediction.h"
 #include "image.h"
 #include "mb_access.h"
+#include "simd.h"
 
 void compute_residue (imgpel **curImg, imgpel **mpr, int **mb_rres, int mb_x, int opix_x, int width, int height)
 {
@@ -38,7 +39,17 @@ void compute_residue (imgpel **curImg, imgpel **mpr, int **mb_rres, int mb_x, in
     imgOrg = &curImg[j][opix_x];    
     imgPred = &mpr[j][mb_x];
     m7 = &mb_rres[j][mb_x]; 
-    for (i = 0; i < width; i++)
+    i = 0;
+#if defined(JM_SIMD)
+    for (; i < width - 3; i += 4)
+    {
+      _mm_storeu_si128((__m128i *) m7, _mm_sub_epi32(simd_load_pel4(imgOrg), simd_load_pel4(imgPred)));
+      imgOrg += 4;
+      imgPred += 4;
+      m7 += 4;
+    }
+#endif
+    for (; i < width; i++)
     {
       *m7++ = *imgOrg++ - *imgPred++;
     }
@@ -50,13 +61,31 @@ void sample_reconstruct (imgpel **curImg, imgpel **mpr, int **mb_rres, int mb_x,
   imgpel *imgOrg, *imgPred;
   int    *m7;
   int i, j;
+#if defined(JM_SIMD)
+  const __m128i vrnd   = _mm_set1_epi32((1 << dq_bits) >> 1);
+  const __m128i vshift = _mm_cvtsi32_si128(dq_bits);
+  const __m128i vmax   = _mm_set1_epi32(max_imgpel_value);
+  const __m128i vzero  = _mm_setzero_si128();
+#endif
 
   for (j = 0; j < height; j++)
   {
     imgOrg = &curImg[j][opix_x];
     imgPred = &mpr[j][mb_x];
     m7 = &mb_rres[j][mb_x]; 
-    for (i=0;i<width;i++)
+    i = 0;
+#if defined(JM_SIMD)
+    for (; i < width - 3; i += 4)
+    {
+      __m128i v = _mm_sra_epi32(_mm_add_epi32(_mm_loadu_si128((__m128i *) m7), vrnd), vshift);
+      v = _mm_add_epi32(v, simd_load_pel4(imgPred));
+      simd_store_pel4(imgOrg, _mm_min_epi32(_mm_max_epi32(v, vzero), vmax));
+      imgOrg += 4;
+      imgPred += 4;
+      m7 += 4;
+    }
+#endif
+    for (; i < width; i++)
       *imgOrg++ = (imgpel) iClip1( max_imgpel_value, rshift_rnd_sf(*m7++, dq_bits) + *imgPred++);
   }
 }
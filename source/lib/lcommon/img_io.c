@@ -247,7 +247,11 @@ void OpenFrameFile( VideoDataFile *input_file, int FrameNumberInFile)
  */
 void OpenFiles( VideoDataFile *input_file)
 {
-  if (input_file->is_concatenated == 1)
+  if (IsInputStream(input_file))
+  {
+    OpenInputStream(input_file);
+  }
+  else if (input_file->is_concatenated == 1)
   {
     if ((int) strlen(input_file->fname) == 0)
     {
@@ -271,6 +275,10 @@ void OpenFiles( VideoDataFile *input_file)
  */
 void CloseFiles(VideoDataFile *input_file)
 {
+  if (input_file->stream != NULL)
+    CloseInputStream(input_file);
+  if (input_file->map != NULL)
+    CloseFrameMap(input_file);
   if (input_file->f_num != -1)
     close(input_file->f_num);
   input_file->f_num = -1;
@@ -286,7 +294,7 @@ VideoFileType ParseVideoType (VideoDataFile *input_file)
 {
   char *format;
 
-  format = input_file->fname + (int) strlen(input_file->fname) - 3;
+  format = input_file->fname + imax((int) strlen(input_file->fname) - 3, 0);
 
   if (strcasecmp (format, "yuv") == 0)
   {
@@ -309,6 +317,12 @@ VideoFileType ParseVideoType (VideoDataFile *input_file)
   {
     input_file->vdtype = VIDEO_AVI;
   }
+  else if (strcasecmp (format, "y4m") == 0)
+  {
+    input_file->vdtype = VIDEO_Y4M;
+    input_file->format.yuv_format = YUV420;
+    input_file->avi = NULL;
+  }
   else
   {
     //snprintf(errortext, ET_SIZE, "ERROR: video file format not supported");
@@ -18,6 +18,7 @@
 #include "io_video.h"
 #include "io_raw.h"
 #include "io_tiff.h"
+#include "io_stream.h"
 
 extern int ParseSizeFromString           (VideoDataFile *input_file, int *xlen, int *ylen, double *fps);
 extern void ParseFrameNoFormatFromString (VideoDataFile *input_file);
@@ -24,6 +24,7 @@
 #include "img_io.h"
 #include "memalloc.h"
 #include "fast_memory.h"
+#include "pel_convert.h"
 
 void buf2img_basic    ( imgpel** imgX, unsigned char* buf, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift);
 void buf2img_endian   ( imgpel** imgX, unsigned char* buf, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift);
@@ -125,249 +126,54 @@ void fillPlane ( imgpel** imgX,                 //!< Pointer to image plane
   }
 }
 
-static void deinterleave_yuv420( unsigned char** input,       //!< input buffer
-  unsigned char** output,      //!< output buffer
-  FrameFormat *source,         //!< format of source buffer
-  int symbol_size_in_bytes     //!< number of bytes per symbol
-  ) 
-{
-  int i;  
-  // original buffer
-  unsigned char *icmp  = *input;
-  // final buffer
-  unsigned char *ocmp0 = *output;
-
-  unsigned char *ocmp1 = ocmp0 + symbol_size_in_bytes * source->size_cmp[Y_COMP];
-  unsigned char *ocmp2 = ocmp1 + symbol_size_in_bytes * source->size_cmp[U_COMP];
-
-  for (i = 0; i < source->size_cmp[U_COMP]; i++) 
-  {
-    memcpy(ocmp1, icmp, symbol_size_in_bytes);
-    ocmp1 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    memcpy(ocmp0, icmp, 2 * symbol_size_in_bytes);
-    ocmp0 += 2 * symbol_size_in_bytes;
-    icmp  += 2 * symbol_size_in_bytes;
-    memcpy(ocmp2, icmp, symbol_size_in_bytes);
-    ocmp2 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    memcpy(ocmp0, icmp, 2 * symbol_size_in_bytes);
-    ocmp0 += 2 * symbol_size_in_bytes;
-    icmp  += 2 * symbol_size_in_bytes;
-  }
-
-  // flip buffers
-  icmp    = *input;
-  *input  = *output;
-  *output = icmp;  
-}
-
-static void deinterleave_yuv444( unsigned char** input,       //!< input buffer
-  unsigned char** output,      //!< output buffer
-  FrameFormat *source,         //!< format of source buffer
-  int symbol_size_in_bytes     //!< number of bytes per symbol
-  ) 
-{
-  int i;  
-  // original buffer
-  unsigned char *icmp  = *input;
-  // final buffer
-  unsigned char *ocmp0 = *output;
-
-  unsigned char *ocmp1 = ocmp0 + symbol_size_in_bytes * source->size_cmp[Y_COMP];
-  unsigned char *ocmp2 = ocmp1 + symbol_size_in_bytes * source->size_cmp[U_COMP];
-
-  for (i = 0; i < source->size_cmp[Y_COMP]; i++) 
-  {
-    memcpy(ocmp0, icmp, symbol_size_in_bytes);
-    ocmp0 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    memcpy(ocmp1, icmp, symbol_size_in_bytes);
-    ocmp1 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    memcpy(ocmp2, icmp, symbol_size_in_bytes);
-    ocmp2 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-  }
-  // flip buffers
-  icmp    = *input;
-  *input  = *output;
-  *output = icmp;
-}
-
-static void deinterleave_yuyv ( unsigned char** input,       //!< input buffer
+/*!
+ ************************************************************************
+ * \brief
+ *    Deinterleave a packed format (groups of samples in layout order)
+ ************************************************************************
+ */
+static void deinterleave_packed ( unsigned char** input,       //!< input buffer
   unsigned char** output,      //!< output buffer
   FrameFormat *source,         //!< format of source buffer
-  int symbol_size_in_bytes     //!< number of bytes per symbol
+  int symbol_size_in_bytes,    //!< number of bytes per symbol
+  const PackedLayout *layout,  //!< order of the samples of a group
+  int groups                   //!< number of groups
   ) 
 {
-  int i;  
   // original buffer
   unsigned char *icmp = *input;
   // final buffer
-  unsigned char *ocmp0 = *output;
+  unsigned char *ocmp[3];
 
-  unsigned char *ocmp1 = ocmp0 + symbol_size_in_bytes * source->size_cmp[Y_COMP];
-  unsigned char *ocmp2 = ocmp1 + symbol_size_in_bytes * source->size_cmp[U_COMP];
+  ocmp[0] = *output;
+  ocmp[1] = ocmp[0] + symbol_size_in_bytes * source->size_cmp[Y_COMP];
+  ocmp[2] = ocmp[1] + symbol_size_in_bytes * source->size_cmp[U_COMP];
 
-  for (i = 0; i < source->size_cmp[U_COMP]; i++) 
-  {
-    // Y
-    memcpy(ocmp0, icmp, symbol_size_in_bytes);
-    ocmp0 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // U
-    memcpy(ocmp1, icmp, symbol_size_in_bytes);
-    ocmp1 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // Y
-    memcpy(ocmp0, icmp, symbol_size_in_bytes);
-    ocmp0 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // V
-    memcpy(ocmp2, icmp, symbol_size_in_bytes);
-    ocmp2 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-  }
-  // flip buffers
-  icmp    = *input;
-  *input  = *output;
-  *output = icmp;
-}
+  get_pel_convert()->deinterleave(ocmp, icmp, layout, symbol_size_in_bytes, groups);
 
-static void deinterleave_yvyu ( unsigned char** input,       //!< input buffer
-  unsigned char** output,      //!< output buffer
-  FrameFormat *source,         //!< format of source buffer
-  int symbol_size_in_bytes     //!< number of bytes per symbol
-  ) 
-{
-  int i;  
-  // original buffer
-  unsigned char *icmp  = *input;
-  // final buffer
-  unsigned char *ocmp0 = *output;
-
-  unsigned char *ocmp1 = ocmp0 + symbol_size_in_bytes * source->size_cmp[Y_COMP];
-  unsigned char *ocmp2 = ocmp1 + symbol_size_in_bytes * source->size_cmp[U_COMP];
-
-  for (i = 0; i < source->size_cmp[U_COMP]; i++) 
-  {
-    // Y
-    memcpy(ocmp0, icmp, symbol_size_in_bytes);
-    ocmp0 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // V
-    memcpy(ocmp2, icmp, symbol_size_in_bytes);
-    ocmp2 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // Y
-    memcpy(ocmp0, icmp, symbol_size_in_bytes);
-    ocmp0 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // U
-    memcpy(ocmp1, icmp, symbol_size_in_bytes);
-    ocmp1 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-  }
   // flip buffers
-  icmp    = *input;
   *input  = *output;
   *output = icmp;
 }
 
-static void deinterleave_uyvy ( unsigned char** input,       //!< input buffer
+static void deinterleave_v210 ( unsigned char** input,       //!< input buffer
   unsigned char** output,      //!< output buffer
   FrameFormat *source,         //!< format of source buffer
   int symbol_size_in_bytes     //!< number of bytes per symbol
   ) 
 {
-  int i;  
   // original buffer
   unsigned char *icmp  = *input;
   // final buffer
-  unsigned char *ocmp0 = *output;
+  uint16 *ocmp[3];
 
-  unsigned char *ocmp1 = ocmp0 + symbol_size_in_bytes * source->size_cmp[Y_COMP];
-  unsigned char *ocmp2 = ocmp1 + symbol_size_in_bytes * source->size_cmp[U_COMP];
-
-  for (i = 0; i < source->size_cmp[U_COMP]; i++) 
-  {
-    // U
-    memcpy(ocmp1, icmp, symbol_size_in_bytes);
-    ocmp1 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // Y
-    memcpy(ocmp0, icmp, symbol_size_in_bytes);
-    ocmp0 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // V
-    memcpy(ocmp2, icmp, symbol_size_in_bytes);
-    ocmp2 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-    // Y
-    memcpy(ocmp0, icmp, symbol_size_in_bytes);
-    ocmp0 += symbol_size_in_bytes;
-    icmp  += symbol_size_in_bytes;
-  }
-  // flip buffers
-  icmp    = *input;
-  *input  = *output;
-  *output = icmp;
-}
-
-static void deinterleave_v210 ( unsigned char** input,       //!< input buffer
-  unsigned char** output,      //!< output buffer
-  FrameFormat *source,         //!< format of source buffer
-  int symbol_size_in_bytes     //!< number of bytes per symbol
-  ) 
-{
-  int i;  
-  // original buffer
-  unsigned char *icmp  = *input;
+  ocmp[0] = (uint16 *) *output;
+  ocmp[1] = ocmp[0] + source->size_cmp[0];
+  ocmp[2] = ocmp[1] + source->size_cmp[1];
 
-  unsigned int   *ui32cmp = (unsigned int *) *input;
-  unsigned short *ui16cmp0 = (unsigned short *) *output;
-  unsigned short *ui16cmp1 = ui16cmp0 + source->size_cmp[0];
-  unsigned short *ui16cmp2 = ui16cmp1 + source->size_cmp[1];
+  get_pel_convert()->unpack_v210(ocmp, icmp, source->size_cmp[U_COMP] / 3);
 
-  for (i = 0; i < source->size_cmp[U_COMP] / 3; i++) 
-  {
-    // Byte 3          Byte 2          Byte 1          Byte 0
-    // Cr 0                Y 0                 Cb 0
-    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
-    *ui16cmp2   = (*ui32cmp & 0x3FF00000)>>20;         // Cr 0
-    *ui16cmp0   = (*ui32cmp & 0xffc00)>>10;            // Y 0
-    *ui16cmp1   = (*(ui32cmp++) & 0x3FF);              // Cb 0
-
-    // Byte 7          Byte 6          Byte 5          Byte 4
-    // Y 2                 Cb 1                Y 1
-    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
-    *(ui16cmp0 + 2) = (*ui32cmp & 0x3FF00000)>>20;     // Y 2
-    *(ui16cmp1 + 1) = (*ui32cmp & 0xffc00)>>10;        // Cb 1
-    *(ui16cmp0 + 1) = (*(ui32cmp++) & 0x3FF);          // Y 1
-
-    // Byte 11         Byte 10         Byte 9          Byte 8
-    // Cb 2                Y 3                 Cr 1
-    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
-    *(ui16cmp1 + 2) = (*ui32cmp & 0x3FF00000)>>20;     // Cb 2
-    *(ui16cmp0 + 3) = (*ui32cmp & 0xffc00)>>10;        // Y 3
-    *(ui16cmp2 + 1) = (*(ui32cmp++) & 0x3FF);          // Cr 1
-
-    // Byte 15         Byte 14         Byte 13         Byte 12
-    // Y 5                 Cr 2                Y 4
-    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
-    *(ui16cmp0 + 5) = (*ui32cmp & 0x3FF00000)>>20;     // Y 2
-    *(ui16cmp2 + 2) = (*ui32cmp & 0xffc00)>>10;        // Cb 1
-    *(ui16cmp0 + 4) = (*(ui32cmp++) & 0x3FF);          // Y 1
-
-    //printf("luma: %d %d %d %d %d %d\n", *(ui16cmp0 + 0), *(ui16cmp0 + 1), *(ui16cmp0 + 2), *(ui16cmp0 + 3), *(ui16cmp0 + 4), *(ui16cmp0 + 5));
-
-    ui16cmp0 += 6;
-    ui16cmp1 += 3;
-    ui16cmp2 += 3;
-  }
   // flip buffers
-  icmp    = *input;
   *input  = *output;
   *output = icmp;
 }
@@ -386,21 +192,21 @@ static void deinterleave ( unsigned char** input,       //!< input buffer
 {
   if (source->yuv_format == YUV420) 
   { // UYYVYY 
-    deinterleave_yuv420(input, output, source, symbol_size_in_bytes);
+    deinterleave_packed(input, output, source, symbol_size_in_bytes, &layout_yuv420, source->size_cmp[U_COMP]);
   }  
   else if (source->yuv_format == YUV422)
   {
     if (source->pixel_format == YUYV || source->pixel_format == YUY2) 
     {
-      deinterleave_yuyv(input, output, source, symbol_size_in_bytes);
+      deinterleave_packed(input, output, source, symbol_size_in_bytes, &layout_yuyv, source->size_cmp[U_COMP]);
     }
     else if (source->pixel_format == YVYU)
     {
-      deinterleave_yvyu(input, output, source, symbol_size_in_bytes);
+      deinterleave_packed(input, output, source, symbol_size_in_bytes, &layout_yvyu, source->size_cmp[U_COMP]);
     }
     else if (source->pixel_format == UYVY) 
     {
-      deinterleave_uyvy(input, output, source, symbol_size_in_bytes);
+      deinterleave_packed(input, output, source, symbol_size_in_bytes, &layout_uyvy, source->size_cmp[U_COMP]);
     }
     else if (source->pixel_format == V210) 
     {
@@ -412,7 +218,7 @@ static void deinterleave ( unsigned char** input,       //!< input buffer
     }
   }
   else if (source->yuv_format == YUV444)  
-    deinterleave_yuv444(input, output, source, symbol_size_in_bytes);
+    deinterleave_packed(input, output, source, symbol_size_in_bytes, &layout_yuv444, source->size_cmp[Y_COMP]);
 }
 
 /*!
@@ -499,18 +305,13 @@ void buf2img_bitshift ( imgpel** imgX,            //!< Pointer to image plane
   else
   {
     // little endian
-    int j_pos;
+    const PelConvert *conv = get_pel_convert();
+
     if (size_x == o_size_x && size_y == o_size_y)
     {
       for (j = 0; j < o_size_y; j++)
       {
-        j_pos = j*size_x;
-        for (i = 0; i < o_size_x; i++)
-        {
-          ui16=0;
-          memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-          imgX[j][i] = (imgpel) rshift_rnd(ui16,bitshift);
-        }
+        conv->shift_row(imgX[j], buf + j * size_x * symbol_size_in_bytes, o_size_x, symbol_size_in_bytes, bitshift);
       }  
     }
     else
@@ -537,13 +338,7 @@ void buf2img_bitshift ( imgpel** imgX,            //!< Pointer to image plane
 
       for (j=0; j < iminheight; j++)
       {        
-        j_pos = (j + offset_y) * size_x + offset_x;
-        for (i=0; i < iminwidth; i++)
-        {
-          ui16=0;
-          memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-          imgX[j + dst_offset_y][i + dst_offset_x] = (imgpel) rshift_rnd(ui16,bitshift);
-        }
+        conv->shift_row(&imgX[j + dst_offset_y][dst_offset_x], buf + ((j + offset_y) * size_x + offset_x) * symbol_size_in_bytes, iminwidth, symbol_size_in_bytes, bitshift);
       }    
     }
   }
@@ -608,19 +403,14 @@ void buf2img_basic (imgpel** imgX,            //!< Pointer to image plane
   }
   else
   {
-    int j_pos;
-    uint16 ui16;
+    // 8 bit samples in a wider imgpel
+    const PelConvert *conv = get_pel_convert();
+
     if (size_x == o_size_x && size_y == o_size_y)
     {
       for (j=0; j < o_size_y; j++)
       {
-        j_pos = j * size_x;
-        for (i=0; i < o_size_x; i++)
-        {
-          ui16=0;          
-          memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-          imgX[j][i]= (imgpel) ui16;
-        }
+        conv->widen_row(imgX[j], buf + j * size_x, o_size_x);
       }    
     }
     else
@@ -645,19 +435,9 @@ void buf2img_basic (imgpel** imgX,            //!< Pointer to image plane
       iminwidth  =  ( (dst_offset_x + iminwidth ) > o_size_x  ) ? (o_size_x  - dst_offset_x) : iminwidth;
       iminheight =  ( (dst_offset_y + iminheight) > o_size_y )  ? (o_size_y - dst_offset_y) : iminheight;
 
-      for (j = 0; j < iminheight; j++) 
-      {
-        memcpy(&imgX[j + dst_offset_y][dst_offset_x], &(temp_buf[(j + offset_y) * size_x + offset_x]), iminwidth * symbol_size_in_bytes);
-      }
       for (j=0; j < iminheight; j++)
       {        
-        j_pos = (j + offset_y) * size_x + offset_x;
-        for (i=0; i < iminwidth; i++)
-        {
-          ui16 = 0;
-          memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-          imgX[j + dst_offset_y][i + dst_offset_x]= (imgpel) ui16;
-        }
+        conv->widen_row(&imgX[j + dst_offset_y][dst_offset_x], &(temp_buf[(j + offset_y) * size_x + offset_x]), iminwidth);
       }    
     }
   }
@@ -800,6 +580,7 @@ int read_one_frame (VideoParameters *p_Vid, VideoDataFile *input_file, int Frame
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
   int file_read = 0;
+  unsigned char *buf = p_Vid->buf;
   unsigned int symbol_size_in_bytes = source->pic_unit_size_shift3;
 
   const int bytes_y  = source->size_cmp[0] * symbol_size_in_bytes;
@@ -808,7 +589,17 @@ int read_one_frame (VideoParameters *p_Vid, VideoDataFile *input_file, int Frame
 
   Boolean rgb_input = (Boolean) (source->color_model == CM_RGB && source->yuv_format == YUV444);
 
-  if (input_file->is_concatenated == 0)
+  if (input_file->stream != NULL)
+  {
+    file_read = ReadFrameStream (p_Inp, input_file, FrameNoInFile, source, p_Vid->buf);
+  }
+  else if (input_file->map != NULL)
+  {
+    // the frame is converted straight from the mapped file
+    buf = MapFrameConcatenated (p_Inp, input_file, FrameNoInFile);
+    file_read = (buf != NULL);
+  }
+  else if (input_file->is_concatenated == 0)
   {    
     if (input_file->vdtype == VIDEO_TIFF)
     {
@@ -833,14 +624,15 @@ int read_one_frame (VideoParameters *p_Vid, VideoDataFile *input_file, int Frame
   if (input_file->is_interleaved)
   {
     deinterleave ( &p_Vid->buf, &p_Vid->ibuf, source, symbol_size_in_bytes);
+    buf = p_Vid->buf;
   }
 
   bit_scale = source->bit_depth[0] - output->bit_depth[0];  
 
   if(rgb_input)
-    p_Vid->buf2img(pImage[0], p_Vid->buf + bytes_y, source->width[0], source->height[0], output->width[0], output->height[0], symbol_size_in_bytes, bit_scale);
+    p_Vid->buf2img(pImage[0], buf + bytes_y, source->width[0], source->height[0], output->width[0], output->height[0], symbol_size_in_bytes, bit_scale);
   else
-    p_Vid->buf2img(pImage[0], p_Vid->buf, source->width[0], source->height[0], output->width[0], output->height[0], symbol_size_in_bytes, bit_scale);
+    p_Vid->buf2img(pImage[0], buf, source->width[0], source->height[0], output->width[0], output->height[0], symbol_size_in_bytes, bit_scale);
 
 #if (DEBUG_BITDEPTH)
   MaskMSBs(pImage[0], ((1 << output->bit_depth[0]) - 1), output->width[0], output->height[0]);
@@ -854,15 +646,15 @@ int read_one_frame (VideoParameters *p_Vid, VideoDataFile *input_file, int Frame
 #endif
     {
       if(rgb_input)
-        p_Vid->buf2img(pImage[1], p_Vid->buf + bytes_y + bytes_uv, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
+        p_Vid->buf2img(pImage[1], buf + bytes_y + bytes_uv, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
       else 
-        p_Vid->buf2img(pImage[1], p_Vid->buf + bytes_y, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
+        p_Vid->buf2img(pImage[1], buf + bytes_y, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
 
       bit_scale = source->bit_depth[2] - output->bit_depth[2];
       if(rgb_input)
-        p_Vid->buf2img(pImage[2], p_Vid->buf, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
+        p_Vid->buf2img(pImage[2], buf, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
       else
-        p_Vid->buf2img(pImage[2], p_Vid->buf + bytes_y + bytes_uv, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
+        p_Vid->buf2img(pImage[2], buf + bytes_y + bytes_uv, source->width[1], source->height[1], output->width[1], output->height[1], symbol_size_in_bytes, bit_scale);
     }
 #if (DEBUG_BITDEPTH)
     MaskMSBs(pImage[1], ((1 << output->bit_depth[1]) - 1), output->width[1], output->height[1]);
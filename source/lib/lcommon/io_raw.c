@@ -16,9 +16,30 @@
 
 #include "global.h"
 #include "img_io.h"
+#include "memalloc.h"
+
+#if !(defined(WIN32) || defined(WIN64))
+#define MAP_INPUT
+#include <sys/mman.h>
+#endif
 
 #define FAST_READ 1
 
+//! Memory mapped concatenated input file
+typedef struct frame_map
+{
+  byte   *data;              //!< mapping of the whole file
+  int64   size;              //!< file size
+  int64   header_size;       //!< bytes before the first frame
+  int64   frame_size;        //!< bytes per frame
+  int64   page_size;
+  int     frames_behind;     //!< frames kept mapped behind the furthest frame read
+  int     frames_ahead;      //!< frames prefetched ahead of the frame read
+  int     furthest;          //!< furthest frame read
+  int     prefetched;        //!< frames before this one have been prefetched
+  int     released;          //!< frames before this one have been released
+} FrameMap;
+
 #if FAST_READ
 static inline int ReadData (int vfile,  FrameFormat *source, unsigned char *buf)
 {
@@ -202,3 +223,156 @@ int ReadFrameSeparate (InputParameters *p_Inp, VideoDataFile *input_file, int Fr
 
   return file_read;
 }
+
+#if defined(MAP_INPUT)
+/*!
+ ************************************************************************
+ * \brief
+ *    Applies a madvise() hint to the pages covering frames [first, last)
+ *    of the mapping. Pages are only released if they lie completely
+ *    inside the range.
+ ************************************************************************
+ */
+static void advise_frames(FrameMap *p_map, int first, int last, int advice)
+{
+  int64 start = p_map->header_size + p_map->frame_size * first;
+  int64 end   = i64min(p_map->header_size + p_map->frame_size * last, p_map->size);
+
+  if (advice == MADV_DONTNEED)
+    start = (start + p_map->page_size - 1) & ~(p_map->page_size - 1);
+  else
+    start &= ~(p_map->page_size - 1);
+
+  if (end > start)
+    madvise(p_map->data + start, (size_t) (end - start), advice);
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Maps a concatenated planar input file into memory, so that frames
+ *    are converted straight from the page cache by buf2img() instead of
+ *    being read() into the frame buffer first. The kernel is told that
+ *    access is sequential; frames_ahead frames after each frame read are
+ *    prefetched, and pages more than frames_behind frames behind the
+ *    furthest frame read are released again.
+ *
+ * \return
+ *    1 if the file is mapped, 0 if the frames are read as before
+ *    (interleaved or V210 data, non seekable input, no mmap support)
+ ************************************************************************
+ */
+int OpenFrameMap(VideoDataFile *input_file, FrameFormat *source, int HeaderSize, int frames_behind, int frames_ahead)
+{
+#if defined(MAP_INPUT)
+  FrameMap *p_map;
+  struct stat st;
+  void *data;
+  int64 frame_size = (int64) (source->size_cmp[0] + 2 * source->size_cmp[1]) * source->pic_unit_size_shift3;
+
+  if (!input_file->is_concatenated || input_file->is_interleaved || input_file->stream != NULL
+    || input_file->f_num == -1 || (source->pic_unit_size_on_disk & 0x07) != 0)
+    return 0;
+
+  if (fstat(input_file->f_num, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < HeaderSize + frame_size
+    || (int64) (size_t) st.st_size != (int64) st.st_size)
+    return 0;
+
+  if ((data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, input_file->f_num, 0)) == MAP_FAILED)
+    return 0;
+
+  if ((p_map = (FrameMap *) calloc(1, sizeof(FrameMap))) == NULL)
+    no_mem_exit("OpenFrameMap: p_map");
+
+  p_map->data          = (byte *) data;
+  p_map->size          = st.st_size;
+  p_map->header_size   = HeaderSize;
+  p_map->frame_size    = frame_size;
+  p_map->page_size     = sysconf(_SC_PAGESIZE);
+  p_map->frames_behind = imax(frames_behind, 0);
+  p_map->frames_ahead  = imax(frames_ahead, 0);
+  p_map->furthest      = -1;
+
+  madvise(data, (size_t) st.st_size, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+  // file backed transparent huge pages, where the file system supports them
+  madvise(data, (size_t) st.st_size, MADV_HUGEPAGE);
+#endif
+
+  input_file->map = p_map;
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Unmaps the input file
+ ************************************************************************
+ */
+void CloseFrameMap(VideoDataFile *input_file)
+{
+  FrameMap *p_map = input_file->map;
+
+  if (p_map == NULL)
+    return;
+
+#if defined(MAP_INPUT)
+  munmap(p_map->data, (size_t) p_map->size);
+#endif
+  free(p_map);
+  input_file->map = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns the data of one frame of a mapped input file
+ *
+ * \param p_Inp
+ *    input parameters
+ * \param input_file
+ *    Input file to read from
+ * \param FrameNoInFile
+ *    Frame number in the source file
+ *
+ * \return
+ *    frame data in the mapping, NULL beyond the end of the file
+ ************************************************************************
+ */
+unsigned char *MapFrameConcatenated(InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile)
+{
+  FrameMap *p_map = input_file->map;
+  int frame = FrameNoInFile + p_Inp->start_frame;
+  int64 offset = p_map->header_size + p_map->frame_size * frame;
+
+  if (offset + p_map->frame_size > p_map->size)
+  {
+    printf ("read_one_frame: cannot read %d bytes from input file, unexpected EOF!\n", (int) p_map->frame_size);
+    return NULL;
+  }
+
+#if defined(MAP_INPUT)
+  if (frame > p_map->furthest)
+    p_map->furthest = frame;
+
+  if (frame + p_map->frames_ahead >= p_map->prefetched)
+  {
+    int first = imax(frame + 1, p_map->prefetched);
+
+    p_map->prefetched = frame + p_map->frames_ahead + 1;
+    advise_frames(p_map, first, p_map->prefetched, MADV_WILLNEED);
+  }
+
+  if (p_map->furthest - p_map->frames_behind > p_map->released)
+  {
+    advise_frames(p_map, p_map->released, p_map->furthest - p_map->frames_behind, MADV_DONTNEED);
+    p_map->released = p_map->furthest - p_map->frames_behind;
+  }
+#endif
+
+  return p_map->data + offset;
+}
@@ -17,6 +17,9 @@
 
 extern int ReadFrameConcatenated  (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, int HeaderSize, FrameFormat *source, unsigned char *buf);
 extern int ReadFrameSeparate      (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, int HeaderSize, FrameFormat *source, unsigned char *buf);
+extern int  OpenFrameMap          (VideoDataFile *input_file, FrameFormat *source, int HeaderSize, int frames_behind, int frames_ahead);
+extern void CloseFrameMap         (VideoDataFile *input_file);
+extern unsigned char *MapFrameConcatenated (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile);
 
 #endif
 
@@ -0,0 +1,615 @@
+/*!
+ *************************************************************************************
+ * \file io_stream.c
+ *
+ * \brief
+ *    Sequential video input.
+ *
+ *    Input from stdin ("-" or "stdin" as input file name), FIFOs and other
+ *    non regular files, and YUV4MPEG2 (.y4m) sequences cannot be accessed
+ *    with lseek(). They are read front to back into a ring of frame
+ *    buffers instead: frames stay available until they are more than
+ *    frames_behind frames older than the furthest frame requested, which
+ *    covers the coding order of the GOP structure. A reader thread keeps
+ *    up to frames_ahead frames beyond the furthest requested frame read in
+ *    advance, so the encoder does not wait for a producer writing into the
+ *    pipe at the same pace.
+ *
+ *    YUV4MPEG2 streams start with a header line describing the sequence
+ *    (W, H, F, C) and have a FRAME line before the planar data of every
+ *    frame. The stream header is read when the stream is opened.
+ *
+ *************************************************************************************
+ */
+#include "contributors.h"
+
+#include "global.h"
+#include "img_io.h"
+#include "memalloc.h"
+
+#if !(defined(WIN32) || defined(WIN64))
+#define STREAM_THREAD
+#include <pthread.h>
+#include <errno.h>
+#endif
+
+#define Y4M_LINE_SIZE  256
+
+typedef struct input_stream
+{
+  int        fd;
+  int        is_y4m;                   //!< YUV4MPEG2 stream
+  Y4MHeader  y4m;                      //!< YUV4MPEG2 stream header
+  byte       io_buf[STREAM_IO_SIZE];   //!< read buffer
+  int        io_pos;                   //!< next unread byte of io_buf
+  int        io_len;                   //!< bytes in io_buf
+  int        header_size;              //!< bytes skipped before the first frame
+  int        frame_size;               //!< bytes of frame data
+  int        frames_behind;            //!< frames kept behind the furthest requested frame
+  int        num_slots;                //!< frame buffers
+  byte     **slot;                     //!< frame n is kept in slot[n % num_slots]
+  int        next;                     //!< next frame to be read from the stream
+  int        reading;                  //!< frame next is being read into its slot
+  int        furthest;                 //!< furthest frame requested
+  int        copying;                  //!< frame being copied out of its slot, or -1
+  int        eof;                      //!< end of stream: next is the number of frames
+  int        threaded;                 //!< frames are read by the reader thread
+#if defined(STREAM_THREAD)
+  int             stop;
+  pthread_t       thread;
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+#endif
+} InputStream;
+
+static int read_fd(InputStream *p_is, byte *dst, int size)
+{
+  int ret;
+
+#if defined(STREAM_THREAD)
+  int state, prev;
+
+  // the reader thread may be cancelled while it waits for data (see CloseInputStream)
+  pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &state);
+  do
+  {
+    ret = (int) read(p_is->fd, dst, size);
+  } while (ret < 0 && errno == EINTR);
+  pthread_setcancelstate(state, &prev);
+#else
+  ret = (int) read(p_is->fd, dst, size);
+#endif
+
+  return ret;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Refills the empty read buffer; returns 0 at the end of the stream
+ ************************************************************************
+ */
+static int fill_buffer(InputStream *p_is)
+{
+  int ret = read_fd(p_is, p_is->io_buf, STREAM_IO_SIZE);
+
+  if (ret <= 0)
+    return 0;
+  p_is->io_pos = 0;
+  p_is->io_len = ret;
+
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads up to size bytes through the read buffer; fewer are returned
+ *    only at the end of the stream
+ ************************************************************************
+ */
+static int stream_read(InputStream *p_is, byte *dst, int size)
+{
+  int done = 0, ret;
+
+  while (done < size)
+  {
+    if (p_is->io_pos < p_is->io_len)
+    {
+      ret = imin(size - done, p_is->io_len - p_is->io_pos);
+      memcpy(dst + done, p_is->io_buf + p_is->io_pos, ret);
+      p_is->io_pos += ret;
+    }
+    else if (size - done >= STREAM_IO_SIZE)
+    {
+      // large reads bypass the buffer
+      if ((ret = read_fd(p_is, dst + done, size - done)) <= 0)
+        break;
+    }
+    else
+    {
+      if (!fill_buffer(p_is))
+        break;
+      continue;
+    }
+    done += ret;
+  }
+
+  return done;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads a line (YUV4MPEG2 headers); returns its length without the
+ *    newline, or -1 at the end of the stream. Excess characters are
+ *    dropped.
+ ************************************************************************
+ */
+static int stream_read_line(InputStream *p_is, char *line, int max_len)
+{
+  int len = 0;
+  byte c;
+
+  for (;;)
+  {
+    if (p_is->io_pos == p_is->io_len && !fill_buffer(p_is))
+      return (len > 0) ? len : -1;
+    c = p_is->io_buf[p_is->io_pos++];
+    if (c == '\n')
+      break;
+    if (len < max_len - 1)
+      line[len++] = (char) c;
+  }
+  line[len] = '\0';
+
+  return len;
+}
+
+static void parse_y4m_header(InputStream *p_is, char *line, char *fname)
+{
+  Y4MHeader *y4m = &p_is->y4m;
+  char *token, *tail;
+
+  y4m->width      = 0;
+  y4m->height     = 0;
+  y4m->frame_rate = 0.0;
+  y4m->yuv_format = YUV420;
+  y4m->bit_depth  = 8;
+
+  for (token = strtok(line + 9, " "); token != NULL; token = strtok(NULL, " "))
+  {
+    switch (token[0])
+    {
+    case 'W':
+      y4m->width = atoi(token + 1);
+      break;
+    case 'H':
+      y4m->height = atoi(token + 1);
+      break;
+    case 'F':
+      {
+        int num = (int) strtol(token + 1, &tail, 10);
+        int den = (*tail == ':') ? atoi(tail + 1) : 1;
+
+        if (num > 0 && den > 0)
+          y4m->frame_rate = (double) num / den;
+      }
+      break;
+    case 'C':
+      if (strncmp(token + 1, "mono", 4) == 0)
+      {
+        y4m->yuv_format = YUV400;
+        tail = token + 5;
+      }
+      else
+      {
+        switch (atoi(token + 1))
+        {
+        case 420: y4m->yuv_format = YUV420; break;
+        case 422: y4m->yuv_format = YUV422; break;
+        case 444: y4m->yuv_format = YUV444; break;
+        default:
+          snprintf(errortext, ET_SIZE, "%s: unsupported YUV4MPEG2 colour space %s", fname, token + 1);
+          error(errortext, 500);
+        }
+        tail = token + 4;
+      }
+      // p10, p12, ... or a bit depth after mono; jpeg, paldv, mpeg2 (420 siting) are 8 bit
+      if (*tail == 'p')
+        tail++;
+      if (*tail >= '0' && *tail <= '9')
+        y4m->bit_depth = atoi(tail);
+      break;
+    default:
+      // I (interlacing), A (aspect ratio) and X (extensions) do not affect the input
+      break;
+    }
+  }
+
+  if (y4m->width <= 0 || y4m->height <= 0)
+  {
+    snprintf(errortext, ET_SIZE, "%s: YUV4MPEG2 header without frame size", fname);
+    error(errortext, 500);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads frame n of the stream into dst
+ ************************************************************************
+ */
+static int read_stream_frame(InputStream *p_is, int n, byte *dst)
+{
+  int ret;
+
+  if (n == 0 && p_is->header_size > 0)
+  {
+    // header of a raw stream (InputHeaderLength)
+    int skip = p_is->header_size;
+
+    while (skip > 0)
+    {
+      if ((ret = stream_read(p_is, dst, imin(skip, p_is->frame_size))) <= 0)
+        return 0;
+      skip -= ret;
+    }
+  }
+
+  if (p_is->is_y4m)
+  {
+    char line[Y4M_LINE_SIZE];
+
+    if (stream_read_line(p_is, line, Y4M_LINE_SIZE) < 0)
+      return 0;
+    if (strncmp(line, "FRAME", 5) != 0)
+    {
+      printf ("ReadFrameStream: YUV4MPEG2 frame %d does not start with FRAME, end of stream assumed\n", n);
+      return 0;
+    }
+  }
+
+  ret = stream_read(p_is, dst, p_is->frame_size);
+  if (ret > 0 && ret < p_is->frame_size)
+    printf ("ReadFrameStream: cannot read %d bytes from input stream, unexpected EOF!\n", p_is->frame_size);
+
+  return (ret == p_is->frame_size);
+}
+
+#if defined(STREAM_THREAD)
+/*!
+ ************************************************************************
+ * \brief
+ *    TRUE if the next frame of the stream may replace the oldest frame
+ *    of the ring
+ ************************************************************************
+ */
+static int can_read_ahead(InputStream *p_is)
+{
+  int evict = p_is->next - p_is->num_slots;
+
+  return (evict < p_is->furthest - p_is->frames_behind && (p_is->copying < 0 || evict < p_is->copying));
+}
+
+static void *stream_reader(void *arg)
+{
+  InputStream *p_is = (InputStream *) arg;
+  int state;
+
+  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &state);
+
+  pthread_mutex_lock(&p_is->lock);
+  for (;;)
+  {
+    int ok;
+
+    while (!p_is->stop && !can_read_ahead(p_is))
+      pthread_cond_wait(&p_is->cond, &p_is->lock);
+    if (p_is->stop)
+      break;
+
+    p_is->reading = 1;
+    pthread_mutex_unlock(&p_is->lock);
+
+    ok = read_stream_frame(p_is, p_is->next, p_is->slot[p_is->next % p_is->num_slots]);
+
+    pthread_mutex_lock(&p_is->lock);
+    p_is->reading = 0;
+    if (ok)
+      p_is->next++;
+    else
+      p_is->eof = 1;
+    pthread_cond_broadcast(&p_is->cond);
+    if (p_is->eof)
+      break;
+  }
+  pthread_mutex_unlock(&p_is->lock);
+
+  return NULL;
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    TRUE if the input has to be read sequentially
+ ************************************************************************
+ */
+int IsInputStream(VideoDataFile *input_file)
+{
+#if defined(STREAM_THREAD)
+  struct stat st;
+#endif
+
+  if (input_file->vdtype == VIDEO_Y4M)
+    return 1;
+  if (strcmp(input_file->fname, "-") == 0 || strcmp(input_file->fname, "stdin") == 0)
+    return 1;
+#if defined(STREAM_THREAD)
+  // FIFOs, character devices, sockets
+  if (input_file->is_concatenated && stat(input_file->fname, &st) == 0 && !S_ISREG(st.st_mode))
+    return 1;
+#endif
+
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Opens a sequential input and reads the YUV4MPEG2 stream header. A
+ *    stream starting with the YUV4MPEG2 signature is read as such
+ *    whatever its name.
+ ************************************************************************
+ */
+void OpenInputStream(VideoDataFile *input_file)
+{
+  InputStream *p_is;
+
+  if (input_file->stream != NULL)
+    return;
+
+  if ((p_is = (InputStream *) calloc(1, sizeof(InputStream))) == NULL)
+    no_mem_exit("OpenInputStream: p_is");
+
+  if (strcmp(input_file->fname, "-") == 0 || strcmp(input_file->fname, "stdin") == 0)
+  {
+    p_is->fd = 0;
+#if (defined(WIN32) || defined(WIN64))
+    _setmode(p_is->fd, _O_BINARY);
+#endif
+  }
+  else if ((p_is->fd = open(input_file->fname, OPENFLAGS_READ)) == -1)
+  {
+    snprintf(errortext, ET_SIZE, "Input file %s does not exist", input_file->fname);
+    error (errortext, 500);
+  }
+
+  // look at the start of the stream for the YUV4MPEG2 signature
+  while (p_is->io_len < 10)
+  {
+    int ret = read_fd(p_is, p_is->io_buf + p_is->io_len, STREAM_IO_SIZE - p_is->io_len);
+
+    if (ret <= 0)
+      break;
+    p_is->io_len += ret;
+  }
+
+  if (p_is->io_len >= 10 && memcmp(p_is->io_buf, "YUV4MPEG2 ", 10) == 0)
+  {
+    char line[Y4M_LINE_SIZE];
+
+    stream_read_line(p_is, line, Y4M_LINE_SIZE);
+    parse_y4m_header(p_is, line, input_file->fname);
+    p_is->is_y4m = 1;
+    input_file->vdtype = VIDEO_Y4M;
+  }
+  else if (input_file->vdtype == VIDEO_Y4M)
+  {
+    snprintf(errortext, ET_SIZE, "%s is not a YUV4MPEG2 sequence", input_file->fname);
+    error (errortext, 500);
+  }
+
+  p_is->copying  = -1;
+  p_is->furthest = -1;
+  input_file->f_num  = p_is->fd;
+  input_file->stream = p_is;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets up the frame ring of an opened stream and starts the reader
+ *    thread (frames_ahead > 0)
+ ************************************************************************
+ */
+void StartInputStream(VideoDataFile *input_file, FrameFormat *source, int HeaderSize, int frames_behind, int frames_ahead)
+{
+  InputStream *p_is = input_file->stream;
+  Boolean is_v210 = (Boolean) (input_file->is_interleaved && source->pixel_format == V210);
+
+  p_is->frame_size    = is_v210 ? 16 * (source->size_cmp[0] / 6)
+    : (source->size_cmp[0] + 2 * source->size_cmp[1]) * source->pic_unit_size_shift3;
+  p_is->header_size   = p_is->is_y4m ? 0 : HeaderSize;
+  p_is->frames_behind = imax(frames_behind, 0);
+  p_is->num_slots     = p_is->frames_behind + imax(frames_ahead, 0) + 1;
+  get_mem2D(&p_is->slot, p_is->num_slots, p_is->frame_size);
+
+#if defined(STREAM_THREAD)
+  pthread_mutex_init(&p_is->lock, NULL);
+  pthread_cond_init(&p_is->cond, NULL);
+  if (frames_ahead > 0)
+    p_is->threaded = (pthread_create(&p_is->thread, NULL, stream_reader, p_is) == 0);
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stops the reader thread and closes the stream
+ ************************************************************************
+ */
+void CloseInputStream(VideoDataFile *input_file)
+{
+  InputStream *p_is = input_file->stream;
+
+  if (p_is == NULL)
+    return;
+
+#if defined(STREAM_THREAD)
+  if (p_is->threaded)
+  {
+    pthread_mutex_lock(&p_is->lock);
+    p_is->stop = 1;
+    pthread_cond_broadcast(&p_is->cond);
+    pthread_mutex_unlock(&p_is->lock);
+    // the reader may be blocked on a pipe whose producer is still running
+    pthread_cancel(p_is->thread);
+    pthread_join(p_is->thread, NULL);
+  }
+  if (p_is->slot != NULL)
+  {
+    pthread_cond_destroy(&p_is->cond);
+    pthread_mutex_destroy(&p_is->lock);
+  }
+#endif
+
+  if (p_is->slot != NULL)
+    free_mem2D(p_is->slot);
+  if (p_is->fd != 0)
+    close(p_is->fd);
+
+  free(p_is);
+  input_file->stream = NULL;
+  input_file->f_num  = -1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads one frame from a sequential input
+ *
+ * \param p_Inp
+ *    input parameters
+ * \param input_file
+ *    Input file to read from
+ * \param FrameNoInFile
+ *    Frame number in the source file
+ * \param source
+ *    source file (on disk) information
+ * \param buf
+ *    image buffer data
+ *
+ * \return
+ *    0 at the end of the stream
+ ************************************************************************
+ */
+int ReadFrameStream(InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, FrameFormat *source, unsigned char *buf)
+{
+  InputStream *p_is = input_file->stream;
+  int frame = FrameNoInFile + p_Inp->start_frame;
+
+#if defined(STREAM_THREAD)
+  if (p_is->threaded)
+    pthread_mutex_lock(&p_is->lock);
+#endif
+
+  if (frame > p_is->furthest)
+    p_is->furthest = frame;
+
+  if (frame < p_is->next - p_is->num_slots + p_is->reading)
+  {
+    snprintf(errortext, ET_SIZE, "ReadFrameStream: frame %d of the input stream is no longer buffered, increase InputStreamBuffer", frame);
+    error (errortext, 500);
+  }
+
+#if defined(STREAM_THREAD)
+  if (p_is->threaded)
+  {
+    pthread_cond_broadcast(&p_is->cond);
+    while (p_is->next <= frame && !p_is->eof)
+      pthread_cond_wait(&p_is->cond, &p_is->lock);
+  }
+  else
+#endif
+  {
+    while (p_is->next <= frame && !p_is->eof)
+    {
+      if (read_stream_frame(p_is, p_is->next, p_is->slot[p_is->next % p_is->num_slots]))
+        p_is->next++;
+      else
+        p_is->eof = 1;
+    }
+  }
+
+  if (frame >= p_is->next)
+  {
+#if defined(STREAM_THREAD)
+    if (p_is->threaded)
+      pthread_mutex_unlock(&p_is->lock);
+#endif
+    return 0;
+  }
+
+  p_is->copying = frame;
+#if defined(STREAM_THREAD)
+  if (p_is->threaded)
+    pthread_mutex_unlock(&p_is->lock);
+#endif
+
+  memcpy(buf, p_is->slot[frame % p_is->num_slots], p_is->frame_size);
+
+#if defined(STREAM_THREAD)
+  if (p_is->threaded)
+  {
+    pthread_mutex_lock(&p_is->lock);
+    p_is->copying = -1;
+    pthread_cond_broadcast(&p_is->cond);
+    pthread_mutex_unlock(&p_is->lock);
+    return 1;
+  }
+#endif
+
+  p_is->copying = -1;
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frames read from the stream so far (all frames once
+ *    ReadFrameStream has reported the end of the stream)
+ ************************************************************************
+ */
+int InputStreamFrames(VideoDataFile *input_file)
+{
+  InputStream *p_is = input_file->stream;
+  int frames;
+
+#if defined(STREAM_THREAD)
+  if (p_is->threaded)
+  {
+    pthread_mutex_lock(&p_is->lock);
+    frames = p_is->next;
+    pthread_mutex_unlock(&p_is->lock);
+    return frames;
+  }
+#endif
+
+  frames = p_is->next;
+  return frames;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    YUV4MPEG2 stream header of an opened stream, NULL for raw streams
+ ************************************************************************
+ */
+Y4MHeader *GetY4MHeader(VideoDataFile *input_file)
+{
+  InputStream *p_is = input_file->stream;
+
+  return (p_is != NULL && p_is->is_y4m) ? &p_is->y4m : NULL;
+}
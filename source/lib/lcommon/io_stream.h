@@ -0,0 +1,35 @@
+/*!
+ ************************************************************************
+ * \file io_stream.h
+ *
+ * \brief
+ *    Sequential (non seekable) video input: stdin, pipes and YUV4MPEG2
+ *
+ ************************************************************************
+ */
+
+#ifndef _IO_STREAM_H_
+#define _IO_STREAM_H_
+
+#define STREAM_IO_SIZE  65536   //!< size of the stream read buffer
+
+//! YUV4MPEG2 stream header
+typedef struct y4m_header
+{
+  int    width;         //!< W
+  int    height;        //!< H
+  double frame_rate;    //!< F
+  int    yuv_format;    //!< C (YUV400, YUV420, YUV422 or YUV444)
+  int    bit_depth;     //!< C (p10, p12, ...)
+} Y4MHeader;
+
+extern int  IsInputStream     (VideoDataFile *input_file);
+extern void OpenInputStream   (VideoDataFile *input_file);
+extern void StartInputStream  (VideoDataFile *input_file, FrameFormat *source, int HeaderSize, int frames_behind, int frames_ahead);
+extern void CloseInputStream  (VideoDataFile *input_file);
+extern int  ReadFrameStream   (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, FrameFormat *source, unsigned char *buf);
+extern int  InputStreamFrames (VideoDataFile *input_file);
+extern Y4MHeader *GetY4MHeader(VideoDataFile *input_file);
+
+#endif
+
@@ -28,7 +28,8 @@ typedef enum {
   VIDEO_RGB     =  1,
   VIDEO_XYZ     =  2,
   VIDEO_TIFF    =  3,
-  VIDEO_AVI     =  4
+  VIDEO_AVI     =  4,
+  VIDEO_Y4M     =  5
 } VideoFileType;
 
 typedef struct video_data_file
@@ -51,6 +52,8 @@ typedef struct video_data_file
   int           crop_y_size;           //!< crop information (y component)
   int           crop_x_offset;         //!< crop offset (x component);
   int           crop_y_offset;         //!< crop offset (y component);
+  struct input_stream *stream;         //!< sequential input (stdin, pipes, YUV4MPEG2), see io_stream.c
+  struct frame_map    *map;            //!< memory mapped concatenated input, see io_raw.c
 
   // AVI related information to be added here
   int* avi;
@@ -18,6 +18,162 @@
 #include "global.h"
 #include "memalloc.h"
 
+JM_THREAD_LOCAL MemArena *p_mem_arena = NULL;
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Create an arena. Blocks of block_size bytes (or larger for big
+ *    requests) are added as needed and kept until arena_destroy().
+ ************************************************************************
+ */
+MemArena *arena_create(size_t block_size)
+{
+  MemArena *arena;
+
+  if ((arena = (MemArena *) calloc(1, sizeof(MemArena))) == NULL)
+    no_mem_exit("arena_create: arena");
+
+  arena->block_size = block_size;
+  return arena;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free an arena and all its blocks
+ ************************************************************************
+ */
+void arena_destroy(MemArena *arena)
+{
+  if (arena != NULL)
+  {
+    MemArenaBlock *block = arena->blocks;
+    while (block != NULL)
+    {
+      MemArenaBlock *next = block->next;
+      free(block);
+      block = next;
+    }
+    free(arena);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Release all allocations of an arena. The blocks are kept and
+ *    reused by the following allocations.
+ ************************************************************************
+ */
+void arena_reset(MemArena *arena)
+{
+  arena->curr = arena->blocks;
+  arena->used = 0;
+}
+
+static MemArenaBlock *arena_new_block(MemArena *arena, size_t size)
+{
+  MemArenaBlock *block;
+  size_t header = (sizeof(MemArenaBlock) + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+
+  if (size < arena->block_size)
+    size = arena->block_size;
+  if ((block = (MemArenaBlock *) malloc(header + size + ARENA_ALIGNMENT)) == NULL)
+    no_mem_exit("arena_new_block: block");
+
+  block->base = (byte *) (((size_t) block + header + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1));
+  block->size = size;
+  return block;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate ARENA_ALIGNMENT aligned memory from an arena
+ ************************************************************************
+ */
+void *arena_alloc(MemArena *arena, size_t size)
+{
+  void *d;
+
+  size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+
+  // skip blocks kept from before the last reset that are too small
+  while (arena->curr != NULL && arena->used + size > arena->curr->size)
+  {
+    arena->curr = arena->curr->next;
+    arena->used = 0;
+  }
+
+  if (arena->curr == NULL)
+  {
+    MemArenaBlock *block = arena_new_block(arena, size);
+    MemArenaBlock **tail = &arena->blocks;
+
+    while (*tail != NULL)
+      tail = &(*tail)->next;
+    block->next = NULL;
+    *tail = block;
+
+    arena->curr = block;
+    arena->used = 0;
+  }
+
+  d = arena->curr->base + arena->used;
+  arena->used += size;
+  return d;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate zeroed memory from an arena
+ ************************************************************************
+ */
+void *arena_calloc(MemArena *arena, size_t nitems, size_t size)
+{
+  void *d = arena_alloc(arena, nitems * size);
+  memset(d, 0, nitems * size);
+  return d;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Check whether p was allocated from an arena
+ ************************************************************************
+ */
+int arena_owns(MemArena *arena, const void *p)
+{
+  MemArenaBlock *block;
+
+  for (block = arena->blocks; block != NULL; block = block->next)
+  {
+    if ((const byte *) p >= block->base && (const byte *) p < block->base + block->size)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Make the memory helpers (get_mem*, mem_malloc, mem_calloc) of the
+ *    calling thread allocate from arena, or from the heap for NULL.
+ *    mem_free() ignores memory of the selected arena.
+ *
+ * \return
+ *    the previously selected arena
+ ************************************************************************
+ */
+MemArena *arena_select(MemArena *arena)
+{
+  MemArena *prev = p_mem_arena;
+  p_mem_arena = arena;
+  return prev;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -878,29 +1034,61 @@ int get_mem2Dpel(imgpel ***array2D, int dim0, int dim1)
   return dim0 * (sizeof(imgpel*) + dim1 * sizeof(imgpel));
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Row stride of a padded plane of the given width. Rows are padded up
+ *    to a multiple of PLANE_ALIGNMENT bytes so that, together with the
+ *    alignment done in get_mem2Dpel_pad(), the first sample of every row
+ *    is PLANE_ALIGNMENT aligned.
+ ************************************************************************
+ */
+int get_plane_stride(int width, int iPadX)
+{
+  int align = PLANE_ALIGNMENT / sizeof(imgpel);
+
+  return ((width + 2 * iPadX + align - 1) / align) * align;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate a padded plane -> imgpel array2D[-iPadY..dim0+iPadY-1][-iPadX..]
+ *    The samples are stored contiguously with a stride of
+ *    get_plane_stride(dim1, iPadX); the row pointers are a legacy view.
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************
+ */
 int get_mem2Dpel_pad(imgpel ***array2D, int dim0, int dim1, int iPadY, int iPadX)
 {
   int i;
   imgpel *curr = NULL;
-  int iHeight, iWidth;
+  int iHeight, iStride;
+  size_t size;
+  byte *raw;
   
   iHeight = dim0+2*iPadY;
-  iWidth = dim1+2*iPadX;
+  iStride = get_plane_stride(dim1, iPadX);
+  size = (size_t) iHeight * iStride * sizeof(imgpel) + PLANE_ALIGNMENT + sizeof(void *);
   if((*array2D    = (imgpel**)mem_malloc(iHeight*sizeof(imgpel*))) == NULL)
     no_mem_exit("get_mem2Dpel_pad: array2D");
-  if((*(*array2D) = (imgpel* )mem_calloc(iHeight * iWidth, sizeof(imgpel ))) == NULL)
+  if((raw = (byte *) mem_calloc(size, 1)) == NULL)
     no_mem_exit("get_mem2Dpel_pad: array2D");
 
-  (*array2D)[0] += iPadX;
-  curr = (*array2D)[0];
+  // align sample column 0 and keep the allocated pointer in front of the plane for free_mem2Dpel_pad()
+  curr = (imgpel *) (((size_t) (raw + sizeof(void *) + iPadX * sizeof(imgpel)) + PLANE_ALIGNMENT - 1) & ~((size_t) PLANE_ALIGNMENT - 1)) - iPadX;
+  memcpy((byte *) curr - sizeof(void *), &raw, sizeof(void *));
+
+  (*array2D)[0] = curr + iPadX;
   for(i = 1 ; i < iHeight; i++)
   {
-    curr += iWidth;
-    (*array2D)[i] = curr;
+    (*array2D)[i] = (*array2D)[i - 1] + iStride;
   }
   (*array2D) = &((*array2D)[iPadY]);
 
-  return iHeight * (sizeof(imgpel*) + iWidth * sizeof(imgpel));
+  return iHeight * (sizeof(imgpel*) + iStride * sizeof(imgpel));
 }
 
 
@@ -917,7 +1105,7 @@ int get_mem3Dpel(imgpel ****array3D, int dim0, int dim1, int dim2)
 {
   int i, mem_size = dim0 * sizeof(imgpel**);
 
-  if(((*array3D) = (imgpel***)malloc(dim0 * sizeof(imgpel**))) == NULL)
+  if(((*array3D) = (imgpel***)mem_malloc(dim0 * sizeof(imgpel**))) == NULL)
     no_mem_exit("get_mem3Dpel: array3D");
 
   mem_size += get_mem2Dpel(*array3D, dim0 * dim1, dim2);
@@ -1070,7 +1258,9 @@ void free_mem2Dpel_pad(imgpel **array2D, int iPadY, int iPadX)
   {
     if (*array2D)
     {
-      mem_free (array2D[-iPadY]-iPadX);
+      void *raw;
+      memcpy(&raw, (byte *) (array2D[-iPadY] - iPadX) - sizeof(void *), sizeof(void *));
+      mem_free (raw);
     }
     else 
       error ("free_mem2Dpel_pad: trying to free unused memory",100);
@@ -2713,7 +2903,7 @@ void free_mem2Ddistblk(distblk **array2D)
       mem_free (*array2D);
     else 
       error ("free_mem2Ddistblk: trying to free unused memory",100);
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -23,6 +23,54 @@
 #include "lagrangian.h"
 #include "quant_params.h"
 
+#if defined(_MSC_VER)
+#define JM_THREAD_LOCAL __declspec(thread)
+#else
+#define JM_THREAD_LOCAL __thread
+#endif
+
+#define ARENA_ALIGNMENT   64            //!< alignment of arena allocations (cache line)
+
+//! block of arena memory
+typedef struct mem_arena_block
+{
+  struct mem_arena_block *next;
+  byte  *base;                          //!< ARENA_ALIGNMENT aligned start of the block
+  size_t size;
+} MemArenaBlock;
+
+//! bump allocator; memory is released all at once with arena_reset()
+typedef struct mem_arena
+{
+  MemArenaBlock *blocks;                //!< all blocks, kept over resets
+  MemArenaBlock *curr;                  //!< block allocations are served from
+  size_t used;                          //!< bytes used in curr
+  size_t block_size;                    //!< default size of new blocks
+  struct mem_arena *next;               //!< link for arena pools
+} MemArena;
+
+#define PLANE_ALIGNMENT   64            //!< byte alignment of the first sample of each row of padded pixel planes
+
+//! contiguous pixel plane: sample (x, y) is data[y * stride + x]
+typedef struct pel_plane
+{
+  imgpel *data;                         //!< sample (0, 0)
+  int     stride;                       //!< distance between vertically adjacent samples
+  int     width;
+  int     height;
+} PelPlane;
+
+//! arena the ND helpers of the calling thread allocate from (NULL: heap)
+extern JM_THREAD_LOCAL MemArena *p_mem_arena;
+
+extern MemArena *arena_create (size_t block_size);
+extern void      arena_destroy(MemArena *arena);
+extern void      arena_reset  (MemArena *arena);
+extern void     *arena_alloc  (MemArena *arena, size_t size);
+extern void     *arena_calloc (MemArena *arena, size_t nitems, size_t size);
+extern int       arena_owns   (MemArena *arena, const void *p);
+extern MemArena *arena_select (MemArena *arena);
+
 extern int  get_mem2Ddist(DistortionData ***array2D, int dim0, int dim1);
 
 extern int  get_mem2Dlm  (LambdaParams ***array2D, int dim0, int dim1);
@@ -75,6 +123,7 @@ extern int  get_mem7Dshort(short ********array7D, int dim0, int dim1, int dim2,
 
 extern int  get_mem1Dpel(imgpel **array2D, int dim0);
 extern int  get_mem2Dpel(imgpel ***array2D, int dim0, int dim1);
+extern int  get_plane_stride(int width, int iPadX);
 extern int  get_mem2Dpel_pad(imgpel ***array2D, int dim0, int dim1, int iPadY, int iPadX);
 
 extern int  get_mem3Dpel    (imgpel ****array3D, int dim0, int dim1, int dim2);
@@ -187,6 +236,8 @@ extern void free_mem3Dpel_2SLayers(imgpel ****buf0, imgpel ****buf1);
 static inline void* mem_malloc(size_t nitems)
 {
   void *d;
+  if (p_mem_arena != NULL)
+    return arena_alloc(p_mem_arena, nitems);
   if((d = malloc(nitems)) == NULL)
   {
     no_mem_exit("malloc failed.\n");
@@ -209,9 +260,26 @@ static inline void* mem_calloc(size_t nitems, size_t size)
   return d;
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Stride-based view of a contiguous imgpel** array, e.g. a plane
+ *    allocated with get_mem2Dpel_pad() or get_mem2Dpel()
+ ************************************************************************
+ */
+static inline void get_pel_plane(PelPlane *plane, imgpel **img, int width, int height)
+{
+  plane->data   = img[0];
+  plane->stride = (height > 1) ? (int) (img[1] - img[0]) : width;
+  plane->width  = width;
+  plane->height = height;
+}
+
 static inline void mem_free(void *a)
 {
-  free_pointer(a);
+  // memory of the selected arena is released by arena_reset()
+  if (p_mem_arena == NULL || !arena_owns(p_mem_arena, a))
+    free_pointer(a);
 }
 
 #endif
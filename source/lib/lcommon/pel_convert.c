@@ -0,0 +1,373 @@
+/*!
+ *************************************************************************************
+ * \file pel_convert.c
+ *
+ * \brief
+ *    Sample format conversions between file buffers and image planes:
+ *    widening of 8 bit samples, bit depth shifts, narrowing to 8 bit,
+ *    deinterleaving of packed (YUYV, UYVY, ...) formats and unpacking
+ *    of V210.
+ *
+ *    Every kernel has a plain C version and an SSE4.1 version. Like the
+ *    other vectorized paths, the SSE4.1 table is selected at compile time
+ *    (JM_SIMD, i.e. a build with -msse4.1), so a binary built that way
+ *    requires SSE4.1. Both give identical results; pel_convert_bench
+ *    checks and times them.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "pel_convert.h"
+#include "simd.h"
+
+const PackedLayout layout_yuv420 = { 6, { 1, 0, 0, 2, 0, 0 } };
+const PackedLayout layout_yuv444 = { 3, { 0, 1, 2 } };
+const PackedLayout layout_yuyv   = { 4, { 0, 1, 0, 2 } };
+const PackedLayout layout_yvyu   = { 4, { 0, 2, 0, 1 } };
+const PackedLayout layout_uyvy   = { 4, { 1, 0, 2, 0 } };
+
+static void widen_row_c(imgpel *dst, const byte *src, int n)
+{
+  int i;
+
+  for (i = 0; i < n; ++i)
+    dst[i] = (imgpel) src[i];
+}
+
+static void shift_row_c(imgpel *dst, const byte *src, int n, int symbol_size_in_bytes, int bitshift)
+{
+  int i;
+  uint16 ui16;
+
+  for (i = 0; i < n; ++i)
+  {
+    ui16 = 0;
+    memcpy(&ui16, src + i * symbol_size_in_bytes, symbol_size_in_bytes);
+    dst[i] = (imgpel) rshift_rnd(ui16, bitshift);
+  }
+}
+
+static void narrow_row_c(byte *dst, const imgpel *src, int n)
+{
+  int i;
+
+  for (i = 0; i < n; ++i)
+    dst[i] = (byte) src[i];
+}
+
+static void deinterleave_c(byte *dst[3], const byte *src, const PackedLayout *layout, int symbol_size_in_bytes, int groups)
+{
+  byte *cmp[3];
+  int i, k;
+
+  cmp[0] = dst[0];
+  cmp[1] = dst[1];
+  cmp[2] = dst[2];
+
+  for (i = 0; i < groups; ++i)
+  {
+    for (k = 0; k < layout->period; ++k)
+    {
+      byte **p = &cmp[layout->plane[k]];
+
+      memcpy(*p, src, symbol_size_in_bytes);
+      *p  += symbol_size_in_bytes;
+      src += symbol_size_in_bytes;
+    }
+  }
+}
+
+static void unpack_v210_c(uint16 *dst[3], const byte *src, int blocks)
+{
+  uint16 *y = dst[0], *cb = dst[1], *cr = dst[2];
+  unsigned int w[4];
+  int i;
+
+  for (i = 0; i < blocks; ++i)
+  {
+    memcpy(w, src, 16);
+    src += 16;
+
+    // Cr 0 | Y 0 | Cb 0
+    cr[0] = (uint16) ((w[0] >> 20) & 0x3FF);
+    y [0] = (uint16) ((w[0] >> 10) & 0x3FF);
+    cb[0] = (uint16) ( w[0]        & 0x3FF);
+    // Y 2 | Cb 1 | Y 1
+    y [2] = (uint16) ((w[1] >> 20) & 0x3FF);
+    cb[1] = (uint16) ((w[1] >> 10) & 0x3FF);
+    y [1] = (uint16) ( w[1]        & 0x3FF);
+    // Cb 2 | Y 3 | Cr 1
+    cb[2] = (uint16) ((w[2] >> 20) & 0x3FF);
+    y [3] = (uint16) ((w[2] >> 10) & 0x3FF);
+    cr[1] = (uint16) ( w[2]        & 0x3FF);
+    // Y 5 | Cr 2 | Y 4
+    y [5] = (uint16) ((w[3] >> 20) & 0x3FF);
+    cr[2] = (uint16) ((w[3] >> 10) & 0x3FF);
+    y [4] = (uint16) ( w[3]        & 0x3FF);
+
+    y  += 6;
+    cb += 3;
+    cr += 3;
+  }
+}
+
+static const PelConvert pel_convert_c =
+{
+  "C",
+  widen_row_c,
+  shift_row_c,
+  narrow_row_c,
+  deinterleave_c,
+  unpack_v210_c
+};
+
+#if defined(JM_SIMD)
+#define PACK_BLOCK  48   //!< bytes of packed data per iteration (a whole number of groups of every layout)
+
+//! Store the first n (4, 8, 12 or 16) bytes of v
+static inline void store_bytes(byte *dst, __m128i v, int n)
+{
+  if (n == 16)
+  {
+    _mm_storeu_si128((__m128i *) dst, v);
+    return;
+  }
+  if (n >= 8)
+  {
+    _mm_storel_epi64((__m128i *) dst, v);
+    v = _mm_srli_si128(v, 8);
+    dst += 8;
+    n -= 8;
+  }
+  if (n > 0)
+  {
+    int w = _mm_cvtsi128_si32(v);
+    memcpy(dst, &w, 4);
+  }
+}
+
+//! Store 8 16 bit values as samples, truncated like a cast to imgpel
+static inline void store_pel8_trunc(imgpel *dst, __m128i v)
+{
+#if (IMGTYPE == 0)
+  _mm_storel_epi64((__m128i *) dst, _mm_packus_epi16(_mm_and_si128(v, _mm_set1_epi16(0xFF)), v));
+#else
+  _mm_storeu_si128((__m128i *) dst, v);
+#endif
+}
+
+static void widen_row_sse41(imgpel *dst, const byte *src, int n)
+{
+#if (IMGTYPE == 0)
+  memcpy(dst, src, n);
+#else
+  int i;
+
+  for (i = 0; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+
+    _mm_storeu_si128((__m128i *) (dst + i    ), _mm_cvtepu8_epi16(v));
+    _mm_storeu_si128((__m128i *) (dst + i + 8), _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+  }
+  for (; i < n; ++i)
+    dst[i] = (imgpel) src[i];
+#endif
+}
+
+static void shift_row_sse41(imgpel *dst, const byte *src, int n, int symbol_size_in_bytes, int bitshift)
+{
+  __m128i one = _mm_set1_epi16(1);
+  __m128i s   = _mm_cvtsi32_si128(iabs(bitshift));
+  __m128i s1  = _mm_cvtsi32_si128(bitshift - 1);
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m128i v = (symbol_size_in_bytes == 1) ? _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *) (src + i)))
+      : _mm_loadu_si128((const __m128i *) (src + 2 * i));
+
+    // (v + (1 << (s - 1))) >> s without the 16 bit overflow
+    if (bitshift > 0)
+      v = _mm_add_epi16(_mm_srl_epi16(v, s), _mm_and_si128(_mm_srl_epi16(v, s1), one));
+    else
+      v = _mm_sll_epi16(v, s);
+    store_pel8_trunc(dst + i, v);
+  }
+  shift_row_c(dst + i, src + i * symbol_size_in_bytes, n - i, symbol_size_in_bytes, bitshift);
+}
+
+static void narrow_row_sse41(byte *dst, const imgpel *src, int n)
+{
+#if (IMGTYPE == 0)
+  memcpy(dst, src, n);
+#else
+  __m128i mask = _mm_set1_epi16(0xFF);
+  int i;
+
+  for (i = 0; i + 16 <= n; i += 16)
+  {
+    __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *) (src + i    )), mask);
+    __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *) (src + i + 8)), mask);
+
+    _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(a, b));
+  }
+  for (; i < n; ++i)
+    dst[i] = (byte) src[i];
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Deinterleaves PACK_BLOCK bytes at a time: every plane gets up to 32
+ *    bytes, each 16 bytes gathered from the three input vectors with
+ *    byte shuffles built from the layout
+ ************************************************************************
+ */
+static void deinterleave_sse41(byte *dst[3], const byte *src, const PackedLayout *layout, int symbol_size_in_bytes, int groups)
+{
+  int group_size = layout->period * symbol_size_in_bytes;
+  int blocks = (PACK_BLOCK % group_size) ? 0 : groups * group_size / PACK_BLOCK;
+  byte   m[3][2][3][16];
+  __m128i mask[3][2][3];
+  int    used[3][2][3];
+  int    count[3] = { 0, 0, 0 };
+  byte  *cmp[3];
+  int i, p, r, k;
+
+  memset(m, 0x80, sizeof(m));
+  memset(used, 0, sizeof(used));
+  for (i = 0; i < PACK_BLOCK; ++i)
+  {
+    int o;
+
+    p = layout->plane[(i / symbol_size_in_bytes) % layout->period];
+    o = count[p]++;
+    m[p][o >> 4][i >> 4][o & 15] = (byte) (i & 15);
+    used[p][o >> 4][i >> 4] = 1;
+  }
+  for (p = 0; p < 3; ++p)
+    for (r = 0; r < 2; ++r)
+      for (k = 0; k < 3; ++k)
+        mask[p][r][k] = _mm_loadu_si128((const __m128i *) m[p][r][k]);
+
+  cmp[0] = dst[0];
+  cmp[1] = dst[1];
+  cmp[2] = dst[2];
+
+  for (i = 0; i < blocks; ++i)
+  {
+    __m128i in[3];
+
+    in[0] = _mm_loadu_si128((const __m128i *) (src     ));
+    in[1] = _mm_loadu_si128((const __m128i *) (src + 16));
+    in[2] = _mm_loadu_si128((const __m128i *) (src + 32));
+    src += PACK_BLOCK;
+
+    for (p = 0; p < 3; ++p)
+    {
+      for (r = 0; r * 16 < count[p]; ++r)
+      {
+        __m128i v = _mm_setzero_si128();
+
+        for (k = 0; k < 3; ++k)
+        {
+          if (used[p][r][k])
+            v = _mm_or_si128(v, _mm_shuffle_epi8(in[k], mask[p][r][k]));
+        }
+        store_bytes(cmp[p] + 16 * r, v, imin(16, count[p] - 16 * r));
+      }
+      cmp[p] += count[p];
+    }
+  }
+
+  deinterleave_c(cmp, src, layout, symbol_size_in_bytes, groups - blocks * PACK_BLOCK / group_size);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Unpacks V210 one 16 byte block at a time: the three 10 bit fields
+ *    of the four words are extracted, packed to 16 bits and shuffled
+ *    into 6 Y, 3 Cb and 3 Cr samples. The stores write a few samples
+ *    past the block, which the next block overwrites; the last block
+ *    is therefore unpacked by the C version.
+ ************************************************************************
+ */
+static void unpack_v210_sse41(uint16 *dst[3], const byte *src, int blocks)
+{
+  const __m128i m10 = _mm_set1_epi32(0x3FF);
+  // fields f0 (bits 0-9) and f1 (bits 10-19) of words 0-3 as P[0-3] and P[4-7], f2 (bits 20-29) as Q[0-3]
+  const __m128i y_p  = _mm_setr_epi8( 8,  9,  2,  3, -1, -1, 12, 13,  6,  7, -1, -1, -1, -1, -1, -1);
+  const __m128i y_q  = _mm_setr_epi8(-1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  6,  7, -1, -1, -1, -1);
+  const __m128i cb_p = _mm_setr_epi8( 0,  1, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i cb_q = _mm_setr_epi8(-1, -1, -1, -1,  4,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i cr_p = _mm_setr_epi8(-1, -1,  4,  5, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i cr_q = _mm_setr_epi8( 0,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  uint16 *y = dst[0], *cb = dst[1], *cr = dst[2];
+  uint16 *rest[3];
+  int i;
+
+  for (i = 0; i < blocks - 1; ++i)
+  {
+    __m128i w  = _mm_loadu_si128((const __m128i *) src);
+    __m128i f0 = _mm_and_si128(w, m10);
+    __m128i f1 = _mm_and_si128(_mm_srli_epi32(w, 10), m10);
+    __m128i f2 = _mm_and_si128(_mm_srli_epi32(w, 20), m10);
+    __m128i P  = _mm_packus_epi32(f0, f1);
+    __m128i Q  = _mm_packus_epi32(f2, f2);
+
+    _mm_storeu_si128((__m128i *) y, _mm_or_si128(_mm_shuffle_epi8(P, y_p), _mm_shuffle_epi8(Q, y_q)));
+    _mm_storel_epi64((__m128i *) cb, _mm_or_si128(_mm_shuffle_epi8(P, cb_p), _mm_shuffle_epi8(Q, cb_q)));
+    _mm_storel_epi64((__m128i *) cr, _mm_or_si128(_mm_shuffle_epi8(P, cr_p), _mm_shuffle_epi8(Q, cr_q)));
+
+    src += 16;
+    y  += 6;
+    cb += 3;
+    cr += 3;
+  }
+
+  rest[0] = y;
+  rest[1] = cb;
+  rest[2] = cr;
+  unpack_v210_c(rest, src, blocks - i);
+}
+
+static const PelConvert pel_convert_sse41 =
+{
+  "SSE4.1",
+  widen_row_sse41,
+  shift_row_sse41,
+  narrow_row_sse41,
+  deinterleave_sse41,
+  unpack_v210_sse41
+};
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Conversion kernels of this build
+ ************************************************************************
+ */
+const PelConvert *get_pel_convert(void)
+{
+#if defined(JM_SIMD)
+  return &pel_convert_sse41;
+#else
+  return &pel_convert_c;
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Plain C conversion kernels (reference for the vectorized ones)
+ ************************************************************************
+ */
+const PelConvert *get_pel_convert_c(void)
+{
+  return &pel_convert_c;
+}
@@ -0,0 +1,48 @@
+/*!
+ ************************************************************************
+ * \file pel_convert.h
+ *
+ * \brief
+ *    Sample format conversions between file buffers and image planes
+ *
+ ************************************************************************
+ */
+
+#ifndef _PEL_CONVERT_H_
+#define _PEL_CONVERT_H_
+
+#include "typedefs.h"
+
+//! Order of the components in one group of a packed (interleaved) format
+typedef struct packed_layout
+{
+  int period;       //!< samples per group
+  int plane[6];     //!< component (0: Y, 1: U, 2: V) of each sample of the group
+} PackedLayout;
+
+//! Conversion kernels, selected for the build (see get_pel_convert)
+typedef struct pel_convert
+{
+  const char *name;
+  //! n 8 bit file samples to imgpel
+  void (*widen_row)    (imgpel *dst, const byte *src, int n);
+  //! n 8 or 16 bit (little endian) file samples to imgpel, with rshift_rnd(sample, bitshift)
+  void (*shift_row)    (imgpel *dst, const byte *src, int n, int symbol_size_in_bytes, int bitshift);
+  //! n imgpel to 8 bit file samples (truncating like a cast)
+  void (*narrow_row)   (byte *dst, const imgpel *src, int n);
+  //! groups of a packed format to the three planes
+  void (*deinterleave) (byte *dst[3], const byte *src, const PackedLayout *layout, int symbol_size_in_bytes, int groups);
+  //! blocks of 16 bytes (6 4:2:2 pixels) of 10 bit V210 to three 16 bit planes
+  void (*unpack_v210)  (uint16 *dst[3], const byte *src, int blocks);
+} PelConvert;
+
+extern const PackedLayout layout_yuv420;   //!< U Y Y V Y Y
+extern const PackedLayout layout_yuv444;   //!< Y U V
+extern const PackedLayout layout_yuyv;     //!< Y U Y V
+extern const PackedLayout layout_yvyu;     //!< Y V Y U
+extern const PackedLayout layout_uyvy;     //!< U Y V Y
+
+extern const PelConvert *get_pel_convert   (void);
+extern const PelConvert *get_pel_convert_c (void);
+
+#endif
@@ -15,6 +15,7 @@
 //#include <malloc.h>
 #include "global.h"
 #include "resize.h"
+#include "simd.h"
 
 /****************************************************************************************\
 Down-sampling pyramids macros
@@ -103,6 +104,66 @@ Up-sampling pyramids macros
 
 typedef int worktype;
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Horizontal 1-4-6-4-1 filter and 2:1 decimation of one row
+ *    (interior output samples x0 <= x < x1)
+ ************************************************************************
+ */
+static inline void pyr_down_row(worktype *row, const imgpel *src, int x0, int x1)
+{
+  int x = x0;
+#if defined(JM_SIMD)
+  const __m128i even_mask = _mm_set1_epi32(0xFFFF);
+  for (; x + 4 <= x1; x += 4)
+  {
+    // 16 bit samples; the low half of each 32 bit lane holds the even sample
+    __m128i v0 = simd_load_pel8(src + 2 * x - 2);
+    __m128i v1 = simd_load_pel8(src + 2 * x);
+    __m128i v2 = simd_load_pel8(src + 2 * x + 2);
+    __m128i e0 = _mm_and_si128(v0, even_mask);
+    __m128i o0 = _mm_srli_epi32(v0, 16);
+    __m128i e1 = _mm_and_si128(v1, even_mask);
+    __m128i o1 = _mm_srli_epi32(v1, 16);
+    __m128i e2 = _mm_and_si128(v2, even_mask);
+    __m128i sum = _mm_add_epi32(_mm_add_epi32(e0, e2), _mm_slli_epi32(_mm_add_epi32(o0, o1), 2));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(e1, _mm_set1_epi32(6)));
+    _mm_storeu_si128((__m128i *) (row + x), sum);
+  }
+#endif
+  for (; x < x1; x++)
+  {
+    row[x] = PD_FILTER( src[2*x-2], src[2*x-1], src[2*x], src[2*x+1], src[2*x+2] );
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Vertical 1-4-6-4-1 filter of five buffered rows, scaled to samples
+ ************************************************************************
+ */
+static inline void pyr_down_col(imgpel *dst, const worktype *r0, const worktype *r1, const worktype *r2, const worktype *r3, const worktype *r4, int width)
+{
+  int x = 0;
+#if defined(JM_SIMD)
+  const __m128i round = _mm_set1_epi32(1 << 7);
+  for (; x + 4 <= width; x += 4)
+  {
+    __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i *) (r0 + x)), _mm_loadu_si128((const __m128i *) (r4 + x)));
+    __m128i mid = _mm_loadu_si128((const __m128i *) (r2 + x));
+    sum = _mm_add_epi32(sum, _mm_slli_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i *) (r1 + x)), _mm_loadu_si128((const __m128i *) (r3 + x))), 2));
+    sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_slli_epi32(mid, 2), _mm_slli_epi32(mid, 1)));
+    simd_store_pel4(dst + x, _mm_srai_epi32(_mm_add_epi32(sum, round), 8));
+  }
+#endif
+  for (; x < width; x++)
+  {
+    dst[x] = (imgpel)PD_SCALE_INT( PD_FILTER( r0[x], r1[x], r2[x], r3[x], r4[x] ));
+  }
+}
+
 /*******************************************************
 only downsample 2:1, the destination is width/2*(height+1)/2;
 ********************************************************/
@@ -166,10 +227,7 @@ int PyrDownG5x5_U8CnR(  const imgpel* src,
           row[0]    = PD_LT( src[0], src[1], src[2] );
           row[Wd-1] = PD_RB( src[Wd*2-4], src[Wd*2-3], src[Wd*2-2], src[Wd*2-1]);
           /* other points (even) */
-          for( x = 1; x < Wd - 1; x++ )
-          {
-            row[x] = PD_FILTER( src[2*x-2], src[2*x-1], src[2*x], src[2*x+1], src[2*x+2] );
-          }
+          pyr_down_row(row, src, 1, Wd - 1);
         }
       }
       else
@@ -216,10 +274,7 @@ int PyrDownG5x5_U8CnR(  const imgpel* src,
     {
       if( y < height - PD_SZ/2 )
       {
-        for( x = 0; x < Wdn; x++, x1++ )
-        {
-          dst[x] = (imgpel)PD_SCALE_INT( PD_FILTER( row01[x],  row01[x1], row23[x], row23[x1], row4[x] ));
-        }
+        pyr_down_col(dst, row01, row01 + x1, row23, row23 + x1, row4, Wdn);
         top_row += 2*buffer_step;
         top_row &= top_row < pd_sz ? -1 : 0;
       }
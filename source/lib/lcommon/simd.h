@@ -0,0 +1,305 @@
+/*!
+ ************************************************************************
+ *  \file
+ *     simd.h
+ *
+ *  \brief
+ *     SSE4.1 helpers shared by the vectorized kernels. All users must
+ *     keep a plain C path for builds where JM_SIMD is not defined.
+ *
+ ************************************************************************
+ */
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include "typedefs.h"
+
+#if (defined(__SSE4_1__) || defined(__AVX__)) && !defined(DISABLE_SIMD) // Check SSE4.1 intrinsics availability
+# define JM_SIMD
+#endif
+
+#if defined(JM_SIMD)
+#include <smmintrin.h>
+
+//! Load 4 consecutive samples and zero extend them to 32 bits
+static inline __m128i simd_load_pel4(const imgpel *p)
+{
+#if (IMGTYPE == 0)
+  int v;
+  memcpy(&v, p, sizeof(int));
+  return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v));
+#else
+  return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *) p));
+#endif
+}
+
+//! Store 4 32 bit values, already clipped to the sample range, as samples
+static inline void simd_store_pel4(imgpel *p, __m128i v)
+{
+  v = _mm_packus_epi32(v, v);
+#if (IMGTYPE == 0)
+  {
+    int w = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+    memcpy(p, &w, sizeof(int));
+  }
+#else
+  _mm_storel_epi64((__m128i *) p, v);
+#endif
+}
+
+//! Load 8 consecutive samples as 16 bit values
+static inline __m128i simd_load_pel8(const imgpel *p)
+{
+#if (IMGTYPE == 0)
+  return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *) p));
+#else
+  return _mm_loadu_si128((const __m128i *) p);
+#endif
+}
+
+//! Store 8 16 bit values as samples
+static inline void simd_store_pel8(imgpel *p, __m128i v)
+{
+#if (IMGTYPE == 0)
+  _mm_storel_epi64((__m128i *) p, _mm_packus_epi16(v, v));
+#else
+  _mm_storeu_si128((__m128i *) p, v);
+#endif
+}
+
+//! Horizontal sum of 4 32 bit lanes
+static inline int simd_hsum_epi32(__m128i v)
+{
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+//! Transpose a 4x4 block of 32 bit values held in four row vectors
+static inline void simd_transpose4x4_epi32(__m128i *r0, __m128i *r1, __m128i *r2, __m128i *r3)
+{
+  __m128i t0 = _mm_unpacklo_epi32(*r0, *r1);
+  __m128i t1 = _mm_unpacklo_epi32(*r2, *r3);
+  __m128i t2 = _mm_unpackhi_epi32(*r0, *r1);
+  __m128i t3 = _mm_unpackhi_epi32(*r2, *r3);
+
+  *r0 = _mm_unpacklo_epi64(t0, t1);
+  *r1 = _mm_unpackhi_epi64(t0, t1);
+  *r2 = _mm_unpacklo_epi64(t2, t3);
+  *r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+//! Transpose an 8x8 block of 32 bit values, row i is held in v[2 * i] (left half) and v[2 * i + 1]
+static inline void simd_transpose8x8_epi32(__m128i *v)
+{
+  __m128i t[16];
+  int g, h, k;
+
+  for (g = 0; g < 2; ++g)
+  {
+    for (h = 0; h < 2; ++h)
+    {
+      __m128i r0 = v[8 * h + g], r1 = v[8 * h + 2 + g], r2 = v[8 * h + 4 + g], r3 = v[8 * h + 6 + g];
+      simd_transpose4x4_epi32(&r0, &r1, &r2, &r3);
+      t[8 * g + h] = r0;
+      t[8 * g + 2 + h] = r1;
+      t[8 * g + 4 + h] = r2;
+      t[8 * g + 6 + h] = r3;
+    }
+  }
+  for (k = 0; k < 16; ++k)
+    v[k] = t[k];
+}
+
+//! One pass of the 4 point forward core transform on the vectors v[0], v[s], v[2s], v[3s]
+static inline void simd_fwd4_pass(__m128i *v, int s)
+{
+  __m128i t0 = _mm_add_epi32(v[0], v[3 * s]);
+  __m128i t1 = _mm_add_epi32(v[s], v[2 * s]);
+  __m128i t2 = _mm_sub_epi32(v[s], v[2 * s]);
+  __m128i t3 = _mm_sub_epi32(v[0], v[3 * s]);
+
+  v[0]     = _mm_add_epi32(t0, t1);
+  v[s]     = _mm_add_epi32(t2, _mm_slli_epi32(t3, 1));
+  v[2 * s] = _mm_sub_epi32(t0, t1);
+  v[3 * s] = _mm_sub_epi32(t3, _mm_slli_epi32(t2, 1));
+}
+
+//! One pass of the 4 point inverse core transform on the vectors v[0], v[s], v[2s], v[3s]
+static inline void simd_inv4_pass(__m128i *v, int s)
+{
+  __m128i p0 = _mm_add_epi32(v[0], v[2 * s]);
+  __m128i p1 = _mm_sub_epi32(v[0], v[2 * s]);
+  __m128i p2 = _mm_sub_epi32(_mm_srai_epi32(v[s], 1), v[3 * s]);
+  __m128i p3 = _mm_add_epi32(v[s], _mm_srai_epi32(v[3 * s], 1));
+
+  v[0]     = _mm_add_epi32(p0, p3);
+  v[s]     = _mm_add_epi32(p1, p2);
+  v[2 * s] = _mm_sub_epi32(p1, p2);
+  v[3 * s] = _mm_sub_epi32(p0, p3);
+}
+
+//! One pass of the 8 point forward transform on the vectors v[0], v[s], ..., v[7s]
+static inline void simd_fwd8_pass(__m128i *v, int s)
+{
+  __m128i p0 = v[0], p1 = v[s], p2 = v[2 * s], p3 = v[3 * s];
+  __m128i p4 = v[4 * s], p5 = v[5 * s], p6 = v[6 * s], p7 = v[7 * s];
+  __m128i a0 = _mm_add_epi32(p0, p7);
+  __m128i a1 = _mm_add_epi32(p1, p6);
+  __m128i a2 = _mm_add_epi32(p2, p5);
+  __m128i a3 = _mm_add_epi32(p3, p4);
+  __m128i b0 = _mm_add_epi32(a0, a3);
+  __m128i b1 = _mm_add_epi32(a1, a2);
+  __m128i b2 = _mm_sub_epi32(a0, a3);
+  __m128i b3 = _mm_sub_epi32(a1, a2);
+  __m128i b4, b5, b6, b7;
+
+  a0 = _mm_sub_epi32(p0, p7);
+  a1 = _mm_sub_epi32(p1, p6);
+  a2 = _mm_sub_epi32(p2, p5);
+  a3 = _mm_sub_epi32(p3, p4);
+
+  b4 = _mm_add_epi32(_mm_add_epi32(a1, a2), _mm_add_epi32(_mm_srai_epi32(a0, 1), a0));
+  b5 = _mm_sub_epi32(_mm_sub_epi32(a0, a3), _mm_add_epi32(_mm_srai_epi32(a2, 1), a2));
+  b6 = _mm_sub_epi32(_mm_add_epi32(a0, a3), _mm_add_epi32(_mm_srai_epi32(a1, 1), a1));
+  b7 = _mm_add_epi32(_mm_sub_epi32(a1, a2), _mm_add_epi32(_mm_srai_epi32(a3, 1), a3));
+
+  v[0]     = _mm_add_epi32(b0, b1);
+  v[s]     = _mm_add_epi32(b4, _mm_srai_epi32(b7, 2));
+  v[2 * s] = _mm_add_epi32(b2, _mm_srai_epi32(b3, 1));
+  v[3 * s] = _mm_add_epi32(b5, _mm_srai_epi32(b6, 2));
+  v[4 * s] = _mm_sub_epi32(b0, b1);
+  v[5 * s] = _mm_sub_epi32(b6, _mm_srai_epi32(b5, 2));
+  v[6 * s] = _mm_sub_epi32(_mm_srai_epi32(b2, 1), b3);
+  v[7 * s] = _mm_sub_epi32(_mm_srai_epi32(b4, 2), b7);
+}
+
+//! One pass of the 8 point inverse transform on the vectors v[0], v[s], ..., v[7s]
+static inline void simd_inv8_pass(__m128i *v, int s)
+{
+  __m128i p0 = v[0], p1 = v[s], p2 = v[2 * s], p3 = v[3 * s];
+  __m128i p4 = v[4 * s], p5 = v[5 * s], p6 = v[6 * s], p7 = v[7 * s];
+  __m128i a0 = _mm_add_epi32(p0, p4);
+  __m128i a1 = _mm_sub_epi32(p0, p4);
+  __m128i a2 = _mm_sub_epi32(p6, _mm_srai_epi32(p2, 1));
+  __m128i a3 = _mm_add_epi32(p2, _mm_srai_epi32(p6, 1));
+  __m128i b0 = _mm_add_epi32(a0, a3);
+  __m128i b2 = _mm_sub_epi32(a1, a2);
+  __m128i b4 = _mm_add_epi32(a1, a2);
+  __m128i b6 = _mm_sub_epi32(a0, a3);
+  __m128i b1, b3, b5, b7;
+
+  a0 = _mm_sub_epi32(_mm_sub_epi32(p5, p3), _mm_add_epi32(p7, _mm_srai_epi32(p7, 1)));
+  a1 = _mm_sub_epi32(_mm_add_epi32(p1, p7), _mm_add_epi32(p3, _mm_srai_epi32(p3, 1)));
+  a2 = _mm_add_epi32(_mm_sub_epi32(p7, p1), _mm_add_epi32(p5, _mm_srai_epi32(p5, 1)));
+  a3 = _mm_add_epi32(_mm_add_epi32(p3, p5), _mm_add_epi32(p1, _mm_srai_epi32(p1, 1)));
+
+  b1 = _mm_add_epi32(a0, _mm_srai_epi32(a3, 2));
+  b3 = _mm_add_epi32(a1, _mm_srai_epi32(a2, 2));
+  b5 = _mm_sub_epi32(a2, _mm_srai_epi32(a1, 2));
+  b7 = _mm_sub_epi32(a3, _mm_srai_epi32(a0, 2));
+
+  v[0]     = _mm_add_epi32(b0, b7);
+  v[s]     = _mm_sub_epi32(b2, b5);
+  v[2 * s] = _mm_add_epi32(b4, b3);
+  v[3 * s] = _mm_add_epi32(b6, b1);
+  v[4 * s] = _mm_sub_epi32(b6, b1);
+  v[5 * s] = _mm_sub_epi32(b4, b3);
+  v[6 * s] = _mm_add_epi32(b2, b5);
+  v[7 * s] = _mm_sub_epi32(b0, b7);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    2D core transforms on blocks held in row vectors. The horizontal
+ *    pass works on the transposed block, so the results are bit exact
+ *    with the scalar versions in transform.c.
+ ************************************************************************
+ */
+static inline void simd_forward4x4(__m128i *v)
+{
+  simd_transpose4x4_epi32(&v[0], &v[1], &v[2], &v[3]);
+  simd_fwd4_pass(v, 1);
+  simd_transpose4x4_epi32(&v[0], &v[1], &v[2], &v[3]);
+  simd_fwd4_pass(v, 1);
+}
+
+static inline void simd_inverse4x4(__m128i *v)
+{
+  simd_transpose4x4_epi32(&v[0], &v[1], &v[2], &v[3]);
+  simd_inv4_pass(v, 1);
+  simd_transpose4x4_epi32(&v[0], &v[1], &v[2], &v[3]);
+  simd_inv4_pass(v, 1);
+}
+
+static inline void simd_forward8x8(__m128i *v)
+{
+  simd_transpose8x8_epi32(v);
+  simd_fwd8_pass(v, 2);
+  simd_fwd8_pass(v + 1, 2);
+  simd_transpose8x8_epi32(v);
+  simd_fwd8_pass(v, 2);
+  simd_fwd8_pass(v + 1, 2);
+}
+
+static inline void simd_inverse8x8(__m128i *v)
+{
+  simd_transpose8x8_epi32(v);
+  simd_inv8_pass(v, 2);
+  simd_inv8_pass(v + 1, 2);
+  simd_transpose8x8_epi32(v);
+  simd_inv8_pass(v, 2);
+  simd_inv8_pass(v + 1, 2);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hadamard transform passes used by the SATD metrics. The outputs
+ *    are in sequency order up to sign, which does not change the sum
+ *    of absolute values.
+ ************************************************************************
+ */
+static inline void simd_hadamard4_pass(__m128i *v, int s)
+{
+  __m128i t0 = _mm_add_epi32(v[0], v[s]);
+  __m128i t1 = _mm_sub_epi32(v[0], v[s]);
+  __m128i t2 = _mm_add_epi32(v[2 * s], v[3 * s]);
+  __m128i t3 = _mm_sub_epi32(v[2 * s], v[3 * s]);
+
+  v[0]     = _mm_add_epi32(t0, t2);
+  v[s]     = _mm_sub_epi32(t0, t2);
+  v[2 * s] = _mm_add_epi32(t1, t3);
+  v[3 * s] = _mm_sub_epi32(t1, t3);
+}
+
+static inline void simd_hadamard8_pass(__m128i *v, int s)
+{
+  __m128i t[8];
+  int k;
+
+  for (k = 0; k < 4; ++k)
+  {
+    t[k]     = _mm_add_epi32(v[k * s], v[(k + 4) * s]);
+    t[k + 4] = _mm_sub_epi32(v[k * s], v[(k + 4) * s]);
+  }
+  simd_hadamard4_pass(t, 1);
+  simd_hadamard4_pass(t + 4, 1);
+  for (k = 0; k < 8; ++k)
+    v[k * s] = t[k];
+}
+
+//! Sum of absolute values of n vectors of 32 bit values
+static inline int simd_sum_abs_epi32(const __m128i *v, int n)
+{
+  __m128i sum = _mm_abs_epi32(v[0]);
+  int k;
+
+  for (k = 1; k < n; ++k)
+    sum = _mm_add_epi32(sum, _mm_abs_epi32(v[k]));
+  return simd_hsum_epi32(sum);
+}
+#endif
+
+#endif
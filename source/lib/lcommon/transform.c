@@ -15,10 +15,21 @@
 
 #include "global.h"
 #include "transform.h"
+#include "simd.h"
 
 
 void forward4x4(int **block, int **tblock, int pos_y, int pos_x)
 {
+#if defined(JM_SIMD)
+  __m128i v[4];
+  int i;
+
+  for (i = 0; i < BLOCK_SIZE; i++)
+    v[i] = _mm_loadu_si128((__m128i *) &block[pos_y + i][pos_x]);
+  simd_forward4x4(v);
+  for (i = 0; i < BLOCK_SIZE; i++)
+    _mm_storeu_si128((__m128i *) &tblock[pos_y + i][pos_x], v[i]);
+#else
   int i, ii;  
   int tmp[16];
   int *pTmp = tmp, *pblock;
@@ -65,10 +76,21 @@ void forward4x4(int **block, int **tblock, int pos_y, int pos_x)
     tblock[pos_y + 2][ii] = t0 -  t1;
     tblock[pos_y + 3][ii] = t3 - (t2 << 1);
   }
+#endif
 }
 
 void inverse4x4(int **tblock, int **block, int pos_y, int pos_x)
 {
+#if defined(JM_SIMD)
+  __m128i v[4];
+  int i;
+
+  for (i = 0; i < BLOCK_SIZE; i++)
+    v[i] = _mm_loadu_si128((__m128i *) &tblock[pos_y + i][pos_x]);
+  simd_inverse4x4(v);
+  for (i = 0; i < BLOCK_SIZE; i++)
+    _mm_storeu_si128((__m128i *) &block[pos_y + i][pos_x], v[i]);
+#else
   int i, ii;  
   int tmp[16];
   int *pTmp = tmp, *pblock;
@@ -115,6 +137,7 @@ void inverse4x4(int **tblock, int **block, int pos_y, int pos_x)
     block[pos_y + 2][ii] = p1 - p2;
     block[pos_y + 3][ii] = p0 - p3;
   }
+#endif
 }
 
 
@@ -352,6 +375,22 @@ void ihadamard2x2(int tblock[4], int block[4])
 
 void forward8x8(int **block, int **tblock, int pos_y, int pos_x)
 {
+#if defined(JM_SIMD)
+  __m128i v[16];
+  int i;
+
+  for (i = 0; i < BLOCK_SIZE_8x8; i++)
+  {
+    v[2 * i    ] = _mm_loadu_si128((__m128i *) &block[pos_y + i][pos_x    ]);
+    v[2 * i + 1] = _mm_loadu_si128((__m128i *) &block[pos_y + i][pos_x + 4]);
+  }
+  simd_forward8x8(v);
+  for (i = 0; i < BLOCK_SIZE_8x8; i++)
+  {
+    _mm_storeu_si128((__m128i *) &tblock[pos_y + i][pos_x    ], v[2 * i    ]);
+    _mm_storeu_si128((__m128i *) &tblock[pos_y + i][pos_x + 4], v[2 * i + 1]);
+  }
+#else
   int i, ii;  
   int tmp[64];
   int *pTmp = tmp, *pblock;
@@ -445,10 +484,27 @@ void forward8x8(int **block, int **tblock, int pos_y, int pos_x)
     tblock[pos_y + 6][ii] = (b2 >> 1) - b3;
     tblock[pos_y + 7][ii] = (b4 >> 2) - b7;
   }
+#endif
 }
 
 void inverse8x8(int **tblock, int **block, int pos_x)
 {
+#if defined(JM_SIMD)
+  __m128i v[16];
+  int i;
+
+  for (i = 0; i < BLOCK_SIZE_8x8; i++)
+  {
+    v[2 * i    ] = _mm_loadu_si128((__m128i *) &tblock[i][pos_x    ]);
+    v[2 * i + 1] = _mm_loadu_si128((__m128i *) &tblock[i][pos_x + 4]);
+  }
+  simd_inverse8x8(v);
+  for (i = 0; i < BLOCK_SIZE_8x8; i++)
+  {
+    _mm_storeu_si128((__m128i *) &block[i][pos_x    ], v[2 * i    ]);
+    _mm_storeu_si128((__m128i *) &block[i][pos_x + 4], v[2 * i + 1]);
+  }
+#else
   int i, ii;
   int tmp[64];
   int *pTmp = tmp, *pblock;
@@ -544,5 +600,6 @@ void inverse8x8(int **tblock, int **block, int pos_x)
     block[6][ii] = b2 + b5;
     block[7][ii] = b0 - b7;
   }
+#endif
 }
 
@@ -30,14 +30,17 @@ typedef          int   int32;
 #if IMGTYPE == 0
 typedef byte   imgpel;           //!< pixel type
 typedef uint16 distpel;          //!< distortion type (for pixels)
-typedef int32  distblk;          //!< distortion type (for Macroblock)
-typedef int32  transpel;         //!< transformed coefficient type
 #else
 typedef uint16 imgpel;
 typedef uint32 distpel;
+#endif
+
+#if DISTTYPE == 0
+typedef int32  distblk;          //!< distortion type (for Macroblock)
+#else
 typedef int64  distblk;
-typedef int32  transpel;
 #endif
+typedef int32  transpel;         //!< transformed coefficient type
 
 //! Boolean Type
 #ifdef FALSE